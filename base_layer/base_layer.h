@@ -25,12 +25,24 @@
 #define BASE_LAYER_H
 
 #include "generated/generated_vulkan_dispatch_table.h"
+#include "logging.h"
 
 #include "vulkan/vulkan.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <string>
 #include <unordered_map>
+#include <vector>
+
+#if defined(__ANDROID__)
+#include <sys/system_properties.h>
+#endif
 
 #ifndef LAYER_NAME
 #error "LAYER_NAME must be defined"
@@ -91,6 +103,48 @@ VKAPI_ATTR VkResult VKAPI_CALL base_layer_CreateDevice(VkPhysicalDevice
                                                        const VkAllocationCallbacks* pAllocator,
                                                        VkDevice*                    pDevice);
 
+// Layers that intercept any of the following functions must forward them through these instead of the dispatch table,
+// as they maintain the instance, physical device, device and child handle tables.
+VKAPI_ATTR void VKAPI_CALL base_layer_DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator);
+
+VKAPI_ATTR VkResult VKAPI_CALL base_layer_EnumeratePhysicalDevices(VkInstance        instance,
+                                                                   uint32_t*         pPhysicalDeviceCount,
+                                                                   VkPhysicalDevice* pPhysicalDevices);
+
+VKAPI_ATTR VkResult VKAPI_CALL
+base_layer_EnumeratePhysicalDeviceGroups(VkInstance                       instance,
+                                         uint32_t*                        pPhysicalDeviceGroupCount,
+                                         VkPhysicalDeviceGroupProperties* pPhysicalDeviceGroupProperties);
+
+VKAPI_ATTR VkResult VKAPI_CALL
+base_layer_EnumeratePhysicalDeviceGroupsKHR(VkInstance                       instance,
+                                            uint32_t*                        pPhysicalDeviceGroupCount,
+                                            VkPhysicalDeviceGroupProperties* pPhysicalDeviceGroupProperties);
+
+VKAPI_ATTR void VKAPI_CALL base_layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator);
+
+VKAPI_ATTR void VKAPI_CALL base_layer_GetDeviceQueue(VkDevice device,
+                                                     uint32_t queueFamilyIndex,
+                                                     uint32_t queueIndex,
+                                                     VkQueue* pQueue);
+
+VKAPI_ATTR void VKAPI_CALL base_layer_GetDeviceQueue2(VkDevice                  device,
+                                                      const VkDeviceQueueInfo2* pQueueInfo,
+                                                      VkQueue*                  pQueue);
+
+VKAPI_ATTR VkResult VKAPI_CALL base_layer_AllocateCommandBuffers(VkDevice                           device,
+                                                                 const VkCommandBufferAllocateInfo* pAllocateInfo,
+                                                                 VkCommandBuffer*                   pCommandBuffers);
+
+VKAPI_ATTR void VKAPI_CALL base_layer_FreeCommandBuffers(VkDevice               device,
+                                                         VkCommandPool          commandPool,
+                                                         uint32_t               commandBufferCount,
+                                                         const VkCommandBuffer* pCommandBuffers);
+
+VKAPI_ATTR void VKAPI_CALL base_layer_DestroyCommandPool(VkDevice                     device,
+                                                         VkCommandPool                commandPool,
+                                                         const VkAllocationCallbacks* pAllocator);
+
 extern "C"
 {
     VKAPI_ATTR VkResult VKAPI_CALL vkNegotiateLoaderLayerInterfaceVersion(VkNegotiateLayerInterface* pVersionStruct);
@@ -110,28 +164,503 @@ extern "C"
                                                                               VkLayerProperties* pProperties);
 }
 
+// Number of child layers compiled into this layer. A layer fused from several child layers defines BASE_LAYER_FUSED
+// to their count, see base_layer/fused_layer.inc.
+#if defined(BASE_LAYER_FUSED)
+static constexpr size_t kChildLayerCount = BASE_LAYER_FUSED;
+#else
+static constexpr size_t kChildLayerCount = 1;
+#endif
+
 struct instance_dispatch_table
 {
-    VkInstance    instance;
-    InstanceTable dispatch_table;
+    VkInstance                    instance;
+    InstanceTable                 dispatch_table;
+    DispatchKey                   dispatch_key{ nullptr };
+    PFN_GetPhysicalDeviceProcAddr next_gpdpa{ nullptr };
+#if defined(BASE_LAYER_FUSED)
+    // The instance as seen by each fused child layer. Its entries lead to the hooks of the next child layer.
+    std::vector<instance_dispatch_table> fused_children;
+#endif
+};
+
+struct physical_device_dispatch_table
+{
+    VkPhysicalDevice         physical_device;
+    instance_dispatch_table* instance_table;
+
+    // Extensions reported by the chain below the layer, guarded by physical_device_lock
+    std::vector<VkExtensionProperties> device_extensions;
+    bool                               device_extensions_cached{ false };
+#if defined(BASE_LAYER_FUSED)
+    // The physical device as seen by each fused child layer, which points to the child layer's view of the instance
+    std::vector<physical_device_dispatch_table> fused_children;
+#endif
+};
+
+// Memoizes the results of vkGetDeviceProcAddr for one device. The table is open addressed by a hash of the command
+// name and never grows; names that do not fit are looked up every time. Published entries are immutable, so lookups
+// and insertions are lock-free. Entries are freed with the cache when the device is destroyed.
+class proc_addr_cache
+{
+  public:
+    proc_addr_cache() = default;
+
+    ~proc_addr_cache()
+    {
+        for (std::atomic<const entry*>& slot : slots_)
+        {
+            delete slot.load(std::memory_order_relaxed);
+        }
+    }
+
+    proc_addr_cache(const proc_addr_cache&)            = delete;
+    proc_addr_cache& operator=(const proc_addr_cache&) = delete;
+
+    bool find(const char* name, PFN_vkVoidFunction* function) const
+    {
+        const uint64_t hash = HashName(name);
+        size_t         i    = static_cast<size_t>(hash) & kMask;
+        for (size_t probes = 0; probes < kCapacity; ++probes, i = (i + 1) & kMask)
+        {
+            const entry* existing = slots_[i].load(std::memory_order_acquire);
+            if (existing == nullptr)
+            {
+                break;
+            }
+            else if ((existing->hash == hash) && (existing->name == name))
+            {
+                *function = existing->function;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void insert(const char* name, PFN_vkVoidFunction function)
+    {
+        entry* added = new entry{ HashName(name), name, function };
+        size_t i     = static_cast<size_t>(added->hash) & kMask;
+        for (size_t probes = 0; probes < kCapacity; ++probes, i = (i + 1) & kMask)
+        {
+            const entry* existing = nullptr;
+            if (slots_[i].compare_exchange_strong(existing, added, std::memory_order_acq_rel))
+            {
+                return;
+            }
+            else if ((existing->hash == added->hash) && (existing->name == added->name))
+            {
+                // Another thread cached the same name
+                break;
+            }
+        }
+
+        delete added;
+    }
+
+  private:
+    static constexpr size_t kCapacity = 512;
+    static constexpr size_t kMask     = kCapacity - 1;
+
+    struct entry
+    {
+        uint64_t           hash;
+        std::string        name;
+        PFN_vkVoidFunction function;
+    };
+
+    static uint64_t HashName(const char* name)
+    {
+        // FNV-1a
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (; *name != '\0'; ++name)
+        {
+            hash = (hash ^ static_cast<uint8_t>(*name)) * 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    std::atomic<const entry*> slots_[kCapacity] = {};
 };
 
+// The dispatch table is interned and may be shared with other devices, see intern_device_table.
 struct device_dispatch_table
 {
-    VkDevice    device;
-    DeviceTable dispatch_table;
+    VkDevice                         device;
+    const DeviceTable&               dispatch_table;
+    DispatchKey                      dispatch_key{ nullptr };
+    std::unique_ptr<proc_addr_cache> proc_addrs{ std::make_unique<proc_addr_cache>() };
+    // Layer defined state of the device. Set by layer_CreateDevice before the device is returned to the application
+    // and released by layer_DestroyDevice, so it is never modified while being read. Each fused child layer has its
+    // own, as it sees the device through its own table.
+    void*                            layer_data{ nullptr };
+#if defined(BASE_LAYER_FUSED)
+    // The device as seen by each fused child layer. Its entries lead to the hooks of the next child layer.
+    std::unique_ptr<DeviceTable[]>     fused_tables;
+    std::vector<device_dispatch_table> fused_children;
+#endif
+};
+
+struct child_handle_info
+{
+    device_dispatch_table* device_table{ nullptr };
+    void*                  layer_data{ nullptr };
+};
+
+// Associates the dispatchable child objects of a device (queues and command buffers) with the dispatch table of
+// their device and a slot for layer defined state, so that both are found with a single lookup that does not go
+// through GetDispatchKey and device_handles. Each child layer of a fused layer has its own state slot. The table is
+// open addressed and indexed directly by the handle's
+// address. Lookups never lock; insertions and removals are serialized by a mutex. Storage replaced when the table
+// grows is retired instead of freed, as lookups may still be probing it, until release_retired is called.
+class child_handle_table
+{
+  public:
+    child_handle_table() { grow(kInitialCapacity); }
+
+    bool find(const void* handle, child_handle_info* info, size_t layer_index = 0) const
+    {
+        const storage* table = current_.load(std::memory_order_acquire);
+        size_t i = table->index_of(handle);
+        for (size_t probes = 0; probes < table->capacity; ++probes, i = (i + 1) & table->mask)
+        {
+            const void* key = table->slots[i].handle.load(std::memory_order_acquire);
+            if (key == handle)
+            {
+                info->device_table = table->slots[i].device_table.load(std::memory_order_relaxed);
+                info->layer_data   = table->slots[i].layer_data[layer_index].load(std::memory_order_acquire);
+                return true;
+            }
+            else if (key == nullptr)
+            {
+                break;
+            }
+        }
+
+        return false;
+    }
+
+    void insert(const void* handle, device_dispatch_table* device_table, uint64_t parent)
+    {
+        std::lock_guard<std::mutex> lock(write_lock_);
+        storage*                    table = current_.load(std::memory_order_relaxed);
+
+        slot* existing = find_slot(table, handle);
+        if (existing != nullptr)
+        {
+            // vkGetDeviceQueue returns the same queue handle every time it is called
+            existing->device_table.store(device_table, std::memory_order_relaxed);
+            existing->parent = parent;
+            return;
+        }
+
+        if ((table->used + 1) * 4 > table->capacity * 3)
+        {
+            table = grow(table->capacity * 2);
+        }
+
+        insert_slot(table, handle, device_table, parent, nullptr);
+    }
+
+    // Sets the layer defined state of a handle. Returns false if the handle is not in the table.
+    bool set_layer_data(const void* handle, void* layer_data, size_t layer_index = 0)
+    {
+        std::lock_guard<std::mutex> lock(write_lock_);
+        slot*                       existing = find_slot(current_.load(std::memory_order_relaxed), handle);
+        if (existing != nullptr)
+        {
+            existing->layer_data[layer_index].store(layer_data, std::memory_order_release);
+            return true;
+        }
+
+        return false;
+    }
+
+    void erase(const void* handle)
+    {
+        std::lock_guard<std::mutex> lock(write_lock_);
+        slot*                       existing = find_slot(current_.load(std::memory_order_relaxed), handle);
+        if (existing != nullptr)
+        {
+            existing->handle.store(kTombstone, std::memory_order_release);
+        }
+    }
+
+    // Erases all handles of a device created from parent, e.g. the command buffers of a destroyed command pool. Parents
+    // are non-dispatchable handles, which are only unique within their device.
+    void erase_children(const device_dispatch_table* device_table, uint64_t parent)
+    {
+        std::lock_guard<std::mutex> lock(write_lock_);
+        storage*                    table = current_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < table->capacity; ++i)
+        {
+            const void* key = table->slots[i].handle.load(std::memory_order_relaxed);
+            if ((key != nullptr) && (key != kTombstone) && (table->slots[i].parent == parent) &&
+                (table->slots[i].device_table.load(std::memory_order_relaxed) == device_table))
+            {
+                table->slots[i].handle.store(kTombstone, std::memory_order_release);
+            }
+        }
+    }
+
+    // Erases all handles that belong to a device.
+    void erase_device(const device_dispatch_table* device_table)
+    {
+        std::lock_guard<std::mutex> lock(write_lock_);
+        storage*                    table = current_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < table->capacity; ++i)
+        {
+            const void* key = table->slots[i].handle.load(std::memory_order_relaxed);
+            if ((key != nullptr) && (key != kTombstone) &&
+                (table->slots[i].device_table.load(std::memory_order_relaxed) == device_table))
+            {
+                table->slots[i].handle.store(kTombstone, std::memory_order_release);
+            }
+        }
+    }
+
+    // Frees the storage retired when the table grew. Must only be called while no lookup can be in progress, which
+    // holds once the last device is destroyed, as queues and command buffers are only used while their device exists.
+    void release_retired()
+    {
+        std::lock_guard<std::mutex> lock(write_lock_);
+        if (tables_.size() > 1)
+        {
+            tables_.erase(tables_.begin(), tables_.end() - 1);
+        }
+    }
+
+  private:
+    static constexpr size_t kInitialCapacity = 256;
+
+    struct slot
+    {
+        std::atomic<const void*>            handle{ nullptr };
+        std::atomic<device_dispatch_table*> device_table{ nullptr };
+        std::atomic<void*>                  layer_data[kChildLayerCount] = {};
+        uint64_t                            parent{ 0 };
+    };
+
+    struct storage
+    {
+        explicit storage(size_t size) : capacity(size), mask(size - 1), slots(new slot[size]) {}
+
+        size_t index_of(const void* handle) const
+        {
+            // Fibonacci hashing spreads the aligned handle addresses over the table
+            return static_cast<size_t>((reinterpret_cast<uintptr_t>(handle) * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+        }
+
+        size_t                  capacity;
+        size_t                  mask;
+        size_t                  used{ 0 };
+        std::unique_ptr<slot[]> slots;
+    };
+
+    static slot* find_slot(storage* table, const void* handle)
+    {
+        size_t i = table->index_of(handle);
+        for (size_t probes = 0; probes < table->capacity; ++probes, i = (i + 1) & table->mask)
+        {
+            const void* key = table->slots[i].handle.load(std::memory_order_relaxed);
+            if (key == handle)
+            {
+                return &table->slots[i];
+            }
+            else if (key == nullptr)
+            {
+                break;
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Inserts a handle, copying the layer defined state from previous when the table is rebuilt. The slot of an erased
+    // handle is reused, so that tables with handle churn are rebuilt less often.
+    static void insert_slot(
+        storage* table, const void* handle, device_dispatch_table* device_table, uint64_t parent, const slot* previous)
+    {
+        size_t      i   = table->index_of(handle);
+        const void* key = table->slots[i].handle.load(std::memory_order_relaxed);
+        while ((key != nullptr) && (key != kTombstone))
+        {
+            i   = (i + 1) & table->mask;
+            key = table->slots[i].handle.load(std::memory_order_relaxed);
+        }
+
+        // The entry must be complete before lookups can match its handle
+        table->slots[i].device_table.store(device_table, std::memory_order_relaxed);
+        for (size_t layer = 0; layer < kChildLayerCount; ++layer)
+        {
+            void* layer_data = (previous != nullptr) ? previous->layer_data[layer].load(std::memory_order_relaxed)
+                                                     : nullptr;
+            table->slots[i].layer_data[layer].store(layer_data, std::memory_order_relaxed);
+        }
+        table->slots[i].parent = parent;
+        table->slots[i].handle.store(handle, std::memory_order_release);
+        table->used += (key == nullptr) ? 1 : 0;
+    }
+
+    // Moves the live entries to new storage. Tombstones are dropped and count towards the load factor until then, so
+    // the table may be rebuilt at the same capacity.
+    storage* grow(size_t capacity)
+    {
+        storage* previous = current_.load(std::memory_order_relaxed);
+        if (previous != nullptr)
+        {
+            size_t live = 0;
+            for (size_t i = 0; i < previous->capacity; ++i)
+            {
+                const void* key = previous->slots[i].handle.load(std::memory_order_relaxed);
+                live += ((key != nullptr) && (key != kTombstone)) ? 1 : 0;
+            }
+
+            if ((live + 1) * 2 <= previous->capacity)
+            {
+                capacity = previous->capacity;
+            }
+        }
+
+        tables_.emplace_back(new storage(capacity));
+        storage* table = tables_.back().get();
+
+        if (previous != nullptr)
+        {
+            for (size_t i = 0; i < previous->capacity; ++i)
+            {
+                const void* key = previous->slots[i].handle.load(std::memory_order_relaxed);
+                if ((key != nullptr) && (key != kTombstone))
+                {
+                    insert_slot(table,
+                                key,
+                                previous->slots[i].device_table.load(std::memory_order_relaxed),
+                                previous->slots[i].parent,
+                                &previous->slots[i]);
+                }
+            }
+        }
+
+        current_.store(table, std::memory_order_release);
+        return table;
+    }
+
+    static inline const void* const kTombstone = reinterpret_cast<const void*>(~uintptr_t(0));
+
+    std::mutex                            write_lock_;
+    std::atomic<storage*>                 current_{ nullptr };
+    std::vector<std::unique_ptr<storage>> tables_;
+};
+
+static child_handle_table child_handles;
+
+#if defined(BASE_LAYER_FUSED)
+typedef PFN_vkVoidFunction(VKAPI_PTR* PFN_layer_GetProcAddr)(const char* pName);
+
+// Entry points of a child layer compiled into a fused layer, see fused_layer.inc.
+struct fused_child_layer
+{
+    PFN_layer_GetProcAddr get_proc_addr;
+    PFN_vkCreateInstance  create_instance;
+    PFN_vkCreateDevice    create_device;
+};
+#endif
+
+// Opt-in lock-free cache in front of instance_handles and device_handles, enabled by defining
+// BASE_LAYER_DIRECT_DISPATCH before including base_layer.inc. The device slots are maintained in every layer, as
+// they also serve the lookups of CachedGetDeviceProcAddr. Applications create very few instances and devices, so
+// a handful of slots that are scanned linearly replace the shared lock and the hash map lookup. Each slot holds the
+// dispatch key next to the table, and the table is only read once the key matches. A table is removed from its slot
+// before it is freed, and that only happens while its own handle is not in use, so a matching key guarantees that the
+// table is alive. Tables that do not fit are still found through the maps.
+template <typename T>
+class direct_dispatch_slots
+{
+  public:
+    T* find(DispatchKey key) const
+    {
+        for (const slot& entry : slots_)
+        {
+            if ((key != nullptr) && (entry.key.load(std::memory_order_acquire) == key))
+            {
+                return entry.table.load(std::memory_order_relaxed);
+            }
+        }
+
+        return nullptr;
+    }
+
+    // Must be called with global_lock held for writing.
+    void add(T* table)
+    {
+        for (slot& entry : slots_)
+        {
+            if (entry.key.load(std::memory_order_relaxed) == nullptr)
+            {
+                // The table must be stored before lookups can match its key
+                entry.table.store(table, std::memory_order_relaxed);
+                entry.key.store(table->dispatch_key, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    // Must be called with global_lock held for writing.
+    void remove(const T* table)
+    {
+        for (slot& entry : slots_)
+        {
+            if ((entry.key.load(std::memory_order_relaxed) != nullptr) &&
+                (entry.table.load(std::memory_order_relaxed) == table))
+            {
+                entry.key.store(nullptr, std::memory_order_release);
+                entry.table.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    }
+
+  private:
+    static constexpr size_t kSlotCount = 8;
+
+    struct slot
+    {
+        std::atomic<DispatchKey> key{ nullptr };
+        std::atomic<T*>          table{ nullptr };
+    };
+
+    slot slots_[kSlotCount];
 };
 
+#if defined(BASE_LAYER_DIRECT_DISPATCH)
+static direct_dispatch_slots<instance_dispatch_table> direct_instance_handles;
+#endif
+static direct_dispatch_slots<device_dispatch_table> direct_device_handles;
+
 static std::shared_mutex                                        global_lock;
 static std::unordered_map<const void*, instance_dispatch_table> instance_handles;
 static std::unordered_map<const void*, device_dispatch_table>   device_handles;
 
+// Physical devices are looked up by handle under their own lock, so that physical device queries from many threads
+// only ever share it for reading. Entries are added when physical devices are enumerated through the layer.
+static std::shared_mutex                                                    physical_device_lock;
+static std::unordered_map<VkPhysicalDevice, physical_device_dispatch_table> physical_device_handles;
+
+static void add_physical_device_handles(VkInstance instance, uint32_t count, const VkPhysicalDevice* physical_devices);
+static void remove_physical_device_handles(const instance_dispatch_table* instance_table);
+
 static InstanceTable* add_instance_handle(VkInstance instance)
 {
     // Store the instance for use with vkCreateDevice.
     std::unique_lock<std::shared_mutex> lock(global_lock);
-    instance_handles[GetDispatchKey(instance)] = { instance, InstanceTable() };
-    return &instance_handles[GetDispatchKey(instance)].dispatch_table;
+    instance_dispatch_table&            entry = instance_handles[GetDispatchKey(instance)];
+    entry                                     = { instance, InstanceTable(), GetDispatchKey(instance) };
+#if defined(BASE_LAYER_DIRECT_DISPATCH)
+    direct_instance_handles.remove(&entry);
+    direct_instance_handles.add(&entry);
+#endif
+    return &entry.dispatch_table;
 }
 
 static void remove_instance_handle(const void* handle)
@@ -140,23 +669,190 @@ static void remove_instance_handle(const void* handle)
     auto                                entry = instance_handles.find(GetDispatchKey(handle));
     if (entry != instance_handles.end())
     {
+#if defined(BASE_LAYER_DIRECT_DISPATCH)
+        direct_instance_handles.remove(&entry->second);
+#endif
+        remove_physical_device_handles(&entry->second);
         instance_handles.erase(entry);
     }
 }
 
 static instance_dispatch_table* get_instance_handle(const void* handle)
 {
+#if defined(BASE_LAYER_DIRECT_DISPATCH)
+    instance_dispatch_table* direct_entry = direct_instance_handles.find(GetDispatchKey(handle));
+    if (direct_entry != nullptr)
+    {
+        return direct_entry;
+    }
+#endif
+
     std::shared_lock<std::shared_mutex> lock(global_lock);
     auto                                entry = instance_handles.find(GetDispatchKey(handle));
     return (entry != instance_handles.end()) ? &entry->second : nullptr;
 }
 
-static DeviceTable* add_device_handle(VkDevice device)
+static void add_physical_device_handles(VkInstance instance, uint32_t count, const VkPhysicalDevice* physical_devices)
 {
-    // Store the instance for use with vkCreateDevice.
+    instance_dispatch_table* instance_table = get_instance_handle(instance);
+    if (instance_table != nullptr)
+    {
+        std::unique_lock<std::shared_mutex> lock(physical_device_lock);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            // Physical device handles do not change between enumerations, so existing records are kept
+            if (physical_device_handles.find(physical_devices[i]) == physical_device_handles.end())
+            {
+                physical_device_dispatch_table physical_device_table{ physical_devices[i], instance_table };
+#if defined(BASE_LAYER_FUSED)
+                for (instance_dispatch_table& child : instance_table->fused_children)
+                {
+                    physical_device_table.fused_children.push_back(
+                        physical_device_dispatch_table{ physical_devices[i], &child });
+                }
+#endif
+                physical_device_handles.emplace(physical_devices[i], std::move(physical_device_table));
+            }
+        }
+    }
+}
+
+static void remove_physical_device_handles(const instance_dispatch_table* instance_table)
+{
+    std::unique_lock<std::shared_mutex> lock(physical_device_lock);
+    for (auto entry = physical_device_handles.begin(); entry != physical_device_handles.end();)
+    {
+        if (entry->second.instance_table == instance_table)
+        {
+            entry = physical_device_handles.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+}
+
+static physical_device_dispatch_table* get_physical_device_handle(VkPhysicalDevice physical_device)
+{
+    std::shared_lock<std::shared_mutex> lock(physical_device_lock);
+    auto                                entry = physical_device_handles.find(physical_device);
+    return (entry != physical_device_handles.end()) ? &entry->second : nullptr;
+}
+
+// Retrieves the instance of a physical device. Physical devices that were not enumerated through the layer are found
+// through their dispatch key, which they share with their instance.
+static instance_dispatch_table* get_physical_device_instance(VkPhysicalDevice physical_device)
+{
+    physical_device_dispatch_table* physical_device_table = get_physical_device_handle(physical_device);
+    return (physical_device_table != nullptr) ? physical_device_table->instance_table
+                                              : get_instance_handle(physical_device);
+}
+
+// Devices created on the same physical device usually resolve to identical function pointers. Their dispatch tables
+// are interned by content and reference counted, so that identical tables are stored once and shared read-only.
+// Guarded by global_lock.
+struct interned_device_table
+{
+    std::unique_ptr<const DeviceTable> table;
+    uint32_t                           references{ 0 };
+};
+
+static std::unordered_multimap<uint64_t, interned_device_table> interned_device_tables;
+
+static uint64_t HashDeviceTable(const DeviceTable& table)
+{
+    // FNV-1a over the function pointers
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&table);
+    uint64_t       hash  = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < sizeof(DeviceTable); ++i)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+// Returns the number of bytes saved by sharing dispatch tables between devices. Must be called with global_lock held.
+static size_t get_shared_device_table_savings()
+{
+    size_t saved = 0;
+    for (const auto& entry : interned_device_tables)
+    {
+        saved += (entry.second.references - 1) * sizeof(DeviceTable);
+    }
+
+    return saved;
+}
+
+// Must be called with global_lock held for writing.
+static const DeviceTable* intern_device_table(const DeviceTable& table)
+{
+    const uint64_t hash  = HashDeviceTable(table);
+    auto           range = interned_device_tables.equal_range(hash);
+    for (auto entry = range.first; entry != range.second; ++entry)
+    {
+        if (std::memcmp(entry->second.table.get(), &table, sizeof(DeviceTable)) == 0)
+        {
+            ++entry->second.references;
+            base_layer_print_info("Device dispatch table shared by %u devices, %zu bytes saved in total\n",
+                                  entry->second.references,
+                                  get_shared_device_table_savings());
+            return entry->second.table.get();
+        }
+    }
+
+    auto entry = interned_device_tables.emplace(hash, interned_device_table{ std::make_unique<DeviceTable>(table), 1 });
+    return entry->second.table.get();
+}
+
+// Must be called with global_lock held for writing.
+static void release_device_table(const DeviceTable* table)
+{
+    auto range = interned_device_tables.equal_range(HashDeviceTable(*table));
+    for (auto entry = range.first; entry != range.second; ++entry)
+    {
+        if (entry->second.table.get() == table)
+        {
+            if (--entry->second.references == 0)
+            {
+                interned_device_tables.erase(entry);
+            }
+            return;
+        }
+    }
+}
+
+// Must be called with global_lock held for writing.
+static void erase_device_handle(std::unordered_map<const void*, device_dispatch_table>::iterator entry)
+{
+    direct_device_handles.remove(&entry->second);
+    child_handles.erase_device(&entry->second);
+    release_device_table(&entry->second.dispatch_table);
+    device_handles.erase(entry);
+
+    if (device_handles.empty())
+    {
+        child_handles.release_retired();
+    }
+}
+
+static device_dispatch_table* add_device_handle(VkDevice device, const DeviceTable& dispatch_table)
+{
+    // Store the device's dispatch table, sharing it with other devices if an identical one exists.
     std::unique_lock<std::shared_mutex> lock(global_lock);
-    device_handles[GetDispatchKey(device)] = { device, DeviceTable() };
-    return &device_handles[GetDispatchKey(device)].dispatch_table;
+    const DispatchKey                   key      = GetDispatchKey(device);
+    auto                                existing = device_handles.find(key);
+    if (existing != device_handles.end())
+    {
+        erase_device_handle(existing);
+    }
+
+    device_dispatch_table& entry =
+        device_handles.emplace(key, device_dispatch_table{ device, *intern_device_table(dispatch_table), key })
+            .first->second;
+    direct_device_handles.add(&entry);
+    return &entry;
 }
 
 static void remove_device_handle(const void* handle)
@@ -165,17 +861,141 @@ static void remove_device_handle(const void* handle)
     auto                                entry = device_handles.find(GetDispatchKey(handle));
     if (entry != device_handles.end())
     {
-        device_handles.erase(entry);
+        erase_device_handle(entry);
     }
 }
 
 static device_dispatch_table* get_device_handle(const void* handle)
 {
+#if defined(BASE_LAYER_DIRECT_DISPATCH)
+    device_dispatch_table* direct_entry = direct_device_handles.find(GetDispatchKey(handle));
+    if (direct_entry != nullptr)
+    {
+        return direct_entry;
+    }
+#endif
+
     std::shared_lock<std::shared_mutex> lock(global_lock);
     auto                                entry = device_handles.find(GetDispatchKey(handle));
     return (entry != device_handles.end()) ? &entry->second : nullptr;
 }
 
+static void add_child_handle(const void* handle, device_dispatch_table* device_table, uint64_t parent = 0)
+{
+    child_handles.insert(handle, device_table, parent);
+}
+
+static void remove_child_handle(const void* handle)
+{
+    child_handles.erase(handle);
+}
+
+// Retrieves the device dispatch table and layer defined state of a queue or command buffer. layer_index selects the
+// state slot of a fused child layer.
+static bool get_child_handle(const void* handle, child_handle_info* info, size_t layer_index = 0)
+{
+    return child_handles.find(handle, info, layer_index);
+}
+
+static bool set_child_handle_data(const void* handle, void* layer_data, size_t layer_index = 0)
+{
+    return child_handles.set_layer_data(handle, layer_data, layer_index);
+}
+
+// Reads a layer setting from the environment variable env_name or, on Android, from the system property
+// android_property. Returns an empty string when the setting is not set.
+static std::string get_layer_setting(const char* env_name, const char* android_property)
+{
+    std::string value;
+
+#if defined(__ANDROID__)
+    char property_value[PROP_VALUE_MAX] = {};
+    if (__system_property_get(android_property, property_value) > 0)
+    {
+        value = property_value;
+    }
+#else
+    (void)android_property;
+#endif
+
+    const char* env_value = std::getenv(env_name);
+    if (env_value != nullptr)
+    {
+        value = env_value;
+    }
+
+    return value;
+}
+
+static bool is_layer_setting_enabled(const char* env_name, const char* android_property)
+{
+    const std::string value = get_layer_setting(env_name, android_property);
+    return (value == "1") || (value == "true") || (value == "TRUE");
+}
+
+static uint64_t get_timestamp_ns()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count());
+}
+
+// Returns true if the device enables the privateData feature, which requires the handles of its objects to be unique
+// and rules out sharing them between creations.
+static bool is_private_data_enabled(const VkDeviceCreateInfo* pCreateInfo)
+{
+    for (uint32_t i = 0; i < pCreateInfo->enabledExtensionCount; ++i)
+    {
+        if (!strcmp(pCreateInfo->ppEnabledExtensionNames[i], VK_EXT_PRIVATE_DATA_EXTENSION_NAME))
+        {
+            return true;
+        }
+    }
+
+    const VkBaseInStructure* next = reinterpret_cast<const VkBaseInStructure*>(pCreateInfo->pNext);
+    for (; next != nullptr; next = next->pNext)
+    {
+        if ((next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRIVATE_DATA_FEATURES) &&
+            reinterpret_cast<const VkPhysicalDevicePrivateDataFeatures*>(next)->privateData)
+        {
+            return true;
+        }
+        else if ((next->sType == VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES) &&
+                 reinterpret_cast<const VkPhysicalDeviceVulkan13Features*>(next)->privateData)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns true if name is a vkCmd* command that is not in DeviceTable. Such commands were added to the registry after
+// the dispatch table was generated, so a layer that tracks command buffer state cannot know what they change.
+static bool is_unknown_command_buffer_command(const char* name)
+{
+    static const char* const kCommandBufferCommands[] = {
+#define COMMAND_BUFFER_COMMAND_NAME(Name) "vk" #Name,
+        FOR_EACH_COMMAND_BUFFER_COMMAND(COMMAND_BUFFER_COMMAND_NAME)
+#undef COMMAND_BUFFER_COMMAND_NAME
+    };
+
+    if ((name == nullptr) || (strncmp(name, "vkCmd", 5) != 0))
+    {
+        return false;
+    }
+
+    for (const char* command : kCommandBufferCommands)
+    {
+        if (!strcmp(name, command))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 } // namespace base_layer
 
 #endif // BASE_LAYER_H
@@ -0,0 +1,302 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the cost per call of a device and a queue command through a minimal layer whose hooks only look up the
+// dispatch table and forward the call, against calling the mock driver directly. It also measures the layer's
+// vkGetDeviceProcAddr, which memoizes its results per device, against resolving the same names with
+// layer_GetDeviceProcAddr every time. The benchmark is built twice, as dispatch_benchmark with the base layer's map
+// lookup and as dispatch_benchmark_direct with BASE_LAYER_DIRECT_DISPATCH, so that the two lookups are compared on the
+// same commands. Run with the number of calls per thread as the optional first argument and the largest number of
+// threads calling concurrently as the optional second one.
+
+#define LAYER_NAME "VK_LAYER_LUNARG_dispatch_benchmark"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Dispatch lookup benchmark layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+#include "base_layer/test/mock_driver.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(BASE_LAYER_DIRECT_DISPATCH)
+static const char* const kLookup = "direct";
+#else
+static const char* const kLookup = "map";
+#endif
+
+// Names resolved by the layer, by the base layer and by the mock driver, and one that no one resolves
+static const char* const kProcNames[] = { "vkGetFenceStatus", "vkQueueWaitIdle",  "vkDestroyDevice",
+                                          "vkCreateFence",    "vkAllocateMemory", "vkCmdDrawIndirectCount" };
+static constexpr size_t  kProcNameCount = sizeof(kProcNames) / sizeof(kProcNames[0]);
+
+// Keeps the results of the queries alive so that they are not optimized away
+static std::atomic<uintptr_t> proc_addr_sink{ 0 };
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pDevice;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetFenceStatus(VkDevice device, VkFence fence)
+{
+    VkResult result = VK_ERROR_DEVICE_LOST;
+
+    // Forward function to next layer / driver
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table != nullptr)
+    {
+        result = device_table->dispatch_table.GetFenceStatus(device, fence);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueueWaitIdle(VkQueue queue)
+{
+    VkResult result = VK_ERROR_DEVICE_LOST;
+
+    // Forward function to next layer / driver
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(queue);
+    if (device_table != nullptr)
+    {
+        result = device_table->dispatch_table.QueueWaitIdle(queue);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName)
+    {
+        if (!strcmp(pName, "vkGetFenceStatus"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetFenceStatus;
+        }
+        else if (!strcmp(pName, "vkQueueWaitIdle"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueueWaitIdle;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
+
+// The driver's commands do no work, so that the measured cost is the layer's
+static VKAPI_ATTR VkResult VKAPI_CALL NoopGetFenceStatus(VkDevice device, VkFence fence)
+{
+    (void)device;
+    (void)fence;
+
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL NoopQueueWaitIdle(VkQueue queue)
+{
+    (void)queue;
+
+    return VK_SUCCESS;
+}
+
+// Runs call on thread_count threads at once and reports the time per call seen by each thread, which grows with the
+// thread count when the threads contend on a lock.
+template <typename Call>
+static void Measure(const char* name, uint32_t iterations, uint32_t thread_count, Call call)
+{
+    // Warms up the caches of the layer and of the CPU
+    call(iterations / 16);
+
+    std::vector<std::thread> threads;
+    const auto               begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back(call, iterations);
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    printf("%-48s %2u threads %10.1f ns/call\n", name, thread_count, ns / iterations);
+}
+
+static void MeasureCommands(const char*                 mode,
+                            PFN_vkGetFenceStatus        get_fence_status,
+                            PFN_vkQueueWaitIdle         queue_wait_idle,
+                            const mock_driver::context& context,
+                            uint32_t                    iterations,
+                            uint32_t                    max_threads)
+{
+    const VkFence fence = mock_driver::NewHandle<VkFence>();
+
+    char name[64];
+    for (uint32_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+    {
+        snprintf(name, sizeof(name), "%s vkGetFenceStatus", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                get_fence_status(context.device, fence);
+            }
+        });
+
+        snprintf(name, sizeof(name), "%s vkQueueWaitIdle", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                queue_wait_idle(context.queue);
+            }
+        });
+    }
+}
+
+// Resolves the same names through layer_GetDeviceProcAddr, as the layer did before memoizing them, and through the
+// vkGetDeviceProcAddr entry point the layer hands out.
+static void MeasureProcAddr(const mock_driver::context& context, uint32_t iterations, uint32_t max_threads)
+{
+    char name[64];
+    for (uint32_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+    {
+        snprintf(name, sizeof(name), "layer (%s) layer_GetDeviceProcAddr", kLookup);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            uintptr_t sum = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const char* proc_name = kProcNames[i % kProcNameCount];
+                sum += reinterpret_cast<uintptr_t>(layer_GetDeviceProcAddr(context.device, proc_name));
+            }
+            proc_addr_sink += sum;
+        });
+
+        snprintf(name, sizeof(name), "layer (%s) vkGetDeviceProcAddr", kLookup);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            uintptr_t sum = 0;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const char* proc_name = kProcNames[i % kProcNameCount];
+                sum += reinterpret_cast<uintptr_t>(vkGetDeviceProcAddr(context.device, proc_name));
+            }
+            proc_addr_sink += sum;
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 1000000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    uint32_t max_threads = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 8;
+    if (max_threads == 0)
+    {
+        max_threads = 1;
+    }
+
+    mock_driver::SetFunction("vkGetFenceStatus", NoopGetFenceStatus);
+    mock_driver::SetFunction("vkQueueWaitIdle", NoopQueueWaitIdle);
+
+    mock_driver::context context;
+    if (!mock_driver::CreateContext(&context))
+    {
+        mock_driver::DestroyContext(&context);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u calls per thread, %s lookup\n", iterations, kLookup);
+
+    MeasureCommands("driver", NoopGetFenceStatus, NoopQueueWaitIdle, context, iterations, max_threads);
+
+    char mode[16];
+    snprintf(mode, sizeof(mode), "layer (%s)", kLookup);
+    MeasureCommands(mode,
+                    MOCK_DEVICE_PROC(context, vkGetFenceStatus),
+                    MOCK_DEVICE_PROC(context, vkQueueWaitIdle),
+                    context,
+                    iterations,
+                    max_threads);
+
+    MeasureProcAddr(context, iterations, max_threads);
+
+    mock_driver::DestroyContext(&context);
+    return (mock_driver::GetState().errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,911 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BASE_LAYER_TEST_MOCK_DRIVER_H
+#define BASE_LAYER_TEST_MOCK_DRIVER_H
+
+// An in-process stand-in for the loader and a driver, for tests and benchmarks of a single layer without a GPU. The
+// layer's source is compiled into the executable, and CreateContext creates an instance and a device through the
+// layer's vkGetInstanceProcAddr with a link chain that ends in the mock, the way the loader would. The mock implements
+// the commands needed to create devices, memory, fences and command buffers, and checks that every VkDeviceMemory it
+// receives is one it allocated. Any other command, or a different behavior, is installed with SetFunction before the
+// context is created.
+
+#include "vulkan/vk_layer.h"
+#include "vulkan/vulkan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Entry points of the layer compiled into the executable
+extern "C"
+{
+    VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetInstanceProcAddr(VkInstance instance, const char* pName);
+    VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice device, const char* pName);
+}
+
+// Returns the layer's entry point for a device command, or the mock's when the layer does not hook it.
+#define MOCK_DEVICE_PROC(context, name) reinterpret_cast<PFN_##name>(vkGetDeviceProcAddr((context).device, #name))
+
+namespace mock_driver
+{
+
+// Dispatchable handles start with the dispatch key read by the layer, which the loader would point at its dispatch
+// table. Queues and command buffers share the key of their device, and physical devices the key of their instance.
+struct dispatchable_object
+{
+    const void* dispatch_key{ nullptr };
+};
+
+struct device_object
+{
+    dispatchable_object                               handle;
+    dispatchable_object                               queue;
+    std::vector<std::unique_ptr<dispatchable_object>> command_buffers;
+};
+
+struct memory_object
+{
+    VkDevice                   device{ VK_NULL_HANDLE };
+    VkDeviceSize               size{ 0 };
+    uint32_t                   memory_type{ 0 };
+    bool                       mapped{ false };
+    std::unique_ptr<uint8_t[]> data;
+};
+
+struct fence_object
+{
+    std::atomic<bool> signaled{ false };
+};
+
+struct memory_bind
+{
+    VkDeviceMemory memory{ VK_NULL_HANDLE };
+    VkDeviceSize   offset{ 0 };
+};
+
+struct driver_state
+{
+    std::mutex lock;
+
+    // Commands installed with SetFunction, which take precedence over the mock's own
+    std::unordered_map<std::string, PFN_vkVoidFunction> functions;
+
+    VkPhysicalDeviceProperties         properties{};
+    VkPhysicalDeviceMemoryProperties   memory_properties{};
+    std::vector<VkExtensionProperties> device_extensions;
+    VkMemoryRequirements               resource_requirements{ 4096, 256, 0x3 };
+
+    dispatchable_object                                                instance;
+    std::vector<std::unique_ptr<device_object>>                        devices;
+    std::unordered_map<VkDeviceMemory, std::unique_ptr<memory_object>> memory;
+    std::unordered_map<VkFence, std::unique_ptr<fence_object>>         fences;
+    std::vector<memory_bind>                                           binds;
+
+    std::atomic<uint64_t> next_handle{ 0x10000 };
+    std::atomic<uint64_t> memory_allocation_count{ 0 };
+
+    // Number of handles the mock received without having created them
+    std::atomic<uint32_t> errors{ 0 };
+};
+
+static driver_state& GetState()
+{
+    static driver_state state;
+    return state;
+}
+
+static void ReportError(const char* message, uint64_t handle)
+{
+    fprintf(stderr, "mock driver: %s 0x%llx\n", message, static_cast<unsigned long long>(handle));
+    ++GetState().errors;
+}
+
+template <typename Handle>
+static Handle NewHandle()
+{
+    return reinterpret_cast<Handle>(GetState().next_handle.fetch_add(1));
+}
+
+// Busy waits for the given time, which benchmarks charge for the work a driver would do in a command.
+static void SpinFor(uint64_t ns)
+{
+    const auto end = std::chrono::steady_clock::now() + std::chrono::nanoseconds(ns);
+    while (std::chrono::steady_clock::now() < end)
+    {
+    }
+}
+
+// Replaces or adds a command of the mock. Must be called before the context is created, as the layer loads its
+// dispatch tables when the instance and the device are created.
+template <typename Function>
+static void SetFunction(const char* name, Function function)
+{
+    std::lock_guard<std::mutex> lock(GetState().lock);
+    GetState().functions[name] = reinterpret_cast<PFN_vkVoidFunction>(function);
+}
+
+// Returns the allocation memory refers to, or reports an error if the mock did not allocate it.
+static memory_object* GetMemory(VkDeviceMemory memory)
+{
+    driver_state&               state = GetState();
+    std::lock_guard<std::mutex> lock(state.lock);
+    auto                        entry = state.memory.find(memory);
+    if (entry == state.memory.end())
+    {
+        ReportError("unknown VkDeviceMemory", reinterpret_cast<uint64_t>(memory));
+        return nullptr;
+    }
+
+    return entry->second.get();
+}
+
+static fence_object* GetFence(VkFence fence)
+{
+    driver_state&               state = GetState();
+    std::lock_guard<std::mutex> lock(state.lock);
+    auto                        entry = state.fences.find(fence);
+    if (entry == state.fences.end())
+    {
+        ReportError("unknown VkFence", reinterpret_cast<uint64_t>(fence));
+        return nullptr;
+    }
+
+    return entry->second.get();
+}
+
+static size_t GetLiveMemoryCount()
+{
+    std::lock_guard<std::mutex> lock(GetState().lock);
+    return GetState().memory.size();
+}
+
+static VkResult CheckBind(VkDeviceMemory memory, VkDeviceSize offset)
+{
+    memory_object* allocation = GetMemory(memory);
+    if (allocation == nullptr)
+    {
+        return VK_ERROR_UNKNOWN;
+    }
+
+    const VkMemoryRequirements& requirements = GetState().resource_requirements;
+    if (((offset % requirements.alignment) != 0) || ((offset + requirements.size) > allocation->size))
+    {
+        ReportError("bind out of range or misaligned at offset", offset);
+        return VK_ERROR_UNKNOWN;
+    }
+
+    std::lock_guard<std::mutex> lock(GetState().lock);
+    GetState().binds.push_back({ memory, offset });
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetInstanceProcAddr(VkInstance instance, const char* pName);
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetDeviceProcAddr(VkDevice device, const char* pName);
+
+static VKAPI_ATTR VkResult VKAPI_CALL CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                     const VkAllocationCallbacks* pAllocator,
+                                                     VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    GetState().instance.dispatch_key = &GetState().instance;
+    *pInstance                       = reinterpret_cast<VkInstance>(&GetState().instance);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+    (void)instance;
+    (void)pAllocator;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL EnumeratePhysicalDevices(VkInstance        instance,
+                                                               uint32_t*         pPhysicalDeviceCount,
+                                                               VkPhysicalDevice* pPhysicalDevices)
+{
+    // The only physical device is the instance object, whose dispatch key it shares
+    if (pPhysicalDevices != nullptr)
+    {
+        if (*pPhysicalDeviceCount == 0)
+        {
+            return VK_INCOMPLETE;
+        }
+
+        pPhysicalDevices[0] = reinterpret_cast<VkPhysicalDevice>(instance);
+    }
+
+    *pPhysicalDeviceCount = 1;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceProperties(VkPhysicalDevice            physicalDevice,
+                                                              VkPhysicalDeviceProperties* pProperties)
+{
+    (void)physicalDevice;
+    *pProperties = GetState().properties;
+}
+
+static VKAPI_ATTR void VKAPI_CALL GetPhysicalDeviceMemoryProperties(VkPhysicalDevice                  physicalDevice,
+                                                                    VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+    (void)physicalDevice;
+    *pMemoryProperties = GetState().memory_properties;
+}
+
+static VKAPI_ATTR void VKAPI_CALL
+GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice         physicalDevice,
+                                       uint32_t*                pQueueFamilyPropertyCount,
+                                       VkQueueFamilyProperties* pQueueFamilyProperties)
+{
+    (void)physicalDevice;
+
+    if ((pQueueFamilyProperties != nullptr) && (*pQueueFamilyPropertyCount > 0))
+    {
+        pQueueFamilyProperties[0]            = {};
+        pQueueFamilyProperties[0].queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+        pQueueFamilyProperties[0].queueCount = 1;
+    }
+
+    *pQueueFamilyPropertyCount = 1;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL EnumerateDeviceExtensionProperties(VkPhysicalDevice       physicalDevice,
+                                                                         const char*            pLayerName,
+                                                                         uint32_t*              pPropertyCount,
+                                                                         VkExtensionProperties* pProperties)
+{
+    (void)physicalDevice;
+    (void)pLayerName;
+
+    const std::vector<VkExtensionProperties>& extensions = GetState().device_extensions;
+    if (pProperties == nullptr)
+    {
+        *pPropertyCount = static_cast<uint32_t>(extensions.size());
+        return VK_SUCCESS;
+    }
+
+    const uint32_t count = std::min(*pPropertyCount, static_cast<uint32_t>(extensions.size()));
+    std::copy(extensions.begin(), extensions.begin() + count, pProperties);
+    *pPropertyCount = count;
+    return (count < extensions.size()) ? VK_INCOMPLETE : VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                   const VkDeviceCreateInfo*    pCreateInfo,
+                                                   const VkAllocationCallbacks* pAllocator,
+                                                   VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    std::unique_ptr<device_object> device = std::make_unique<device_object>();
+    device->handle.dispatch_key           = device.get();
+    device->queue.dispatch_key            = device.get();
+    *pDevice                              = reinterpret_cast<VkDevice>(&device->handle);
+
+    std::lock_guard<std::mutex> lock(GetState().lock);
+    GetState().devices.push_back(std::move(device));
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    (void)pAllocator;
+
+    driver_state&               state = GetState();
+    std::lock_guard<std::mutex> lock(state.lock);
+    for (auto entry = state.memory.begin(); entry != state.memory.end();)
+    {
+        if (entry->second->device == device)
+        {
+            fprintf(stderr, "mock driver: VkDeviceMemory leaked by vkDestroyDevice\n");
+            ++state.errors;
+            entry = state.memory.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+
+    state.devices.erase(std::remove_if(state.devices.begin(),
+                                       state.devices.end(),
+                                       [device](const std::unique_ptr<device_object>& candidate) {
+                                           return reinterpret_cast<VkDevice>(&candidate->handle) == device;
+                                       }),
+                        state.devices.end());
+}
+
+static VKAPI_ATTR void VKAPI_CALL GetDeviceQueue(VkDevice device,
+                                                 uint32_t queueFamilyIndex,
+                                                 uint32_t queueIndex,
+                                                 VkQueue* pQueue)
+{
+    (void)queueFamilyIndex;
+    (void)queueIndex;
+
+    device_object* object = reinterpret_cast<device_object*>(device);
+    *pQueue               = reinterpret_cast<VkQueue>(&object->queue);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL AllocateMemory(VkDevice                     device,
+                                                     const VkMemoryAllocateInfo*  pAllocateInfo,
+                                                     const VkAllocationCallbacks* pAllocator,
+                                                     VkDeviceMemory*              pMemory)
+{
+    (void)pAllocator;
+
+    driver_state& state = GetState();
+    if (pAllocateInfo->memoryTypeIndex >= state.memory_properties.memoryTypeCount)
+    {
+        ReportError("memory type out of range", pAllocateInfo->memoryTypeIndex);
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    std::unique_ptr<memory_object> memory = std::make_unique<memory_object>();
+    memory->device                        = device;
+    memory->size                          = pAllocateInfo->allocationSize;
+    memory->memory_type                   = pAllocateInfo->memoryTypeIndex;
+
+    // Only host visible memory is backed by host memory, so that large device local allocations stay cheap
+    const VkMemoryPropertyFlags flags = state.memory_properties.memoryTypes[memory->memory_type].propertyFlags;
+    if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0)
+    {
+        memory->data = std::make_unique<uint8_t[]>(static_cast<size_t>(memory->size));
+    }
+
+    *pMemory = NewHandle<VkDeviceMemory>();
+    ++state.memory_allocation_count;
+
+    std::lock_guard<std::mutex> lock(state.lock);
+    state.memory[*pMemory] = std::move(memory);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL FreeMemory(VkDevice                     device,
+                                             VkDeviceMemory               memory,
+                                             const VkAllocationCallbacks* pAllocator)
+{
+    (void)device;
+    (void)pAllocator;
+
+    if ((memory != VK_NULL_HANDLE) && (GetMemory(memory) != nullptr))
+    {
+        std::lock_guard<std::mutex> lock(GetState().lock);
+        GetState().memory.erase(memory);
+    }
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL MapMemory(VkDevice         device,
+                                                VkDeviceMemory   memory,
+                                                VkDeviceSize     offset,
+                                                VkDeviceSize     size,
+                                                VkMemoryMapFlags flags,
+                                                void**           ppData)
+{
+    (void)device;
+    (void)size;
+    (void)flags;
+
+    memory_object* allocation = GetMemory(memory);
+    if ((allocation == nullptr) || (allocation->data == nullptr) || allocation->mapped)
+    {
+        ReportError("memory cannot be mapped", reinterpret_cast<uint64_t>(memory));
+        return VK_ERROR_MEMORY_MAP_FAILED;
+    }
+
+    allocation->mapped = true;
+    *ppData            = allocation->data.get() + offset;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL UnmapMemory(VkDevice device, VkDeviceMemory memory)
+{
+    (void)device;
+
+    memory_object* allocation = GetMemory(memory);
+    if (allocation != nullptr)
+    {
+        allocation->mapped = false;
+    }
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL FlushMappedMemoryRanges(VkDevice                   device,
+                                                              uint32_t                   memoryRangeCount,
+                                                              const VkMappedMemoryRange* pMemoryRanges)
+{
+    (void)device;
+
+    for (uint32_t i = 0; i < memoryRangeCount; ++i)
+    {
+        GetMemory(pMemoryRanges[i].memory);
+    }
+
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL GetBufferMemoryRequirements(VkDevice              device,
+                                                              VkBuffer              buffer,
+                                                              VkMemoryRequirements* pMemoryRequirements)
+{
+    (void)device;
+    (void)buffer;
+    *pMemoryRequirements = GetState().resource_requirements;
+}
+
+static VKAPI_ATTR void VKAPI_CALL GetImageMemoryRequirements(VkDevice              device,
+                                                             VkImage               image,
+                                                             VkMemoryRequirements* pMemoryRequirements)
+{
+    (void)device;
+    (void)image;
+    *pMemoryRequirements = GetState().resource_requirements;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL BindBufferMemory(VkDevice       device,
+                                                       VkBuffer       buffer,
+                                                       VkDeviceMemory memory,
+                                                       VkDeviceSize   memoryOffset)
+{
+    (void)device;
+    (void)buffer;
+    return CheckBind(memory, memoryOffset);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL BindImageMemory(VkDevice       device,
+                                                      VkImage        image,
+                                                      VkDeviceMemory memory,
+                                                      VkDeviceSize   memoryOffset)
+{
+    (void)device;
+    (void)image;
+    return CheckBind(memory, memoryOffset);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL BindBufferMemory2(VkDevice                      device,
+                                                        uint32_t                      bindInfoCount,
+                                                        const VkBindBufferMemoryInfo* pBindInfos)
+{
+    (void)device;
+
+    VkResult result = VK_SUCCESS;
+    for (uint32_t i = 0; (i < bindInfoCount) && (result == VK_SUCCESS); ++i)
+    {
+        result = CheckBind(pBindInfos[i].memory, pBindInfos[i].memoryOffset);
+    }
+
+    return result;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL CreateFence(VkDevice                     device,
+                                                  const VkFenceCreateInfo*     pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkFence*                     pFence)
+{
+    (void)device;
+    (void)pAllocator;
+
+    std::unique_ptr<fence_object> fence = std::make_unique<fence_object>();
+    fence->signaled                     = ((pCreateInfo->flags & VK_FENCE_CREATE_SIGNALED_BIT) != 0);
+    *pFence                             = NewHandle<VkFence>();
+
+    std::lock_guard<std::mutex> lock(GetState().lock);
+    GetState().fences[*pFence] = std::move(fence);
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL DestroyFence(VkDevice device, VkFence fence, const VkAllocationCallbacks* pAllocator)
+{
+    (void)device;
+    (void)pAllocator;
+
+    std::lock_guard<std::mutex> lock(GetState().lock);
+    GetState().fences.erase(fence);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL GetFenceStatus(VkDevice device, VkFence fence)
+{
+    (void)device;
+
+    fence_object* object = GetFence(fence);
+    return ((object != nullptr) && object->signaled.load(std::memory_order_acquire)) ? VK_SUCCESS : VK_NOT_READY;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL ResetFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences)
+{
+    (void)device;
+
+    for (uint32_t i = 0; i < fenceCount; ++i)
+    {
+        fence_object* object = GetFence(pFences[i]);
+        if (object != nullptr)
+        {
+            object->signaled.store(false, std::memory_order_release);
+        }
+    }
+
+    return VK_SUCCESS;
+}
+
+// Yields until the fences are signaled by another thread or the timeout expires.
+static VKAPI_ATTR VkResult VKAPI_CALL
+WaitForFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout)
+{
+    std::vector<fence_object*> fences(fenceCount);
+    for (uint32_t i = 0; i < fenceCount; ++i)
+    {
+        fences[i] = GetFence(pFences[i]);
+        if (fences[i] == nullptr)
+        {
+            return VK_ERROR_DEVICE_LOST;
+        }
+    }
+
+    (void)device;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (;;)
+    {
+        const auto is_signaled = [](const fence_object* fence) {
+            return fence->signaled.load(std::memory_order_acquire);
+        };
+
+        if (waitAll ? std::all_of(fences.begin(), fences.end(), is_signaled)
+                    : std::any_of(fences.begin(), fences.end(), is_signaled))
+        {
+            return VK_SUCCESS;
+        }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) >= timeout)
+        {
+            return VK_TIMEOUT;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL QueueSubmit(VkQueue             queue,
+                                                  uint32_t            submitCount,
+                                                  const VkSubmitInfo* pSubmits,
+                                                  VkFence             fence)
+{
+    (void)queue;
+    (void)submitCount;
+    (void)pSubmits;
+
+    // Work completes as soon as it is submitted
+    if (fence != VK_NULL_HANDLE)
+    {
+        fence_object* object = GetFence(fence);
+        if (object != nullptr)
+        {
+            object->signaled.store(true, std::memory_order_release);
+        }
+    }
+
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL QueueWaitIdle(VkQueue queue)
+{
+    (void)queue;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL DeviceWaitIdle(VkDevice device)
+{
+    (void)device;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL CreateCommandPool(VkDevice                       device,
+                                                        const VkCommandPoolCreateInfo* pCreateInfo,
+                                                        const VkAllocationCallbacks*   pAllocator,
+                                                        VkCommandPool*                 pCommandPool)
+{
+    (void)device;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    *pCommandPool = NewHandle<VkCommandPool>();
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL DestroyCommandPool(VkDevice                     device,
+                                                     VkCommandPool                commandPool,
+                                                     const VkAllocationCallbacks* pAllocator)
+{
+    (void)device;
+    (void)commandPool;
+    (void)pAllocator;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL AllocateCommandBuffers(VkDevice                           device,
+                                                             const VkCommandBufferAllocateInfo* pAllocateInfo,
+                                                             VkCommandBuffer*                   pCommandBuffers)
+{
+    device_object*              object = reinterpret_cast<device_object*>(device);
+    std::lock_guard<std::mutex> lock(GetState().lock);
+    for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+    {
+        object->command_buffers.push_back(std::make_unique<dispatchable_object>());
+        object->command_buffers.back()->dispatch_key = object;
+        pCommandBuffers[i] = reinterpret_cast<VkCommandBuffer>(object->command_buffers.back().get());
+    }
+
+    return VK_SUCCESS;
+}
+
+// Command buffers are released with their device.
+static VKAPI_ATTR void VKAPI_CALL FreeCommandBuffers(VkDevice               device,
+                                                     VkCommandPool          commandPool,
+                                                     uint32_t               commandBufferCount,
+                                                     const VkCommandBuffer* pCommandBuffers)
+{
+    (void)device;
+    (void)commandPool;
+    (void)commandBufferCount;
+    (void)pCommandBuffers;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL BeginCommandBuffer(VkCommandBuffer                 commandBuffer,
+                                                         const VkCommandBufferBeginInfo* pBeginInfo)
+{
+    (void)commandBuffer;
+    (void)pBeginInfo;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL EndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+    (void)commandBuffer;
+    return VK_SUCCESS;
+}
+
+static PFN_vkVoidFunction GetFunction(const char* pName)
+{
+    static const std::unordered_map<std::string, PFN_vkVoidFunction> kFunctions = {
+        { "vkGetInstanceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(GetInstanceProcAddr) },
+        { "vkGetDeviceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(GetDeviceProcAddr) },
+        { "vkCreateInstance", reinterpret_cast<PFN_vkVoidFunction>(CreateInstance) },
+        { "vkDestroyInstance", reinterpret_cast<PFN_vkVoidFunction>(DestroyInstance) },
+        { "vkEnumeratePhysicalDevices", reinterpret_cast<PFN_vkVoidFunction>(EnumeratePhysicalDevices) },
+        { "vkGetPhysicalDeviceProperties", reinterpret_cast<PFN_vkVoidFunction>(GetPhysicalDeviceProperties) },
+        { "vkGetPhysicalDeviceMemoryProperties",
+          reinterpret_cast<PFN_vkVoidFunction>(GetPhysicalDeviceMemoryProperties) },
+        { "vkGetPhysicalDeviceQueueFamilyProperties",
+          reinterpret_cast<PFN_vkVoidFunction>(GetPhysicalDeviceQueueFamilyProperties) },
+        { "vkEnumerateDeviceExtensionProperties",
+          reinterpret_cast<PFN_vkVoidFunction>(EnumerateDeviceExtensionProperties) },
+        { "vkCreateDevice", reinterpret_cast<PFN_vkVoidFunction>(CreateDevice) },
+        { "vkDestroyDevice", reinterpret_cast<PFN_vkVoidFunction>(DestroyDevice) },
+        { "vkGetDeviceQueue", reinterpret_cast<PFN_vkVoidFunction>(GetDeviceQueue) },
+        { "vkAllocateMemory", reinterpret_cast<PFN_vkVoidFunction>(AllocateMemory) },
+        { "vkFreeMemory", reinterpret_cast<PFN_vkVoidFunction>(FreeMemory) },
+        { "vkMapMemory", reinterpret_cast<PFN_vkVoidFunction>(MapMemory) },
+        { "vkUnmapMemory", reinterpret_cast<PFN_vkVoidFunction>(UnmapMemory) },
+        { "vkFlushMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(FlushMappedMemoryRanges) },
+        { "vkInvalidateMappedMemoryRanges", reinterpret_cast<PFN_vkVoidFunction>(FlushMappedMemoryRanges) },
+        { "vkGetBufferMemoryRequirements", reinterpret_cast<PFN_vkVoidFunction>(GetBufferMemoryRequirements) },
+        { "vkGetImageMemoryRequirements", reinterpret_cast<PFN_vkVoidFunction>(GetImageMemoryRequirements) },
+        { "vkBindBufferMemory", reinterpret_cast<PFN_vkVoidFunction>(BindBufferMemory) },
+        { "vkBindImageMemory", reinterpret_cast<PFN_vkVoidFunction>(BindImageMemory) },
+        { "vkBindBufferMemory2", reinterpret_cast<PFN_vkVoidFunction>(BindBufferMemory2) },
+        { "vkCreateFence", reinterpret_cast<PFN_vkVoidFunction>(CreateFence) },
+        { "vkDestroyFence", reinterpret_cast<PFN_vkVoidFunction>(DestroyFence) },
+        { "vkGetFenceStatus", reinterpret_cast<PFN_vkVoidFunction>(GetFenceStatus) },
+        { "vkResetFences", reinterpret_cast<PFN_vkVoidFunction>(ResetFences) },
+        { "vkWaitForFences", reinterpret_cast<PFN_vkVoidFunction>(WaitForFences) },
+        { "vkQueueSubmit", reinterpret_cast<PFN_vkVoidFunction>(QueueSubmit) },
+        { "vkQueueWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(QueueWaitIdle) },
+        { "vkDeviceWaitIdle", reinterpret_cast<PFN_vkVoidFunction>(DeviceWaitIdle) },
+        { "vkCreateCommandPool", reinterpret_cast<PFN_vkVoidFunction>(CreateCommandPool) },
+        { "vkDestroyCommandPool", reinterpret_cast<PFN_vkVoidFunction>(DestroyCommandPool) },
+        { "vkAllocateCommandBuffers", reinterpret_cast<PFN_vkVoidFunction>(AllocateCommandBuffers) },
+        { "vkFreeCommandBuffers", reinterpret_cast<PFN_vkVoidFunction>(FreeCommandBuffers) },
+        { "vkBeginCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(BeginCommandBuffer) },
+        { "vkEndCommandBuffer", reinterpret_cast<PFN_vkVoidFunction>(EndCommandBuffer) }
+    };
+
+    if (pName == nullptr)
+    {
+        return nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(GetState().lock);
+        auto                        entry = GetState().functions.find(pName);
+        if (entry != GetState().functions.end())
+        {
+            return entry->second;
+        }
+    }
+
+    auto entry = kFunctions.find(pName);
+    return (entry != kFunctions.end()) ? entry->second : nullptr;
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    (void)instance;
+    return GetFunction(pName);
+}
+
+static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    (void)device;
+    return GetFunction(pName);
+}
+
+// A device with two memory types, device local and host visible, each on its own heap.
+static void SetDefaultProperties()
+{
+    driver_state& state = GetState();
+
+    state.properties                                     = {};
+    state.properties.apiVersion                          = VK_API_VERSION_1_3;
+    state.properties.limits.nonCoherentAtomSize          = 64;
+    state.properties.limits.bufferImageGranularity       = 1024;
+    state.memory_properties                              = {};
+    state.memory_properties.memoryTypeCount              = 2;
+    state.memory_properties.memoryTypes[0].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+    state.memory_properties.memoryTypes[0].heapIndex     = 0;
+    state.memory_properties.memoryTypes[1].propertyFlags =
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    state.memory_properties.memoryTypes[1].heapIndex     = 1;
+    state.memory_properties.memoryHeapCount              = 2;
+    state.memory_properties.memoryHeaps[0].size          = 1024ull * 1024 * 1024;
+    state.memory_properties.memoryHeaps[0].flags         = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+    state.memory_properties.memoryHeaps[1].size          = 256ull * 1024 * 1024;
+    strncpy(state.properties.deviceName, "Mock device", VK_MAX_PHYSICAL_DEVICE_NAME_SIZE - 1);
+}
+
+// Sets a layer setting read from the environment. Layers read their settings once, so this must be called before the
+// first context is created.
+static void SetLayerSetting(const char* name, const char* value)
+{
+#if defined(_WIN32)
+    _putenv_s(name, value);
+#else
+    setenv(name, value, 1);
+#endif
+}
+
+// Instance and device created through the layer, with the mock as the next element of the chain
+struct context
+{
+    VkInstance       instance{ VK_NULL_HANDLE };
+    VkPhysicalDevice physical_device{ VK_NULL_HANDLE };
+    VkDevice         device{ VK_NULL_HANDLE };
+    VkQueue          queue{ VK_NULL_HANDLE };
+};
+
+static bool CreateContext(context*           context,
+                          uint32_t           extension_count = 0,
+                          const char* const* extensions      = nullptr,
+                          const void*        device_next     = nullptr)
+{
+    if (GetState().memory_properties.memoryTypeCount == 0)
+    {
+        SetDefaultProperties();
+    }
+
+    VkLayerInstanceLink instance_link        = {};
+    instance_link.pfnNextGetInstanceProcAddr = GetInstanceProcAddr;
+
+    VkLayerInstanceCreateInfo instance_chain = {};
+    instance_chain.sType                     = VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO;
+    instance_chain.function                  = VK_LAYER_LINK_INFO;
+    instance_chain.u.pLayerInfo              = &instance_link;
+
+    VkApplicationInfo application_info = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+    application_info.apiVersion        = VK_API_VERSION_1_3;
+
+    VkInstanceCreateInfo instance_info = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+    instance_info.pNext                = &instance_chain;
+    instance_info.pApplicationInfo     = &application_info;
+
+    PFN_vkCreateInstance create_instance =
+        reinterpret_cast<PFN_vkCreateInstance>(vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkCreateInstance"));
+    if ((create_instance == nullptr) || (create_instance(&instance_info, nullptr, &context->instance) != VK_SUCCESS))
+    {
+        fprintf(stderr, "mock driver: vkCreateInstance failed\n");
+        return false;
+    }
+
+    // Physical devices are enumerated through the layer so that it records them
+    PFN_vkEnumeratePhysicalDevices enumerate_physical_devices = reinterpret_cast<PFN_vkEnumeratePhysicalDevices>(
+        vkGetInstanceProcAddr(context->instance, "vkEnumeratePhysicalDevices"));
+    uint32_t physical_device_count = 1;
+    enumerate_physical_devices(context->instance, &physical_device_count, &context->physical_device);
+
+    VkLayerDeviceLink device_link          = {};
+    device_link.pfnNextGetInstanceProcAddr = GetInstanceProcAddr;
+    device_link.pfnNextGetDeviceProcAddr   = GetDeviceProcAddr;
+
+    VkLayerDeviceCreateInfo device_chain = {};
+    device_chain.sType                   = VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO;
+    device_chain.pNext                   = device_next;
+    device_chain.function                = VK_LAYER_LINK_INFO;
+    device_chain.u.pLayerInfo            = &device_link;
+
+    const float             priority   = 1.0f;
+    VkDeviceQueueCreateInfo queue_info = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+    queue_info.queueFamilyIndex        = 0;
+    queue_info.queueCount              = 1;
+    queue_info.pQueuePriorities        = &priority;
+
+    VkDeviceCreateInfo device_info      = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+    device_info.pNext                   = &device_chain;
+    device_info.queueCreateInfoCount    = 1;
+    device_info.pQueueCreateInfos       = &queue_info;
+    device_info.enabledExtensionCount   = extension_count;
+    device_info.ppEnabledExtensionNames = extensions;
+
+    PFN_vkCreateDevice create_device =
+        reinterpret_cast<PFN_vkCreateDevice>(vkGetInstanceProcAddr(context->instance, "vkCreateDevice"));
+    if (create_device(context->physical_device, &device_info, nullptr, &context->device) != VK_SUCCESS)
+    {
+        fprintf(stderr, "mock driver: vkCreateDevice failed\n");
+        return false;
+    }
+
+    MOCK_DEVICE_PROC(*context, vkGetDeviceQueue)(context->device, 0, 0, &context->queue);
+    return true;
+}
+
+static void DestroyContext(context* context)
+{
+    if (context->device != VK_NULL_HANDLE)
+    {
+        MOCK_DEVICE_PROC(*context, vkDestroyDevice)(context->device, nullptr);
+        context->device = VK_NULL_HANDLE;
+    }
+
+    if (context->instance != VK_NULL_HANDLE)
+    {
+        reinterpret_cast<PFN_vkDestroyInstance>(vkGetInstanceProcAddr(context->instance, "vkDestroyInstance"))(
+            context->instance, nullptr);
+        context->instance = VK_NULL_HANDLE;
+    }
+}
+
+} // namespace mock_driver
+
+#endif // BASE_LAYER_TEST_MOCK_DRIVER_H
@@ -71,6 +71,7 @@ default_blacklists = 'blacklists.json'
 default_platform_types = 'platform_types.json'
 default_replay_overrides = 'replay_overrides.json'
 default_capture_overrides = 'capture_overrides.json'
+default_hot_commands = 'hot_commands.json'
 
 
 def _getExtraVulkanHeaders(extraHeadersDir):
@@ -135,6 +136,7 @@ def make_gen_opts(args):
     platform_types = os.path.join(args.configs, default_platform_types)
     replay_overrides = os.path.join(args.configs, default_replay_overrides)
     capture_overrides = os.path.join(args.configs, default_capture_overrides)
+    hot_commands = os.path.join(args.configs, default_hot_commands)
 
     # Copyright text prefixing all headers (list of strings).
     prefix_strings = [
@@ -177,7 +179,22 @@ def make_gen_opts(args):
             prefix_text=prefix_strings + vk_prefix_strings,
             protect_file=True,
             protect_feature=False,
-            extraVulkanHeaders=extraVulkanHeaders
+            extraVulkanHeaders=extraVulkanHeaders,
+            hot_commands=hot_commands
+        )
+    ]
+
+    gen_opts['generated_vulkan_dispatch_table_loader.inc'] = [
+        VulkanDispatchTableGenerator,
+        VulkanDispatchTableGeneratorOptions(
+            filename='generated_vulkan_dispatch_table_loader.inc',
+            directory=directory,
+            prefix_text=prefix_strings + vk_prefix_strings,
+            protect_file=False,
+            protect_feature=False,
+            extraVulkanHeaders=extraVulkanHeaders,
+            hot_commands=hot_commands,
+            generate_loader=True
         )
     ]
 
@@ -43,6 +43,7 @@ VK_HEADERS_DIR = os.path.join(
 # File names to provide to the Vulkan XML Registry generator script.
 generate_targets = [
     'generated_vulkan_dispatch_table.h',
+    'generated_vulkan_dispatch_table_loader.inc',
 ]
 
 if __name__ == '__main__':
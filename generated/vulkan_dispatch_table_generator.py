@@ -21,6 +21,8 @@
 # FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 # IN THE SOFTWARE.
 
+import json
+import os
 import sys
 from base_generator import BaseGenerator, BaseGeneratorOptions, write
 
@@ -37,7 +39,9 @@ class VulkanDispatchTableGeneratorOptions(BaseGeneratorOptions):
         prefix_text='',
         protect_file=False,
         protect_feature=True,
-        extraVulkanHeaders=[]
+        extraVulkanHeaders=[],
+        hot_commands=None,  # Path to JSON file listing device commands to place at the front of DeviceTable.
+        generate_loader=False  # Generate the table loading functions instead of the table definitions.
     ):
         BaseGeneratorOptions.__init__(
             self,
@@ -50,6 +54,8 @@ class VulkanDispatchTableGeneratorOptions(BaseGeneratorOptions):
             protect_feature,
             extraVulkanHeaders=extraVulkanHeaders
         )
+        self.hot_commands = hot_commands
+        self.generate_loader = generate_loader
 
 
 class VulkanDispatchTableGenerator(BaseGenerator):
@@ -85,11 +91,28 @@ class VulkanDispatchTableGenerator(BaseGenerator):
         )  # Map of API call names to no-op function declarations
         self.device_cmd_names = dict(
         )  # Map of API call names to no-op function declarations
+        self.hot_cmd_names = [
+        ]  # Device commands that are laid out first in DeviceTable, most frequently called first
+        self.allocation_callbacks_cmd_names = set(
+        )  # Commands with a VkAllocationCallbacks parameter
 
     def beginFile(self, gen_opts):
         """Method override."""
         BaseGenerator.beginFile(self, gen_opts)
 
+        if getattr(gen_opts, 'hot_commands', None) and os.path.isfile(gen_opts.hot_commands):
+            self.load_hot_commands(gen_opts.hot_commands)
+
+        self.generate_loader = getattr(gen_opts, 'generate_loader', False)
+        if self.generate_loader:
+            write('#include "generated_vulkan_dispatch_table.h"', file=self.outFile)
+            self.newline()
+            write('#include <cassert>', file=self.outFile)
+            write('#include <cstddef>', file=self.outFile)
+            write('#include <cstdint>', file=self.outFile)
+            self.newline()
+            return
+
         write('#include "platform_types.h"', file=self.outFile)
         write('#include "logging.h"', file=self.outFile)
         self.newline()
@@ -108,6 +131,11 @@ class VulkanDispatchTableGenerator(BaseGenerator):
 
     def endFile(self):
         """Method override."""
+        if self.generate_loader:
+            self.generate_loader_file()
+            BaseGenerator.endFile(self)
+            return
+
         self.newline()
 
         write('typedef const void* DispatchKey;', file=self.outFile)
@@ -146,23 +174,83 @@ class VulkanDispatchTableGenerator(BaseGenerator):
         self.newline()
         self.generate_device_cmd_table()
         self.newline()
+        self.generate_command_buffer_cmd_list()
+        self.newline()
+        self.generate_allocation_callbacks_cmd_lists()
+        self.newline()
+
+        write(
+            '// Defined in generated_vulkan_dispatch_table_loader.inc, which must be included once per layer. They have internal\n'
+            '// linkage, so that a layer never binds to the copy of another loaded layer built against a different table layout.',
+            file=self.outFile
+        )
+        write(
+            'static void LoadInstanceTable(PFN_vkGetInstanceProcAddr gpa, VkInstance instance, InstanceTable* table);',
+            file=self.outFile
+        )
+        write(
+            'static void LoadDeviceTable(PFN_vkGetDeviceProcAddr gpa, VkDevice device, DeviceTable* table);',
+            file=self.outFile
+        )
+        self.newline()
+
+        # Finish processing in superclass
+        BaseGenerator.endFile(self)
+
+    def generate_loader_file(self):
+        """Generate the table loading functions.
+        Tables are loaded by a single loop over an array of command names and member offsets, rather than with one
+        call per command, which keeps the loaders small."""
+        write('struct DispatchTableEntry', file=self.outFile)
+        write('{', file=self.outFile)
+        write('    const char* name;', file=self.outFile)
+        write('    size_t      offset;', file=self.outFile)
+        write('};', file=self.outFile)
+        self.newline()
+        self.generate_table_entries(
+            'kInstanceTableEntries', 'InstanceTable', [
+                name for name in self.instance_cmd_names
+                if name != 'vkGetInstanceProcAddr'
+            ]
+        )
+        self.newline()
+        self.generate_table_entries(
+            'kDeviceTableEntries', 'DeviceTable', [
+                name for name in self.get_device_cmd_order()[0]
+                if name != 'vkGetDeviceProcAddr'
+            ]
+        )
+        self.newline()
 
         write(
-            'template <typename GetProcAddr, typename Handle, typename FuncP>',
+            'template <typename GetProcAddr, typename Handle, typename Table, size_t Count>',
             file=self.outFile
         )
         write(
-            'static void LoadFunction(GetProcAddr gpa, Handle handle, const char* name, FuncP* funcp)',
+            'static void LoadTableEntries(GetProcAddr gpa, Handle handle, const DispatchTableEntry (&entries)[Count], Table* table)',
             file=self.outFile
         )
         write('{', file=self.outFile)
         write(
-            '    FuncP result = reinterpret_cast<FuncP>(gpa(handle, name));',
+            '    uint8_t* base = reinterpret_cast<uint8_t*>(table);',
+            file=self.outFile
+        )
+        write(
+            '    for (const DispatchTableEntry& entry : entries)',
             file=self.outFile
         )
-        write('    if (result != nullptr)', file=self.outFile)
         write('    {', file=self.outFile)
-        write('        (*funcp) = result;', file=self.outFile)
+        write(
+            '        PFN_vkVoidFunction result = gpa(handle, entry.name);',
+            file=self.outFile
+        )
+        write('        if (result != nullptr)', file=self.outFile)
+        write('        {', file=self.outFile)
+        write(
+            '            *reinterpret_cast<PFN_vkVoidFunction*>(base + entry.offset) = result;',
+            file=self.outFile
+        )
+        write('        }', file=self.outFile)
         write('    }', file=self.outFile)
         write('}', file=self.outFile)
 
@@ -172,8 +260,20 @@ class VulkanDispatchTableGenerator(BaseGenerator):
         self.generate_load_device_table_func()
         self.newline()
 
-        # Finish processing in superclass
-        BaseGenerator.endFile(self)
+    def generate_table_entries(self, array_name, table_name, names):
+        """Generate the array of command names and table member offsets used to load a table."""
+        write(
+            'static constexpr DispatchTableEntry {}[] = {{'.format(array_name),
+            file=self.outFile
+        )
+        for name in names:
+            write(
+                '    {{ "{}", offsetof({}, {}) }},'.format(
+                    name, table_name, name[2:]
+                ),
+                file=self.outFile
+            )
+        write('};', file=self.outFile)
 
     def need_feature_generation(self):
         """Indicates that the current feature has C++ code to generate."""
@@ -195,6 +295,9 @@ class VulkanDispatchTableGenerator(BaseGenerator):
                         return_type = info[0]
                         proto = info[1]
 
+                        if any(value.base_type == 'VkAllocationCallbacks' for value in values):
+                            self.allocation_callbacks_cmd_names.add(name)
+
                         # vkSetDebugUtilsObjectNameEXT and vkSetDebugUtilsObjectTagEXT
                         # need to be probed from GetInstanceProcAddress due to a loader issue.
                         # https://github.com/KhronosGroup/Vulkan-Loader/issues/1109
@@ -220,12 +323,43 @@ class VulkanDispatchTableGenerator(BaseGenerator):
 
         write('};', file=self.outFile)
 
+    def load_hot_commands(self, filename):
+        """Load the device commands that are called most frequently.
+        The file either lists them by priority under 'commands', or holds a 'profile' mapping command names to call
+        counts captured from an instrumented run, in which case the most frequently called commands come first."""
+        hot = json.loads(open(filename, 'r').read())
+        names = list(hot.get('commands', []))
+        profile = hot.get('profile', {})
+        names += sorted(
+            [name for name in profile if name not in names],
+            key=lambda name: profile[name],
+            reverse=True
+        )
+        limit = hot.get('limit')
+        self.hot_cmd_names = names[:limit] if limit else names
+
+    def get_device_cmd_order(self):
+        """Return the device command names with the hot commands first, so that they share as few cache lines as possible."""
+        hot = [
+            name for name in self.hot_cmd_names
+            if name in self.device_cmd_names
+        ]
+        return hot + [
+            name for name in self.device_cmd_names if name not in hot
+        ], len(hot)
+
     def generate_device_cmd_table(self):
         """Generate device dispatch table structure."""
         write('struct DeviceTable', file=self.outFile)
         write('{', file=self.outFile)
 
-        for name in self.device_cmd_names:
+        names, hot_count = self.get_device_cmd_order()
+        for index, name in enumerate(names):
+            if hot_count and index == 0:
+                write('    // Frequently called commands', file=self.outFile)
+            elif hot_count and index == hot_count:
+                self.newline()
+                write('    // Remaining commands in registry order', file=self.outFile)
             decl = '    PFN_{} {}{{ nullptr }};'.format(
                 name, name[2:]
             )
@@ -233,6 +367,52 @@ class VulkanDispatchTableGenerator(BaseGenerator):
 
         write('};', file=self.outFile)
 
+    def generate_command_buffer_cmd_list(self):
+        """Generate a macro that expands an argument macro for each command recorded into a command buffer.
+        Layers that must observe every recorded command use it to wrap the commands they do not intercept."""
+        names = [
+            name for name in self.get_device_cmd_order()[0]
+            if name.startswith('vkCmd')
+        ]
+        write(
+            '// Invokes COMMAND(Name) for every vkCmd* command in DeviceTable, in table order',
+            file=self.outFile
+        )
+        write(
+            '#define FOR_EACH_COMMAND_BUFFER_COMMAND(COMMAND) \\',
+            file=self.outFile
+        )
+        for index, name in enumerate(names):
+            suffix = ' \\' if index < len(names) - 1 else ''
+            write('    COMMAND({}){}'.format(name[2:], suffix), file=self.outFile)
+
+    def generate_allocation_callbacks_cmd_lists(self):
+        """Generate macros that expand an argument macro for each instance and device command taking a
+        VkAllocationCallbacks parameter. Layers that supply host allocation callbacks use them to wrap those commands."""
+        lists = [
+            ('INSTANCE', 'InstanceTable', list(self.instance_cmd_names)),
+            ('DEVICE', 'DeviceTable', self.get_device_cmd_order()[0])
+        ]
+        for index, (kind, table_name, cmd_names) in enumerate(lists):
+            names = [
+                name for name in cmd_names
+                if name in self.allocation_callbacks_cmd_names
+            ]
+            if index > 0:
+                self.newline()
+            write(
+                '// Invokes COMMAND(Name) for every command in {} with a VkAllocationCallbacks parameter, in table order'
+                .format(table_name),
+                file=self.outFile
+            )
+            write(
+                '#define FOR_EACH_{}_ALLOCATION_CALLBACKS_COMMAND(COMMAND) \\'.format(kind),
+                file=self.outFile
+            )
+            for name_index, name in enumerate(names):
+                suffix = ' \\' if name_index < len(names) - 1 else ''
+                write('    COMMAND({}){}'.format(name[2:], suffix), file=self.outFile)
+
     def generate_load_instance_table_func(self):
         """Generate function to set the instance table's functions with a getprocaddress routine."""
         write(
@@ -242,18 +422,12 @@ class VulkanDispatchTableGenerator(BaseGenerator):
         write('{', file=self.outFile)
         write('    assert(table != nullptr);', file=self.outFile)
         self.newline()
-
-        for name in self.instance_cmd_names:
-            if name == 'vkGetInstanceProcAddr':
-                write(
-                    '    table->GetInstanceProcAddr = gpa;', file=self.outFile
-                )
-            else:
-                expr = '    LoadFunction(gpa, instance, "{}", &table->{});'.format(
-                    name, name[2:]
-                )
-                write(expr, file=self.outFile)
-
+        write(
+            '    LoadTableEntries(gpa, instance, kInstanceTableEntries, table);',
+            file=self.outFile
+        )
+        if 'vkGetInstanceProcAddr' in self.instance_cmd_names:
+            write('    table->GetInstanceProcAddr = gpa;', file=self.outFile)
         write('}', file=self.outFile)
 
     def generate_load_device_table_func(self):
@@ -265,16 +439,12 @@ class VulkanDispatchTableGenerator(BaseGenerator):
         write('{', file=self.outFile)
         write('    assert(table != nullptr);', file=self.outFile)
         self.newline()
-
-        for name in self.device_cmd_names:
-            if name == 'vkGetDeviceProcAddr':
-                write('    table->GetDeviceProcAddr = gpa;', file=self.outFile)
-            else:
-                expr = '    LoadFunction(gpa, device, "{}", &table->{});'.format(
-                    name, name[2:]
-                )
-                write(expr, file=self.outFile)
-
+        write(
+            '    LoadTableEntries(gpa, device, kDeviceTableEntries, table);',
+            file=self.outFile
+        )
+        if 'vkGetDeviceProcAddr' in self.device_cmd_names:
+            write('    table->GetDeviceProcAddr = gpa;', file=self.outFile)
         write('}', file=self.outFile)
 
     def make_full_typename(self, value):
@@ -0,0 +1,821 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_barrier_batching"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Pipeline barrier batching layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+#include "base_layer/command_buffer_tracker.inc"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Consecutive vkCmdPipelineBarrier or vkCmdPipelineBarrier2 calls recorded into a command buffer are held back and
+// forwarded as a single call when any other command is recorded. Every vkCmd* command is wrapped to flush the pending
+// barriers first, see FOR_EACH_COMMAND_BUFFER_COMMAND.
+//
+// vkCmdPipelineBarrier calls are merged by taking the union of their stage masks, which only widens the dependency.
+// Barriers to the same buffer or image are never merged, as the layout transitions and queue family ownership
+// transfers of a single call are not ordered with each other. Calls with different dependency flags and barriers with
+// a pNext chain, which could point to memory that is gone by the time the barriers are flushed, are not merged either.
+//
+// Within a single call, the first synchronization scope of a barrier does not include the second scope of another, so a
+// call that waits for stages the pending barriers block is not merged with them, as it would lose its dependency on
+// them. Global memory barriers cover every resource, and are not merged with other barriers for the same reason as
+// barriers to the same buffer or image.
+//
+// The application can record vkCmd* commands that are not in DeviceTable, which the layer cannot wrap. Barriers of
+// a device for which such a command was handed out are forwarded as they are recorded.
+static constexpr size_t kMaxPendingBarriers = 64;
+
+// Attached to the dispatch table of each device as its layer data.
+struct device_state
+{
+    std::atomic<bool> unbatched{ false };
+};
+
+struct pending_barriers
+{
+    uint32_t call_count{ 0 };
+    bool     synchronization2{ false };
+    bool     khr{ false }; // vkCmdPipelineBarrier2KHR was called rather than vkCmdPipelineBarrier2
+
+    VkPipelineStageFlags               src_stage_mask{ 0 };
+    VkPipelineStageFlags               dst_stage_mask{ 0 };
+    VkPipelineStageFlags2              dst_stage_mask2{ 0 }; // Union of the dstStageMask of the *_barriers2 members
+    VkDependencyFlags                  dependency_flags{ 0 };
+    std::vector<VkMemoryBarrier>       memory_barriers;
+    std::vector<VkBufferMemoryBarrier> buffer_barriers;
+    std::vector<VkImageMemoryBarrier>  image_barriers;
+
+    std::vector<VkMemoryBarrier2>       memory_barriers2;
+    std::vector<VkBufferMemoryBarrier2> buffer_barriers2;
+    std::vector<VkImageMemoryBarrier2>  image_barriers2;
+
+    size_t GetBarrierCount() const
+    {
+        return memory_barriers.size() + buffer_barriers.size() + image_barriers.size() + memory_barriers2.size() +
+               buffer_barriers2.size() + image_barriers2.size();
+    }
+};
+
+struct barrier_stats
+{
+    uint32_t barrier_calls{ 0 };
+    uint32_t forwarded_calls{ 0 };
+};
+
+// The barrier arrays of a record keep their capacity when the command buffer is recorded again.
+struct command_buffer_record
+{
+    pending_barriers pending;
+    barrier_stats    stats;
+};
+
+// The record of a command buffer is nullptr in its recording context when the layer did not see it being allocated,
+// and its barriers are then forwarded as they are recorded.
+using recording_context = base_layer::command_buffer_tracker<command_buffer_record>::recording_context;
+
+static base_layer::command_buffer_tracker<command_buffer_record> command_buffers;
+
+static std::atomic<uint64_t> total_barrier_calls{ 0 };
+static std::atomic<uint64_t> total_forwarded_calls{ 0 };
+
+static void ClearPendingBarriers(pending_barriers* pending)
+{
+    pending->call_count      = 0;
+    pending->src_stage_mask  = 0;
+    pending->dst_stage_mask  = 0;
+    pending->dst_stage_mask2 = 0;
+    pending->memory_barriers.clear();
+    pending->buffer_barriers.clear();
+    pending->image_barriers.clear();
+    pending->memory_barriers2.clear();
+    pending->buffer_barriers2.clear();
+    pending->image_barriers2.clear();
+}
+
+static void ResetRecord(command_buffer_record* record)
+{
+    ClearPendingBarriers(&record->pending);
+    record->stats = {};
+}
+
+static void FlushPendingBarriers(VkCommandBuffer commandBuffer, recording_context* context)
+{
+    pending_barriers& pending = context->record->pending;
+
+    // Forward function to next layer / driver
+    if (pending.synchronization2)
+    {
+        VkDependencyInfo dependency_info         = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+        dependency_info.dependencyFlags          = pending.dependency_flags;
+        dependency_info.memoryBarrierCount       = static_cast<uint32_t>(pending.memory_barriers2.size());
+        dependency_info.pMemoryBarriers          = pending.memory_barriers2.data();
+        dependency_info.bufferMemoryBarrierCount = static_cast<uint32_t>(pending.buffer_barriers2.size());
+        dependency_info.pBufferMemoryBarriers    = pending.buffer_barriers2.data();
+        dependency_info.imageMemoryBarrierCount  = static_cast<uint32_t>(pending.image_barriers2.size());
+        dependency_info.pImageMemoryBarriers     = pending.image_barriers2.data();
+
+        if (pending.khr)
+        {
+            context->dispatch_table->CmdPipelineBarrier2KHR(commandBuffer, &dependency_info);
+        }
+        else
+        {
+            context->dispatch_table->CmdPipelineBarrier2(commandBuffer, &dependency_info);
+        }
+    }
+    else
+    {
+        context->dispatch_table->CmdPipelineBarrier(commandBuffer,
+                                                    pending.src_stage_mask,
+                                                    pending.dst_stage_mask,
+                                                    pending.dependency_flags,
+                                                    static_cast<uint32_t>(pending.memory_barriers.size()),
+                                                    pending.memory_barriers.data(),
+                                                    static_cast<uint32_t>(pending.buffer_barriers.size()),
+                                                    pending.buffer_barriers.data(),
+                                                    static_cast<uint32_t>(pending.image_barriers.size()),
+                                                    pending.image_barriers.data());
+    }
+
+    ++context->record->stats.forwarded_calls;
+    ClearPendingBarriers(&pending);
+}
+
+// Returns false for the devices whose barriers are forwarded as they are recorded.
+static bool IsBatchingEnabled(const recording_context* context)
+{
+    const device_state* state = static_cast<const device_state*>(context->device_data);
+    return (state != nullptr) && !state->unbatched.load(std::memory_order_acquire);
+}
+
+static void DisableBatching(VkDevice device, const char* pName)
+{
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table == nullptr)
+    {
+        return;
+    }
+
+    device_state* state = static_cast<device_state*>(device_table->layer_data);
+    if ((state != nullptr) && !state->unbatched.exchange(true, std::memory_order_acq_rel))
+    {
+        base_layer::base_layer_print_info(
+            "Barrier batching: %s is not wrapped by the layer, barriers of device %p are not batched\n",
+            pName,
+            static_cast<void*>(device));
+    }
+}
+
+// Adds the stages that stages stand for to it, so that stages that overlap share a bit.
+static VkPipelineStageFlags2 ExpandStages(VkPipelineStageFlags2 stages)
+{
+    if ((stages & (VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_RESOLVE_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT |
+                   VK_PIPELINE_STAGE_2_CLEAR_BIT | VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_COPY_BIT_KHR)) != 0)
+    {
+        stages |= VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+    }
+
+    if ((stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT)) != 0)
+    {
+        stages |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
+    }
+
+    if ((stages & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT) != 0)
+    {
+        stages |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_TESSELLATION_CONTROL_SHADER_BIT |
+                  VK_PIPELINE_STAGE_2_TESSELLATION_EVALUATION_SHADER_BIT | VK_PIPELINE_STAGE_2_GEOMETRY_SHADER_BIT |
+                  VK_PIPELINE_STAGE_2_TASK_SHADER_BIT_EXT | VK_PIPELINE_STAGE_2_MESH_SHADER_BIT_EXT;
+    }
+
+    return stages;
+}
+
+// Returns true if the first synchronization scope of a barrier, given by src_stages, includes stages of the second
+// scope of the pending barriers, given by pending_dst_stages. Bottom of pipe stands for all commands in the first scope
+// and top of pipe in the second one.
+static bool WaitsForPendingStages(VkPipelineStageFlags2 src_stages, VkPipelineStageFlags2 pending_dst_stages)
+{
+    static constexpr VkPipelineStageFlags2 kAllCommands =
+        VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT | VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT;
+
+    src_stages &= ~VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+    pending_dst_stages &= ~VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT;
+    if ((src_stages == 0) || (pending_dst_stages == 0))
+    {
+        return false;
+    }
+
+    if (((src_stages & (kAllCommands | VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT)) != 0) ||
+        ((pending_dst_stages & (kAllCommands | VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT)) != 0))
+    {
+        return true;
+    }
+
+    return (ExpandStages(src_stages) & ExpandStages(pending_dst_stages)) != 0;
+}
+
+// Returns true if a global memory barrier of the call or of the pending barriers would be merged with other barriers.
+static bool HasGlobalBarrierConflict(size_t   pending_memory_barrier_count,
+                                     size_t   pending_barrier_count,
+                                     uint32_t memory_barrier_count,
+                                     uint32_t barrier_count)
+{
+    return ((memory_barrier_count != 0) && (pending_barrier_count != 0)) ||
+           ((pending_memory_barrier_count != 0) && (barrier_count != 0));
+}
+
+template <typename Barrier>
+static bool HasNoChains(uint32_t count, const Barrier* pBarriers)
+{
+    return std::all_of(pBarriers, pBarriers + count, [](const Barrier& barrier) { return barrier.pNext == nullptr; });
+}
+
+// Returns true if one of the barriers refers to the same buffer as a pending barrier.
+template <typename Barrier>
+static bool HasPendingBuffer(const std::vector<Barrier>& pending, uint32_t count, const Barrier* pBarriers)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        for (const Barrier& barrier : pending)
+        {
+            if (barrier.buffer == pBarriers[i].buffer)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Returns true if one of the barriers refers to the same image as a pending barrier.
+template <typename Barrier>
+static bool HasPendingImage(const std::vector<Barrier>& pending, uint32_t count, const Barrier* pBarriers)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        for (const Barrier& barrier : pending)
+        {
+            if (barrier.image == pBarriers[i].image)
+            {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+// Wraps a command that is not intercepted otherwise, flushing the pending barriers before it is recorded.
+template <typename Function, Function DeviceTable::*Member>
+struct flushing_command;
+
+template <typename... Args, void(VKAPI_PTR* DeviceTable::*Member)(VkCommandBuffer, Args...)>
+struct flushing_command<void(VKAPI_PTR*)(VkCommandBuffer, Args...), Member>
+{
+    static VKAPI_ATTR void VKAPI_CALL Call(VkCommandBuffer commandBuffer, Args... args)
+    {
+        recording_context* context = command_buffers.get_recording_context(commandBuffer);
+        if (context != nullptr)
+        {
+            if ((context->record != nullptr) && (context->record->pending.call_count != 0))
+            {
+                FlushPendingBarriers(commandBuffer, context);
+            }
+
+            // Forward function to next layer / driver
+            (context->dispatch_table->*Member)(commandBuffer, args...);
+        }
+    }
+};
+
+struct flushing_command_entry
+{
+    const char*        name;
+    size_t             offset; // Offset of the command in DeviceTable
+    PFN_vkVoidFunction function;
+};
+
+static const flushing_command_entry kFlushingCommands[] = {
+#define FLUSHING_COMMAND(Name)                 \
+    { "vk" #Name,                              \
+      offsetof(DeviceTable, Name),             \
+      reinterpret_cast<PFN_vkVoidFunction>(flushing_command<PFN_vk##Name, &DeviceTable::Name>::Call) },
+    FOR_EACH_COMMAND_BUFFER_COMMAND(FLUSHING_COMMAND)
+#undef FLUSHING_COMMAND
+};
+
+// Returns the wrapper of a command that is not intercepted otherwise, or nullptr if the command is not a vkCmd*
+// command or is not available from the next layer or driver.
+static PFN_vkVoidFunction GetFlushingCommand(VkDevice device, const char* pName)
+{
+    if ((device == VK_NULL_HANDLE) || (strncmp(pName, "vkCmd", 5) != 0))
+    {
+        return nullptr;
+    }
+
+    for (const flushing_command_entry& entry : kFlushingCommands)
+    {
+        if (!strcmp(pName, entry.name))
+        {
+            const base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+            if (device_table == nullptr)
+            {
+                return nullptr;
+            }
+
+            const uint8_t* table = reinterpret_cast<const uint8_t*>(&device_table->dispatch_table);
+            return (*reinterpret_cast<const PFN_vkVoidFunction*>(table + entry.offset) != nullptr) ? entry.function
+                                                                                                  : nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    base_layer::get_device_handle(*pDevice)->layer_data = new device_state();
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table != nullptr)
+    {
+        delete static_cast<device_state*>(device_table->layer_data);
+        device_table->layer_data = nullptr;
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+    const uint64_t barrier_calls   = total_barrier_calls.load();
+    const uint64_t forwarded_calls = total_forwarded_calls.load();
+    base_layer::base_layer_print_info("Barrier batching: %llu barrier calls forwarded as %llu (%llu merged)\n",
+                                      static_cast<unsigned long long>(barrier_calls),
+                                      static_cast<unsigned long long>(forwarded_calls),
+                                      static_cast<unsigned long long>(barrier_calls - forwarded_calls));
+
+    // Forward function to next layer / driver through the base layer, which releases the instance's dispatch table
+    base_layer::base_layer_DestroyInstance(instance, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_AllocateCommandBuffers(VkDevice                           device,
+                                                            const VkCommandBufferAllocateInfo* pAllocateInfo,
+                                                            VkCommandBuffer*                   pCommandBuffers)
+{
+    // Forward function to next layer / driver through the base layer, which registers the command buffers
+    VkResult result = base_layer::base_layer_AllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+
+    if (result == VK_SUCCESS)
+    {
+        command_buffers.add(device, pAllocateInfo->commandPool, pAllocateInfo->commandBufferCount, pCommandBuffers);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_FreeCommandBuffers(VkDevice               device,
+                                                    VkCommandPool          commandPool,
+                                                    uint32_t               commandBufferCount,
+                                                    const VkCommandBuffer* pCommandBuffers)
+{
+    // Forward function to next layer / driver through the base layer, which unregisters the command buffers
+    base_layer::base_layer_FreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+
+    command_buffers.remove(commandBufferCount, pCommandBuffers);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_ResetCommandPool(VkDevice                device,
+                                                      VkCommandPool           commandPool,
+                                                      VkCommandPoolResetFlags flags)
+{
+    command_buffers.reset_pool(device, commandPool, ResetRecord);
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.ResetCommandPool(device, commandPool, flags);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyCommandPool(VkDevice                     device,
+                                                    VkCommandPool                commandPool,
+                                                    const VkAllocationCallbacks* pAllocator)
+{
+    // Forward function to next layer / driver through the base layer, which unregisters the pool's command buffers
+    base_layer::base_layer_DestroyCommandPool(device, commandPool, pAllocator);
+
+    command_buffers.destroy_pool(device, commandPool);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BeginCommandBuffer(VkCommandBuffer                 commandBuffer,
+                                                        const VkCommandBufferBeginInfo* pBeginInfo)
+{
+    // Forward function to next layer / driver
+    VkResult           result  = VK_SUCCESS;
+    recording_context* context = command_buffers.get_recording_context_slow(commandBuffer);
+    if (context != nullptr)
+    {
+        if (context->record != nullptr)
+        {
+            ResetRecord(context->record);
+        }
+
+        result = context->dispatch_table->BeginCommandBuffer(commandBuffer, pBeginInfo);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_EndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+    // Forward function to next layer / driver
+    VkResult           result  = VK_SUCCESS;
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        command_buffer_record* record = context->record;
+        if (record != nullptr)
+        {
+            if (record->pending.call_count != 0)
+            {
+                FlushPendingBarriers(commandBuffer, context);
+            }
+
+            total_barrier_calls.fetch_add(record->stats.barrier_calls, std::memory_order_relaxed);
+            total_forwarded_calls.fetch_add(record->stats.forwarded_calls, std::memory_order_relaxed);
+            record->stats = {};
+        }
+
+        result = context->dispatch_table->EndCommandBuffer(commandBuffer);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_ResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags)
+{
+    // Forward function to next layer / driver
+    VkResult           result  = VK_SUCCESS;
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        if (context->record != nullptr)
+        {
+            ResetRecord(context->record);
+        }
+
+        result = context->dispatch_table->ResetCommandBuffer(commandBuffer, flags);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdPipelineBarrier(VkCommandBuffer              commandBuffer,
+                                                    VkPipelineStageFlags         srcStageMask,
+                                                    VkPipelineStageFlags         dstStageMask,
+                                                    VkDependencyFlags            dependencyFlags,
+                                                    uint32_t                     memoryBarrierCount,
+                                                    const VkMemoryBarrier*       pMemoryBarriers,
+                                                    uint32_t                     bufferMemoryBarrierCount,
+                                                    const VkBufferMemoryBarrier* pBufferMemoryBarriers,
+                                                    uint32_t                     imageMemoryBarrierCount,
+                                                    const VkImageMemoryBarrier*  pImageMemoryBarriers)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if ((record != nullptr) && IsBatchingEnabled(context) && HasNoChains(memoryBarrierCount, pMemoryBarriers) &&
+        HasNoChains(bufferMemoryBarrierCount, pBufferMemoryBarriers) &&
+        HasNoChains(imageMemoryBarrierCount, pImageMemoryBarriers))
+    {
+        pending_barriers& pending = record->pending;
+        ++record->stats.barrier_calls;
+
+        if ((pending.call_count != 0) &&
+            (pending.synchronization2 || (pending.dependency_flags != dependencyFlags) ||
+             (pending.GetBarrierCount() >= kMaxPendingBarriers) ||
+             WaitsForPendingStages(srcStageMask, pending.dst_stage_mask) ||
+             HasGlobalBarrierConflict(pending.memory_barriers.size(),
+                                      pending.GetBarrierCount(),
+                                      memoryBarrierCount,
+                                      memoryBarrierCount + bufferMemoryBarrierCount + imageMemoryBarrierCount) ||
+             HasPendingBuffer(pending.buffer_barriers, bufferMemoryBarrierCount, pBufferMemoryBarriers) ||
+             HasPendingImage(pending.image_barriers, imageMemoryBarrierCount, pImageMemoryBarriers)))
+        {
+            FlushPendingBarriers(commandBuffer, context);
+        }
+
+        ++pending.call_count;
+        pending.synchronization2 = false;
+        pending.dependency_flags = dependencyFlags;
+        pending.src_stage_mask |= srcStageMask;
+        pending.dst_stage_mask |= dstStageMask;
+        pending.memory_barriers.insert(
+            pending.memory_barriers.end(), pMemoryBarriers, pMemoryBarriers + memoryBarrierCount);
+        pending.buffer_barriers.insert(
+            pending.buffer_barriers.end(), pBufferMemoryBarriers, pBufferMemoryBarriers + bufferMemoryBarrierCount);
+        pending.image_barriers.insert(
+            pending.image_barriers.end(), pImageMemoryBarriers, pImageMemoryBarriers + imageMemoryBarrierCount);
+        return;
+    }
+
+    if ((record != nullptr) && (record->pending.call_count != 0))
+    {
+        FlushPendingBarriers(commandBuffer, context);
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdPipelineBarrier(commandBuffer,
+                                                srcStageMask,
+                                                dstStageMask,
+                                                dependencyFlags,
+                                                memoryBarrierCount,
+                                                pMemoryBarriers,
+                                                bufferMemoryBarrierCount,
+                                                pBufferMemoryBarriers,
+                                                imageMemoryBarrierCount,
+                                                pImageMemoryBarriers);
+}
+
+// Returns the union of the srcStageMask of the barriers of a dependency.
+static VkPipelineStageFlags2 GetSrcStageMask(const VkDependencyInfo* pDependencyInfo)
+{
+    VkPipelineStageFlags2 stages = 0;
+    for (uint32_t i = 0; i < pDependencyInfo->memoryBarrierCount; ++i)
+    {
+        stages |= pDependencyInfo->pMemoryBarriers[i].srcStageMask;
+    }
+
+    for (uint32_t i = 0; i < pDependencyInfo->bufferMemoryBarrierCount; ++i)
+    {
+        stages |= pDependencyInfo->pBufferMemoryBarriers[i].srcStageMask;
+    }
+
+    for (uint32_t i = 0; i < pDependencyInfo->imageMemoryBarrierCount; ++i)
+    {
+        stages |= pDependencyInfo->pImageMemoryBarriers[i].srcStageMask;
+    }
+
+    return stages;
+}
+
+// Returns the union of the dstStageMask of the barriers of a dependency.
+static VkPipelineStageFlags2 GetDstStageMask(const VkDependencyInfo* pDependencyInfo)
+{
+    VkPipelineStageFlags2 stages = 0;
+    for (uint32_t i = 0; i < pDependencyInfo->memoryBarrierCount; ++i)
+    {
+        stages |= pDependencyInfo->pMemoryBarriers[i].dstStageMask;
+    }
+
+    for (uint32_t i = 0; i < pDependencyInfo->bufferMemoryBarrierCount; ++i)
+    {
+        stages |= pDependencyInfo->pBufferMemoryBarriers[i].dstStageMask;
+    }
+
+    for (uint32_t i = 0; i < pDependencyInfo->imageMemoryBarrierCount; ++i)
+    {
+        stages |= pDependencyInfo->pImageMemoryBarriers[i].dstStageMask;
+    }
+
+    return stages;
+}
+
+static void RecordPipelineBarrier2(VkCommandBuffer commandBuffer, const VkDependencyInfo* pDependencyInfo, bool khr)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if ((record != nullptr) && IsBatchingEnabled(context) && (pDependencyInfo->pNext == nullptr) &&
+        HasNoChains(pDependencyInfo->memoryBarrierCount, pDependencyInfo->pMemoryBarriers) &&
+        HasNoChains(pDependencyInfo->bufferMemoryBarrierCount, pDependencyInfo->pBufferMemoryBarriers) &&
+        HasNoChains(pDependencyInfo->imageMemoryBarrierCount, pDependencyInfo->pImageMemoryBarriers))
+    {
+        pending_barriers& pending = record->pending;
+        ++record->stats.barrier_calls;
+
+        const VkPipelineStageFlags2 src_stage_mask = GetSrcStageMask(pDependencyInfo);
+        const VkPipelineStageFlags2 dst_stage_mask = GetDstStageMask(pDependencyInfo);
+        const uint32_t              barrier_count  = pDependencyInfo->memoryBarrierCount +
+                                                   pDependencyInfo->bufferMemoryBarrierCount +
+                                                   pDependencyInfo->imageMemoryBarrierCount;
+
+        if ((pending.call_count != 0) &&
+            (!pending.synchronization2 || (pending.khr != khr) ||
+             (pending.dependency_flags != pDependencyInfo->dependencyFlags) ||
+             (pending.GetBarrierCount() >= kMaxPendingBarriers) ||
+             WaitsForPendingStages(src_stage_mask, pending.dst_stage_mask2) ||
+             HasGlobalBarrierConflict(pending.memory_barriers2.size(),
+                                      pending.GetBarrierCount(),
+                                      pDependencyInfo->memoryBarrierCount,
+                                      barrier_count) ||
+             HasPendingBuffer(pending.buffer_barriers2,
+                              pDependencyInfo->bufferMemoryBarrierCount,
+                              pDependencyInfo->pBufferMemoryBarriers) ||
+             HasPendingImage(pending.image_barriers2,
+                             pDependencyInfo->imageMemoryBarrierCount,
+                             pDependencyInfo->pImageMemoryBarriers)))
+        {
+            FlushPendingBarriers(commandBuffer, context);
+        }
+
+        ++pending.call_count;
+        pending.synchronization2 = true;
+        pending.khr              = khr;
+        pending.dependency_flags = pDependencyInfo->dependencyFlags;
+        pending.dst_stage_mask2 |= dst_stage_mask;
+        pending.memory_barriers2.insert(pending.memory_barriers2.end(),
+                                        pDependencyInfo->pMemoryBarriers,
+                                        pDependencyInfo->pMemoryBarriers + pDependencyInfo->memoryBarrierCount);
+        pending.buffer_barriers2.insert(pending.buffer_barriers2.end(),
+                                        pDependencyInfo->pBufferMemoryBarriers,
+                                        pDependencyInfo->pBufferMemoryBarriers +
+                                            pDependencyInfo->bufferMemoryBarrierCount);
+        pending.image_barriers2.insert(pending.image_barriers2.end(),
+                                       pDependencyInfo->pImageMemoryBarriers,
+                                       pDependencyInfo->pImageMemoryBarriers +
+                                           pDependencyInfo->imageMemoryBarrierCount);
+        return;
+    }
+
+    if ((record != nullptr) && (record->pending.call_count != 0))
+    {
+        FlushPendingBarriers(commandBuffer, context);
+    }
+
+    // Forward function to next layer / driver
+    if (khr)
+    {
+        context->dispatch_table->CmdPipelineBarrier2KHR(commandBuffer, pDependencyInfo);
+    }
+    else
+    {
+        context->dispatch_table->CmdPipelineBarrier2(commandBuffer, pDependencyInfo);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdPipelineBarrier2(VkCommandBuffer         commandBuffer,
+                                                     const VkDependencyInfo* pDependencyInfo)
+{
+    RecordPipelineBarrier2(commandBuffer, pDependencyInfo, false);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdPipelineBarrier2KHR(VkCommandBuffer         commandBuffer,
+                                                        const VkDependencyInfo* pDependencyInfo)
+{
+    RecordPipelineBarrier2(commandBuffer, pDependencyInfo, true);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName)
+    {
+        if (!strcmp(pName, "vkDestroyInstance"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyInstance;
+        }
+        else if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkAllocateCommandBuffers"))
+        {
+            result = (PFN_vkVoidFunction)layer_AllocateCommandBuffers;
+        }
+        else if (!strcmp(pName, "vkFreeCommandBuffers"))
+        {
+            result = (PFN_vkVoidFunction)layer_FreeCommandBuffers;
+        }
+        else if (!strcmp(pName, "vkResetCommandPool"))
+        {
+            result = (PFN_vkVoidFunction)layer_ResetCommandPool;
+        }
+        else if (!strcmp(pName, "vkDestroyCommandPool"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyCommandPool;
+        }
+        else if (!strcmp(pName, "vkBeginCommandBuffer"))
+        {
+            result = (PFN_vkVoidFunction)layer_BeginCommandBuffer;
+        }
+        else if (!strcmp(pName, "vkEndCommandBuffer"))
+        {
+            result = (PFN_vkVoidFunction)layer_EndCommandBuffer;
+        }
+        else if (!strcmp(pName, "vkResetCommandBuffer"))
+        {
+            result = (PFN_vkVoidFunction)layer_ResetCommandBuffer;
+        }
+        else if (!strcmp(pName, "vkCmdPipelineBarrier"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdPipelineBarrier;
+        }
+        else if (!strcmp(pName, "vkCmdPipelineBarrier2"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdPipelineBarrier2;
+        }
+        else if (!strcmp(pName, "vkCmdPipelineBarrier2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdPipelineBarrier2KHR;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result && pName)
+    {
+        result = GetFlushingCommand(device, pName);
+    }
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+
+        // The application can record a command that does not flush the pending barriers before it
+        if ((result != nullptr) && (device != VK_NULL_HANDLE) && (strncmp(pName, "vkCmd", 5) == 0))
+        {
+            DisableBatching(device, pName);
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,204 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the cost of recording runs of single-image vkCmdPipelineBarrier calls followed by a draw, through the
+// barrier batching layer and directly against the mock driver, which charges a fixed cost for each barrier call it
+// receives. Run with the number of runs as the optional first argument, the driver's cost per barrier call in
+// nanoseconds as the optional second one and the number of barrier calls per run as the optional third one.
+
+#include "base_layer/test/mock_driver.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static uint64_t barrier_cost_ns = 1000;
+
+static VKAPI_ATTR void VKAPI_CALL CostlyCmdPipelineBarrier(VkCommandBuffer              commandBuffer,
+                                                           VkPipelineStageFlags         srcStageMask,
+                                                           VkPipelineStageFlags         dstStageMask,
+                                                           VkDependencyFlags            dependencyFlags,
+                                                           uint32_t                     memoryBarrierCount,
+                                                           const VkMemoryBarrier*       pMemoryBarriers,
+                                                           uint32_t                     bufferMemoryBarrierCount,
+                                                           const VkBufferMemoryBarrier* pBufferMemoryBarriers,
+                                                           uint32_t                     imageMemoryBarrierCount,
+                                                           const VkImageMemoryBarrier*  pImageMemoryBarriers)
+{
+    (void)commandBuffer;
+    (void)srcStageMask;
+    (void)dstStageMask;
+    (void)dependencyFlags;
+    (void)memoryBarrierCount;
+    (void)pMemoryBarriers;
+    (void)bufferMemoryBarrierCount;
+    (void)pBufferMemoryBarriers;
+    (void)imageMemoryBarrierCount;
+    (void)pImageMemoryBarriers;
+
+    mock_driver::SpinFor(barrier_cost_ns);
+}
+
+static VKAPI_ATTR void VKAPI_CALL NoopCmdDraw(VkCommandBuffer commandBuffer,
+                                              uint32_t        vertexCount,
+                                              uint32_t        instanceCount,
+                                              uint32_t        firstVertex,
+                                              uint32_t        firstInstance)
+{
+    (void)commandBuffer;
+    (void)vertexCount;
+    (void)instanceCount;
+    (void)firstVertex;
+    (void)firstInstance;
+}
+
+// Commands of the layer, or of the mock driver when the layer is bypassed
+struct recording_commands
+{
+    PFN_vkCmdPipelineBarrier pipeline_barrier{ nullptr };
+    PFN_vkCmdDraw            draw{ nullptr };
+};
+
+template <typename Call>
+static void Measure(const char* name, uint32_t iterations, Call call)
+{
+    // Warms up the caches of the layer and of the CPU
+    call(iterations / 16);
+
+    const auto begin = std::chrono::steady_clock::now();
+    call(iterations);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    printf("%-40s %10.1f ns/run\n", name, ns / iterations);
+}
+
+static void MeasureCommands(const char*               mode,
+                            const recording_commands& commands,
+                            VkCommandBuffer           command_buffer,
+                            uint32_t                  iterations,
+                            uint32_t                  barriers_per_run)
+{
+    VkImageMemoryBarrier barrier        = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.srcAccessMask               = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask               = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout                   = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.newLayout                   = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+
+    // Each barrier of a run transitions its own image, the way a render graph prepares the inputs of a pass
+    std::vector<VkImageMemoryBarrier> barriers(barriers_per_run, barrier);
+    for (VkImageMemoryBarrier& image_barrier : barriers)
+    {
+        image_barrier.image = mock_driver::NewHandle<VkImage>();
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s %u barriers+vkCmdDraw", mode, barriers_per_run);
+    Measure(name, iterations, [&](uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            for (const VkImageMemoryBarrier& image_barrier : barriers)
+            {
+                commands.pipeline_barrier(command_buffer,
+                                          VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                                          VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                          0,
+                                          0,
+                                          nullptr,
+                                          0,
+                                          nullptr,
+                                          1,
+                                          &image_barrier);
+            }
+
+            commands.draw(command_buffer, 3, 1, 0, 0);
+        }
+    });
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 10000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    if (argc > 2)
+    {
+        barrier_cost_ns = strtoull(argv[2], nullptr, 10);
+    }
+
+    uint32_t barriers_per_run = (argc > 3) ? static_cast<uint32_t>(strtoul(argv[3], nullptr, 10)) : 8;
+    if (barriers_per_run == 0)
+    {
+        barriers_per_run = 1;
+    }
+
+    mock_driver::SetFunction("vkCmdPipelineBarrier", CostlyCmdPipelineBarrier);
+    mock_driver::SetFunction("vkCmdDraw", NoopCmdDraw);
+
+    mock_driver::context context;
+    if (!mock_driver::CreateContext(&context))
+    {
+        mock_driver::DestroyContext(&context);
+        return EXIT_FAILURE;
+    }
+
+    VkCommandPool           pool      = VK_NULL_HANDLE;
+    VkCommandPoolCreateInfo pool_info = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    MOCK_DEVICE_PROC(context, vkCreateCommandPool)(context.device, &pool_info, nullptr, &pool);
+
+    VkCommandBuffer             command_buffer = VK_NULL_HANDLE;
+    VkCommandBufferAllocateInfo allocate_info  = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocate_info.commandPool                  = pool;
+    allocate_info.level                        = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount           = 1;
+    MOCK_DEVICE_PROC(context, vkAllocateCommandBuffers)(context.device, &allocate_info, &command_buffer);
+
+    VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    MOCK_DEVICE_PROC(context, vkBeginCommandBuffer)(command_buffer, &begin_info);
+
+    printf("%u runs, %llu ns per driver barrier call\n", iterations, static_cast<unsigned long long>(barrier_cost_ns));
+
+    recording_commands driver_commands;
+    driver_commands.pipeline_barrier = CostlyCmdPipelineBarrier;
+    driver_commands.draw             = NoopCmdDraw;
+    MeasureCommands("driver", driver_commands, command_buffer, iterations, barriers_per_run);
+
+    recording_commands layer_commands;
+    layer_commands.pipeline_barrier = MOCK_DEVICE_PROC(context, vkCmdPipelineBarrier);
+    layer_commands.draw             = MOCK_DEVICE_PROC(context, vkCmdDraw);
+    MeasureCommands("layer", layer_commands, command_buffer, iterations, barriers_per_run);
+
+    MOCK_DEVICE_PROC(context, vkEndCommandBuffer)(command_buffer);
+    MOCK_DEVICE_PROC(context, vkDestroyCommandPool)(context.device, pool, nullptr);
+    mock_driver::DestroyContext(&context);
+    return (mock_driver::GetState().errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,582 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the decisions of the barrier batching layer to merge a barrier call with the pending ones or to flush them
+// first, by recording barriers through the layer and checking the calls that reach the mock driver.
+
+#include "base_layer/test/mock_driver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (false)
+
+// A command received by the mock driver, with the union of the stage masks and the barrier counts of barrier calls
+struct recorded_command
+{
+    const char*           name{ nullptr };
+    VkPipelineStageFlags2 src_stage_mask{ 0 };
+    VkPipelineStageFlags2 dst_stage_mask{ 0 };
+    VkDependencyFlags     dependency_flags{ 0 };
+    uint32_t              memory_barrier_count{ 0 };
+    uint32_t              buffer_barrier_count{ 0 };
+    uint32_t              image_barrier_count{ 0 };
+};
+
+static std::vector<recorded_command> recorded;
+
+static VKAPI_ATTR void VKAPI_CALL MockCmdPipelineBarrier(VkCommandBuffer              commandBuffer,
+                                                         VkPipelineStageFlags         srcStageMask,
+                                                         VkPipelineStageFlags         dstStageMask,
+                                                         VkDependencyFlags            dependencyFlags,
+                                                         uint32_t                     memoryBarrierCount,
+                                                         const VkMemoryBarrier*       pMemoryBarriers,
+                                                         uint32_t                     bufferMemoryBarrierCount,
+                                                         const VkBufferMemoryBarrier* pBufferMemoryBarriers,
+                                                         uint32_t                     imageMemoryBarrierCount,
+                                                         const VkImageMemoryBarrier*  pImageMemoryBarriers)
+{
+    (void)commandBuffer;
+    (void)pMemoryBarriers;
+    (void)pBufferMemoryBarriers;
+    (void)pImageMemoryBarriers;
+
+    recorded_command command;
+    command.name                 = "vkCmdPipelineBarrier";
+    command.src_stage_mask       = srcStageMask;
+    command.dst_stage_mask       = dstStageMask;
+    command.dependency_flags     = dependencyFlags;
+    command.memory_barrier_count = memoryBarrierCount;
+    command.buffer_barrier_count = bufferMemoryBarrierCount;
+    command.image_barrier_count  = imageMemoryBarrierCount;
+    recorded.push_back(command);
+}
+
+static void RecordPipelineBarrier2(const char* name, const VkDependencyInfo* pDependencyInfo)
+{
+    recorded_command command;
+    command.name                 = name;
+    command.dependency_flags     = pDependencyInfo->dependencyFlags;
+    command.memory_barrier_count = pDependencyInfo->memoryBarrierCount;
+    command.buffer_barrier_count = pDependencyInfo->bufferMemoryBarrierCount;
+    command.image_barrier_count  = pDependencyInfo->imageMemoryBarrierCount;
+
+    for (uint32_t i = 0; i < pDependencyInfo->memoryBarrierCount; ++i)
+    {
+        command.src_stage_mask |= pDependencyInfo->pMemoryBarriers[i].srcStageMask;
+        command.dst_stage_mask |= pDependencyInfo->pMemoryBarriers[i].dstStageMask;
+    }
+
+    for (uint32_t i = 0; i < pDependencyInfo->bufferMemoryBarrierCount; ++i)
+    {
+        command.src_stage_mask |= pDependencyInfo->pBufferMemoryBarriers[i].srcStageMask;
+        command.dst_stage_mask |= pDependencyInfo->pBufferMemoryBarriers[i].dstStageMask;
+    }
+
+    for (uint32_t i = 0; i < pDependencyInfo->imageMemoryBarrierCount; ++i)
+    {
+        command.src_stage_mask |= pDependencyInfo->pImageMemoryBarriers[i].srcStageMask;
+        command.dst_stage_mask |= pDependencyInfo->pImageMemoryBarriers[i].dstStageMask;
+    }
+
+    recorded.push_back(command);
+}
+
+static VKAPI_ATTR void VKAPI_CALL MockCmdPipelineBarrier2(VkCommandBuffer         commandBuffer,
+                                                          const VkDependencyInfo* pDependencyInfo)
+{
+    (void)commandBuffer;
+
+    RecordPipelineBarrier2("vkCmdPipelineBarrier2", pDependencyInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL MockCmdPipelineBarrier2KHR(VkCommandBuffer         commandBuffer,
+                                                             const VkDependencyInfo* pDependencyInfo)
+{
+    (void)commandBuffer;
+
+    RecordPipelineBarrier2("vkCmdPipelineBarrier2KHR", pDependencyInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL MockCmdDraw(VkCommandBuffer commandBuffer,
+                                              uint32_t        vertexCount,
+                                              uint32_t        instanceCount,
+                                              uint32_t        firstVertex,
+                                              uint32_t        firstInstance)
+{
+    (void)commandBuffer;
+    (void)vertexCount;
+    (void)instanceCount;
+    (void)firstVertex;
+    (void)firstInstance;
+
+    recorded_command command;
+    command.name = "vkCmdDraw";
+    recorded.push_back(command);
+}
+
+// A command buffer being recorded through the layer, with the layer's commands used by the tests
+struct recording
+{
+    mock_driver::context context;
+    VkCommandPool        pool{ VK_NULL_HANDLE };
+    VkCommandBuffer      command_buffer{ VK_NULL_HANDLE };
+
+    PFN_vkCmdPipelineBarrier     pipeline_barrier{ nullptr };
+    PFN_vkCmdPipelineBarrier2    pipeline_barrier2{ nullptr };
+    PFN_vkCmdPipelineBarrier2KHR pipeline_barrier2_khr{ nullptr };
+    PFN_vkCmdDraw                draw{ nullptr };
+};
+
+static bool BeginRecording(recording* recording)
+{
+    if (!mock_driver::CreateContext(&recording->context))
+    {
+        return false;
+    }
+
+    const mock_driver::context& context = recording->context;
+
+    VkCommandPoolCreateInfo pool_info = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    MOCK_DEVICE_PROC(context, vkCreateCommandPool)(context.device, &pool_info, nullptr, &recording->pool);
+
+    VkCommandBufferAllocateInfo allocate_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocate_info.commandPool                 = recording->pool;
+    allocate_info.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount          = 1;
+    MOCK_DEVICE_PROC(context, vkAllocateCommandBuffers)(context.device, &allocate_info, &recording->command_buffer);
+
+    recording->pipeline_barrier      = MOCK_DEVICE_PROC(context, vkCmdPipelineBarrier);
+    recording->pipeline_barrier2     = MOCK_DEVICE_PROC(context, vkCmdPipelineBarrier2);
+    recording->pipeline_barrier2_khr = MOCK_DEVICE_PROC(context, vkCmdPipelineBarrier2KHR);
+    recording->draw                  = MOCK_DEVICE_PROC(context, vkCmdDraw);
+
+    VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+    MOCK_DEVICE_PROC(context, vkBeginCommandBuffer)(recording->command_buffer, &begin_info);
+
+    recorded.clear();
+    return true;
+}
+
+static void EndRecording(recording* recording)
+{
+    const mock_driver::context& context = recording->context;
+
+    MOCK_DEVICE_PROC(context, vkEndCommandBuffer)(recording->command_buffer);
+    MOCK_DEVICE_PROC(context, vkDestroyCommandPool)(context.device, recording->pool, nullptr);
+    mock_driver::DestroyContext(&recording->context);
+}
+
+static void ImageBarrier(const recording&     recording,
+                         VkPipelineStageFlags src_stage_mask,
+                         VkPipelineStageFlags dst_stage_mask,
+                         VkImage              image,
+                         VkDependencyFlags    dependency_flags = 0,
+                         const void*          next             = nullptr)
+{
+    VkImageMemoryBarrier barrier        = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER };
+    barrier.pNext                       = next;
+    barrier.oldLayout                   = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout                   = VK_IMAGE_LAYOUT_GENERAL;
+    barrier.srcQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex         = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                       = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+
+    recording.pipeline_barrier(recording.command_buffer,
+                               src_stage_mask,
+                               dst_stage_mask,
+                               dependency_flags,
+                               0,
+                               nullptr,
+                               0,
+                               nullptr,
+                               1,
+                               &barrier);
+}
+
+static void BufferBarrier(const recording&     recording,
+                          VkPipelineStageFlags src_stage_mask,
+                          VkPipelineStageFlags dst_stage_mask,
+                          VkBuffer             buffer)
+{
+    VkBufferMemoryBarrier barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER };
+    barrier.srcQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex   = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer                = buffer;
+    barrier.size                  = VK_WHOLE_SIZE;
+
+    recording.pipeline_barrier(
+        recording.command_buffer, src_stage_mask, dst_stage_mask, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+static void GlobalBarrier(const recording&     recording,
+                          VkPipelineStageFlags src_stage_mask,
+                          VkPipelineStageFlags dst_stage_mask)
+{
+    VkMemoryBarrier barrier = { VK_STRUCTURE_TYPE_MEMORY_BARRIER };
+    barrier.srcAccessMask   = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask   = VK_ACCESS_MEMORY_READ_BIT;
+
+    recording.pipeline_barrier(
+        recording.command_buffer, src_stage_mask, dst_stage_mask, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+static void BufferBarrier2(const recording&      recording,
+                           VkPipelineStageFlags2 src_stage_mask,
+                           VkPipelineStageFlags2 dst_stage_mask,
+                           VkBuffer              buffer,
+                           bool                  khr = false)
+{
+    VkBufferMemoryBarrier2 barrier = { VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2 };
+    barrier.srcStageMask           = src_stage_mask;
+    barrier.dstStageMask           = dst_stage_mask;
+    barrier.srcQueueFamilyIndex    = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex    = VK_QUEUE_FAMILY_IGNORED;
+    barrier.buffer                 = buffer;
+    barrier.size                   = VK_WHOLE_SIZE;
+
+    VkDependencyInfo dependency_info         = { VK_STRUCTURE_TYPE_DEPENDENCY_INFO };
+    dependency_info.bufferMemoryBarrierCount = 1;
+    dependency_info.pBufferMemoryBarriers    = &barrier;
+
+    if (khr)
+    {
+        recording.pipeline_barrier2_khr(recording.command_buffer, &dependency_info);
+    }
+    else
+    {
+        recording.pipeline_barrier2(recording.command_buffer, &dependency_info);
+    }
+}
+
+// Returns the number of barrier calls that reached the driver, after flushing the pending ones with a draw.
+static size_t FlushAndCountBarrierCalls(const recording& recording)
+{
+    recording.draw(recording.command_buffer, 3, 1, 0, 0);
+
+    CHECK(!recorded.empty() && (strcmp(recorded.back().name, "vkCmdDraw") == 0));
+    return recorded.empty() ? 0 : recorded.size() - 1;
+}
+
+static void TestIndependentBarriersAreMerged()
+{
+    recording recording;
+    CHECK(BeginRecording(&recording));
+
+    ImageBarrier(recording,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                 mock_driver::NewHandle<VkImage>());
+    ImageBarrier(recording,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                 mock_driver::NewHandle<VkImage>());
+    BufferBarrier(
+        recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, mock_driver::NewHandle<VkBuffer>());
+
+    // Nothing reaches the driver before the next other command
+    CHECK(recorded.empty());
+    CHECK(FlushAndCountBarrierCalls(recording) == 1);
+    if (recorded.size() == 2)
+    {
+        const recorded_command& merged = recorded[0];
+        CHECK(merged.src_stage_mask == (VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT));
+        CHECK(merged.dst_stage_mask == (VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                        VK_PIPELINE_STAGE_TRANSFER_BIT));
+        CHECK((merged.image_barrier_count == 2) && (merged.buffer_barrier_count == 1));
+    }
+
+    EndRecording(&recording);
+}
+
+static void TestSameResourceIsNotMerged()
+{
+    recording recording;
+    CHECK(BeginRecording(&recording));
+
+    // Layout transitions of one image in a single call would not be ordered
+    const VkImage image = mock_driver::NewHandle<VkImage>();
+    ImageBarrier(recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, image);
+    ImageBarrier(recording, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, image);
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+
+    recorded.clear();
+    const VkBuffer buffer = mock_driver::NewHandle<VkBuffer>();
+    BufferBarrier(recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, buffer);
+    BufferBarrier(recording, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, buffer);
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+
+    recorded.clear();
+    BufferBarrier2(recording, VK_PIPELINE_STAGE_2_COPY_BIT, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, buffer);
+    BufferBarrier2(recording, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, buffer);
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+
+    EndRecording(&recording);
+}
+
+static void TestWaitsForPendingStages()
+{
+    struct stage_case
+    {
+        VkPipelineStageFlags pending_dst_stage_mask;
+        VkPipelineStageFlags src_stage_mask;
+        bool                 merged;
+    };
+
+    static const stage_case kCases[] = {
+        { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, false },
+        { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, true },
+        { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, false },
+        { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, false },
+        // Bottom of pipe stands for every stage in a first synchronization scope, top of pipe for none
+        { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, false },
+        { VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, true },
+        // Bottom of pipe stands for no stage in a second synchronization scope
+        { VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, true },
+        { VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, false },
+    };
+
+    recording recording;
+    CHECK(BeginRecording(&recording));
+
+    for (const stage_case& stage_case : kCases)
+    {
+        recorded.clear();
+        ImageBarrier(recording,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     stage_case.pending_dst_stage_mask,
+                     mock_driver::NewHandle<VkImage>());
+        ImageBarrier(recording,
+                     stage_case.src_stage_mask,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     mock_driver::NewHandle<VkImage>());
+        CHECK(FlushAndCountBarrierCalls(recording) == (stage_case.merged ? 1 : 2));
+    }
+
+    // Stages that stand for several others overlap with each of them
+    static const VkPipelineStageFlags2 kOverlappingStages[][2] = {
+        { VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_PIPELINE_STAGE_2_COPY_BIT },
+        { VK_PIPELINE_STAGE_2_CLEAR_BIT, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT },
+        { VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT },
+        { VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT, VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT },
+    };
+
+    for (const VkPipelineStageFlags2* stages : kOverlappingStages)
+    {
+        recorded.clear();
+        BufferBarrier2(recording, VK_PIPELINE_STAGE_2_HOST_BIT, stages[0], mock_driver::NewHandle<VkBuffer>());
+        BufferBarrier2(recording, stages[1], VK_PIPELINE_STAGE_2_HOST_BIT, mock_driver::NewHandle<VkBuffer>());
+        CHECK(FlushAndCountBarrierCalls(recording) == 2);
+    }
+
+    recorded.clear();
+    BufferBarrier2(
+        recording, VK_PIPELINE_STAGE_2_HOST_BIT, VK_PIPELINE_STAGE_2_COPY_BIT, mock_driver::NewHandle<VkBuffer>());
+    BufferBarrier2(recording,
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_PIPELINE_STAGE_2_HOST_BIT,
+                   mock_driver::NewHandle<VkBuffer>());
+    CHECK(FlushAndCountBarrierCalls(recording) == 1);
+
+    EndRecording(&recording);
+}
+
+static void TestGlobalBarriersAreNotMerged()
+{
+    recording recording;
+    CHECK(BeginRecording(&recording));
+
+    // A global barrier covers every resource, like a barrier to a resource that already has a pending one
+    ImageBarrier(recording,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                 mock_driver::NewHandle<VkImage>());
+    GlobalBarrier(recording, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+
+    recorded.clear();
+    GlobalBarrier(recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    BufferBarrier(recording,
+                  VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                  VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                  mock_driver::NewHandle<VkBuffer>());
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+
+    recorded.clear();
+    GlobalBarrier(recording, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    GlobalBarrier(recording, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT);
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+
+    EndRecording(&recording);
+}
+
+static void TestIncompatibleCallsAreNotMerged()
+{
+    recording recording;
+    CHECK(BeginRecording(&recording));
+
+    // Different dependency flags
+    ImageBarrier(recording,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                 mock_driver::NewHandle<VkImage>());
+    ImageBarrier(recording,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                 mock_driver::NewHandle<VkImage>(),
+                 VK_DEPENDENCY_BY_REGION_BIT);
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+    CHECK((recorded.size() == 3) && (recorded[1].dependency_flags == VK_DEPENDENCY_BY_REGION_BIT));
+
+    // A barrier with a pNext chain is forwarded as it is recorded, after the pending ones
+    recorded.clear();
+    VkSampleLocationsInfoEXT chain = { VK_STRUCTURE_TYPE_SAMPLE_LOCATIONS_INFO_EXT };
+    ImageBarrier(recording,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                 mock_driver::NewHandle<VkImage>());
+    ImageBarrier(recording,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                 VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+                 mock_driver::NewHandle<VkImage>(),
+                 0,
+                 &chain);
+    CHECK(recorded.size() == 2);
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+
+    // vkCmdPipelineBarrier, vkCmdPipelineBarrier2 and vkCmdPipelineBarrier2KHR calls are kept apart
+    recorded.clear();
+    BufferBarrier(recording,
+                  VK_PIPELINE_STAGE_TRANSFER_BIT,
+                  VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                  mock_driver::NewHandle<VkBuffer>());
+    BufferBarrier2(recording,
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                   mock_driver::NewHandle<VkBuffer>());
+    BufferBarrier2(recording,
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                   mock_driver::NewHandle<VkBuffer>(),
+                   true);
+    CHECK(FlushAndCountBarrierCalls(recording) == 3);
+    if (recorded.size() == 4)
+    {
+        CHECK(strcmp(recorded[0].name, "vkCmdPipelineBarrier") == 0);
+        CHECK(strcmp(recorded[1].name, "vkCmdPipelineBarrier2") == 0);
+        CHECK(strcmp(recorded[2].name, "vkCmdPipelineBarrier2KHR") == 0);
+    }
+
+    EndRecording(&recording);
+}
+
+static void TestSynchronization2BarriersAreMerged()
+{
+    recording recording;
+    CHECK(BeginRecording(&recording));
+
+    BufferBarrier2(recording,
+                   VK_PIPELINE_STAGE_2_COPY_BIT,
+                   VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,
+                   mock_driver::NewHandle<VkBuffer>());
+    BufferBarrier2(recording,
+                   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+                   VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT,
+                   mock_driver::NewHandle<VkBuffer>());
+    CHECK(FlushAndCountBarrierCalls(recording) == 1);
+
+    // The barriers keep their own stage masks
+    CHECK((recorded.size() == 2) && (recorded[0].buffer_barrier_count == 2));
+
+    EndRecording(&recording);
+}
+
+static void TestPendingBarriersAreFlushed()
+{
+    recording recording;
+    CHECK(BeginRecording(&recording));
+
+    // A call is flushed once it holds 64 barriers
+    for (uint32_t i = 0; i < 65; ++i)
+    {
+        ImageBarrier(recording,
+                     VK_PIPELINE_STAGE_TRANSFER_BIT,
+                     VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                     mock_driver::NewHandle<VkImage>());
+    }
+
+    CHECK(FlushAndCountBarrierCalls(recording) == 2);
+    CHECK((recorded.size() == 3) && (recorded[0].image_barrier_count == 64) && (recorded[1].image_barrier_count == 1));
+
+    // The barriers pending when recording ends are forwarded before vkEndCommandBuffer
+    recorded.clear();
+    ImageBarrier(recording,
+                 VK_PIPELINE_STAGE_TRANSFER_BIT,
+                 VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                 mock_driver::NewHandle<VkImage>());
+    CHECK(recorded.empty());
+    EndRecording(&recording);
+    CHECK(recorded.size() == 1);
+}
+
+int main()
+{
+    mock_driver::SetFunction("vkCmdPipelineBarrier", MockCmdPipelineBarrier);
+    mock_driver::SetFunction("vkCmdPipelineBarrier2", MockCmdPipelineBarrier2);
+    mock_driver::SetFunction("vkCmdPipelineBarrier2KHR", MockCmdPipelineBarrier2KHR);
+    mock_driver::SetFunction("vkCmdDraw", MockCmdDraw);
+
+    TestIndependentBarriersAreMerged();
+    TestSameResourceIsNotMerged();
+    TestWaitsForPendingStages();
+    TestGlobalBarriersAreNotMerged();
+    TestIncompatibleCallsAreNotMerged();
+    TestSynchronization2BarriersAreMerged();
+    TestPendingBarriersAreFlushed();
+
+    CHECK(mock_driver::GetState().errors == 0);
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,242 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the cost per call of commands hooked by the three layers of VK_LAYER_LUNARG_fused, either through the
+// fused layer or through the three layers stacked by the loader. Run with "fused", "stacked" or "none" as the first
+// argument and the number of calls per command as the optional second one. The layers must be found by the loader,
+// for example through VK_ADD_LAYER_PATH, and GFXR_SPIN_WAIT must be set so that the spin wait layer hooks its
+// commands.
+
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static constexpr uint32_t kCommandsPerRecording = 4096;
+
+static const char* const kFusedLayers[]   = { "VK_LAYER_LUNARG_fused" };
+static const char* const kStackedLayers[] = { "VK_LAYER_LUNARG_physical_device_cache",
+                                              "VK_LAYER_LUNARG_gfxreconstruct_perfetto",
+                                              "VK_LAYER_LUNARG_spin_wait" };
+
+struct benchmark_context
+{
+    VkInstance       instance{ VK_NULL_HANDLE };
+    VkPhysicalDevice physical_device{ VK_NULL_HANDLE };
+    VkDevice         device{ VK_NULL_HANDLE };
+    VkFence          fence{ VK_NULL_HANDLE };
+    VkCommandPool    command_pool{ VK_NULL_HANDLE };
+    VkCommandBuffer  command_buffer{ VK_NULL_HANDLE };
+};
+
+static bool CreateContext(const char* const* layers, uint32_t layer_count, benchmark_context* context)
+{
+    VkApplicationInfo application_info = { VK_STRUCTURE_TYPE_APPLICATION_INFO };
+    application_info.pApplicationName  = "fused_layer_benchmark";
+    application_info.apiVersion        = VK_API_VERSION_1_1;
+
+    VkInstanceCreateInfo instance_info = { VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO };
+    instance_info.pApplicationInfo     = &application_info;
+    instance_info.enabledLayerCount    = layer_count;
+    instance_info.ppEnabledLayerNames  = layers;
+    if (vkCreateInstance(&instance_info, nullptr, &context->instance) != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateInstance failed, are the layers on the loader's search path?\n");
+        return false;
+    }
+
+    uint32_t physical_device_count = 1;
+    VkResult result =
+        vkEnumeratePhysicalDevices(context->instance, &physical_device_count, &context->physical_device);
+    if (((result != VK_SUCCESS) && (result != VK_INCOMPLETE)) || (physical_device_count == 0))
+    {
+        fprintf(stderr, "No physical device found\n");
+        return false;
+    }
+
+    const float             priority   = 1.0f;
+    VkDeviceQueueCreateInfo queue_info = { VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO };
+    queue_info.queueFamilyIndex        = 0;
+    queue_info.queueCount              = 1;
+    queue_info.pQueuePriorities        = &priority;
+
+    VkDeviceCreateInfo device_info   = { VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO };
+    device_info.queueCreateInfoCount = 1;
+    device_info.pQueueCreateInfos    = &queue_info;
+    if (vkCreateDevice(context->physical_device, &device_info, nullptr, &context->device) != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkCreateDevice failed\n");
+        return false;
+    }
+
+    VkFenceCreateInfo fence_info = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    fence_info.flags             = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    VkCommandPoolCreateInfo pool_info = { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO };
+    pool_info.flags                   = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex        = 0;
+
+    if ((vkCreateFence(context->device, &fence_info, nullptr, &context->fence) != VK_SUCCESS) ||
+        (vkCreateCommandPool(context->device, &pool_info, nullptr, &context->command_pool) != VK_SUCCESS))
+    {
+        fprintf(stderr, "Failed to create the fence or the command pool\n");
+        return false;
+    }
+
+    VkCommandBufferAllocateInfo allocate_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO };
+    allocate_info.commandPool                 = context->command_pool;
+    allocate_info.level                       = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocate_info.commandBufferCount          = 1;
+    if (vkAllocateCommandBuffers(context->device, &allocate_info, &context->command_buffer) != VK_SUCCESS)
+    {
+        fprintf(stderr, "vkAllocateCommandBuffers failed\n");
+        return false;
+    }
+
+    return true;
+}
+
+static void DestroyContext(benchmark_context* context)
+{
+    if (context->device != VK_NULL_HANDLE)
+    {
+        vkDestroyCommandPool(context->device, context->command_pool, nullptr);
+        vkDestroyFence(context->device, context->fence, nullptr);
+        vkDestroyDevice(context->device, nullptr);
+    }
+
+    if (context->instance != VK_NULL_HANDLE)
+    {
+        vkDestroyInstance(context->instance, nullptr);
+    }
+}
+
+template <typename Call>
+static void Measure(const char* name, uint32_t iterations, Call call)
+{
+    // Warms up the caches of the layers and of the CPU
+    call(iterations / 16);
+
+    const auto begin = std::chrono::steady_clock::now();
+    call(iterations);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    printf("%-32s %8.1f ns/call\n", name, ns / iterations);
+}
+
+int main(int argc, char** argv)
+{
+    const char* mode       = (argc > 1) ? argv[1] : "fused";
+    uint32_t    iterations = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1000000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    const char* const* layers      = nullptr;
+    uint32_t           layer_count = 0;
+    if (!strcmp(mode, "fused"))
+    {
+        layers      = kFusedLayers;
+        layer_count = static_cast<uint32_t>(sizeof(kFusedLayers) / sizeof(kFusedLayers[0]));
+    }
+    else if (!strcmp(mode, "stacked"))
+    {
+        layers      = kStackedLayers;
+        layer_count = static_cast<uint32_t>(sizeof(kStackedLayers) / sizeof(kStackedLayers[0]));
+    }
+    else if (strcmp(mode, "none"))
+    {
+        fprintf(stderr, "Usage: %s [fused|stacked|none] [calls per command]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    benchmark_context context;
+    if (!CreateContext(layers, layer_count, &context))
+    {
+        DestroyContext(&context);
+        return EXIT_FAILURE;
+    }
+
+    printf("%s, %u calls per command\n", mode, iterations);
+
+    // Hooked by the physical device cache layer
+    Measure("vkGetPhysicalDeviceProperties", iterations, [&](uint32_t count) {
+        VkPhysicalDeviceProperties properties;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            vkGetPhysicalDeviceProperties(context.physical_device, &properties);
+        }
+    });
+
+    // Hooked by the perfetto layer
+    Measure("vkGetFenceStatus", iterations, [&](uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            vkGetFenceStatus(context.device, context.fence);
+        }
+    });
+
+    // Hooked by the perfetto and spin wait layers. The fence is signaled, so the wait returns right away.
+    Measure("vkWaitForFences", iterations, [&](uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            vkWaitForFences(context.device, 1, &context.fence, VK_TRUE, UINT64_MAX);
+        }
+    });
+
+    // Hooked by the perfetto layer. The recording is restarted regularly so that the command buffer stays small.
+    Measure("vkCmdPipelineBarrier", iterations, [&](uint32_t count) {
+        VkCommandBufferBeginInfo begin_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO };
+        begin_info.flags                    = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            if ((i % kCommandsPerRecording) == 0)
+            {
+                vkBeginCommandBuffer(context.command_buffer, &begin_info);
+            }
+
+            vkCmdPipelineBarrier(context.command_buffer,
+                                 VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                                 VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                                 0,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr,
+                                 0,
+                                 nullptr);
+
+            if ((((i + 1) % kCommandsPerRecording) == 0) || ((i + 1) == count))
+            {
+                vkEndCommandBuffer(context.command_buffer);
+            }
+        }
+    });
+
+    DestroyContext(&context);
+    return EXIT_SUCCESS;
+}
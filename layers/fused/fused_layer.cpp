@@ -0,0 +1,93 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// The physical device cache, perfetto and spin wait layers fused into a single layer, see base_layer/fused_layer.inc.
+
+#define LAYER_NAME "VK_LAYER_LUNARG_fused"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Physical device cache, GFXReconstruct perfetto and spin wait layers fused into one layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+#define BASE_LAYER_DIRECT_DISPATCH
+#define BASE_LAYER_FUSED 3
+
+#include "base_layer/base_layer.inc"
+
+// Headers included by the child layers
+#include "../perfetto/perfetto_tracing_categories.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace fused_physical_device_cache
+{
+#define BASE_LAYER_FUSED_INDEX 0
+#include "base_layer/fused_child.inc"
+#undef BASE_LAYER_FUSED_INDEX
+
+#include "../physical_device_cache/physical_device_cache_layer.cpp"
+} // namespace fused_physical_device_cache
+
+namespace fused_perfetto
+{
+#define BASE_LAYER_FUSED_INDEX 1
+#include "base_layer/fused_child.inc"
+#undef BASE_LAYER_FUSED_INDEX
+
+#include "../perfetto/perfetto_layer.cpp"
+} // namespace fused_perfetto
+
+namespace fused_spin_wait
+{
+#define BASE_LAYER_FUSED_INDEX 2
+#include "base_layer/fused_child.inc"
+#undef BASE_LAYER_FUSED_INDEX
+
+#include "../spin_wait/spin_wait_layer.cpp"
+} // namespace fused_spin_wait
+
+static const base_layer::fused_child_layer kFusedLayers[] = {
+    { fused_physical_device_cache::layer_GetProcAddr,
+      fused_physical_device_cache::layer_CreateInstance,
+      fused_physical_device_cache::layer_CreateDevice },
+    { fused_perfetto::layer_GetProcAddr, fused_perfetto::layer_CreateInstance, fused_perfetto::layer_CreateDevice },
+    { fused_spin_wait::layer_GetProcAddr, fused_spin_wait::layer_CreateInstance, fused_spin_wait::layer_CreateDevice },
+};
+
+#include "base_layer/fused_layer.inc"
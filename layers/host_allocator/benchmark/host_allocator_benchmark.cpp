@@ -0,0 +1,199 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the cost per call of the host allocator layer's callbacks against callbacks forwarding to malloc, realloc
+// and free, with one thread and then with several threads allocating concurrently. All allocations ask for an
+// alignment of 16 bytes, which malloc provides on 64-bit systems. Run with the number of calls per thread as the
+// optional first argument and the largest number of threads as the optional second one.
+
+#include "../thread_caching_allocator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+static constexpr size_t   kAlignment       = 16;
+static constexpr uint32_t kSizeCount       = 4096;
+static constexpr uint32_t kLiveAllocations = 256;
+
+static void* VKAPI_PTR SystemAllocation(void*                   pUserData,
+                                        size_t                  size,
+                                        size_t                  alignment,
+                                        VkSystemAllocationScope allocationScope)
+{
+    (void)pUserData;
+    (void)alignment;
+    (void)allocationScope;
+
+    return malloc(size);
+}
+
+static void* VKAPI_PTR SystemReallocation(void*                   pUserData,
+                                          void*                   pOriginal,
+                                          size_t                  size,
+                                          size_t                  alignment,
+                                          VkSystemAllocationScope allocationScope)
+{
+    (void)pUserData;
+    (void)alignment;
+    (void)allocationScope;
+
+    return realloc(pOriginal, size);
+}
+
+static void VKAPI_PTR SystemFree(void* pUserData, void* pMemory)
+{
+    (void)pUserData;
+
+    free(pMemory);
+}
+
+static const VkAllocationCallbacks kSystemCallbacks = {
+    nullptr, SystemAllocation, SystemReallocation, SystemFree, nullptr, nullptr
+};
+
+// Sizes of the allocations, mostly of a few hundred bytes as made for the objects of a driver, with some larger than
+// the largest size class of the layer
+static std::vector<size_t> GetSizes()
+{
+    std::mt19937                            random(1);
+    std::uniform_int_distribution<uint32_t> percent(0, 99);
+    std::vector<size_t>                     sizes(kSizeCount);
+    for (size_t& size : sizes)
+    {
+        const uint32_t kind = percent(random);
+        const size_t   max  = (kind < 80) ? 256 : ((kind < 98) ? kMaxBlockSize : 4 * kMaxBlockSize);
+        size                = std::uniform_int_distribution<size_t>(1, max)(random);
+    }
+
+    return sizes;
+}
+
+template <typename Call>
+static void Measure(const char* name, uint32_t iterations, uint32_t thread_count, Call call)
+{
+    // Warms up the caches of the allocator and of the CPU
+    call(iterations / 16);
+
+    std::vector<std::thread> threads;
+    const auto               begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back(call, iterations);
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    printf("%-48s %2u threads %10.1f ns/call\n", name, thread_count, ns / iterations);
+}
+
+static void MeasureCallbacks(const char*                  mode,
+                             const VkAllocationCallbacks& callbacks,
+                             const std::vector<size_t>&   sizes,
+                             uint32_t                     iterations,
+                             uint32_t                     max_threads)
+{
+    const VkSystemAllocationScope scope = VK_SYSTEM_ALLOCATION_SCOPE_OBJECT;
+
+    char name[64];
+    for (uint32_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+    {
+        snprintf(name, sizeof(name), "%s allocate+free", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                void* memory = callbacks.pfnAllocation(callbacks.pUserData, sizes[i % kSizeCount], kAlignment, scope);
+                callbacks.pfnFree(callbacks.pUserData, memory);
+            }
+        });
+
+        // Allocations replaced in a loop with others live, so that blocks are freed in a different order than they
+        // were allocated
+        snprintf(name, sizeof(name), "%s allocate+free with %u live", mode, kLiveAllocations);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            std::vector<void*> live(kLiveAllocations, nullptr);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                void*& memory = live[(i * 97) % kLiveAllocations];
+                callbacks.pfnFree(callbacks.pUserData, memory);
+                memory = callbacks.pfnAllocation(callbacks.pUserData, sizes[i % kSizeCount], kAlignment, scope);
+            }
+
+            for (void* memory : live)
+            {
+                callbacks.pfnFree(callbacks.pUserData, memory);
+            }
+        });
+
+        // Arrays grown by doubling their size, from 16 bytes to twice the largest size class of the layer
+        snprintf(name, sizeof(name), "%s reallocate", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            void* memory = nullptr;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const size_t size = kMinBlockSize << (i % (kSizeClassCount + 1));
+                if (size == kMinBlockSize)
+                {
+                    callbacks.pfnFree(callbacks.pUserData, memory);
+                    memory = nullptr;
+                }
+
+                memory = callbacks.pfnReallocation(callbacks.pUserData, memory, size, kAlignment, scope);
+            }
+
+            callbacks.pfnFree(callbacks.pUserData, memory);
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 1000000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    uint32_t max_threads = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 8;
+    if (max_threads == 0)
+    {
+        max_threads = 1;
+    }
+
+    const std::vector<size_t> sizes = GetSizes();
+
+    printf("%u calls per thread\n", iterations);
+
+    MeasureCallbacks("malloc", kSystemCallbacks, sizes, iterations, max_threads);
+    MeasureCallbacks("layer", kHostAllocationCallbacks, sizes, iterations, max_threads);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,876 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_host_allocator"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Thread caching host allocation callbacks layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+
+#include "../perfetto/perfetto_tracing_categories.h"
+#include "thread_caching_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// When enabled, commands called without VkAllocationCallbacks are given the layer's callbacks, so that the host memory
+// of the loader and driver below comes from a thread caching allocator rather than from the system heap. The layer can
+// also profile the host allocations made through any callbacks, see GetProfiledCallbacks. Every instance and device
+// command with a VkAllocationCallbacks parameter is wrapped, see FOR_EACH_INSTANCE_ALLOCATION_CALLBACKS_COMMAND and
+// FOR_EACH_DEVICE_ALLOCATION_CALLBACKS_COMMAND, so that objects are always destroyed with the callbacks they were
+// created with. The allocator itself is in thread_caching_allocator.h.
+static const char* const kScopeNames[kScopeCount] = { "command", "object", "cache", "device", "instance" };
+
+static bool IsHostAllocatorEnabled()
+{
+    static const bool enabled =
+        base_layer::is_layer_setting_enabled("GFXR_HOST_ALLOCATOR", "debug.gfxr.host_allocator");
+    return enabled;
+}
+
+static bool IsProfilingEnabled()
+{
+    static const bool enabled =
+        base_layer::is_layer_setting_enabled("GFXR_HOST_ALLOCATOR_PROFILE", "debug.gfxr.host_allocator.profile");
+    return enabled;
+}
+
+static bool IsInterceptionEnabled()
+{
+    return IsHostAllocatorEnabled() || IsProfilingEnabled();
+}
+
+// When profiling, every command with a VkAllocationCallbacks parameter is given callbacks that time and count the
+// allocations made through them before passing them on to the application's callbacks, to the layer's own callbacks
+// or to the system heap. Each allocation is preceded by an allocation_prefix holding its size and scope, so that frees
+// can be accounted. Counts and latencies are kept per thread and only written by their thread; live and peak bytes are
+// shared, so that the peak is exact.
+static constexpr uint64_t kSlowAllocationNs = 100000;
+
+struct allocation_prefix
+{
+    uint64_t size{ 0 };
+    uint32_t scope{ 0 };
+    uint32_t offset{ 0 }; // Distance from the start of the wrapped allocation
+};
+
+static_assert(sizeof(allocation_prefix) == 16, "The prefix must keep allocations aligned to 16 bytes");
+
+// pUserData of callbacks points to the structure itself
+struct profiled_callbacks
+{
+    VkAllocationCallbacks callbacks{};
+    VkAllocationCallbacks wrapped{};
+};
+
+struct profile_counters
+{
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> reallocations{ 0 };
+    std::atomic<uint64_t> frees{ 0 };
+    std::atomic<uint64_t> latency_ns{ 0 };
+    std::atomic<uint64_t> max_latency_ns{ 0 };
+};
+
+// Counters of a thread are handed to another thread when it exits. They are never reset, as they are only summed.
+struct thread_profile
+{
+    profile_counters  scopes[kScopeCount];
+    std::atomic<bool> in_use{ false };
+    thread_profile*   next{ nullptr };
+};
+
+struct thread_profile_owner
+{
+    thread_profile* profile{ nullptr };
+
+    ~thread_profile_owner()
+    {
+        if (profile != nullptr)
+        {
+            profile->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+struct profiled_scope_memory
+{
+    std::atomic<int64_t> live_bytes{ 0 };
+    std::atomic<int64_t> peak_bytes{ 0 };
+};
+
+struct profile_totals
+{
+    uint64_t allocations{ 0 };
+    uint64_t reallocations{ 0 };
+    uint64_t frees{ 0 };
+    uint64_t latency_ns{ 0 };
+    uint64_t max_latency_ns{ 0 };
+};
+
+static std::atomic<thread_profile*>                     thread_profiles{ nullptr };
+static thread_local thread_profile_owner                current_profile;
+static profiled_scope_memory                            profiled_memory[kScopeCount];
+static std::shared_mutex                                profiled_callbacks_lock;
+static std::vector<std::unique_ptr<profiled_callbacks>> application_profiled_callbacks;
+static std::mutex                                       frame_counters_lock;
+static uint64_t                                         last_frame_operations{ 0 };
+static uint64_t                                         last_frame_latency_ns{ 0 };
+
+static const char* const kLiveBytesCounterNames[kScopeCount] = { "Host command scope live bytes",
+                                                                 "Host object scope live bytes",
+                                                                 "Host cache scope live bytes",
+                                                                 "Host device scope live bytes",
+                                                                 "Host instance scope live bytes" };
+
+static void InitializePerfetto()
+{
+    static bool initialized = false;
+
+    if (!initialized)
+    {
+        perfetto::TracingInitArgs args;
+        args.backends |= perfetto::kInProcessBackend;
+        args.backends |= perfetto::kSystemBackend;
+        perfetto::Tracing::Initialize(args);
+        perfetto::TrackEvent::Register();
+
+        initialized = true;
+    }
+}
+
+static thread_profile* GetThreadProfile()
+{
+    thread_profile_owner& owner = current_profile;
+    if (owner.profile != nullptr)
+    {
+        return owner.profile;
+    }
+
+    thread_profile* released = thread_profiles.load(std::memory_order_acquire);
+    for (; released != nullptr; released = released->next)
+    {
+        bool in_use = false;
+        if (!released->in_use.load(std::memory_order_relaxed) &&
+            released->in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire))
+        {
+            owner.profile = released;
+            return released;
+        }
+    }
+
+    thread_profile* profile = new thread_profile();
+    profile->in_use.store(true, std::memory_order_relaxed);
+    profile->next = thread_profiles.load(std::memory_order_relaxed);
+    while (!thread_profiles.compare_exchange_weak(
+        profile->next, profile, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+
+    owner.profile = profile;
+    return profile;
+}
+
+// Counters are only written by the thread that owns them
+static void AddToCounter(std::atomic<uint64_t>& counter, uint64_t value)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static void AddLiveBytes(uint32_t scope, int64_t bytes)
+{
+    profiled_scope_memory& memory = profiled_memory[scope];
+    const int64_t          live   = memory.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    int64_t peak = memory.peak_bytes.load(std::memory_order_relaxed);
+    while ((live > peak) && !memory.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+    {
+    }
+}
+
+static void RecordAllocation(uint32_t scope, size_t size, uint64_t latency_ns, bool reallocation)
+{
+    profile_counters& counters = GetThreadProfile()->scopes[scope];
+    AddToCounter(reallocation ? counters.reallocations : counters.allocations, 1);
+    AddToCounter(counters.latency_ns, latency_ns);
+    if (latency_ns > counters.max_latency_ns.load(std::memory_order_relaxed))
+    {
+        counters.max_latency_ns.store(latency_ns, std::memory_order_relaxed);
+    }
+
+    if (latency_ns >= kSlowAllocationNs)
+    {
+        TRACE_EVENT_INSTANT("GFXR",
+                            reallocation ? "Slow host reallocation" : "Slow host allocation",
+                            "scope",
+                            kScopeNames[scope],
+                            "bytes",
+                            static_cast<uint64_t>(size),
+                            "us",
+                            static_cast<double>(latency_ns) / 1000.0);
+    }
+}
+
+static void RecordFree(const allocation_prefix& prefix)
+{
+    AddToCounter(GetThreadProfile()->scopes[prefix.scope].frees, 1);
+    AddLiveBytes(prefix.scope, -static_cast<int64_t>(prefix.size));
+}
+
+static allocation_prefix* GetAllocationPrefix(void* memory)
+{
+    return reinterpret_cast<allocation_prefix*>(static_cast<uint8_t*>(memory) - sizeof(allocation_prefix));
+}
+
+static uint32_t GetPrefixOffset(size_t alignment)
+{
+    return static_cast<uint32_t>(std::max(alignment, sizeof(allocation_prefix)));
+}
+
+// Allocates from the wrapped callbacks and writes the prefix, without recording the allocation
+static void* AllocateWrapped(const profiled_callbacks* profiled,
+                             size_t                    size,
+                             size_t                    alignment,
+                             VkSystemAllocationScope   allocationScope)
+{
+    const uint32_t offset  = GetPrefixOffset(alignment);
+    uint8_t*       wrapped = static_cast<uint8_t*>(profiled->wrapped.pfnAllocation(
+        profiled->wrapped.pUserData, size + offset, std::max(alignment, alignof(allocation_prefix)), allocationScope));
+    if (wrapped == nullptr)
+    {
+        return nullptr;
+    }
+
+    allocation_prefix* prefix = GetAllocationPrefix(wrapped + offset);
+    prefix->size              = size;
+    prefix->scope             = GetScope(allocationScope);
+    prefix->offset            = offset;
+
+    return wrapped + offset;
+}
+
+static void FreeWrapped(const profiled_callbacks* profiled, void* memory)
+{
+    profiled->wrapped.pfnFree(profiled->wrapped.pUserData,
+                              static_cast<uint8_t*>(memory) - GetAllocationPrefix(memory)->offset);
+}
+
+static void* VKAPI_PTR ProfiledAllocation(void*                   pUserData,
+                                          size_t                  size,
+                                          size_t                  alignment,
+                                          VkSystemAllocationScope allocationScope)
+{
+    const profiled_callbacks* profiled   = static_cast<const profiled_callbacks*>(pUserData);
+    const uint64_t            start_ns   = base_layer::get_timestamp_ns();
+    void*                     memory     = AllocateWrapped(profiled, size, alignment, allocationScope);
+    const uint64_t            latency_ns = base_layer::get_timestamp_ns() - start_ns;
+
+    if (memory != nullptr)
+    {
+        const uint32_t scope = GetScope(allocationScope);
+        RecordAllocation(scope, size, latency_ns, false);
+        AddLiveBytes(scope, static_cast<int64_t>(size));
+    }
+
+    return memory;
+}
+
+static void VKAPI_PTR ProfiledFree(void* pUserData, void* pMemory)
+{
+    if (pMemory != nullptr)
+    {
+        RecordFree(*GetAllocationPrefix(pMemory));
+        FreeWrapped(static_cast<const profiled_callbacks*>(pUserData), pMemory);
+    }
+}
+
+static void* VKAPI_PTR ProfiledReallocation(void*                   pUserData,
+                                            void*                   pOriginal,
+                                            size_t                  size,
+                                            size_t                  alignment,
+                                            VkSystemAllocationScope allocationScope)
+{
+    if (pOriginal == nullptr)
+    {
+        return ProfiledAllocation(pUserData, size, alignment, allocationScope);
+    }
+    else if (size == 0)
+    {
+        ProfiledFree(pUserData, pOriginal);
+        return nullptr;
+    }
+
+    const profiled_callbacks* profiled = static_cast<const profiled_callbacks*>(pUserData);
+    const allocation_prefix   original = *GetAllocationPrefix(pOriginal);
+    const uint32_t            offset   = GetPrefixOffset(alignment);
+    const uint64_t            start_ns = base_layer::get_timestamp_ns();
+
+    void* memory = nullptr;
+    if ((offset == original.offset) && (profiled->wrapped.pfnReallocation != nullptr))
+    {
+        uint8_t* wrapped = static_cast<uint8_t*>(
+            profiled->wrapped.pfnReallocation(profiled->wrapped.pUserData,
+                                              static_cast<uint8_t*>(pOriginal) - original.offset,
+                                              size + offset,
+                                              std::max(alignment, alignof(allocation_prefix)),
+                                              allocationScope));
+        if (wrapped != nullptr)
+        {
+            allocation_prefix* prefix = GetAllocationPrefix(wrapped + offset);
+            prefix->size              = size;
+            prefix->scope             = GetScope(allocationScope);
+            memory                    = wrapped + offset;
+        }
+    }
+    else
+    {
+        // The prefix moves with the alignment, or the wrapped callbacks cannot reallocate
+        memory = AllocateWrapped(profiled, size, alignment, allocationScope);
+        if (memory != nullptr)
+        {
+            std::memcpy(memory, pOriginal, std::min(size, static_cast<size_t>(original.size)));
+            FreeWrapped(profiled, pOriginal);
+        }
+    }
+
+    const uint64_t latency_ns = base_layer::get_timestamp_ns() - start_ns;
+
+    if (memory != nullptr)
+    {
+        const uint32_t scope = GetScope(allocationScope);
+        RecordAllocation(scope, size, latency_ns, true);
+        AddLiveBytes(original.scope, -static_cast<int64_t>(original.size));
+        AddLiveBytes(scope, static_cast<int64_t>(size));
+    }
+
+    return memory;
+}
+
+static void VKAPI_PTR ProfiledInternalAllocation(void*                    pUserData,
+                                                 size_t                   size,
+                                                 VkInternalAllocationType allocationType,
+                                                 VkSystemAllocationScope  allocationScope)
+{
+    const profiled_callbacks* profiled = static_cast<const profiled_callbacks*>(pUserData);
+    profiled->wrapped.pfnInternalAllocation(profiled->wrapped.pUserData, size, allocationType, allocationScope);
+}
+
+static void VKAPI_PTR ProfiledInternalFree(void*                    pUserData,
+                                           size_t                   size,
+                                           VkInternalAllocationType allocationType,
+                                           VkSystemAllocationScope  allocationScope)
+{
+    const profiled_callbacks* profiled = static_cast<const profiled_callbacks*>(pUserData);
+    profiled->wrapped.pfnInternalFree(profiled->wrapped.pUserData, size, allocationType, allocationScope);
+}
+
+static void* VKAPI_PTR SystemAllocation(void*                   pUserData,
+                                        size_t                  size,
+                                        size_t                  alignment,
+                                        VkSystemAllocationScope allocationScope)
+{
+    (void)pUserData;
+    (void)allocationScope;
+
+    return AllocateSystemMemory(size, alignment);
+}
+
+static void VKAPI_PTR SystemFree(void* pUserData, void* pMemory)
+{
+    (void)pUserData;
+
+    FreeSystemMemory(pMemory);
+}
+
+// Used under the profiling callbacks when neither the application nor the layer's allocator provide callbacks. There
+// is no reallocation function, as the size of the original allocation is only known to the profiling callbacks.
+static const VkAllocationCallbacks kSystemAllocationCallbacks = {
+    nullptr, SystemAllocation, nullptr, SystemFree, nullptr, nullptr
+};
+
+static void InitializeProfiledCallbacks(const VkAllocationCallbacks& wrapped, profiled_callbacks* profiled)
+{
+    profiled->wrapped                   = wrapped;
+    profiled->callbacks.pUserData       = profiled;
+    profiled->callbacks.pfnAllocation   = ProfiledAllocation;
+    profiled->callbacks.pfnReallocation = ProfiledReallocation;
+    profiled->callbacks.pfnFree         = ProfiledFree;
+    if ((wrapped.pfnInternalAllocation != nullptr) && (wrapped.pfnInternalFree != nullptr))
+    {
+        profiled->callbacks.pfnInternalAllocation = ProfiledInternalAllocation;
+        profiled->callbacks.pfnInternalFree       = ProfiledInternalFree;
+    }
+}
+
+static bool IsSameCallbacks(const VkAllocationCallbacks& lhs, const VkAllocationCallbacks& rhs)
+{
+    return (lhs.pUserData == rhs.pUserData) && (lhs.pfnAllocation == rhs.pfnAllocation) &&
+           (lhs.pfnReallocation == rhs.pfnReallocation) && (lhs.pfnFree == rhs.pfnFree) &&
+           (lhs.pfnInternalAllocation == rhs.pfnInternalAllocation) && (lhs.pfnInternalFree == rhs.pfnInternalFree);
+}
+
+// Returns the profiling callbacks wrapping the given callbacks. Objects must be destroyed with callbacks compatible
+// with the ones they were created with, so the same application callbacks are always given the same profiling
+// callbacks. They are kept until the layer is unloaded.
+static const VkAllocationCallbacks* GetProfiledCallbacks(const VkAllocationCallbacks* pAllocator)
+{
+    if (pAllocator == nullptr)
+    {
+        static profiled_callbacks* default_callbacks = []() {
+            const VkAllocationCallbacks& wrapped =
+                IsHostAllocatorEnabled() ? kHostAllocationCallbacks : kSystemAllocationCallbacks;
+            profiled_callbacks* profiled = new profiled_callbacks();
+            InitializeProfiledCallbacks(wrapped, profiled);
+            return profiled;
+        }();
+
+        return &default_callbacks->callbacks;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(profiled_callbacks_lock);
+        for (const std::unique_ptr<profiled_callbacks>& profiled : application_profiled_callbacks)
+        {
+            if (IsSameCallbacks(profiled->wrapped, *pAllocator))
+            {
+                return &profiled->callbacks;
+            }
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(profiled_callbacks_lock);
+    for (const std::unique_ptr<profiled_callbacks>& profiled : application_profiled_callbacks)
+    {
+        if (IsSameCallbacks(profiled->wrapped, *pAllocator))
+        {
+            return &profiled->callbacks;
+        }
+    }
+
+    application_profiled_callbacks.push_back(std::make_unique<profiled_callbacks>());
+    InitializeProfiledCallbacks(*pAllocator, application_profiled_callbacks.back().get());
+
+    return &application_profiled_callbacks.back()->callbacks;
+}
+
+static void GetProfileTotals(profile_totals* totals)
+{
+    const thread_profile* profile = thread_profiles.load(std::memory_order_acquire);
+    for (; profile != nullptr; profile = profile->next)
+    {
+        for (uint32_t scope = 0; scope < kScopeCount; ++scope)
+        {
+            const profile_counters& counters = profile->scopes[scope];
+            totals[scope].allocations += counters.allocations.load(std::memory_order_relaxed);
+            totals[scope].reallocations += counters.reallocations.load(std::memory_order_relaxed);
+            totals[scope].frees += counters.frees.load(std::memory_order_relaxed);
+            totals[scope].latency_ns += counters.latency_ns.load(std::memory_order_relaxed);
+            totals[scope].max_latency_ns =
+                std::max(totals[scope].max_latency_ns, counters.max_latency_ns.load(std::memory_order_relaxed));
+        }
+    }
+}
+
+// Emits the live bytes of each scope, and the allocations and the time spent allocating since the last call.
+static void EmitProfileCounters()
+{
+    profile_totals totals[kScopeCount];
+    GetProfileTotals(totals);
+
+    uint64_t operations = 0;
+    uint64_t latency_ns = 0;
+    for (uint32_t scope = 0; scope < kScopeCount; ++scope)
+    {
+        operations += totals[scope].allocations + totals[scope].reallocations;
+        latency_ns += totals[scope].latency_ns;
+
+        TRACE_COUNTER("GFXR",
+                      perfetto::CounterTrack(kLiveBytesCounterNames[scope]),
+                      profiled_memory[scope].live_bytes.load(std::memory_order_relaxed));
+    }
+
+    std::lock_guard<std::mutex> lock(frame_counters_lock);
+    TRACE_COUNTER("GFXR", "Host allocations in frame", operations - last_frame_operations);
+    TRACE_COUNTER("GFXR",
+                  "Host allocation time in frame (ms)",
+                  static_cast<double>(latency_ns - last_frame_latency_ns) / 1000000.0);
+
+    last_frame_operations = operations;
+    last_frame_latency_ns = latency_ns;
+}
+
+// Writes the totals of each scope as JSON to the file named by GFXR_HOST_ALLOCATOR_PROFILE_FILE, or to the log.
+static void WriteProfileSummary()
+{
+    profile_totals totals[kScopeCount];
+    GetProfileTotals(totals);
+
+    std::stringstream summary;
+    summary << "{\n  \"scopes\": {";
+    for (uint32_t scope = 0; scope < kScopeCount; ++scope)
+    {
+        const uint64_t operations = totals[scope].allocations + totals[scope].reallocations;
+        summary << ((scope == 0) ? "\n" : ",\n") << "    \"" << kScopeNames[scope] << "\": {"
+                << "\"allocations\": " << totals[scope].allocations
+                << ", \"reallocations\": " << totals[scope].reallocations << ", \"frees\": " << totals[scope].frees
+                << ", \"live_bytes\": " << profiled_memory[scope].live_bytes.load()
+                << ", \"peak_bytes\": " << profiled_memory[scope].peak_bytes.load()
+                << ", \"total_latency_us\": " << (totals[scope].latency_ns / 1000)
+                << ", \"average_latency_ns\": " << ((operations != 0) ? (totals[scope].latency_ns / operations) : 0)
+                << ", \"max_latency_us\": " << (totals[scope].max_latency_ns / 1000) << "}";
+    }
+    summary << "\n  }\n}\n";
+
+    const std::string path =
+        base_layer::get_layer_setting("GFXR_HOST_ALLOCATOR_PROFILE_FILE", "debug.gfxr.host_allocator.profile_file");
+    if (!path.empty())
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << summary.str();
+        if (file.good())
+        {
+            return;
+        }
+
+        base_layer::base_layer_print_error("Host allocator: failed to write %s\n", path.c_str());
+    }
+
+    base_layer::base_layer_print_info("Host allocator profile:\n%s", summary.str().c_str());
+}
+
+template <typename T>
+static T InjectAllocator(T value)
+{
+    return value;
+}
+
+static const VkAllocationCallbacks* InjectAllocator(const VkAllocationCallbacks* pAllocator)
+{
+    if (IsProfilingEnabled())
+    {
+        return GetProfiledCallbacks(pAllocator);
+    }
+
+    return (pAllocator != nullptr) ? pAllocator : &kHostAllocationCallbacks;
+}
+
+static const InstanceTable& GetInstanceTable(VkInstance instance)
+{
+    return base_layer::get_instance_handle(instance)->dispatch_table;
+}
+
+static const InstanceTable& GetInstanceTable(VkPhysicalDevice physicalDevice)
+{
+    return base_layer::get_physical_device_instance(physicalDevice)->dispatch_table;
+}
+
+// Wraps a command that is not intercepted otherwise, passing the layer's callbacks when the application passes none.
+template <typename Function, Function InstanceTable::*Member>
+struct instance_allocation_command;
+
+template <typename Result,
+          typename Handle,
+          typename... Args,
+          Result(VKAPI_PTR* InstanceTable::*Member)(Handle, Args...)>
+struct instance_allocation_command<Result(VKAPI_PTR*)(Handle, Args...), Member>
+{
+    static_assert((std::is_same<Args, const VkAllocationCallbacks*>::value || ...),
+                  "The command must have a VkAllocationCallbacks parameter");
+
+    static VKAPI_ATTR Result VKAPI_CALL Call(Handle handle, Args... args)
+    {
+        // Forward function to next layer / driver
+        return (GetInstanceTable(handle).*Member)(handle, InjectAllocator(args)...);
+    }
+};
+
+template <typename Function, Function DeviceTable::*Member>
+struct device_allocation_command;
+
+template <typename Result, typename... Args, Result(VKAPI_PTR* DeviceTable::*Member)(VkDevice, Args...)>
+struct device_allocation_command<Result(VKAPI_PTR*)(VkDevice, Args...), Member>
+{
+    static_assert((std::is_same<Args, const VkAllocationCallbacks*>::value || ...),
+                  "The command must have a VkAllocationCallbacks parameter");
+
+    static VKAPI_ATTR Result VKAPI_CALL Call(VkDevice device, Args... args)
+    {
+        // Forward function to next layer / driver
+        return (base_layer::get_device_handle(device)->dispatch_table.*Member)(device, InjectAllocator(args)...);
+    }
+};
+
+struct allocation_command_entry
+{
+    const char*        name;
+    size_t             offset; // Offset of the command in InstanceTable or DeviceTable
+    PFN_vkVoidFunction function;
+};
+
+// vkDestroyInstance, vkDestroyDevice and vkDestroyCommandPool are returned by layer_GetProcAddr, which forwards them
+// through the base layer, before these lists are searched.
+static const allocation_command_entry kInstanceAllocationCommands[] = {
+#define INSTANCE_ALLOCATION_COMMAND(Name)      \
+    { "vk" #Name,                              \
+      offsetof(InstanceTable, Name),           \
+      reinterpret_cast<PFN_vkVoidFunction>(    \
+          instance_allocation_command<PFN_vk##Name, &InstanceTable::Name>::Call) },
+    FOR_EACH_INSTANCE_ALLOCATION_CALLBACKS_COMMAND(INSTANCE_ALLOCATION_COMMAND)
+#undef INSTANCE_ALLOCATION_COMMAND
+};
+
+static const allocation_command_entry kDeviceAllocationCommands[] = {
+#define DEVICE_ALLOCATION_COMMAND(Name)        \
+    { "vk" #Name,                              \
+      offsetof(DeviceTable, Name),             \
+      reinterpret_cast<PFN_vkVoidFunction>(device_allocation_command<PFN_vk##Name, &DeviceTable::Name>::Call) },
+    FOR_EACH_DEVICE_ALLOCATION_CALLBACKS_COMMAND(DEVICE_ALLOCATION_COMMAND)
+#undef DEVICE_ALLOCATION_COMMAND
+};
+
+// Returns the wrapper of a command that is not intercepted otherwise, or nullptr if the command has no
+// VkAllocationCallbacks parameter or is not available from the next layer or driver.
+template <size_t Count>
+static PFN_vkVoidFunction GetAllocationCommand(const allocation_command_entry (&entries)[Count],
+                                               const void*     table,
+                                               const char*     pName)
+{
+    for (const allocation_command_entry& entry : entries)
+    {
+        if (!strcmp(pName, entry.name))
+        {
+            const uint8_t* entries_start = static_cast<const uint8_t*>(table);
+            return (*reinterpret_cast<const PFN_vkVoidFunction*>(entries_start + entry.offset) != nullptr)
+                       ? entry.function
+                       : nullptr;
+        }
+    }
+
+    return nullptr;
+}
+
+static void PrintStats()
+{
+    AddThreadStats(current_cache.stats);
+
+    for (uint32_t scope = 0; scope < kScopeCount; ++scope)
+    {
+        const scope_stats& stats = global_stats[scope];
+        if (stats.allocations.load() != 0)
+        {
+            base_layer::base_layer_print_info("Host allocator: %s scope: %llu allocations, %llu reallocations, %llu "
+                                              "frees, %llu bytes requested, %lld bytes in use\n",
+                                              kScopeNames[scope],
+                                              static_cast<unsigned long long>(stats.allocations.load()),
+                                              static_cast<unsigned long long>(stats.reallocations.load()),
+                                              static_cast<unsigned long long>(stats.frees.load()),
+                                              static_cast<unsigned long long>(stats.allocated_bytes.load()),
+                                              static_cast<long long>(stats.live_bytes.load()));
+        }
+    }
+
+    base_layer::base_layer_print_info("Host allocator: %llu spans of %zu KiB reserved, %llu large allocations in use\n",
+                                      static_cast<unsigned long long>(span_count.load()),
+                                      kSpanSize / 1024,
+                                      static_cast<unsigned long long>(large_allocation_count.load()));
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pDevice;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_InjectingCreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                             const VkAllocationCallbacks* pAllocator,
+                                                             VkInstance*                  pInstance)
+{
+    if (IsProfilingEnabled())
+    {
+        InitializePerfetto();
+    }
+
+    // Forward function to next layer / driver through the base layer, which creates the instance's dispatch table
+    return base_layer::base_layer_CreateInstance(pCreateInfo, InjectAllocator(pAllocator), pInstance);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_InjectingCreateDevice(VkPhysicalDevice             physicalDevice,
+                                                           const VkDeviceCreateInfo*    pCreateInfo,
+                                                           const VkAllocationCallbacks* pAllocator,
+                                                           VkDevice*                    pDevice)
+{
+    // Forward function to next layer / driver through the base layer, which creates the device's dispatch table
+    return base_layer::base_layer_CreateDevice(physicalDevice, pCreateInfo, InjectAllocator(pAllocator), pDevice);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+    // Forward function to next layer / driver through the base layer, which releases the instance's dispatch table
+    base_layer::base_layer_DestroyInstance(instance, InjectAllocator(pAllocator));
+
+    if (IsHostAllocatorEnabled())
+    {
+        PrintStats();
+    }
+
+    if (IsProfilingEnabled())
+    {
+        EmitProfileCounters();
+        WriteProfileSummary();
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, InjectAllocator(pAllocator));
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyCommandPool(VkDevice                     device,
+                                                    VkCommandPool                commandPool,
+                                                    const VkAllocationCallbacks* pAllocator)
+{
+    // Forward function to next layer / driver through the base layer, which releases the pool's command buffers
+    base_layer::base_layer_DestroyCommandPool(device, commandPool, InjectAllocator(pAllocator));
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+    // Forward function to next layer / driver
+    VkResult result = base_layer::get_device_handle(queue)->dispatch_table.QueuePresentKHR(queue, pPresentInfo);
+
+    EmitProfileCounters();
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName && IsInterceptionEnabled())
+    {
+        if (!strcmp(pName, "vkCreateInstance"))
+        {
+            result = (PFN_vkVoidFunction)layer_InjectingCreateInstance;
+        }
+        else if (!strcmp(pName, "vkCreateDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_InjectingCreateDevice;
+        }
+        else if (!strcmp(pName, "vkDestroyInstance"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyInstance;
+        }
+        else if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkDestroyCommandPool"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyCommandPool;
+        }
+        else if (!strcmp(pName, "vkQueuePresentKHR") && IsProfilingEnabled())
+        {
+            result = (PFN_vkVoidFunction)layer_QueuePresentKHR;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result && pName && (instance != VK_NULL_HANDLE) && IsInterceptionEnabled())
+    {
+        const base_layer::instance_dispatch_table* instance_table = base_layer::get_instance_handle(instance);
+        if (instance_table != nullptr)
+        {
+            result = GetAllocationCommand(kInstanceAllocationCommands, &instance_table->dispatch_table, pName);
+        }
+    }
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result && pName && (device != VK_NULL_HANDLE) && IsInterceptionEnabled())
+    {
+        const base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+        if (device_table != nullptr)
+        {
+            result = GetAllocationCommand(kDeviceAllocationCommands, &device_table->dispatch_table, pName);
+        }
+    }
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
@@ -0,0 +1,284 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the size classes, spans and large allocations of the host allocator layer's thread caching allocator.
+
+#include "../thread_caching_allocator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (false)
+
+static bool IsAligned(const void* memory, size_t alignment)
+{
+    return (reinterpret_cast<uintptr_t>(memory) % alignment) == 0;
+}
+
+static bool HasPattern(const void* memory, size_t size, uint8_t pattern)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(memory);
+    return std::all_of(bytes, bytes + size, [pattern](uint8_t byte) { return byte == pattern; });
+}
+
+static void TestGetSizeClass()
+{
+    CHECK(GetSizeClass(1) == 0);
+    CHECK(GetSizeClass(kMinBlockSize) == 0);
+    CHECK(GetSizeClass(kMinBlockSize + 1) == 1);
+    CHECK(GetSizeClass(2 * kMinBlockSize) == 1);
+    CHECK(GetSizeClass(1000) == 6);
+    CHECK(GetSizeClass(kMaxBlockSize) == (kSizeClassCount - 1));
+
+    CHECK(GetScope(VK_SYSTEM_ALLOCATION_SCOPE_COMMAND) == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+    CHECK(GetScope(VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE) == VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE);
+    CHECK(GetScope(static_cast<VkSystemAllocationScope>(100)) == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+}
+
+// Blocks are rounded up to a power of two of at least their alignment, and aligned to that size.
+static void TestBlocksAreAlignedToTheirSize()
+{
+    const size_t sizes[]      = { 0, 1, 15, 16, 17, 100, 1000, 4096, kMaxBlockSize };
+    const size_t alignments[] = { 0, 1, 8, 16, 64, 256, 4096, kMaxBlockSize };
+
+    for (size_t size : sizes)
+    {
+        for (size_t alignment : alignments)
+        {
+            const size_t   block_size = std::max(std::max(size, alignment), size_t(1));
+            const uint32_t size_class = GetSizeClass(block_size);
+
+            void* memory = Allocate(size, alignment, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+            CHECK(memory != nullptr);
+            CHECK(IsAligned(memory, kMinBlockSize << size_class));
+            CHECK(GetUsableSize(memory) == (kMinBlockSize << size_class));
+
+            const span_header* header = GetSpanHeader(memory);
+            CHECK(IsAligned(header, kSpanSize));
+            CHECK(header->size_class == size_class);
+            CHECK(header->scope == VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+            const uint8_t* span = reinterpret_cast<const uint8_t*>(header);
+            CHECK(static_cast<uint8_t*>(memory) >= (span + kSpanHeaderSize));
+            CHECK((static_cast<uint8_t*>(memory) + block_size) <= (span + kSpanSize));
+
+            std::memset(memory, 0xab, GetUsableSize(memory));
+            Free(memory);
+        }
+    }
+}
+
+// Every block of a span has the size class and scope of its header, and no two live blocks overlap.
+static void TestSpansHoldOneSizeClassAndScope()
+{
+    const uint32_t kBlocksPerScope = 3000;
+
+    std::vector<std::pair<uint8_t*, size_t>> blocks;
+    for (uint32_t scope = 0; scope < kScopeCount; ++scope)
+    {
+        for (uint32_t i = 0; i < kBlocksPerScope; ++i)
+        {
+            const size_t size   = kMinBlockSize << (i % 4);
+            uint8_t*     memory = static_cast<uint8_t*>(Allocate(size, 1, static_cast<VkSystemAllocationScope>(scope)));
+            CHECK(memory != nullptr);
+            CHECK(GetSpanHeader(memory)->scope == scope);
+            CHECK(GetSpanHeader(memory)->size_class == GetSizeClass(size));
+            blocks.emplace_back(memory, size);
+        }
+    }
+
+    std::sort(blocks.begin(), blocks.end());
+    for (size_t i = 1; i < blocks.size(); ++i)
+    {
+        CHECK((blocks[i - 1].first + blocks[i - 1].second) <= blocks[i].first);
+    }
+
+    for (const std::pair<uint8_t*, size_t>& block : blocks)
+    {
+        Free(block.first);
+    }
+}
+
+// Allocations larger than kMaxBlockSize, or more strictly aligned, are made from the system with a header at the start
+// of their kSpanSize aligned window.
+static void TestLargeAllocations()
+{
+    const size_t sizes[]      = { 1, kMaxBlockSize, kMaxBlockSize + 1, kSpanSize, 3 * kSpanSize + 7 };
+    const size_t alignments[] = { 0, 16, 4096, 2 * kMaxBlockSize, kSpanSize, 4 * kSpanSize };
+
+    for (size_t size : sizes)
+    {
+        for (size_t alignment : alignments)
+        {
+            if ((size <= kMaxBlockSize) && (alignment <= kMaxBlockSize))
+            {
+                continue;
+            }
+
+            const uint64_t live_count = large_allocation_count.load();
+
+            uint8_t* memory = static_cast<uint8_t*>(Allocate(size, alignment, VK_SYSTEM_ALLOCATION_SCOPE_CACHE));
+            CHECK(memory != nullptr);
+            CHECK(IsAligned(memory, std::max(alignment, kMinBlockSize)));
+            CHECK(GetUsableSize(memory) == size);
+            CHECK(large_allocation_count.load() == (live_count + 1));
+
+            const span_header* header        = GetSpanHeader(memory);
+            const uint8_t*     system_memory = static_cast<const uint8_t*>(header->system_memory);
+            CHECK(header->size_class == kLargeSizeClass);
+            CHECK(header->scope == VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
+            CHECK(header->size == size);
+            CHECK(reinterpret_cast<const uint8_t*>(header) >= system_memory);
+            CHECK(memory >= (reinterpret_cast<const uint8_t*>(header) + kSpanHeaderSize));
+
+            std::memset(memory, 0xcd, size);
+            Free(memory);
+            CHECK(large_allocation_count.load() == live_count);
+        }
+    }
+}
+
+// Reallocations within the usable size of a suitably aligned block keep it, others move the contents to a new one.
+static void TestReallocation()
+{
+    const VkSystemAllocationScope scope = VK_SYSTEM_ALLOCATION_SCOPE_OBJECT;
+
+    void* memory = HostReallocation(nullptr, nullptr, 20, 16, scope);
+    CHECK(memory != nullptr);
+    CHECK(GetUsableSize(memory) == 32);
+    std::memset(memory, 0x11, 20);
+
+    CHECK(HostReallocation(nullptr, memory, 32, 16, scope) == memory);
+    CHECK(HostReallocation(nullptr, memory, 8, 8, scope) == memory);
+    CHECK(HostReallocation(nullptr, memory, 20, 32, scope) == memory);
+
+    void* moved = HostReallocation(nullptr, memory, 33, 16, scope);
+    CHECK((moved != nullptr) && (moved != memory));
+    CHECK(GetUsableSize(moved) == 64);
+    CHECK(HasPattern(moved, 20, 0x11));
+
+    // A block that is large enough but not aligned to the new alignment moves
+    std::vector<void*> aligned;
+    void*              misaligned = Allocate(64, 16, scope);
+    while (IsAligned(misaligned, 128) && (aligned.size() < 8))
+    {
+        aligned.push_back(misaligned);
+        misaligned = Allocate(64, 16, scope);
+    }
+
+    for (void* block : aligned)
+    {
+        Free(block);
+    }
+
+    CHECK(misaligned != nullptr);
+    std::memset(misaligned, 0x22, 64);
+    void* realigned = HostReallocation(nullptr, misaligned, 64, 128, scope);
+    CHECK((realigned != nullptr) && (realigned != misaligned) && IsAligned(realigned, 128));
+    CHECK(HasPattern(realigned, 64, 0x22));
+    Free(realigned);
+
+    // Large allocations shrink in place and move when they grow
+    void* large = HostReallocation(nullptr, moved, 20000, 16, scope);
+    CHECK((large != nullptr) && (GetSpanHeader(large)->size_class == kLargeSizeClass));
+    CHECK(HasPattern(large, 20, 0x11));
+    std::memset(large, 0x33, 20000);
+
+    CHECK(HostReallocation(nullptr, large, 10000, 16, scope) == large);
+    CHECK(GetUsableSize(large) == 20000);
+
+    void* larger = HostReallocation(nullptr, large, 30000, 16, scope);
+    CHECK((larger != nullptr) && (larger != large));
+    CHECK(HasPattern(larger, 20000, 0x33));
+
+    // Allocations aligned more strictly than kMaxBlockSize are large whatever their size
+    void* small = HostReallocation(nullptr, larger, 100, 4 * kSpanSize, scope);
+    CHECK((small != nullptr) && IsAligned(small, 4 * kSpanSize));
+    CHECK(GetSpanHeader(small)->size_class == kLargeSizeClass);
+    CHECK(HostReallocation(nullptr, small, 100, 16, scope) == small);
+
+    CHECK(HostReallocation(nullptr, small, 0, 16, scope) == nullptr);
+}
+
+// Blocks freed by another thread are cached by that thread, and returned to the depot when it exits.
+static void TestBlocksFreedOnAnotherThread()
+{
+    const uint32_t kBlockCount = 1000;
+    const uint32_t size_class  = GetSizeClass(256);
+
+    std::vector<void*> blocks;
+    for (uint32_t i = 0; i < kBlockCount; ++i)
+    {
+        blocks.push_back(HostAllocation(nullptr, 256, 16, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND));
+        CHECK(blocks.back() != nullptr);
+    }
+
+    const uint32_t depot_count = depot[VK_SYSTEM_ALLOCATION_SCOPE_COMMAND][size_class].blocks.count;
+
+    std::thread thread([&blocks]() {
+        for (void* block : blocks)
+        {
+            HostFree(nullptr, block);
+        }
+    });
+    thread.join();
+
+    CHECK(depot[VK_SYSTEM_ALLOCATION_SCOPE_COMMAND][size_class].blocks.count == (depot_count + kBlockCount));
+
+    // The bytes the exited thread freed cancel out those allocated by this one, added or still in its cache
+    const int64_t live_bytes = global_stats[VK_SYSTEM_ALLOCATION_SCOPE_COMMAND].live_bytes.load() +
+                               current_cache.stats[VK_SYSTEM_ALLOCATION_SCOPE_COMMAND].live_bytes;
+    CHECK(live_bytes == 0);
+}
+
+int main()
+{
+    TestGetSizeClass();
+    TestBlocksAreAlignedToTheirSize();
+    TestSpansHoldOneSizeClassAndScope();
+    TestLargeAllocations();
+    TestReallocation();
+    TestBlocksFreedOnAnotherThread();
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
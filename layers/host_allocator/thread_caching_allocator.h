@@ -0,0 +1,457 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef HOST_ALLOCATOR_THREAD_CACHING_ALLOCATOR_H
+#define HOST_ALLOCATOR_THREAD_CACHING_ALLOCATOR_H
+
+#include "vulkan/vulkan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+// Allocations of up to kMaxBlockSize bytes, after rounding up to their alignment, are served from power of two size
+// classes. Blocks are carved from spans aligned to kSpanSize, so every block is aligned to its size, and a span holds
+// blocks of a single size class and VkSystemAllocationScope, recorded in its header. Freed blocks go to a free list of
+// the calling thread and move to and from a shared depot kBatchSize blocks at a time. Spans are never returned to the
+// system. Larger allocations are made from the system, with a header at the start of the kSpanSize aligned window
+// holding them, so that the owner of any pointer is found by rounding it down.
+static constexpr size_t   kSpanSize        = 64 * 1024;
+static constexpr size_t   kSpansPerChunk   = 16;
+static constexpr size_t   kSpanHeaderSize  = 64;
+static constexpr size_t   kMinBlockSize    = 16;
+static constexpr uint32_t kSizeClassCount  = 10;
+static constexpr size_t   kMaxBlockSize    = kMinBlockSize << (kSizeClassCount - 1);
+static constexpr uint32_t kLargeSizeClass  = kSizeClassCount;
+static constexpr uint32_t kScopeCount      = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1;
+static constexpr uint32_t kBatchSize       = 32;
+static constexpr uint32_t kMaxCachedBlocks = 2 * kBatchSize;
+
+static_assert(kMaxBlockSize <= (kSpanSize / 8), "A span must hold several blocks of the largest size class");
+
+struct span_header
+{
+    uint32_t size_class{ 0 };          // kLargeSizeClass for an allocation made from the system
+    uint32_t scope{ 0 };
+    size_t   size{ 0 };                // Requested size of a large allocation
+    void*    system_memory{ nullptr }; // System allocation holding a large allocation
+};
+
+static_assert(sizeof(span_header) <= kSpanHeaderSize, "The span header must fit in front of the first block");
+
+struct free_block
+{
+    free_block* next;
+};
+
+struct free_list
+{
+    free_block* head{ nullptr };
+    uint32_t    count{ 0 };
+};
+
+struct depot_list
+{
+    std::mutex lock;
+    free_list  blocks;
+};
+
+// Counters of a thread, added to the shared counters when blocks move to or from the depot
+struct thread_scope_stats
+{
+    uint64_t allocations{ 0 };
+    uint64_t reallocations{ 0 };
+    uint64_t frees{ 0 };
+    uint64_t allocated_bytes{ 0 };
+    int64_t  live_bytes{ 0 };
+};
+
+struct scope_stats
+{
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> reallocations{ 0 };
+    std::atomic<uint64_t> frees{ 0 };
+    std::atomic<uint64_t> allocated_bytes{ 0 };
+    std::atomic<int64_t>  live_bytes{ 0 };
+};
+
+static void ReturnBlocks(uint32_t scope, uint32_t size_class, free_list* list, uint32_t count);
+static void AddThreadStats(thread_scope_stats* stats);
+
+// Blocks cached by a thread are returned to the depot when the thread exits.
+struct thread_cache
+{
+    free_list          lists[kScopeCount][kSizeClassCount];
+    thread_scope_stats stats[kScopeCount];
+
+    ~thread_cache()
+    {
+        for (uint32_t scope = 0; scope < kScopeCount; ++scope)
+        {
+            for (uint32_t size_class = 0; size_class < kSizeClassCount; ++size_class)
+            {
+                free_list& list = lists[scope][size_class];
+                ReturnBlocks(scope, size_class, &list, list.count);
+            }
+        }
+
+        AddThreadStats(stats);
+    }
+};
+
+static depot_list                depot[kScopeCount][kSizeClassCount];
+static std::mutex                span_lock;
+static uint8_t*                  chunk_spans{ nullptr };
+static size_t                    chunk_span_count{ 0 };
+static std::atomic<uint64_t>     span_count{ 0 };
+static std::atomic<uint64_t>     large_allocation_count{ 0 };
+static scope_stats               global_stats[kScopeCount];
+static thread_local thread_cache current_cache;
+
+// alignment must be a power of two
+static void* AllocateSystemMemory(size_t size, size_t alignment)
+{
+#if defined(_WIN32)
+    return _aligned_malloc(size, alignment);
+#else
+    void* memory = nullptr;
+    return (posix_memalign(&memory, std::max(alignment, sizeof(void*)), size) == 0) ? memory : nullptr;
+#endif
+}
+
+static void FreeSystemMemory(void* memory)
+{
+#if defined(_WIN32)
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+static span_header* GetSpanHeader(const void* memory)
+{
+    // Blocks never start at the beginning of their window, which holds the header
+    return reinterpret_cast<span_header*>((reinterpret_cast<uintptr_t>(memory) - 1) & ~(kSpanSize - 1));
+}
+
+static uint32_t GetSizeClass(size_t size)
+{
+    uint32_t size_class = 0;
+    while ((kMinBlockSize << size_class) < size)
+    {
+        ++size_class;
+    }
+
+    return size_class;
+}
+
+static uint32_t GetScope(VkSystemAllocationScope allocationScope)
+{
+    const uint32_t scope = static_cast<uint32_t>(allocationScope);
+    return (scope < kScopeCount) ? scope : static_cast<uint32_t>(VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+}
+
+static void AddThreadStats(thread_scope_stats* stats)
+{
+    for (uint32_t scope = 0; scope < kScopeCount; ++scope)
+    {
+        thread_scope_stats& thread_stats = stats[scope];
+        if ((thread_stats.allocations != 0) || (thread_stats.reallocations != 0) || (thread_stats.frees != 0))
+        {
+            global_stats[scope].allocations.fetch_add(thread_stats.allocations, std::memory_order_relaxed);
+            global_stats[scope].reallocations.fetch_add(thread_stats.reallocations, std::memory_order_relaxed);
+            global_stats[scope].frees.fetch_add(thread_stats.frees, std::memory_order_relaxed);
+            global_stats[scope].allocated_bytes.fetch_add(thread_stats.allocated_bytes, std::memory_order_relaxed);
+            global_stats[scope].live_bytes.fetch_add(thread_stats.live_bytes, std::memory_order_relaxed);
+            thread_stats = thread_scope_stats();
+        }
+    }
+}
+
+static uint8_t* AllocateSpan()
+{
+    std::lock_guard<std::mutex> lock(span_lock);
+    if (chunk_span_count == 0)
+    {
+        chunk_spans = static_cast<uint8_t*>(AllocateSystemMemory(kSpanSize * kSpansPerChunk, kSpanSize));
+        if (chunk_spans == nullptr)
+        {
+            return nullptr;
+        }
+
+        chunk_span_count = kSpansPerChunk;
+    }
+
+    uint8_t* span = chunk_spans;
+    chunk_spans += kSpanSize;
+    --chunk_span_count;
+    span_count.fetch_add(1, std::memory_order_relaxed);
+
+    return span;
+}
+
+// Moves the first count blocks of a thread's list to the depot.
+static void ReturnBlocks(uint32_t scope, uint32_t size_class, free_list* list, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    free_block* first = list->head;
+    free_block* last  = first;
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        last = last->next;
+    }
+
+    list->head  = last->next;
+    list->count -= count;
+
+    depot_list&                 depot_blocks = depot[scope][size_class];
+    std::lock_guard<std::mutex> lock(depot_blocks.lock);
+    last->next                = depot_blocks.blocks.head;
+    depot_blocks.blocks.head  = first;
+    depot_blocks.blocks.count += count;
+}
+
+// Moves up to kBatchSize blocks from the depot to an empty thread list, carving a new span if the depot is empty.
+static bool FetchBlocks(uint32_t scope, uint32_t size_class, free_list* list)
+{
+    depot_list&                 depot_blocks = depot[scope][size_class];
+    std::lock_guard<std::mutex> lock(depot_blocks.lock);
+
+    if (depot_blocks.blocks.head == nullptr)
+    {
+        uint8_t* span = AllocateSpan();
+        if (span == nullptr)
+        {
+            return false;
+        }
+
+        span_header* header = new (span) span_header();
+        header->size_class  = size_class;
+        header->scope       = scope;
+
+        const size_t block_size = kMinBlockSize << size_class;
+        for (size_t offset = kSpanSize - block_size; offset >= std::max(block_size, kSpanHeaderSize);
+             offset -= block_size)
+        {
+            free_block* block        = reinterpret_cast<free_block*>(span + offset);
+            block->next              = depot_blocks.blocks.head;
+            depot_blocks.blocks.head = block;
+            ++depot_blocks.blocks.count;
+        }
+    }
+
+    const uint32_t count = std::min(kBatchSize, depot_blocks.blocks.count);
+    free_block*    last  = depot_blocks.blocks.head;
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        last = last->next;
+    }
+
+    list->head                = depot_blocks.blocks.head;
+    list->count               = count;
+    depot_blocks.blocks.head  = last->next;
+    depot_blocks.blocks.count -= count;
+    last->next                = nullptr;
+
+    return true;
+}
+
+static void* AllocateLarge(size_t size, size_t alignment, uint32_t scope)
+{
+    // The block starts at least kSpanHeaderSize bytes into the system allocation, so its header is found by rounding
+    // the block's address down to kSpanSize
+    uint8_t* system_memory = static_cast<uint8_t*>(AllocateSystemMemory(size + alignment + kSpanHeaderSize, kSpanSize));
+    if (system_memory == nullptr)
+    {
+        return nullptr;
+    }
+
+    const uintptr_t address =
+        (reinterpret_cast<uintptr_t>(system_memory) + kSpanHeaderSize + alignment - 1) & ~(uintptr_t(alignment) - 1);
+    void* memory = reinterpret_cast<void*>(address);
+
+    span_header* header   = new (GetSpanHeader(memory)) span_header();
+    header->size_class    = kLargeSizeClass;
+    header->scope         = scope;
+    header->size          = size;
+    header->system_memory = system_memory;
+
+    large_allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+    thread_scope_stats& stats = current_cache.stats[scope];
+    ++stats.allocations;
+    stats.allocated_bytes += size;
+    stats.live_bytes      += static_cast<int64_t>(size);
+
+    return memory;
+}
+
+static void* Allocate(size_t size, size_t alignment, VkSystemAllocationScope allocationScope)
+{
+    const uint32_t scope      = GetScope(allocationScope);
+    const size_t   block_size = std::max(std::max(size, alignment), size_t(1));
+    if (block_size > kMaxBlockSize)
+    {
+        return AllocateLarge(size, std::max(alignment, kMinBlockSize), scope);
+    }
+
+    const uint32_t size_class = GetSizeClass(block_size);
+    thread_cache&  cache      = current_cache;
+    free_list&     list       = cache.lists[scope][size_class];
+    if (list.head == nullptr)
+    {
+        AddThreadStats(cache.stats);
+        if (!FetchBlocks(scope, size_class, &list))
+        {
+            return nullptr;
+        }
+    }
+
+    free_block* block = list.head;
+    list.head         = block->next;
+    --list.count;
+
+    thread_scope_stats& stats = cache.stats[scope];
+    ++stats.allocations;
+    stats.allocated_bytes += size;
+    stats.live_bytes      += static_cast<int64_t>(kMinBlockSize << size_class);
+
+    return block;
+}
+
+static size_t GetUsableSize(const void* memory)
+{
+    const span_header* header = GetSpanHeader(memory);
+    return (header->size_class == kLargeSizeClass) ? header->size : (kMinBlockSize << header->size_class);
+}
+
+static void Free(void* memory)
+{
+    if (memory == nullptr)
+    {
+        return;
+    }
+
+    span_header*  header = GetSpanHeader(memory);
+    thread_cache& cache  = current_cache;
+    if (header->size_class == kLargeSizeClass)
+    {
+        thread_scope_stats& stats = cache.stats[header->scope];
+        ++stats.frees;
+        stats.live_bytes -= static_cast<int64_t>(header->size);
+
+        large_allocation_count.fetch_sub(1, std::memory_order_relaxed);
+        FreeSystemMemory(header->system_memory);
+        return;
+    }
+
+    const uint32_t scope      = header->scope;
+    const uint32_t size_class = header->size_class;
+
+    thread_scope_stats& stats = cache.stats[scope];
+    ++stats.frees;
+    stats.live_bytes -= static_cast<int64_t>(kMinBlockSize << size_class);
+
+    free_list&  list  = cache.lists[scope][size_class];
+    free_block* block = static_cast<free_block*>(memory);
+    block->next       = list.head;
+    list.head         = block;
+    if (++list.count > kMaxCachedBlocks)
+    {
+        AddThreadStats(cache.stats);
+        ReturnBlocks(scope, size_class, &list, kBatchSize);
+    }
+}
+
+static void* VKAPI_PTR HostAllocation(void*                   pUserData,
+                                      size_t                  size,
+                                      size_t                  alignment,
+                                      VkSystemAllocationScope allocationScope)
+{
+    (void)pUserData;
+
+    return Allocate(size, alignment, allocationScope);
+}
+
+static void* VKAPI_PTR HostReallocation(void*                   pUserData,
+                                        void*                   pOriginal,
+                                        size_t                  size,
+                                        size_t                  alignment,
+                                        VkSystemAllocationScope allocationScope)
+{
+    (void)pUserData;
+
+    if (pOriginal == nullptr)
+    {
+        return Allocate(size, alignment, allocationScope);
+    }
+    else if (size == 0)
+    {
+        Free(pOriginal);
+        return nullptr;
+    }
+
+    // Blocks that are large enough and suitably aligned are kept
+    const size_t usable_size = GetUsableSize(pOriginal);
+    if ((size <= usable_size) && ((reinterpret_cast<uintptr_t>(pOriginal) % std::max(alignment, size_t(1))) == 0))
+    {
+        ++current_cache.stats[GetSpanHeader(pOriginal)->scope].reallocations;
+        return pOriginal;
+    }
+
+    void* memory = Allocate(size, alignment, allocationScope);
+    if (memory != nullptr)
+    {
+        std::memcpy(memory, pOriginal, std::min(size, usable_size));
+        Free(pOriginal);
+        ++current_cache.stats[GetScope(allocationScope)].reallocations;
+    }
+
+    return memory;
+}
+
+static void VKAPI_PTR HostFree(void* pUserData, void* pMemory)
+{
+    (void)pUserData;
+
+    Free(pMemory);
+}
+
+static const VkAllocationCallbacks kHostAllocationCallbacks = {
+    nullptr, HostAllocation, HostReallocation, HostFree, nullptr, nullptr
+};
+
+#endif // HOST_ALLOCATOR_THREAD_CACHING_ALLOCATOR_H
@@ -0,0 +1,267 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the cost per create and destroy pair of samplers and descriptor set layouts through the object
+// deduplication layer and directly against the mock driver, which charges a fixed cost for each object it creates or
+// destroys. Each thread creates its objects from a small set of create infos, as a renderer creating them per
+// material would, and destroys them once they are all created. Run with the number of objects per thread as the
+// optional first argument, the largest number of threads as the optional second one and the driver's cost per
+// creation in nanoseconds as the optional third one.
+
+#include "base_layer/test/mock_driver.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t kCreateInfoCount = 16;
+
+static uint64_t creation_cost_ns = 2000;
+
+static VKAPI_ATTR VkResult VKAPI_CALL CostlyCreateSampler(VkDevice                     device,
+                                                          const VkSamplerCreateInfo*   pCreateInfo,
+                                                          const VkAllocationCallbacks* pAllocator,
+                                                          VkSampler*                   pSampler)
+{
+    (void)device;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    mock_driver::SpinFor(creation_cost_ns);
+    *pSampler = mock_driver::NewHandle<VkSampler>();
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL CostlyDestroySampler(VkDevice                     device,
+                                                       VkSampler                    sampler,
+                                                       const VkAllocationCallbacks* pAllocator)
+{
+    (void)device;
+    (void)sampler;
+    (void)pAllocator;
+
+    mock_driver::SpinFor(creation_cost_ns);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL
+CostlyCreateDescriptorSetLayout(VkDevice                               device,
+                                const VkDescriptorSetLayoutCreateInfo* pCreateInfo,
+                                const VkAllocationCallbacks*           pAllocator,
+                                VkDescriptorSetLayout*                 pSetLayout)
+{
+    (void)device;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    mock_driver::SpinFor(creation_cost_ns);
+    *pSetLayout = mock_driver::NewHandle<VkDescriptorSetLayout>();
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL CostlyDestroyDescriptorSetLayout(VkDevice                     device,
+                                                                   VkDescriptorSetLayout        descriptorSetLayout,
+                                                                   const VkAllocationCallbacks* pAllocator)
+{
+    (void)device;
+    (void)descriptorSetLayout;
+    (void)pAllocator;
+
+    mock_driver::SpinFor(creation_cost_ns);
+}
+
+// Commands of the layer, or of the mock driver when the layer is bypassed
+struct object_commands
+{
+    PFN_vkCreateSampler              create_sampler{ nullptr };
+    PFN_vkDestroySampler             destroy_sampler{ nullptr };
+    PFN_vkCreateDescriptorSetLayout  create_descriptor_set_layout{ nullptr };
+    PFN_vkDestroyDescriptorSetLayout destroy_descriptor_set_layout{ nullptr };
+};
+
+// Create infos that differ in one member, with a pNext chain and bindings as an application would pass them
+struct create_infos
+{
+    VkSamplerReductionModeCreateInfo reduction{ VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO };
+    VkSamplerCreateInfo              samplers[kCreateInfoCount]{};
+    VkDescriptorSetLayoutBinding     bindings[kCreateInfoCount][4]{};
+    VkDescriptorSetLayoutCreateInfo  layouts[kCreateInfoCount]{};
+
+    create_infos()
+    {
+        reduction.reductionMode = VK_SAMPLER_REDUCTION_MODE_WEIGHTED_AVERAGE;
+
+        for (uint32_t i = 0; i < kCreateInfoCount; ++i)
+        {
+            VkSamplerCreateInfo& sampler = samplers[i];
+            sampler.sType                = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+            sampler.pNext                = &reduction;
+            sampler.magFilter            = VK_FILTER_LINEAR;
+            sampler.minFilter            = VK_FILTER_LINEAR;
+            sampler.mipmapMode           = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+            sampler.addressModeU         = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+            sampler.addressModeV         = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+            sampler.addressModeW         = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+            sampler.anisotropyEnable     = VK_TRUE;
+            sampler.maxAnisotropy        = static_cast<float>(1 + i);
+            sampler.maxLod               = VK_LOD_CLAMP_NONE;
+
+            // Bindings in reverse order, which the layer sorts
+            for (uint32_t binding = 0; binding < 4; ++binding)
+            {
+                VkDescriptorSetLayoutBinding& layout_binding = bindings[i][3 - binding];
+                layout_binding.binding                       = binding;
+                layout_binding.descriptorType                = (binding == 0) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER
+                                                                              : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+                layout_binding.descriptorCount               = (binding == 3) ? (1 + i) : 1;
+                layout_binding.stageFlags                    = VK_SHADER_STAGE_FRAGMENT_BIT;
+            }
+
+            VkDescriptorSetLayoutCreateInfo& layout = layouts[i];
+            layout.sType                            = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+            layout.bindingCount                     = 4;
+            layout.pBindings                        = bindings[i];
+        }
+    }
+};
+
+template <typename Call>
+static void Measure(const char* name, uint32_t iterations, uint32_t thread_count, Call call)
+{
+    // Warms up the caches of the layer and of the CPU
+    call(iterations / 16);
+
+    std::vector<std::thread> threads;
+    const auto               begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back(call, iterations);
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    printf("%-48s %2u threads %10.1f ns/call\n", name, thread_count, ns / iterations);
+}
+
+static void MeasureCommands(const char*                 mode,
+                            const object_commands&      commands,
+                            const create_infos&         infos,
+                            const mock_driver::context& context,
+                            uint32_t                    iterations,
+                            uint32_t                    max_threads)
+{
+    char name[64];
+    for (uint32_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+    {
+        snprintf(name, sizeof(name), "%s vkCreateSampler+vkDestroySampler", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            std::vector<VkSampler> samplers(count, VK_NULL_HANDLE);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                commands.create_sampler(context.device, &infos.samplers[i % kCreateInfoCount], nullptr, &samplers[i]);
+            }
+
+            for (VkSampler sampler : samplers)
+            {
+                commands.destroy_sampler(context.device, sampler, nullptr);
+            }
+        });
+
+        snprintf(name, sizeof(name), "%s vkCreate+vkDestroyDescriptorSetLayout", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            std::vector<VkDescriptorSetLayout> layouts(count, VK_NULL_HANDLE);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                commands.create_descriptor_set_layout(
+                    context.device, &infos.layouts[i % kCreateInfoCount], nullptr, &layouts[i]);
+            }
+
+            for (VkDescriptorSetLayout layout : layouts)
+            {
+                commands.destroy_descriptor_set_layout(context.device, layout, nullptr);
+            }
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 100000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    uint32_t max_threads = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 8;
+    if (max_threads == 0)
+    {
+        max_threads = 1;
+    }
+
+    if (argc > 3)
+    {
+        creation_cost_ns = strtoull(argv[3], nullptr, 10);
+    }
+
+    mock_driver::SetFunction("vkCreateSampler", CostlyCreateSampler);
+    mock_driver::SetFunction("vkDestroySampler", CostlyDestroySampler);
+    mock_driver::SetFunction("vkCreateDescriptorSetLayout", CostlyCreateDescriptorSetLayout);
+    mock_driver::SetFunction("vkDestroyDescriptorSetLayout", CostlyDestroyDescriptorSetLayout);
+
+    mock_driver::context context;
+    if (!mock_driver::CreateContext(&context))
+    {
+        mock_driver::DestroyContext(&context);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u objects per thread, %llu ns per driver creation, %u distinct create infos\n",
+           iterations,
+           static_cast<unsigned long long>(creation_cost_ns),
+           kCreateInfoCount);
+
+    const create_infos infos;
+
+    object_commands driver_commands;
+    driver_commands.create_sampler                = CostlyCreateSampler;
+    driver_commands.destroy_sampler               = CostlyDestroySampler;
+    driver_commands.create_descriptor_set_layout  = CostlyCreateDescriptorSetLayout;
+    driver_commands.destroy_descriptor_set_layout = CostlyDestroyDescriptorSetLayout;
+    MeasureCommands("driver", driver_commands, infos, context, iterations, max_threads);
+
+    object_commands layer_commands;
+    layer_commands.create_sampler                = MOCK_DEVICE_PROC(context, vkCreateSampler);
+    layer_commands.destroy_sampler               = MOCK_DEVICE_PROC(context, vkDestroySampler);
+    layer_commands.create_descriptor_set_layout  = MOCK_DEVICE_PROC(context, vkCreateDescriptorSetLayout);
+    layer_commands.destroy_descriptor_set_layout = MOCK_DEVICE_PROC(context, vkDestroyDescriptorSetLayout);
+    MeasureCommands("layer", layer_commands, infos, context, iterations, max_threads);
+
+    mock_driver::DestroyContext(&context);
+    return (mock_driver::GetState().errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
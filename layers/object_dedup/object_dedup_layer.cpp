@@ -0,0 +1,645 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_object_dedup"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Sampler and descriptor set layout deduplication layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// Samplers and descriptor set layouts created from equivalent create infos share one object, which is destroyed with
+// its last reference. A create info is reduced to a canonical key: the device, the object type, the members that
+// affect the object and the supported pNext structures, sorted by type. Create infos with other pNext structures or
+// with allocation callbacks are never shared, and devices that enable the privateData feature are left alone as it
+// requires handles to be unique.
+//
+// Create infos that refer to other objects, immutable samplers and YCbCr conversions, are not shared either. The
+// driver may reuse the handle of a destroyed object for a different one, which would then match the stale key.
+struct object_key
+{
+    uint64_t              hash{ 0 };
+    std::vector<uint64_t> words;
+
+    bool operator==(const object_key& other) const { return (hash == other.hash) && (words == other.words); }
+};
+
+struct object_key_hasher
+{
+    size_t operator()(const object_key& key) const { return static_cast<size_t>(key.hash); }
+};
+
+struct shared_object
+{
+    uint64_t handle{ 0 };
+    uint32_t references{ 0 };
+};
+
+// Shared objects are spread over independently locked shards selected by their key, and the handles handed out over
+// shards selected by the handle, which find the key of the object again on destruction. Handles are only unique within
+// a device and an object type, so both are part of the handle's key.
+struct object_shard
+{
+    std::mutex                                                       lock;
+    std::unordered_map<object_key, shared_object, object_key_hasher> objects;
+};
+
+struct handle_key
+{
+    VkDevice device{ VK_NULL_HANDLE };
+    uint64_t type{ 0 };
+    uint64_t handle{ 0 };
+
+    bool operator==(const handle_key& other) const
+    {
+        return (device == other.device) && (type == other.type) && (handle == other.handle);
+    }
+};
+
+struct handle_key_hasher
+{
+    static uint64_t hash(const handle_key& key)
+    {
+        uint64_t hash = key.handle ^ (reinterpret_cast<uintptr_t>(key.device) * 0x9e3779b97f4a7c15ull) ^ key.type;
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    size_t operator()(const handle_key& key) const { return static_cast<size_t>(hash(key)); }
+};
+
+struct handle_entry
+{
+    object_shard*     shard{ nullptr };
+    const object_key* key{ nullptr };
+};
+
+struct handle_shard
+{
+    std::mutex                                                      lock;
+    std::unordered_map<handle_key, handle_entry, handle_key_hasher> handles;
+};
+
+struct device_counters
+{
+    std::atomic<uint64_t> requested_samplers{ 0 };
+    std::atomic<uint64_t> unique_samplers{ 0 };
+    std::atomic<uint64_t> requested_layouts{ 0 };
+    std::atomic<uint64_t> unique_layouts{ 0 };
+    std::atomic<uint64_t> create_ns{ 0 };
+};
+
+static constexpr size_t kShardCount = 64;
+static object_shard     object_shards[kShardCount];
+static handle_shard     handle_shards[kShardCount];
+
+static constexpr uint64_t kSamplerKey             = 1;
+static constexpr uint64_t kDescriptorSetLayoutKey = 2;
+
+static std::shared_mutex                                               device_lock;
+static std::unordered_map<VkDevice, std::unique_ptr<device_counters>> devices;
+
+template <typename T>
+static uint64_t HandleToUint64(T handle)
+{
+    return (uint64_t)(handle);
+}
+
+static handle_shard& GetHandleShard(const handle_key& key)
+{
+    // The low bits select the bucket of the shard's map
+    return handle_shards[(handle_key_hasher::hash(key) >> 32) % kShardCount];
+}
+
+static void AddFloat(std::vector<uint64_t>* words, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    words->push_back(bits);
+}
+
+// Appends the supported structures of a pNext chain to key, sorted by structure type so that the order of the chain
+// does not matter. Returns false if the chain holds a structure that is not supported.
+template <typename AddStructure>
+static bool AddChain(object_key* key, const void* pNext, AddStructure add_structure)
+{
+    std::vector<std::vector<uint64_t>> structures;
+
+    const VkBaseInStructure* next = reinterpret_cast<const VkBaseInStructure*>(pNext);
+    for (; next != nullptr; next = next->pNext)
+    {
+        structures.emplace_back(1, static_cast<uint64_t>(next->sType));
+        if (!add_structure(next, &structures.back()))
+        {
+            return false;
+        }
+    }
+
+    std::sort(structures.begin(), structures.end());
+    for (const std::vector<uint64_t>& structure : structures)
+    {
+        key->words.insert(key->words.end(), structure.begin(), structure.end());
+    }
+
+    return true;
+}
+
+static void FinishKey(object_key* key)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint64_t word : key->words)
+    {
+        hash = (hash ^ word) * 0x100000001b3ull;
+        hash ^= hash >> 29;
+    }
+
+    key->hash = hash;
+}
+
+static bool AddSamplerStructure(const VkBaseInStructure* structure, std::vector<uint64_t>* words)
+{
+    switch (structure->sType)
+    {
+        case VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO:
+            words->push_back(reinterpret_cast<const VkSamplerReductionModeCreateInfo*>(structure)->reductionMode);
+            return true;
+        case VK_STRUCTURE_TYPE_SAMPLER_CUSTOM_BORDER_COLOR_CREATE_INFO_EXT:
+        {
+            const auto* info = reinterpret_cast<const VkSamplerCustomBorderColorCreateInfoEXT*>(structure);
+            uint32_t    color[4];
+            std::memcpy(color, &info->customBorderColor, sizeof(color));
+            words->insert(words->end(), color, color + 4);
+            words->push_back(info->format);
+            return true;
+        }
+        case VK_STRUCTURE_TYPE_SAMPLER_BORDER_COLOR_COMPONENT_MAPPING_CREATE_INFO_EXT:
+        {
+            const auto* info = reinterpret_cast<const VkSamplerBorderColorComponentMappingCreateInfoEXT*>(structure);
+            words->insert(words->end(), { static_cast<uint64_t>(info->components.r),
+                                          static_cast<uint64_t>(info->components.g),
+                                          static_cast<uint64_t>(info->components.b),
+                                          static_cast<uint64_t>(info->components.a),
+                                          static_cast<uint64_t>(info->srgb) });
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+static bool GetSamplerKey(VkDevice device, const VkSamplerCreateInfo* pCreateInfo, object_key* key)
+{
+    key->words = { kSamplerKey,
+                   HandleToUint64(device),
+                   pCreateInfo->flags,
+                   static_cast<uint64_t>(pCreateInfo->magFilter),
+                   static_cast<uint64_t>(pCreateInfo->minFilter),
+                   static_cast<uint64_t>(pCreateInfo->mipmapMode),
+                   static_cast<uint64_t>(pCreateInfo->addressModeU),
+                   static_cast<uint64_t>(pCreateInfo->addressModeV),
+                   static_cast<uint64_t>(pCreateInfo->addressModeW),
+                   static_cast<uint64_t>(pCreateInfo->borderColor),
+                   pCreateInfo->unnormalizedCoordinates,
+                   pCreateInfo->anisotropyEnable,
+                   pCreateInfo->compareEnable,
+                   // Members that are ignored when the feature using them is disabled
+                   pCreateInfo->compareEnable ? static_cast<uint64_t>(pCreateInfo->compareOp) : 0 };
+    AddFloat(&key->words, pCreateInfo->mipLodBias);
+    AddFloat(&key->words, pCreateInfo->anisotropyEnable ? pCreateInfo->maxAnisotropy : 0.0f);
+    AddFloat(&key->words, pCreateInfo->minLod);
+    AddFloat(&key->words, pCreateInfo->maxLod);
+
+    if (!AddChain(key, pCreateInfo->pNext, AddSamplerStructure))
+    {
+        return false;
+    }
+
+    FinishKey(key);
+    return true;
+}
+
+// Bindings are keyed in binding number order. Structures in the chain with an entry per binding are keyed in the
+// same order, which order maps to the index in pBindings.
+static bool
+GetDescriptorSetLayoutKey(VkDevice device, const VkDescriptorSetLayoutCreateInfo* pCreateInfo, object_key* key)
+{
+    std::vector<uint32_t> order(pCreateInfo->bindingCount);
+    for (uint32_t i = 0; i < pCreateInfo->bindingCount; ++i)
+    {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [pCreateInfo](uint32_t a, uint32_t b) {
+        return pCreateInfo->pBindings[a].binding < pCreateInfo->pBindings[b].binding;
+    });
+
+    key->words = { kDescriptorSetLayoutKey, HandleToUint64(device), pCreateInfo->flags, pCreateInfo->bindingCount };
+    for (uint32_t index : order)
+    {
+        const VkDescriptorSetLayoutBinding& binding = pCreateInfo->pBindings[index];
+        key->words.insert(key->words.end(),
+                          { binding.binding,
+                            static_cast<uint64_t>(binding.descriptorType),
+                            binding.descriptorCount,
+                            binding.stageFlags });
+
+        if ((binding.pImmutableSamplers != nullptr) &&
+            ((binding.descriptorType == VK_DESCRIPTOR_TYPE_SAMPLER) ||
+             (binding.descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)))
+        {
+            return false;
+        }
+    }
+
+    auto add_structure = [&order](const VkBaseInStructure* structure, std::vector<uint64_t>* words) {
+        switch (structure->sType)
+        {
+            case VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO:
+            {
+                const auto* info = reinterpret_cast<const VkDescriptorSetLayoutBindingFlagsCreateInfo*>(structure);
+                words->push_back(info->bindingCount);
+                if (info->bindingCount != 0)
+                {
+                    for (uint32_t index : order)
+                    {
+                        words->push_back(info->pBindingFlags[index]);
+                    }
+                }
+                return true;
+            }
+            case VK_STRUCTURE_TYPE_MUTABLE_DESCRIPTOR_TYPE_CREATE_INFO_EXT:
+            {
+                // Bindings without a list have an empty one
+                const auto* info = reinterpret_cast<const VkMutableDescriptorTypeCreateInfoEXT*>(structure);
+                for (uint32_t index : order)
+                {
+                    if (index < info->mutableDescriptorTypeListCount)
+                    {
+                        const VkMutableDescriptorTypeListEXT& list = info->pMutableDescriptorTypeLists[index];
+                        words->push_back(list.descriptorTypeCount);
+                        words->insert(
+                            words->end(), list.pDescriptorTypes, list.pDescriptorTypes + list.descriptorTypeCount);
+                    }
+                    else
+                    {
+                        words->push_back(0);
+                    }
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    };
+
+    if (!AddChain(key, pCreateInfo->pNext, add_structure))
+    {
+        return false;
+    }
+
+    FinishKey(key);
+    return true;
+}
+
+static device_counters* GetDeviceCounters(VkDevice device)
+{
+    std::shared_lock<std::shared_mutex> lock(device_lock);
+    auto                                entry = devices.find(device);
+    return (entry != devices.end()) ? entry->second.get() : nullptr;
+}
+
+// Returns the shared object for key in pHandle, calling create to create it if there is none.
+template <typename Handle, typename Create>
+static VkResult GetSharedObject(VkDevice               device,
+                                uint64_t               type,
+                                const object_key&      key,
+                                std::atomic<uint64_t>* unique_count,
+                                Handle*                pHandle,
+                                Create                 create)
+{
+    object_shard&               shard = object_shards[key.hash % kShardCount];
+    std::lock_guard<std::mutex> lock(shard.lock);
+
+    auto entry = shard.objects.find(key);
+    if (entry != shard.objects.end())
+    {
+        ++entry->second.references;
+        *pHandle = (Handle)(entry->second.handle);
+        return VK_SUCCESS;
+    }
+
+    VkResult result = create(pHandle);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+
+    const uint64_t handle = HandleToUint64(*pHandle);
+    auto           added  = shard.objects.emplace(key, shared_object{ handle, 1 }).first;
+    ++*unique_count;
+
+    const handle_key            handle_id{ device, type, handle };
+    handle_shard&               handles = GetHandleShard(handle_id);
+    std::lock_guard<std::mutex> handle_lock(handles.lock);
+    handles.handles[handle_id] = handle_entry{ &shard, &added->first };
+
+    return VK_SUCCESS;
+}
+
+// Releases a reference to a shared object. Returns false if the object must be destroyed, either because it is not
+// shared or because this was its last reference.
+static bool ReleaseSharedObject(VkDevice device, uint64_t type, uint64_t handle)
+{
+    const handle_key handle_id{ device, type, handle };
+    handle_shard&    handles = GetHandleShard(handle_id);
+    handle_entry     entry;
+    {
+        std::lock_guard<std::mutex> lock(handles.lock);
+        auto                        found = handles.handles.find(handle_id);
+        if (found == handles.handles.end())
+        {
+            return false;
+        }
+
+        entry = found->second;
+    }
+
+    std::lock_guard<std::mutex> lock(entry.shard->lock);
+    auto                        object = entry.shard->objects.find(*entry.key);
+    if ((object == entry.shard->objects.end()) || (object->second.handle != handle))
+    {
+        return false;
+    }
+
+    if (--object->second.references > 0)
+    {
+        return true;
+    }
+
+    // The handle is forgotten before the object is destroyed, as the driver may hand it out again afterwards
+    {
+        std::lock_guard<std::mutex> handle_lock(handles.lock);
+        handles.handles.erase(handle_id);
+    }
+
+    entry.shard->objects.erase(object);
+    return false;
+}
+
+// Forgets the objects of a device, including the ones the application did not destroy.
+static void RemoveDeviceObjects(VkDevice device)
+{
+    for (handle_shard& handles : handle_shards)
+    {
+        std::lock_guard<std::mutex> lock(handles.lock);
+        for (auto entry = handles.handles.begin(); entry != handles.handles.end();)
+        {
+            entry = (entry->first.device == device) ? handles.handles.erase(entry) : std::next(entry);
+        }
+    }
+
+    for (object_shard& shard : object_shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.lock);
+        for (auto entry = shard.objects.begin(); entry != shard.objects.end();)
+        {
+            entry = (entry->first.words[1] == HandleToUint64(device)) ? shard.objects.erase(entry) : std::next(entry);
+        }
+    }
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pAllocator;
+
+    if (!base_layer::is_private_data_enabled(pCreateInfo))
+    {
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        devices[*pDevice] = std::make_unique<device_counters>();
+    }
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    std::unique_ptr<device_counters> counters;
+    {
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        auto                                entry = devices.find(device);
+        if (entry != devices.end())
+        {
+            counters = std::move(entry->second);
+            devices.erase(entry);
+        }
+    }
+
+    if (counters != nullptr)
+    {
+        RemoveDeviceObjects(device);
+
+        const uint64_t requested = counters->requested_samplers.load() + counters->requested_layouts.load();
+        base_layer::base_layer_print_info(
+            "Object deduplication: %llu unique of %llu requested samplers, %llu unique of %llu requested "
+            "descriptor set layouts, %.2f us per creation\n",
+            static_cast<unsigned long long>(counters->unique_samplers.load()),
+            static_cast<unsigned long long>(counters->requested_samplers.load()),
+            static_cast<unsigned long long>(counters->unique_layouts.load()),
+            static_cast<unsigned long long>(counters->requested_layouts.load()),
+            (requested > 0) ? static_cast<double>(counters->create_ns.load()) / 1000.0 / requested : 0.0);
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateSampler(VkDevice                     device,
+                                                   const VkSamplerCreateInfo*   pCreateInfo,
+                                                   const VkAllocationCallbacks* pAllocator,
+                                                   VkSampler*                   pSampler)
+{
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+    device_counters*   counters       = GetDeviceCounters(device);
+    object_key         key;
+    if ((counters == nullptr) || (pAllocator != nullptr) || !GetSamplerKey(device, pCreateInfo, &key))
+    {
+        // Forward function to next layer / driver
+        return dispatch_table.CreateSampler(device, pCreateInfo, pAllocator, pSampler);
+    }
+
+    const uint64_t start_ns = base_layer::get_timestamp_ns();
+    ++counters->requested_samplers;
+
+    // Forward function to next layer / driver
+    VkResult result =
+        GetSharedObject(device, kSamplerKey, key, &counters->unique_samplers, pSampler, [&](VkSampler* pNewSampler) {
+            return dispatch_table.CreateSampler(device, pCreateInfo, pAllocator, pNewSampler);
+        });
+
+    counters->create_ns += base_layer::get_timestamp_ns() - start_ns;
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroySampler(VkDevice                     device,
+                                                VkSampler                    sampler,
+                                                const VkAllocationCallbacks* pAllocator)
+{
+    if ((sampler != VK_NULL_HANDLE) && ReleaseSharedObject(device, kSamplerKey, HandleToUint64(sampler)))
+    {
+        return;
+    }
+
+    // Forward function to next layer / driver
+    base_layer::get_device_handle(device)->dispatch_table.DestroySampler(device, sampler, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDescriptorSetLayout(VkDevice                               device,
+                                                               const VkDescriptorSetLayoutCreateInfo* pCreateInfo,
+                                                               const VkAllocationCallbacks*           pAllocator,
+                                                               VkDescriptorSetLayout*                 pSetLayout)
+{
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+    device_counters*   counters       = GetDeviceCounters(device);
+    object_key         key;
+    if ((counters == nullptr) || (pAllocator != nullptr) || !GetDescriptorSetLayoutKey(device, pCreateInfo, &key))
+    {
+        // Forward function to next layer / driver
+        return dispatch_table.CreateDescriptorSetLayout(device, pCreateInfo, pAllocator, pSetLayout);
+    }
+
+    const uint64_t start_ns = base_layer::get_timestamp_ns();
+    ++counters->requested_layouts;
+
+    // Forward function to next layer / driver
+    VkResult result = GetSharedObject(device,
+                                      kDescriptorSetLayoutKey,
+                                      key,
+                                      &counters->unique_layouts,
+                                      pSetLayout,
+                                      [&](VkDescriptorSetLayout* pNewSetLayout) {
+                                          return dispatch_table.CreateDescriptorSetLayout(
+                                              device, pCreateInfo, pAllocator, pNewSetLayout);
+                                      });
+
+    counters->create_ns += base_layer::get_timestamp_ns() - start_ns;
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDescriptorSetLayout(VkDevice                     device,
+                                                            VkDescriptorSetLayout        descriptorSetLayout,
+                                                            const VkAllocationCallbacks* pAllocator)
+{
+    if ((descriptorSetLayout != VK_NULL_HANDLE) &&
+        ReleaseSharedObject(device, kDescriptorSetLayoutKey, HandleToUint64(descriptorSetLayout)))
+    {
+        return;
+    }
+
+    // Forward function to next layer / driver
+    base_layer::get_device_handle(device)->dispatch_table.DestroyDescriptorSetLayout(
+        device, descriptorSetLayout, pAllocator);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName)
+    {
+        if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkCreateSampler"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateSampler;
+        }
+        else if (!strcmp(pName, "vkDestroySampler"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroySampler;
+        }
+        else if (!strcmp(pName, "vkCreateDescriptorSetLayout"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateDescriptorSetLayout;
+        }
+        else if (!strcmp(pName, "vkDestroyDescriptorSetLayout"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDescriptorSetLayout;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
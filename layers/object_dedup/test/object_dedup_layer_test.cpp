@@ -0,0 +1,427 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the object deduplication layer against the mock driver, which counts the samplers and descriptor set layouts
+// it creates and fails a test when it is asked to destroy one that is not alive.
+
+#include "base_layer/test/mock_driver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_set>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (false)
+
+// Objects created by the mock and not destroyed yet, and the number of calls that created them
+static std::unordered_set<uint64_t> live_objects;
+static uint32_t                     sampler_creations = 0;
+static uint32_t                     layout_creations  = 0;
+
+static VKAPI_ATTR VkResult VKAPI_CALL MockCreateSampler(VkDevice                     device,
+                                                        const VkSamplerCreateInfo*   pCreateInfo,
+                                                        const VkAllocationCallbacks* pAllocator,
+                                                        VkSampler*                   pSampler)
+{
+    (void)device;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    ++sampler_creations;
+    *pSampler = mock_driver::NewHandle<VkSampler>();
+    live_objects.insert((uint64_t)(*pSampler));
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL MockDestroySampler(VkDevice                     device,
+                                                     VkSampler                    sampler,
+                                                     const VkAllocationCallbacks* pAllocator)
+{
+    (void)device;
+    (void)pAllocator;
+
+    CHECK(live_objects.erase((uint64_t)(sampler)) == 1);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL MockCreateDescriptorSetLayout(VkDevice                               device,
+                                                                    const VkDescriptorSetLayoutCreateInfo* pCreateInfo,
+                                                                    const VkAllocationCallbacks*           pAllocator,
+                                                                    VkDescriptorSetLayout*                 pSetLayout)
+{
+    (void)device;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    ++layout_creations;
+    *pSetLayout = mock_driver::NewHandle<VkDescriptorSetLayout>();
+    live_objects.insert((uint64_t)(*pSetLayout));
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR void VKAPI_CALL MockDestroyDescriptorSetLayout(VkDevice                     device,
+                                                                 VkDescriptorSetLayout        descriptorSetLayout,
+                                                                 const VkAllocationCallbacks* pAllocator)
+{
+    (void)device;
+    (void)pAllocator;
+
+    CHECK(live_objects.erase((uint64_t)(descriptorSetLayout)) == 1);
+}
+
+static VkSamplerCreateInfo GetSamplerInfo(const void* next = nullptr)
+{
+    VkSamplerCreateInfo create_info = { VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO };
+    create_info.pNext               = next;
+    create_info.magFilter           = VK_FILTER_LINEAR;
+    create_info.minFilter           = VK_FILTER_LINEAR;
+    create_info.mipmapMode          = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    create_info.addressModeU        = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    create_info.addressModeV        = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    create_info.addressModeW        = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    create_info.maxAnisotropy       = 1.0f;
+    create_info.maxLod              = VK_LOD_CLAMP_NONE;
+    return create_info;
+}
+
+static VkSampler CreateSampler(const mock_driver::context&  context,
+                               const VkSamplerCreateInfo&   create_info,
+                               const VkAllocationCallbacks* allocator = nullptr)
+{
+    VkSampler sampler = VK_NULL_HANDLE;
+    CHECK(MOCK_DEVICE_PROC(context, vkCreateSampler)(context.device, &create_info, allocator, &sampler) ==
+          VK_SUCCESS);
+    return sampler;
+}
+
+static void DestroySampler(const mock_driver::context&  context,
+                           VkSampler                    sampler,
+                           const VkAllocationCallbacks* allocator = nullptr)
+{
+    MOCK_DEVICE_PROC(context, vkDestroySampler)(context.device, sampler, allocator);
+}
+
+static VkDescriptorSetLayout CreateLayout(const mock_driver::context&         context,
+                                          const VkDescriptorSetLayoutBinding* bindings,
+                                          uint32_t                            binding_count,
+                                          const void*                         next = nullptr)
+{
+    VkDescriptorSetLayoutCreateInfo create_info = { VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO };
+    create_info.pNext                           = next;
+    create_info.bindingCount                    = binding_count;
+    create_info.pBindings                       = bindings;
+
+    VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+    CHECK(MOCK_DEVICE_PROC(context, vkCreateDescriptorSetLayout)(context.device, &create_info, nullptr, &layout) ==
+          VK_SUCCESS);
+    return layout;
+}
+
+static void DestroyLayout(const mock_driver::context& context, VkDescriptorSetLayout layout)
+{
+    MOCK_DEVICE_PROC(context, vkDestroyDescriptorSetLayout)(context.device, layout, nullptr);
+}
+
+static void TestEquivalentSamplersAreShared()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    const uint32_t            creations   = sampler_creations;
+    const VkSamplerCreateInfo create_info = GetSamplerInfo();
+    VkSampler                 first       = CreateSampler(context, create_info);
+    VkSampler                 second      = CreateSampler(context, create_info);
+    CHECK(first == second);
+    CHECK(sampler_creations == (creations + 1));
+
+    // The shared sampler is destroyed with its last reference, and created again by the next call
+    DestroySampler(context, first);
+    CHECK(live_objects.count((uint64_t)(first)) == 1);
+    DestroySampler(context, second);
+    CHECK(live_objects.count((uint64_t)(first)) == 0);
+
+    VkSampler third = CreateSampler(context, create_info);
+    CHECK(sampler_creations == (creations + 2));
+    DestroySampler(context, third);
+
+    mock_driver::DestroyContext(&context);
+}
+
+// Members that the driver ignores are left out of the key, the others are part of it.
+static void TestIgnoredSamplerMembers()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    VkSamplerCreateInfo create_info = GetSamplerInfo();
+    VkSampler           base        = CreateSampler(context, create_info);
+
+    create_info.maxAnisotropy = 16.0f;
+    create_info.compareOp     = VK_COMPARE_OP_LESS;
+    VkSampler ignored         = CreateSampler(context, create_info);
+    CHECK(ignored == base);
+
+    create_info.anisotropyEnable = VK_TRUE;
+    VkSampler anisotropic        = CreateSampler(context, create_info);
+    CHECK(anisotropic != base);
+
+    create_info               = GetSamplerInfo();
+    create_info.compareEnable = VK_TRUE;
+    create_info.compareOp     = VK_COMPARE_OP_LESS;
+    VkSampler compare_less    = CreateSampler(context, create_info);
+    create_info.compareOp     = VK_COMPARE_OP_GREATER;
+    VkSampler compare_greater = CreateSampler(context, create_info);
+    CHECK((compare_less != base) && (compare_less != compare_greater));
+
+    create_info        = GetSamplerInfo();
+    create_info.maxLod = 4.0f;
+    VkSampler clamped  = CreateSampler(context, create_info);
+    CHECK(clamped != base);
+
+    for (VkSampler sampler : { base, ignored, anisotropic, compare_less, compare_greater, clamped })
+    {
+        DestroySampler(context, sampler);
+    }
+
+    CHECK(live_objects.empty());
+    mock_driver::DestroyContext(&context);
+}
+
+// The structures of a pNext chain are keyed in structure type order, whatever their order in the chain.
+static void TestSamplerChainOrder()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    VkSamplerReductionModeCreateInfo reduction = { VK_STRUCTURE_TYPE_SAMPLER_REDUCTION_MODE_CREATE_INFO };
+    reduction.reductionMode                    = VK_SAMPLER_REDUCTION_MODE_MIN;
+
+    VkSamplerCustomBorderColorCreateInfoEXT border_color = {
+        VK_STRUCTURE_TYPE_SAMPLER_CUSTOM_BORDER_COLOR_CREATE_INFO_EXT
+    };
+    border_color.customBorderColor.float32[0] = 0.5f;
+    border_color.format                       = VK_FORMAT_R8G8B8A8_UNORM;
+
+    reduction.pNext                 = &border_color;
+    VkSamplerCreateInfo create_info = GetSamplerInfo(&reduction);
+    create_info.borderColor         = VK_BORDER_COLOR_FLOAT_CUSTOM_EXT;
+    VkSampler reduction_first       = CreateSampler(context, create_info);
+
+    border_color.pNext    = &reduction;
+    reduction.pNext       = nullptr;
+    create_info.pNext     = &border_color;
+    VkSampler color_first = CreateSampler(context, create_info);
+    CHECK(color_first == reduction_first);
+
+    // A different value in either structure is a different sampler
+    reduction.reductionMode = VK_SAMPLER_REDUCTION_MODE_MAX;
+    VkSampler max_reduction = CreateSampler(context, create_info);
+    CHECK(max_reduction != reduction_first);
+
+    reduction.reductionMode                   = VK_SAMPLER_REDUCTION_MODE_MIN;
+    border_color.customBorderColor.float32[0] = 1.0f;
+    VkSampler other_color                     = CreateSampler(context, create_info);
+    CHECK((other_color != reduction_first) && (other_color != max_reduction));
+
+    // A chain missing one of the structures is a different sampler
+    reduction.pNext    = nullptr;
+    create_info.pNext  = &reduction;
+    VkSampler no_color = CreateSampler(context, create_info);
+    CHECK(no_color != reduction_first);
+
+    for (VkSampler sampler : { reduction_first, color_first, max_reduction, other_color, no_color })
+    {
+        DestroySampler(context, sampler);
+    }
+
+    CHECK(live_objects.empty());
+    mock_driver::DestroyContext(&context);
+}
+
+// Create infos with an unsupported structure or with allocation callbacks always reach the driver.
+static void TestUnsharedSamplers()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    VkSamplerYcbcrConversionInfo conversion_info = { VK_STRUCTURE_TYPE_SAMPLER_YCBCR_CONVERSION_INFO };
+    conversion_info.conversion                   = mock_driver::NewHandle<VkSamplerYcbcrConversion>();
+
+    const VkSamplerCreateInfo ycbcr_info = GetSamplerInfo(&conversion_info);
+    VkSampler                 first      = CreateSampler(context, ycbcr_info);
+    VkSampler                 second     = CreateSampler(context, ycbcr_info);
+    CHECK(first != second);
+
+    // The callbacks are never called by the mock
+    const VkAllocationCallbacks allocator      = {};
+    const VkSamplerCreateInfo   create_info    = GetSamplerInfo();
+    VkSampler                   shared         = CreateSampler(context, create_info);
+    VkSampler                   with_callbacks = CreateSampler(context, create_info, &allocator);
+    CHECK(with_callbacks != shared);
+
+    DestroySampler(context, first);
+    DestroySampler(context, second);
+    DestroySampler(context, shared);
+    DestroySampler(context, with_callbacks, &allocator);
+
+    CHECK(live_objects.empty());
+    mock_driver::DestroyContext(&context);
+}
+
+// Bindings are keyed in binding number order, and so are the per binding entries of the structures in the chain.
+static void TestLayoutBindingOrder()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    const VkDescriptorSetLayoutBinding bindings[] = {
+        { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT, nullptr },
+        { 1, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr },
+        { 3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr },
+    };
+    const VkDescriptorSetLayoutBinding reordered[] = { bindings[2], bindings[0], bindings[1] };
+
+    const uint32_t        creations = layout_creations;
+    VkDescriptorSetLayout ordered   = CreateLayout(context, bindings, 3);
+    VkDescriptorSetLayout shuffled  = CreateLayout(context, reordered, 3);
+    CHECK(ordered == shuffled);
+    CHECK(layout_creations == (creations + 1));
+
+    // The binding flags follow the bindings they apply to
+    const VkDescriptorBindingFlags flags[]           = { 0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT, 0 };
+    const VkDescriptorBindingFlags reordered_flags[] = { 0, 0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT };
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info = {
+        VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO
+    };
+    flags_info.bindingCount             = 3;
+    flags_info.pBindingFlags            = flags;
+    VkDescriptorSetLayout ordered_flags = CreateLayout(context, bindings, 3, &flags_info);
+    CHECK(ordered_flags != ordered);
+
+    flags_info.pBindingFlags             = reordered_flags;
+    VkDescriptorSetLayout shuffled_flags = CreateLayout(context, reordered, 3, &flags_info);
+    CHECK(shuffled_flags == ordered_flags);
+
+    // The same flags on the reordered bindings apply to a different binding
+    flags_info.pBindingFlags          = flags;
+    VkDescriptorSetLayout other_flags = CreateLayout(context, reordered, 3, &flags_info);
+    CHECK(other_flags != ordered_flags);
+
+    // So do the mutable descriptor type lists, where bindings without a list have an empty one
+    const VkDescriptorType mutable_types[] = { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE };
+    const VkMutableDescriptorTypeListEXT lists[]           = { { 0, nullptr }, { 2, mutable_types } };
+    const VkMutableDescriptorTypeListEXT reordered_lists[] = { { 0, nullptr }, { 0, nullptr }, { 2, mutable_types } };
+
+    VkMutableDescriptorTypeCreateInfoEXT mutable_info = { VK_STRUCTURE_TYPE_MUTABLE_DESCRIPTOR_TYPE_CREATE_INFO_EXT };
+    mutable_info.mutableDescriptorTypeListCount       = 2;
+    mutable_info.pMutableDescriptorTypeLists          = lists;
+    VkDescriptorSetLayout ordered_lists               = CreateLayout(context, bindings, 3, &mutable_info);
+
+    mutable_info.mutableDescriptorTypeListCount = 3;
+    mutable_info.pMutableDescriptorTypeLists    = reordered_lists;
+    VkDescriptorSetLayout shuffled_lists        = CreateLayout(context, reordered, 3, &mutable_info);
+    CHECK(shuffled_lists == ordered_lists);
+
+    // Both structures, in either order
+    mutable_info.mutableDescriptorTypeListCount = 2;
+    mutable_info.pMutableDescriptorTypeLists    = lists;
+    flags_info.pBindingFlags                    = flags;
+    flags_info.pNext                            = &mutable_info;
+    VkDescriptorSetLayout flags_first           = CreateLayout(context, bindings, 3, &flags_info);
+
+    flags_info.pNext                 = nullptr;
+    mutable_info.pNext               = &flags_info;
+    VkDescriptorSetLayout list_first = CreateLayout(context, bindings, 3, &mutable_info);
+    CHECK((list_first == flags_first) && (list_first != ordered_flags) && (list_first != ordered_lists));
+
+    for (VkDescriptorSetLayout layout : { ordered,
+                                          shuffled,
+                                          ordered_flags,
+                                          shuffled_flags,
+                                          other_flags,
+                                          ordered_lists,
+                                          shuffled_lists,
+                                          flags_first,
+                                          list_first })
+    {
+        DestroyLayout(context, layout);
+    }
+
+    CHECK(live_objects.empty());
+    mock_driver::DestroyContext(&context);
+}
+
+// Layouts with immutable samplers refer to other objects, whose handles the driver may reuse, and are never shared.
+static void TestImmutableSamplersAreNotShared()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    const VkSampler                    sampler = mock_driver::NewHandle<VkSampler>();
+    const VkDescriptorSetLayoutBinding binding = {
+        0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, &sampler
+    };
+
+    VkDescriptorSetLayout first  = CreateLayout(context, &binding, 1);
+    VkDescriptorSetLayout second = CreateLayout(context, &binding, 1);
+    CHECK(first != second);
+
+    DestroyLayout(context, first);
+    DestroyLayout(context, second);
+
+    CHECK(live_objects.empty());
+    mock_driver::DestroyContext(&context);
+}
+
+int main()
+{
+    mock_driver::SetFunction("vkCreateSampler", MockCreateSampler);
+    mock_driver::SetFunction("vkDestroySampler", MockDestroySampler);
+    mock_driver::SetFunction("vkCreateDescriptorSetLayout", MockCreateDescriptorSetLayout);
+    mock_driver::SetFunction("vkDestroyDescriptorSetLayout", MockDestroyDescriptorSetLayout);
+
+    TestEquivalentSamplersAreShared();
+    TestIgnoredSamplerMembers();
+    TestSamplerChainOrder();
+    TestUnsharedSamplers();
+    TestLayoutBindingOrder();
+    TestImmutableSamplersAreNotShared();
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -27,12 +27,22 @@
 #define LAYER_VERSION_PATCH 0
 #define LAYER_DESCRIPTION "GFXReconstruct perfetto layer"
 #define LAYER_VERSION_DESIGNATION "-dev"
+#define BASE_LAYER_DIRECT_DISPATCH
 
 #include "base_layer/base_layer.inc"
+#include "base_layer/command_buffer_tracker.inc"
 
 #include "perfetto_tracing_categories.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 static void InitializePerfetto()
 {
@@ -53,12 +63,655 @@ static void InitializePerfetto()
 typedef uint64_t(VKAPI_PTR* PFN_vkGetBlockIndexGFXR)();
 static PFN_vkGetBlockIndexGFXR GetBlockIndexGFXR_fp = nullptr;
 
+// Time the CPU spent blocked on the GPU and creating pipelines since the last present, accumulated from the wrappers
+// below.
+static std::atomic<uint64_t> frame_index{ 0 };
+static std::atomic<uint64_t> frame_blocked_ns{ 0 };
+static std::atomic<uint32_t> frame_idle_waits{ 0 };
+static std::atomic<uint64_t> frame_pipeline_ns{ 0 };
+static std::atomic<uint32_t> frame_pipelines{ 0 };
+
+static void AccumulateCpuStall(uint64_t start_ns, bool idle_wait)
+{
+    frame_blocked_ns.fetch_add(base_layer::get_timestamp_ns() - start_ns, std::memory_order_relaxed);
+
+    if (idle_wait)
+    {
+        frame_idle_waits.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+static void AccumulatePipelineCreation(uint64_t start_ns, uint32_t pipeline_count)
+{
+    frame_pipeline_ns.fetch_add(base_layer::get_timestamp_ns() - start_ns, std::memory_order_relaxed);
+    frame_pipelines.fetch_add(pipeline_count, std::memory_order_relaxed);
+}
+
+// Emits the per frame counters for the frame that just ended and starts accumulating for the next one.
+static void EmitFrameCounters()
+{
+    const uint64_t frame       = frame_index.fetch_add(1, std::memory_order_relaxed);
+    const uint64_t blocked_ns  = frame_blocked_ns.exchange(0, std::memory_order_relaxed);
+    const uint32_t idle_waits  = frame_idle_waits.exchange(0, std::memory_order_relaxed);
+    const uint64_t pipeline_ns = frame_pipeline_ns.exchange(0, std::memory_order_relaxed);
+    const uint32_t pipelines   = frame_pipelines.exchange(0, std::memory_order_relaxed);
+
+    TRACE_COUNTER("GFXR", "CPU blocked on GPU (ms)", static_cast<double>(blocked_ns) / 1000000.0);
+    TRACE_COUNTER("GFXR", "Idle waits in frame", idle_waits);
+    TRACE_COUNTER("GFXR", "Pipeline creation in frame (ms)", static_cast<double>(pipeline_ns) / 1000000.0);
+
+    if (idle_waits > 0)
+    {
+        // A full queue or device idle inside a frame serializes CPU and GPU work.
+        TRACE_EVENT_INSTANT("GFXR", "Serialization point", "frame", frame, "idle_waits", idle_waits);
+    }
+
+    if (pipeline_ns > 0)
+    {
+        // Shader and pipeline compilation on the frame's critical path shows up as a hitch.
+        TRACE_EVENT_INSTANT("GFXR",
+                            "Pipeline creation in frame",
+                            "frame",
+                            frame,
+                            "pipelines",
+                            pipelines,
+                            "ms",
+                            static_cast<double>(pipeline_ns) / 1000000.0);
+    }
+}
+
+template <typename T>
+static uint64_t HandleToUint64(T handle)
+{
+    return (uint64_t)(handle);
+}
+
+// Non-dispatchable handles are only unique per device and may equal handles of other object types, so the perfetto
+// track of an object is identified by a hash of its type, its device and its handle.
+static uint64_t GetObjectTrackUuid(VkObjectType type, VkDevice device, uint64_t handle)
+{
+    uint64_t uuid = static_cast<uint64_t>(type);
+    for (const uint64_t value : { HandleToUint64(device), handle })
+    {
+        uuid = (uuid ^ value) * 0xff51afd7ed558ccdull;
+        uuid ^= uuid >> 33;
+    }
+
+    return uuid;
+}
+
+// Acquire/present bookkeeping for each swapchain, keyed by the uuid of its track. Every present gets a sequence number
+// which is remembered per image. When an image is acquired again, the present that last queued it must have been
+// retired by the presentation engine, so the presents issued after it are the ones still queued (frames in flight).
+struct swapchain_state
+{
+    uint64_t              present_count{ 0 };
+    uint64_t              retired_present{ 0 };
+    uint32_t              acquired_images{ 0 };
+    std::vector<uint64_t> image_present_index;
+};
+
+static std::mutex                                    swapchain_lock;
+static std::unordered_map<uint64_t, swapchain_state> swapchain_states;
+
+static perfetto::Track GetSwapchainTrack(VkDevice device, VkSwapchainKHR swapchain)
+{
+    return perfetto::Track(GetObjectTrackUuid(VK_OBJECT_TYPE_SWAPCHAIN_KHR, device, HandleToUint64(swapchain)));
+}
+
+static void AddSwapchain(VkDevice device, VkSwapchainKHR swapchain)
+{
+    const perfetto::Track track = GetSwapchainTrack(device, swapchain);
+
+    {
+        std::lock_guard<std::mutex> lock(swapchain_lock);
+        swapchain_states[track.uuid] = swapchain_state();
+    }
+
+    std::stringstream track_name;
+    track_name << "Swapchain 0x" << std::hex << HandleToUint64(swapchain);
+
+    auto desc = track.Serialize();
+    desc.set_name(track_name.str());
+    perfetto::TrackEvent::SetTrackDescriptor(track, desc);
+}
+
+static void RemoveSwapchain(VkDevice device, VkSwapchainKHR swapchain)
+{
+    std::lock_guard<std::mutex> lock(swapchain_lock);
+    swapchain_states.erase(GetSwapchainTrack(device, swapchain).uuid);
+}
+
+// Closes the acquire slice opened on the swapchain's track and updates its counters.
+static void TraceSwapchainAcquire(VkDevice        device,
+                                  VkSwapchainKHR  swapchain,
+                                  VkResult        result,
+                                  const uint32_t* pImageIndex)
+{
+    const perfetto::Track track = GetSwapchainTrack(device, swapchain);
+    const bool acquired = ((result == VK_SUCCESS) || (result == VK_SUBOPTIMAL_KHR)) && (pImageIndex != nullptr);
+
+    if (!acquired)
+    {
+        TRACE_EVENT_END("GFXR", track, "result", static_cast<int32_t>(result));
+        return;
+    }
+
+    const uint32_t image_index      = *pImageIndex;
+    uint64_t       frames_in_flight = 0;
+    uint32_t       acquired_images  = 0;
+    {
+        std::lock_guard<std::mutex> lock(swapchain_lock);
+        swapchain_state&            state = swapchain_states[track.uuid];
+
+        if (image_index < state.image_present_index.size())
+        {
+            state.retired_present = std::max(state.retired_present, state.image_present_index[image_index]);
+        }
+
+        frames_in_flight = state.present_count - state.retired_present;
+        acquired_images  = ++state.acquired_images;
+    }
+
+    TRACE_EVENT_END("GFXR", track, "imageIndex", image_index, "result", static_cast<int32_t>(result));
+    TRACE_COUNTER("GFXR", perfetto::CounterTrack("Frames in flight", track), frames_in_flight);
+    TRACE_COUNTER("GFXR", perfetto::CounterTrack("Acquired images", track), acquired_images);
+}
+
+static void TraceSwapchainPresent(VkDevice device, VkSwapchainKHR swapchain, uint32_t image_index)
+{
+    const perfetto::Track track            = GetSwapchainTrack(device, swapchain);
+    uint64_t              frames_in_flight = 0;
+    uint32_t              acquired_images  = 0;
+    {
+        std::lock_guard<std::mutex> lock(swapchain_lock);
+        swapchain_state&            state = swapchain_states[track.uuid];
+
+        if (image_index >= state.image_present_index.size())
+        {
+            state.image_present_index.resize(image_index + 1, 0);
+        }
+
+        state.image_present_index[image_index] = ++state.present_count;
+
+        if (state.acquired_images > 0)
+        {
+            --state.acquired_images;
+        }
+
+        frames_in_flight = state.present_count - state.retired_present;
+        acquired_images  = state.acquired_images;
+    }
+
+    TRACE_EVENT_INSTANT("GFXR", "vkQueuePresentKHR", track, "imageIndex", image_index);
+    TRACE_COUNTER("GFXR", perfetto::CounterTrack("Frames in flight", track), frames_in_flight);
+    TRACE_COUNTER("GFXR", perfetto::CounterTrack("Acquired images", track), acquired_images);
+}
+
+// Live device memory per heap and per memory type of a device, kept as the layer data of the device's dispatch table.
+// All counters are atomics so that allocation calls from different threads only contend on the shard that holds their
+// allocation record.
+struct device_memory_state
+{
+    VkDevice                         device{ VK_NULL_HANDLE };
+    VkPhysicalDeviceMemoryProperties properties{};
+    std::atomic<int64_t>             heap_bytes[VK_MAX_MEMORY_HEAPS]{};
+    std::atomic<int64_t>             heap_allocations[VK_MAX_MEMORY_HEAPS]{};
+    std::atomic<int64_t>             type_bytes[VK_MAX_MEMORY_TYPES]{};
+    std::atomic<int64_t>             type_allocations[VK_MAX_MEMORY_TYPES]{};
+    std::atomic<int64_t>             mapped_bytes{ 0 };
+    std::atomic<uint32_t>            frame_churn{ 0 };
+    std::atomic<uint32_t>            frame_binds{ 0 };
+};
+
+struct memory_allocation
+{
+    device_memory_state* state{ nullptr };
+    VkDeviceSize         size{ 0 };
+    VkDeviceSize         mapped_size{ 0 };
+    uint32_t             type_index{ 0 };
+    uint32_t             heap_index{ 0 };
+};
+
+// Memory handles are only unique per device, so allocation records are keyed by both.
+struct memory_allocation_key
+{
+    VkDevice       device{ VK_NULL_HANDLE };
+    VkDeviceMemory memory{ VK_NULL_HANDLE };
+
+    bool operator==(const memory_allocation_key& other) const
+    {
+        return (device == other.device) && (memory == other.memory);
+    }
+};
+
+struct memory_allocation_key_hasher
+{
+    size_t operator()(const memory_allocation_key& key) const
+    {
+        return static_cast<size_t>(
+            GetObjectTrackUuid(VK_OBJECT_TYPE_DEVICE_MEMORY, key.device, HandleToUint64(key.memory)));
+    }
+};
+
+// Allocation records are spread over independently locked shards selected by the device and the memory handle.
+struct memory_allocation_shard
+{
+    std::mutex                                                                                 lock;
+    std::unordered_map<memory_allocation_key, memory_allocation, memory_allocation_key_hasher> allocations;
+};
+
+static constexpr size_t kMemoryAllocationShardCount = 64;
+static memory_allocation_shard memory_allocation_shards[kMemoryAllocationShardCount];
+
+static memory_allocation_shard& GetMemoryAllocationShard(const memory_allocation_key& key)
+{
+    // The low bits of the hash select the bucket of the shard's map
+    const uint64_t hash = GetObjectTrackUuid(VK_OBJECT_TYPE_DEVICE_MEMORY, key.device, HandleToUint64(key.memory));
+    return memory_allocation_shards[(hash >> 32) % kMemoryAllocationShardCount];
+}
+
+static void AddDeviceMemoryState(VkPhysicalDevice physicalDevice, base_layer::device_dispatch_table* device_table)
+{
+    device_memory_state* state = new device_memory_state();
+    state->device              = device_table->device;
+
+    base_layer::instance_dispatch_table* instance_table = base_layer::get_physical_device_instance(physicalDevice);
+    if (instance_table && instance_table->dispatch_table.GetPhysicalDeviceMemoryProperties)
+    {
+        instance_table->dispatch_table.GetPhysicalDeviceMemoryProperties(physicalDevice, &state->properties);
+    }
+
+    device_table->layer_data = state;
+}
+
+static void RemoveDeviceMemoryState(base_layer::device_dispatch_table* device_table)
+{
+    std::unique_ptr<device_memory_state> state(static_cast<device_memory_state*>(device_table->layer_data));
+    device_table->layer_data = nullptr;
+    if (state == nullptr)
+    {
+        return;
+    }
+
+    // Drop the records of allocations the application did not free before destroying the device.
+    for (memory_allocation_shard& shard : memory_allocation_shards)
+    {
+        std::lock_guard<std::mutex> shard_lock(shard.lock);
+        for (auto it = shard.allocations.begin(); it != shard.allocations.end();)
+        {
+            it = (it->second.state == state.get()) ? shard.allocations.erase(it) : std::next(it);
+        }
+    }
+}
+
+static device_memory_state* GetDeviceMemoryState(const base_layer::device_dispatch_table* device_table)
+{
+    return static_cast<device_memory_state*>(device_table->layer_data);
+}
+
+static void TrackMemoryAllocation(const base_layer::device_dispatch_table* device_table,
+                                  VkDeviceMemory                           memory,
+                                  const VkMemoryAllocateInfo*              pAllocateInfo)
+{
+    device_memory_state* state = GetDeviceMemoryState(device_table);
+    if ((state == nullptr) || (pAllocateInfo->memoryTypeIndex >= state->properties.memoryTypeCount))
+    {
+        return;
+    }
+
+    memory_allocation allocation;
+    allocation.state      = state;
+    allocation.size       = pAllocateInfo->allocationSize;
+    allocation.type_index = pAllocateInfo->memoryTypeIndex;
+    allocation.heap_index = state->properties.memoryTypes[allocation.type_index].heapIndex;
+
+    state->heap_bytes[allocation.heap_index].fetch_add(allocation.size, std::memory_order_relaxed);
+    state->heap_allocations[allocation.heap_index].fetch_add(1, std::memory_order_relaxed);
+    state->type_bytes[allocation.type_index].fetch_add(allocation.size, std::memory_order_relaxed);
+    state->type_allocations[allocation.type_index].fetch_add(1, std::memory_order_relaxed);
+    state->frame_churn.fetch_add(1, std::memory_order_relaxed);
+
+    const memory_allocation_key key{ device_table->device, memory };
+    memory_allocation_shard&    shard = GetMemoryAllocationShard(key);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    shard.allocations[key] = allocation;
+}
+
+static void TrackMemoryFree(VkDevice device, VkDeviceMemory memory)
+{
+    const memory_allocation_key key{ device, memory };
+    memory_allocation           allocation;
+    {
+        memory_allocation_shard&    shard = GetMemoryAllocationShard(key);
+        std::lock_guard<std::mutex> lock(shard.lock);
+        auto                        entry = shard.allocations.find(key);
+        if (entry == shard.allocations.end())
+        {
+            return;
+        }
+
+        allocation = entry->second;
+        shard.allocations.erase(entry);
+    }
+
+    device_memory_state* state = allocation.state;
+    state->heap_bytes[allocation.heap_index].fetch_sub(allocation.size, std::memory_order_relaxed);
+    state->heap_allocations[allocation.heap_index].fetch_sub(1, std::memory_order_relaxed);
+    state->type_bytes[allocation.type_index].fetch_sub(allocation.size, std::memory_order_relaxed);
+    state->type_allocations[allocation.type_index].fetch_sub(1, std::memory_order_relaxed);
+    state->mapped_bytes.fetch_sub(allocation.mapped_size, std::memory_order_relaxed);
+    state->frame_churn.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void TrackMemoryMap(VkDevice device, VkDeviceMemory memory, VkDeviceSize offset, VkDeviceSize size, bool map)
+{
+    const memory_allocation_key key{ device, memory };
+    memory_allocation_shard&    shard = GetMemoryAllocationShard(key);
+    std::lock_guard<std::mutex> lock(shard.lock);
+    auto                        entry = shard.allocations.find(key);
+    if (entry != shard.allocations.end())
+    {
+        memory_allocation& allocation = entry->second;
+        allocation.state->mapped_bytes.fetch_sub(allocation.mapped_size, std::memory_order_relaxed);
+
+        if (map)
+        {
+            allocation.mapped_size = (size == VK_WHOLE_SIZE) ? (allocation.size - offset) : size;
+        }
+        else
+        {
+            allocation.mapped_size = 0;
+        }
+
+        allocation.state->mapped_bytes.fetch_add(allocation.mapped_size, std::memory_order_relaxed);
+    }
+}
+
+static void TrackMemoryBinds(const base_layer::device_dispatch_table* device_table,
+                             VkResult                                 result,
+                             uint32_t                                 bind_count)
+{
+    device_memory_state* state = GetDeviceMemoryState(device_table);
+    if ((state != nullptr) && (result == VK_SUCCESS))
+    {
+        state->frame_binds.fetch_add(bind_count, std::memory_order_relaxed);
+    }
+}
+
+// Emits the memory counters of a device on its own track and resets the per frame ones.
+static void EmitMemoryCounters(const base_layer::device_dispatch_table* device_table)
+{
+    device_memory_state* state = GetDeviceMemoryState(device_table);
+    if (state == nullptr)
+    {
+        return;
+    }
+
+    const VkDevice        device = device_table->device;
+    const perfetto::Track track(GetObjectTrackUuid(VK_OBJECT_TYPE_DEVICE, device, HandleToUint64(device)));
+
+    for (uint32_t i = 0; i < state->properties.memoryHeapCount; ++i)
+    {
+        const std::string heap = "Heap " + std::to_string(i);
+        TRACE_COUNTER("GFXR",
+                      perfetto::CounterTrack(perfetto::DynamicString{ heap + " live bytes" }, track),
+                      state->heap_bytes[i].load(std::memory_order_relaxed));
+        TRACE_COUNTER("GFXR",
+                      perfetto::CounterTrack(perfetto::DynamicString{ heap + " allocations" }, track),
+                      state->heap_allocations[i].load(std::memory_order_relaxed));
+    }
+
+    for (uint32_t i = 0; i < state->properties.memoryTypeCount; ++i)
+    {
+        const std::string type = "Memory type " + std::to_string(i);
+        TRACE_COUNTER("GFXR",
+                      perfetto::CounterTrack(perfetto::DynamicString{ type + " live bytes" }, track),
+                      state->type_bytes[i].load(std::memory_order_relaxed));
+        TRACE_COUNTER("GFXR",
+                      perfetto::CounterTrack(perfetto::DynamicString{ type + " allocations" }, track),
+                      state->type_allocations[i].load(std::memory_order_relaxed));
+    }
+
+    TRACE_COUNTER("GFXR",
+                  perfetto::CounterTrack("Mapped bytes", track),
+                  state->mapped_bytes.load(std::memory_order_relaxed));
+    TRACE_COUNTER("GFXR",
+                  perfetto::CounterTrack("Allocation churn", track),
+                  state->frame_churn.exchange(0, std::memory_order_relaxed));
+    TRACE_COUNTER("GFXR",
+                  perfetto::CounterTrack("Memory binds", track),
+                  state->frame_binds.exchange(0, std::memory_order_relaxed));
+}
+
+// Devices on which VkPipelineCreationFeedbackCreateInfo can be chained into pipeline create infos, either because
+// VK_EXT_pipeline_creation_feedback was enabled or because both the instance and the device are Vulkan 1.3.
+static std::mutex                               pipeline_feedback_lock;
+static std::unordered_map<VkInstance, uint32_t> instance_api_versions;
+static std::unordered_set<VkDevice>             pipeline_feedback_devices;
+
+static void AddPipelineFeedbackSupport(VkPhysicalDevice          physicalDevice,
+                                       const VkDeviceCreateInfo* pCreateInfo,
+                                       VkDevice                  device)
+{
+    bool supported = false;
+
+    for (uint32_t i = 0; (i < pCreateInfo->enabledExtensionCount) && !supported; ++i)
+    {
+        supported =
+            (strcmp(pCreateInfo->ppEnabledExtensionNames[i], VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME) == 0);
+    }
+
+    base_layer::instance_dispatch_table* instance_table = base_layer::get_physical_device_instance(physicalDevice);
+    if (!supported && instance_table && instance_table->dispatch_table.GetPhysicalDeviceProperties)
+    {
+        VkPhysicalDeviceProperties properties;
+        instance_table->dispatch_table.GetPhysicalDeviceProperties(physicalDevice, &properties);
+
+        std::lock_guard<std::mutex> lock(pipeline_feedback_lock);
+        auto                        entry = instance_api_versions.find(instance_table->instance);
+        supported = (entry != instance_api_versions.end()) && (entry->second >= VK_API_VERSION_1_3) &&
+                    (properties.apiVersion >= VK_API_VERSION_1_3);
+    }
+
+    if (supported)
+    {
+        std::lock_guard<std::mutex> lock(pipeline_feedback_lock);
+        pipeline_feedback_devices.insert(device);
+    }
+}
+
+static bool IsPipelineFeedbackSupported(VkDevice device)
+{
+    std::lock_guard<std::mutex> lock(pipeline_feedback_lock);
+    return pipeline_feedback_devices.find(device) != pipeline_feedback_devices.end();
+}
+
+// Collects the VkPipelineCreationFeedback of every pipeline in a vkCreate*Pipelines call. Feedback chained by the
+// application is read in place, otherwise a VkPipelineCreationFeedbackCreateInfo is chained into a copy of the
+// create info when the device supports it.
+template <typename CreateInfo>
+class pipeline_feedback
+{
+  public:
+    const CreateInfo* Prepare(uint32_t count, const CreateInfo* pCreateInfos, bool inject)
+    {
+        if (pCreateInfos == nullptr)
+        {
+            return pCreateInfos;
+        }
+
+        create_infos_.assign(pCreateInfos, pCreateInfos + count);
+        feedback_infos_.resize(count);
+        feedbacks_.resize(count);
+        results_.assign(count, nullptr);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const VkBaseInStructure* next = reinterpret_cast<const VkBaseInStructure*>(pCreateInfos[i].pNext);
+            while ((next != nullptr) && (next->sType != VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO))
+            {
+                next = next->pNext;
+            }
+
+            if (next != nullptr)
+            {
+                results_[i] =
+                    reinterpret_cast<const VkPipelineCreationFeedbackCreateInfo*>(next)->pPipelineCreationFeedback;
+            }
+            else if (inject)
+            {
+                feedbacks_[i]      = {};
+                feedback_infos_[i] = { VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+                                       create_infos_[i].pNext,
+                                       &feedbacks_[i],
+                                       0,
+                                       nullptr };
+
+                create_infos_[i].pNext = &feedback_infos_[i];
+                results_[i]            = &feedbacks_[i];
+            }
+        }
+
+        return create_infos_.data();
+    }
+
+    // Number of pipelines for which feedback was reported.
+    uint32_t GetReportedCount() const
+    {
+        uint32_t count = 0;
+        for (const VkPipelineCreationFeedback* feedback : results_)
+        {
+            if ((feedback != nullptr) && ((feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) != 0))
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    uint32_t GetCacheHitCount() const
+    {
+        uint32_t count = 0;
+        for (const VkPipelineCreationFeedback* feedback : results_)
+        {
+            if ((feedback != nullptr) && ((feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) != 0) &&
+                ((feedback->flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0))
+            {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+  private:
+    std::vector<CreateInfo>                           create_infos_;
+    std::vector<VkPipelineCreationFeedbackCreateInfo> feedback_infos_;
+    std::vector<VkPipelineCreationFeedback>           feedbacks_;
+    std::vector<const VkPipelineCreationFeedback*>    results_;
+};
+
+template <typename CreateInfo>
+static void TracePipelineCreationEnd(const pipeline_feedback<CreateInfo>& feedback, VkResult result)
+{
+    TRACE_EVENT_END("GFXR",
+                    "result",
+                    static_cast<int32_t>(result),
+                    "feedbackReported",
+                    feedback.GetReportedCount(),
+                    "cacheHits",
+                    feedback.GetCacheHitCount());
+}
+
+// Per command buffer recording statistics. They are only collected when the GFXR_PERFETTO_RECORDING_STATS
+// environment variable (debug.gfxr.perfetto.recording_stats property on Android) is enabled, as that requires
+// intercepting the vkCmd* calls.
+struct command_buffer_stats
+{
+    uint32_t draws{ 0 };
+    uint32_t dispatches{ 0 };
+    uint32_t barriers{ 0 };
+    uint32_t descriptor_binds{ 0 };
+};
+
+// Records are attached to their command buffer as the layer data of the base layer's child handle table, which is what
+// the recording and submit paths look them up through.
+struct command_buffer_record
+{
+    command_buffer_stats stats;
+};
+
+using recording_context = base_layer::command_buffer_tracker<command_buffer_record>::recording_context;
+
+static base_layer::command_buffer_tracker<command_buffer_record> command_buffers;
+static thread_local command_buffer_stats                         untracked_stats;
+
+static bool IsRecordingStatsEnabled()
+{
+    static const bool enabled =
+        base_layer::is_layer_setting_enabled("GFXR_PERFETTO_RECORDING_STATS", "debug.gfxr.perfetto.recording_stats");
+    return enabled;
+}
+
+// Command buffers that were not allocated through the layer are counted in statistics that are never reported
+static command_buffer_stats* GetRecordingStats(recording_context* context)
+{
+    return (context->record != nullptr) ? &context->record->stats : &untracked_stats;
+}
+
+static command_buffer_record* GetCommandBufferRecord(VkCommandBuffer commandBuffer)
+{
+    base_layer::child_handle_info info;
+    return base_layer::get_child_handle(commandBuffer, &info) ? static_cast<command_buffer_record*>(info.layer_data)
+                                                              : nullptr;
+}
+
+static void ResetCommandBufferStats(VkCommandBuffer commandBuffer)
+{
+    command_buffer_record* record = GetCommandBufferRecord(commandBuffer);
+    if (record != nullptr)
+    {
+        record->stats = {};
+    }
+}
+
+static command_buffer_stats GetSubmitStats(uint32_t submitCount, const VkSubmitInfo* pSubmits)
+{
+    command_buffer_stats totals;
+
+    for (uint32_t i = 0; i < submitCount; ++i)
+    {
+        for (uint32_t j = 0; j < pSubmits[i].commandBufferCount; ++j)
+        {
+            const command_buffer_record* record = GetCommandBufferRecord(pSubmits[i].pCommandBuffers[j]);
+            if (record != nullptr)
+            {
+                totals.draws += record->stats.draws;
+                totals.dispatches += record->stats.dispatches;
+                totals.barriers += record->stats.barriers;
+                totals.descriptor_binds += record->stats.descriptor_binds;
+            }
+        }
+    }
+
+    return totals;
+}
+
 VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
                                                     const VkAllocationCallbacks* pAllocator,
                                                     VkInstance*                  pInstance)
 {
     InitializePerfetto();
 
+    {
+        const uint32_t api_version = (pCreateInfo->pApplicationInfo != nullptr)
+                                         ? pCreateInfo->pApplicationInfo->apiVersion
+                                         : VK_API_VERSION_1_0;
+
+        std::lock_guard<std::mutex> lock(pipeline_feedback_lock);
+        instance_api_versions[*pInstance] = api_version;
+    }
+
     base_layer::instance_dispatch_table* instance_table = base_layer::get_instance_handle(*pInstance);
 
     if (instance_table && instance_table->dispatch_table.GetInstanceProcAddr)
@@ -102,6 +755,9 @@ VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             p
             base_layer::base_layer_print_error(
                 "Pointer to QueuePresentKHR in dispatch table for device %p has not been initialized\n", *pDevice);
         }
+
+        AddDeviceMemoryState(physicalDevice, device_table);
+        AddPipelineFeedbackSupport(physicalDevice, pCreateInfo, *pDevice);
     }
     else
     {
@@ -138,6 +794,15 @@ VKAPI_ATTR VkResult VKAPI_CALL layer_QueueSubmit(VkQueue             queue,
                     perfetto::DynamicString{ "vkCommandBuffer: " + std::to_string(i) },
                     perfetto::DynamicString(cmd_buf_ptr.str()));
             }
+
+            if (IsRecordingStatsEnabled())
+            {
+                const command_buffer_stats totals = GetSubmitStats(submitCount, pSubmits);
+                ctx.AddDebugAnnotation("draws", totals.draws);
+                ctx.AddDebugAnnotation("dispatches", totals.dispatches);
+                ctx.AddDebugAnnotation("barriers", totals.barriers);
+                ctx.AddDebugAnnotation("descriptorBinds", totals.descriptor_binds);
+            }
         });
     }
     else
@@ -163,22 +828,1137 @@ VKAPI_ATTR VkResult VKAPI_CALL layer_QueuePresentKHR(VkQueue queue, const VkPres
         ctx.AddDebugAnnotation(perfetto::DynamicString{ "QueuePresent:" }, block_index);
     });
 
-    return result;
-}
-
+    if (device_table && pPresentInfo && pPresentInfo->pSwapchains && pPresentInfo->pImageIndices)
+    {
+        for (uint32_t i = 0; i < pPresentInfo->swapchainCount; ++i)
+        {
+            TraceSwapchainPresent(device_table->device, pPresentInfo->pSwapchains[i], pPresentInfo->pImageIndices[i]);
+        }
+    }
+
+    if (device_table)
+    {
+        EmitMemoryCounters(device_table);
+    }
+
+    EmitFrameCounters();
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+    {
+        std::lock_guard<std::mutex> lock(pipeline_feedback_lock);
+        instance_api_versions.erase(instance);
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the instance's dispatch table
+    base_layer::base_layer_DestroyInstance(instance, pAllocator);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table != nullptr)
+    {
+        RemoveDeviceMemoryState(device_table);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pipeline_feedback_lock);
+        pipeline_feedback_devices.erase(device);
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_AllocateMemory(VkDevice                     device,
+                                                    const VkMemoryAllocateInfo*  pAllocateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkDeviceMemory*              pMemory)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.AllocateMemory && pAllocateInfo)
+    {
+        TRACE_EVENT("GFXR",
+                    "vkAllocateMemory",
+                    "allocationSize",
+                    pAllocateInfo->allocationSize,
+                    "memoryTypeIndex",
+                    pAllocateInfo->memoryTypeIndex);
+
+        result = device_table->dispatch_table.AllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+
+        if (result == VK_SUCCESS)
+        {
+            TrackMemoryAllocation(device_table, *pMemory, pAllocateInfo);
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_FreeMemory(VkDevice                     device,
+                                            VkDeviceMemory               memory,
+                                            const VkAllocationCallbacks* pAllocator)
+{
+    if (memory != VK_NULL_HANDLE)
+    {
+        TrackMemoryFree(device, memory);
+    }
+
+    // Forward function to next layer / driver
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.FreeMemory)
+    {
+        TRACE_EVENT("GFXR", "vkFreeMemory");
+        device_table->dispatch_table.FreeMemory(device, memory, pAllocator);
+    }
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_MapMemory(VkDevice         device,
+                                               VkDeviceMemory   memory,
+                                               VkDeviceSize     offset,
+                                               VkDeviceSize     size,
+                                               VkMemoryMapFlags flags,
+                                               void**           ppData)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.MapMemory)
+    {
+        result = device_table->dispatch_table.MapMemory(device, memory, offset, size, flags, ppData);
+
+        if (result == VK_SUCCESS)
+        {
+            TrackMemoryMap(device, memory, offset, size, true);
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_UnmapMemory(VkDevice device, VkDeviceMemory memory)
+{
+    TrackMemoryMap(device, memory, 0, 0, false);
+
+    // Forward function to next layer / driver
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.UnmapMemory)
+    {
+        device_table->dispatch_table.UnmapMemory(device, memory);
+    }
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindBufferMemory(VkDevice       device,
+                                                      VkBuffer       buffer,
+                                                      VkDeviceMemory memory,
+                                                      VkDeviceSize   memoryOffset)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.BindBufferMemory)
+    {
+        result = device_table->dispatch_table.BindBufferMemory(device, buffer, memory, memoryOffset);
+        TrackMemoryBinds(device_table, result, 1);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindImageMemory(VkDevice       device,
+                                                     VkImage        image,
+                                                     VkDeviceMemory memory,
+                                                     VkDeviceSize   memoryOffset)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.BindImageMemory)
+    {
+        result = device_table->dispatch_table.BindImageMemory(device, image, memory, memoryOffset);
+        TrackMemoryBinds(device_table, result, 1);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindBufferMemory2(VkDevice                      device,
+                                                       uint32_t                      bindInfoCount,
+                                                       const VkBindBufferMemoryInfo* pBindInfos)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.BindBufferMemory2)
+    {
+        result = device_table->dispatch_table.BindBufferMemory2(device, bindInfoCount, pBindInfos);
+        TrackMemoryBinds(device_table, result, bindInfoCount);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindBufferMemory2KHR(VkDevice                      device,
+                                                          uint32_t                      bindInfoCount,
+                                                          const VkBindBufferMemoryInfo* pBindInfos)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.BindBufferMemory2KHR)
+    {
+        result = device_table->dispatch_table.BindBufferMemory2KHR(device, bindInfoCount, pBindInfos);
+        TrackMemoryBinds(device_table, result, bindInfoCount);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindImageMemory2(VkDevice                     device,
+                                                      uint32_t                     bindInfoCount,
+                                                      const VkBindImageMemoryInfo* pBindInfos)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.BindImageMemory2)
+    {
+        result = device_table->dispatch_table.BindImageMemory2(device, bindInfoCount, pBindInfos);
+        TrackMemoryBinds(device_table, result, bindInfoCount);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindImageMemory2KHR(VkDevice                     device,
+                                                         uint32_t                     bindInfoCount,
+                                                         const VkBindImageMemoryInfo* pBindInfos)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.BindImageMemory2KHR)
+    {
+        result = device_table->dispatch_table.BindImageMemory2KHR(device, bindInfoCount, pBindInfos);
+        TrackMemoryBinds(device_table, result, bindInfoCount);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateShaderModule(VkDevice                        device,
+                                                        const VkShaderModuleCreateInfo* pCreateInfo,
+                                                        const VkAllocationCallbacks*    pAllocator,
+                                                        VkShaderModule*                 pShaderModule)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.CreateShaderModule)
+    {
+        TRACE_EVENT("GFXR", "vkCreateShaderModule", "codeSize", pCreateInfo ? pCreateInfo->codeSize : 0);
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result = device_table->dispatch_table.CreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
+        AccumulatePipelineCreation(start_ns, 0);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateGraphicsPipelines(VkDevice                            device,
+                                                             VkPipelineCache                     pipelineCache,
+                                                             uint32_t                            createInfoCount,
+                                                             const VkGraphicsPipelineCreateInfo* pCreateInfos,
+                                                             const VkAllocationCallbacks*        pAllocator,
+                                                             VkPipeline*                         pPipelines)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.CreateGraphicsPipelines)
+    {
+        pipeline_feedback<VkGraphicsPipelineCreateInfo> feedback;
+        const VkGraphicsPipelineCreateInfo*             create_infos =
+            feedback.Prepare(createInfoCount, pCreateInfos, IsPipelineFeedbackSupported(device));
+
+        TRACE_EVENT_BEGIN("GFXR",
+                          "vkCreateGraphicsPipelines",
+                          "pipelineCount",
+                          createInfoCount,
+                          "pipelineCache",
+                          HandleToUint64(pipelineCache));
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.CreateGraphicsPipelines(
+            device, pipelineCache, createInfoCount, create_infos, pAllocator, pPipelines);
+        AccumulatePipelineCreation(start_ns, createInfoCount);
+
+        TracePipelineCreationEnd(feedback, result);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateComputePipelines(VkDevice                           device,
+                                                            VkPipelineCache                    pipelineCache,
+                                                            uint32_t                           createInfoCount,
+                                                            const VkComputePipelineCreateInfo* pCreateInfos,
+                                                            const VkAllocationCallbacks*       pAllocator,
+                                                            VkPipeline*                        pPipelines)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.CreateComputePipelines)
+    {
+        pipeline_feedback<VkComputePipelineCreateInfo> feedback;
+        const VkComputePipelineCreateInfo*             create_infos =
+            feedback.Prepare(createInfoCount, pCreateInfos, IsPipelineFeedbackSupported(device));
+
+        TRACE_EVENT_BEGIN("GFXR",
+                          "vkCreateComputePipelines",
+                          "pipelineCount",
+                          createInfoCount,
+                          "pipelineCache",
+                          HandleToUint64(pipelineCache));
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.CreateComputePipelines(
+            device, pipelineCache, createInfoCount, create_infos, pAllocator, pPipelines);
+        AccumulatePipelineCreation(start_ns, createInfoCount);
+
+        TracePipelineCreationEnd(feedback, result);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+layer_CreateRayTracingPipelinesKHR(VkDevice                                 device,
+                                   VkDeferredOperationKHR                   deferredOperation,
+                                   VkPipelineCache                          pipelineCache,
+                                   uint32_t                                 createInfoCount,
+                                   const VkRayTracingPipelineCreateInfoKHR* pCreateInfos,
+                                   const VkAllocationCallbacks*             pAllocator,
+                                   VkPipeline*                              pPipelines)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.CreateRayTracingPipelinesKHR)
+    {
+        // Feedback of deferred creations is only written once the deferred operation completes.
+        const bool inject = (deferredOperation == VK_NULL_HANDLE) && IsPipelineFeedbackSupported(device);
+
+        pipeline_feedback<VkRayTracingPipelineCreateInfoKHR> feedback;
+        const VkRayTracingPipelineCreateInfoKHR* create_infos = feedback.Prepare(createInfoCount, pCreateInfos, inject);
+
+        TRACE_EVENT_BEGIN("GFXR",
+                          "vkCreateRayTracingPipelinesKHR",
+                          "pipelineCount",
+                          createInfoCount,
+                          "pipelineCache",
+                          HandleToUint64(pipelineCache),
+                          "deferred",
+                          deferredOperation != VK_NULL_HANDLE);
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.CreateRayTracingPipelinesKHR(
+            device, deferredOperation, pipelineCache, createInfoCount, create_infos, pAllocator, pPipelines);
+        AccumulatePipelineCreation(start_ns, createInfoCount);
+
+        TracePipelineCreationEnd(feedback, result);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateSwapchainKHR(VkDevice                        device,
+                                                        const VkSwapchainCreateInfoKHR* pCreateInfo,
+                                                        const VkAllocationCallbacks*    pAllocator,
+                                                        VkSwapchainKHR*                 pSwapchain)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.CreateSwapchainKHR)
+    {
+        result = device_table->dispatch_table.CreateSwapchainKHR(device, pCreateInfo, pAllocator, pSwapchain);
+    }
+
+    if ((result == VK_SUCCESS) && pSwapchain && (*pSwapchain != VK_NULL_HANDLE))
+    {
+        AddSwapchain(device, *pSwapchain);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroySwapchainKHR(VkDevice                     device,
+                                                     VkSwapchainKHR               swapchain,
+                                                     const VkAllocationCallbacks* pAllocator)
+{
+    RemoveSwapchain(device, swapchain);
+
+    // Forward function to next layer / driver
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.DestroySwapchainKHR)
+    {
+        device_table->dispatch_table.DestroySwapchainKHR(device, swapchain, pAllocator);
+    }
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_AcquireNextImageKHR(VkDevice       device,
+                                                         VkSwapchainKHR swapchain,
+                                                         uint64_t       timeout,
+                                                         VkSemaphore    semaphore,
+                                                         VkFence        fence,
+                                                         uint32_t*      pImageIndex)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.AcquireNextImageKHR)
+    {
+        TRACE_EVENT_BEGIN("GFXR", "vkAcquireNextImageKHR", GetSwapchainTrack(device, swapchain), "timeout", timeout);
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.AcquireNextImageKHR(
+            device, swapchain, timeout, semaphore, fence, pImageIndex);
+        AccumulateCpuStall(start_ns, false);
+
+        TraceSwapchainAcquire(device, swapchain, result, pImageIndex);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_AcquireNextImage2KHR(VkDevice                         device,
+                                                          const VkAcquireNextImageInfoKHR* pAcquireInfo,
+                                                          uint32_t*                        pImageIndex)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.AcquireNextImage2KHR && pAcquireInfo)
+    {
+        TRACE_EVENT_BEGIN("GFXR",
+                          "vkAcquireNextImage2KHR",
+                          GetSwapchainTrack(device, pAcquireInfo->swapchain),
+                          "timeout",
+                          pAcquireInfo->timeout);
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.AcquireNextImage2KHR(device, pAcquireInfo, pImageIndex);
+        AccumulateCpuStall(start_ns, false);
+
+        TraceSwapchainAcquire(device, pAcquireInfo->swapchain, result, pImageIndex);
+    }
+
+    return result;
+}
+
 VKAPI_PTR void VKAPI_CALL layer_FrameBoundaryANDROID(VkDevice device, VkSemaphore semaphore, VkImage image)
 {
     // Forward function to next layer / driver
     base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
-    if (device_table && device_table->dispatch_table.FrameBoundaryANDROID)
+    if (device_table && device_table->dispatch_table.FrameBoundaryANDROID)
+    {
+        device_table->dispatch_table.FrameBoundaryANDROID(device, semaphore, image);
+    }
+
+    const uint64_t block_index = GetBlockIndexGFXR_fp ? GetBlockIndexGFXR_fp() : 0;
+    TRACE_EVENT_INSTANT("GFXR", "FrameBoundaryANDROID", [&](perfetto::EventContext ctx) {
+        ctx.AddDebugAnnotation(perfetto::DynamicString{ "FrameBoundaryANDROID:" }, block_index);
+    });
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitForFences(VkDevice       device,
+                                                   uint32_t       fenceCount,
+                                                   const VkFence* pFences,
+                                                   VkBool32       waitAll,
+                                                   uint64_t       timeout)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.WaitForFences)
+    {
+        TRACE_EVENT("GFXR",
+                    "vkWaitForFences",
+                    "fenceCount",
+                    fenceCount,
+                    "waitAll",
+                    static_cast<bool>(waitAll),
+                    "timeout",
+                    timeout);
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.WaitForFences(
+            device, fenceCount, pFences, waitAll, timeout);
+        AccumulateCpuStall(start_ns, false);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitSemaphores(VkDevice                   device,
+                                                    const VkSemaphoreWaitInfo* pWaitInfo,
+                                                    uint64_t                   timeout)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.WaitSemaphores)
+    {
+        TRACE_EVENT("GFXR",
+                    "vkWaitSemaphores",
+                    "semaphoreCount",
+                    pWaitInfo ? pWaitInfo->semaphoreCount : 0,
+                    "timeout",
+                    timeout);
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.WaitSemaphores(device, pWaitInfo, timeout);
+        AccumulateCpuStall(start_ns, false);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitSemaphoresKHR(VkDevice                   device,
+                                                       const VkSemaphoreWaitInfo* pWaitInfo,
+                                                       uint64_t                   timeout)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.WaitSemaphoresKHR)
+    {
+        TRACE_EVENT("GFXR",
+                    "vkWaitSemaphoresKHR",
+                    "semaphoreCount",
+                    pWaitInfo ? pWaitInfo->semaphoreCount : 0,
+                    "timeout",
+                    timeout);
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.WaitSemaphoresKHR(device, pWaitInfo, timeout);
+        AccumulateCpuStall(start_ns, false);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueueWaitIdle(VkQueue queue)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(queue);
+    if (device_table && device_table->dispatch_table.QueueWaitIdle)
+    {
+        TRACE_EVENT("GFXR", "vkQueueWaitIdle");
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.QueueWaitIdle(queue);
+        AccumulateCpuStall(start_ns, true);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_DeviceWaitIdle(VkDevice device)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.DeviceWaitIdle)
+    {
+        TRACE_EVENT("GFXR", "vkDeviceWaitIdle");
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.DeviceWaitIdle(device);
+        AccumulateCpuStall(start_ns, true);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetFenceStatus(VkDevice device, VkFence fence)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.GetFenceStatus)
+    {
+        TRACE_EVENT_BEGIN("GFXR", "vkGetFenceStatus");
+
+        const uint64_t start_ns = base_layer::get_timestamp_ns();
+        result                  = device_table->dispatch_table.GetFenceStatus(device, fence);
+        AccumulateCpuStall(start_ns, false);
+
+        TRACE_EVENT_END("GFXR", "signaled", result == VK_SUCCESS);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetQueryPoolResults(VkDevice           device,
+                                                         VkQueryPool        queryPool,
+                                                         uint32_t           firstQuery,
+                                                         uint32_t           queryCount,
+                                                         size_t             dataSize,
+                                                         void*              pData,
+                                                         VkDeviceSize       stride,
+                                                         VkQueryResultFlags flags)
+{
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.GetQueryPoolResults)
+    {
+        if ((flags & VK_QUERY_RESULT_WAIT_BIT) != 0)
+        {
+            // Only waiting queries can stall the CPU
+            TRACE_EVENT("GFXR", "vkGetQueryPoolResults (wait)", "queryCount", queryCount);
+
+            const uint64_t start_ns = base_layer::get_timestamp_ns();
+            result                  = device_table->dispatch_table.GetQueryPoolResults(
+                device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
+            AccumulateCpuStall(start_ns, false);
+        }
+        else
+        {
+            result = device_table->dispatch_table.GetQueryPoolResults(
+                device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_AllocateCommandBuffers(VkDevice                           device,
+                                                            const VkCommandBufferAllocateInfo* pAllocateInfo,
+                                                            VkCommandBuffer*                   pCommandBuffers)
+{
+    // Forward function to next layer / driver through the base layer, which registers the command buffers
+    VkResult result = base_layer::base_layer_AllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+
+    if (result == VK_SUCCESS)
+    {
+        command_buffers.add(device, pAllocateInfo->commandPool, pAllocateInfo->commandBufferCount, pCommandBuffers);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_FreeCommandBuffers(VkDevice               device,
+                                                    VkCommandPool          commandPool,
+                                                    uint32_t               commandBufferCount,
+                                                    const VkCommandBuffer* pCommandBuffers)
+{
+    // Forward function to next layer / driver through the base layer, which unregisters the command buffers
+    base_layer::base_layer_FreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+
+    command_buffers.remove(commandBufferCount, pCommandBuffers);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_ResetCommandPool(VkDevice                device,
+                                                      VkCommandPool           commandPool,
+                                                      VkCommandPoolResetFlags flags)
+{
+    command_buffers.reset_pool(device, commandPool, [](command_buffer_record* record) { record->stats = {}; });
+
+    // Forward function to next layer / driver
+    VkResult                           result       = VK_SUCCESS;
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table && device_table->dispatch_table.ResetCommandPool)
     {
-        device_table->dispatch_table.FrameBoundaryANDROID(device, semaphore, image);
+        result = device_table->dispatch_table.ResetCommandPool(device, commandPool, flags);
     }
 
-    const uint64_t block_index = GetBlockIndexGFXR_fp ? GetBlockIndexGFXR_fp() : 0;
-    TRACE_EVENT_INSTANT("GFXR", "FrameBoundaryANDROID", [&](perfetto::EventContext ctx) {
-        ctx.AddDebugAnnotation(perfetto::DynamicString{ "FrameBoundaryANDROID:" }, block_index);
-    });
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyCommandPool(VkDevice                     device,
+                                                    VkCommandPool                commandPool,
+                                                    const VkAllocationCallbacks* pAllocator)
+{
+    // Forward function to next layer / driver through the base layer, which unregisters the pool's command buffers
+    base_layer::base_layer_DestroyCommandPool(device, commandPool, pAllocator);
+
+    command_buffers.destroy_pool(device, commandPool);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BeginCommandBuffer(VkCommandBuffer                 commandBuffer,
+                                                        const VkCommandBufferBeginInfo* pBeginInfo)
+{
+    ResetCommandBufferStats(commandBuffer);
+
+    // Forward function to next layer / driver
+    VkResult           result  = VK_SUCCESS;
+    recording_context* context = command_buffers.get_recording_context_slow(commandBuffer);
+    if (context != nullptr)
+    {
+        result = context->dispatch_table->BeginCommandBuffer(commandBuffer, pBeginInfo);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_ResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags)
+{
+    ResetCommandBufferStats(commandBuffer);
+
+    // Forward function to next layer / driver
+    VkResult           result  = VK_SUCCESS;
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        result = context->dispatch_table->ResetCommandBuffer(commandBuffer, flags);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDraw(VkCommandBuffer commandBuffer,
+                                         uint32_t        vertexCount,
+                                         uint32_t        instanceCount,
+                                         uint32_t        firstVertex,
+                                         uint32_t        firstInstance)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDraw(commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawIndexed(VkCommandBuffer commandBuffer,
+                                                uint32_t        indexCount,
+                                                uint32_t        instanceCount,
+                                                uint32_t        firstIndex,
+                                                int32_t         vertexOffset,
+                                                uint32_t        firstInstance)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawIndexed(
+            commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawIndirect(VkCommandBuffer commandBuffer,
+                                                 VkBuffer        buffer,
+                                                 VkDeviceSize    offset,
+                                                 uint32_t        drawCount,
+                                                 uint32_t        stride)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawIndirect(commandBuffer, buffer, offset, drawCount, stride);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawIndexedIndirect(VkCommandBuffer commandBuffer,
+                                                        VkBuffer        buffer,
+                                                        VkDeviceSize    offset,
+                                                        uint32_t        drawCount,
+                                                        uint32_t        stride)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawIndexedIndirect(commandBuffer, buffer, offset, drawCount, stride);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawIndirectCount(VkCommandBuffer commandBuffer,
+                                                      VkBuffer        buffer,
+                                                      VkDeviceSize    offset,
+                                                      VkBuffer        countBuffer,
+                                                      VkDeviceSize    countBufferOffset,
+                                                      uint32_t        maxDrawCount,
+                                                      uint32_t        stride)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawIndirectCount(
+            commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawIndexedIndirectCount(VkCommandBuffer commandBuffer,
+                                                             VkBuffer        buffer,
+                                                             VkDeviceSize    offset,
+                                                             VkBuffer        countBuffer,
+                                                             VkDeviceSize    countBufferOffset,
+                                                             uint32_t        maxDrawCount,
+                                                             uint32_t        stride)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawIndexedIndirectCount(
+            commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawIndirectCountKHR(VkCommandBuffer commandBuffer,
+                                                         VkBuffer        buffer,
+                                                         VkDeviceSize    offset,
+                                                         VkBuffer        countBuffer,
+                                                         VkDeviceSize    countBufferOffset,
+                                                         uint32_t        maxDrawCount,
+                                                         uint32_t        stride)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawIndirectCountKHR(
+            commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawIndexedIndirectCountKHR(VkCommandBuffer commandBuffer,
+                                                                VkBuffer        buffer,
+                                                                VkDeviceSize    offset,
+                                                                VkBuffer        countBuffer,
+                                                                VkDeviceSize    countBufferOffset,
+                                                                uint32_t        maxDrawCount,
+                                                                uint32_t        stride)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawIndexedIndirectCountKHR(
+            commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawMeshTasksEXT(VkCommandBuffer commandBuffer,
+                                                     uint32_t        groupCountX,
+                                                     uint32_t        groupCountY,
+                                                     uint32_t        groupCountZ)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawMeshTasksEXT(commandBuffer, groupCountX, groupCountY, groupCountZ);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawMeshTasksIndirectEXT(VkCommandBuffer commandBuffer,
+                                                             VkBuffer        buffer,
+                                                             VkDeviceSize    offset,
+                                                             uint32_t        drawCount,
+                                                             uint32_t        stride)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawMeshTasksIndirectEXT(commandBuffer, buffer, offset, drawCount, stride);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDrawMeshTasksIndirectCountEXT(VkCommandBuffer commandBuffer,
+                                                                  VkBuffer        buffer,
+                                                                  VkDeviceSize    offset,
+                                                                  VkBuffer        countBuffer,
+                                                                  VkDeviceSize    countBufferOffset,
+                                                                  uint32_t        maxDrawCount,
+                                                                  uint32_t        stride)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->draws;
+        context->dispatch_table->CmdDrawMeshTasksIndirectCountEXT(
+            commandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDispatch(VkCommandBuffer commandBuffer,
+                                             uint32_t        groupCountX,
+                                             uint32_t        groupCountY,
+                                             uint32_t        groupCountZ)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->dispatches;
+        context->dispatch_table->CmdDispatch(commandBuffer, groupCountX, groupCountY, groupCountZ);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDispatchIndirect(VkCommandBuffer commandBuffer,
+                                                     VkBuffer        buffer,
+                                                     VkDeviceSize    offset)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->dispatches;
+        context->dispatch_table->CmdDispatchIndirect(commandBuffer, buffer, offset);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDispatchBase(VkCommandBuffer commandBuffer,
+                                                 uint32_t        baseGroupX,
+                                                 uint32_t        baseGroupY,
+                                                 uint32_t        baseGroupZ,
+                                                 uint32_t        groupCountX,
+                                                 uint32_t        groupCountY,
+                                                 uint32_t        groupCountZ)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->dispatches;
+        context->dispatch_table->CmdDispatchBase(
+            commandBuffer, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdDispatchBaseKHR(VkCommandBuffer commandBuffer,
+                                                    uint32_t        baseGroupX,
+                                                    uint32_t        baseGroupY,
+                                                    uint32_t        baseGroupZ,
+                                                    uint32_t        groupCountX,
+                                                    uint32_t        groupCountY,
+                                                    uint32_t        groupCountZ)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->dispatches;
+        context->dispatch_table->CmdDispatchBaseKHR(
+            commandBuffer, baseGroupX, baseGroupY, baseGroupZ, groupCountX, groupCountY, groupCountZ);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdPipelineBarrier(VkCommandBuffer              commandBuffer,
+                                                    VkPipelineStageFlags         srcStageMask,
+                                                    VkPipelineStageFlags         dstStageMask,
+                                                    VkDependencyFlags            dependencyFlags,
+                                                    uint32_t                     memoryBarrierCount,
+                                                    const VkMemoryBarrier*       pMemoryBarriers,
+                                                    uint32_t                     bufferMemoryBarrierCount,
+                                                    const VkBufferMemoryBarrier* pBufferMemoryBarriers,
+                                                    uint32_t                     imageMemoryBarrierCount,
+                                                    const VkImageMemoryBarrier*  pImageMemoryBarriers)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->barriers;
+        context->dispatch_table->CmdPipelineBarrier(commandBuffer,
+                                                    srcStageMask,
+                                                    dstStageMask,
+                                                    dependencyFlags,
+                                                    memoryBarrierCount,
+                                                    pMemoryBarriers,
+                                                    bufferMemoryBarrierCount,
+                                                    pBufferMemoryBarriers,
+                                                    imageMemoryBarrierCount,
+                                                    pImageMemoryBarriers);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdPipelineBarrier2(VkCommandBuffer         commandBuffer,
+                                                     const VkDependencyInfo* pDependencyInfo)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->barriers;
+        context->dispatch_table->CmdPipelineBarrier2(commandBuffer, pDependencyInfo);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdPipelineBarrier2KHR(VkCommandBuffer         commandBuffer,
+                                                        const VkDependencyInfo* pDependencyInfo)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->barriers;
+        context->dispatch_table->CmdPipelineBarrier2KHR(commandBuffer, pDependencyInfo);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindDescriptorSets(VkCommandBuffer        commandBuffer,
+                                                       VkPipelineBindPoint    pipelineBindPoint,
+                                                       VkPipelineLayout       layout,
+                                                       uint32_t               firstSet,
+                                                       uint32_t               descriptorSetCount,
+                                                       const VkDescriptorSet* pDescriptorSets,
+                                                       uint32_t               dynamicOffsetCount,
+                                                       const uint32_t*        pDynamicOffsets)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->descriptor_binds;
+        context->dispatch_table->CmdBindDescriptorSets(commandBuffer,
+                                                       pipelineBindPoint,
+                                                       layout,
+                                                       firstSet,
+                                                       descriptorSetCount,
+                                                       pDescriptorSets,
+                                                       dynamicOffsetCount,
+                                                       pDynamicOffsets);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdPushDescriptorSetKHR(VkCommandBuffer             commandBuffer,
+                                                         VkPipelineBindPoint         pipelineBindPoint,
+                                                         VkPipelineLayout            layout,
+                                                         uint32_t                    set,
+                                                         uint32_t                    descriptorWriteCount,
+                                                         const VkWriteDescriptorSet* pDescriptorWrites)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        ++GetRecordingStats(context)->descriptor_binds;
+        context->dispatch_table->CmdPushDescriptorSetKHR(
+            commandBuffer, pipelineBindPoint, layout, set, descriptorWriteCount, pDescriptorWrites);
+    }
+}
+
+// vkCmd* and command buffer lifetime functions are only intercepted when recording statistics are enabled.
+static PFN_vkVoidFunction GetRecordingStatsProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (!strcmp(pName, "vkAllocateCommandBuffers"))
+    {
+        result = (PFN_vkVoidFunction)layer_AllocateCommandBuffers;
+    }
+    else if (!strcmp(pName, "vkFreeCommandBuffers"))
+    {
+        result = (PFN_vkVoidFunction)layer_FreeCommandBuffers;
+    }
+    else if (!strcmp(pName, "vkResetCommandPool"))
+    {
+        result = (PFN_vkVoidFunction)layer_ResetCommandPool;
+    }
+    else if (!strcmp(pName, "vkDestroyCommandPool"))
+    {
+        result = (PFN_vkVoidFunction)layer_DestroyCommandPool;
+    }
+    else if (!strcmp(pName, "vkBeginCommandBuffer"))
+    {
+        result = (PFN_vkVoidFunction)layer_BeginCommandBuffer;
+    }
+    else if (!strcmp(pName, "vkResetCommandBuffer"))
+    {
+        result = (PFN_vkVoidFunction)layer_ResetCommandBuffer;
+    }
+    else if (!strcmp(pName, "vkCmdDraw"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDraw;
+    }
+    else if (!strcmp(pName, "vkCmdDrawIndexed"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawIndexed;
+    }
+    else if (!strcmp(pName, "vkCmdDrawIndirect"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawIndirect;
+    }
+    else if (!strcmp(pName, "vkCmdDrawIndexedIndirect"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawIndexedIndirect;
+    }
+    else if (!strcmp(pName, "vkCmdDrawIndirectCount"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawIndirectCount;
+    }
+    else if (!strcmp(pName, "vkCmdDrawIndexedIndirectCount"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawIndexedIndirectCount;
+    }
+    else if (!strcmp(pName, "vkCmdDrawIndirectCountKHR"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawIndirectCountKHR;
+    }
+    else if (!strcmp(pName, "vkCmdDrawIndexedIndirectCountKHR"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawIndexedIndirectCountKHR;
+    }
+    else if (!strcmp(pName, "vkCmdDrawMeshTasksEXT"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawMeshTasksEXT;
+    }
+    else if (!strcmp(pName, "vkCmdDrawMeshTasksIndirectEXT"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawMeshTasksIndirectEXT;
+    }
+    else if (!strcmp(pName, "vkCmdDrawMeshTasksIndirectCountEXT"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDrawMeshTasksIndirectCountEXT;
+    }
+    else if (!strcmp(pName, "vkCmdDispatch"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDispatch;
+    }
+    else if (!strcmp(pName, "vkCmdDispatchIndirect"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDispatchIndirect;
+    }
+    else if (!strcmp(pName, "vkCmdDispatchBase"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDispatchBase;
+    }
+    else if (!strcmp(pName, "vkCmdDispatchBaseKHR"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdDispatchBaseKHR;
+    }
+    else if (!strcmp(pName, "vkCmdPipelineBarrier"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdPipelineBarrier;
+    }
+    else if (!strcmp(pName, "vkCmdPipelineBarrier2"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdPipelineBarrier2;
+    }
+    else if (!strcmp(pName, "vkCmdPipelineBarrier2KHR"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdPipelineBarrier2KHR;
+    }
+    else if (!strcmp(pName, "vkCmdBindDescriptorSets"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdBindDescriptorSets;
+    }
+    else if (!strcmp(pName, "vkCmdPushDescriptorSetKHR"))
+    {
+        result = (PFN_vkVoidFunction)layer_CmdPushDescriptorSetKHR;
+    }
+
+    return result;
 }
 
 VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
@@ -199,6 +1979,118 @@ VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
         {
             result = (PFN_vkVoidFunction)layer_FrameBoundaryANDROID;
         }
+        else if (!strcmp(pName, "vkDestroyInstance"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyInstance;
+        }
+        else if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkAllocateMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_AllocateMemory;
+        }
+        else if (!strcmp(pName, "vkFreeMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_FreeMemory;
+        }
+        else if (!strcmp(pName, "vkMapMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_MapMemory;
+        }
+        else if (!strcmp(pName, "vkUnmapMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_UnmapMemory;
+        }
+        else if (!strcmp(pName, "vkBindBufferMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindBufferMemory;
+        }
+        else if (!strcmp(pName, "vkBindImageMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindImageMemory;
+        }
+        else if (!strcmp(pName, "vkBindBufferMemory2"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindBufferMemory2;
+        }
+        else if (!strcmp(pName, "vkBindBufferMemory2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindBufferMemory2KHR;
+        }
+        else if (!strcmp(pName, "vkBindImageMemory2"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindImageMemory2;
+        }
+        else if (!strcmp(pName, "vkBindImageMemory2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindImageMemory2KHR;
+        }
+        else if (!strcmp(pName, "vkCreateShaderModule"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateShaderModule;
+        }
+        else if (!strcmp(pName, "vkCreateGraphicsPipelines"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateGraphicsPipelines;
+        }
+        else if (!strcmp(pName, "vkCreateComputePipelines"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateComputePipelines;
+        }
+        else if (!strcmp(pName, "vkCreateRayTracingPipelinesKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateRayTracingPipelinesKHR;
+        }
+        else if (!strcmp(pName, "vkCreateSwapchainKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateSwapchainKHR;
+        }
+        else if (!strcmp(pName, "vkDestroySwapchainKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroySwapchainKHR;
+        }
+        else if (!strcmp(pName, "vkAcquireNextImageKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_AcquireNextImageKHR;
+        }
+        else if (!strcmp(pName, "vkAcquireNextImage2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_AcquireNextImage2KHR;
+        }
+        else if (!strcmp(pName, "vkWaitForFences"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitForFences;
+        }
+        else if (!strcmp(pName, "vkWaitSemaphores"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitSemaphores;
+        }
+        else if (!strcmp(pName, "vkWaitSemaphoresKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitSemaphoresKHR;
+        }
+        else if (!strcmp(pName, "vkQueueWaitIdle"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueueWaitIdle;
+        }
+        else if (!strcmp(pName, "vkDeviceWaitIdle"))
+        {
+            result = (PFN_vkVoidFunction)layer_DeviceWaitIdle;
+        }
+        else if (!strcmp(pName, "vkGetFenceStatus"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetFenceStatus;
+        }
+        else if (!strcmp(pName, "vkGetQueryPoolResults"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetQueryPoolResults;
+        }
+        else if (IsRecordingStatsEnabled())
+        {
+            result = GetRecordingStatsProcAddr(pName);
+        }
     }
 
     return result;
@@ -0,0 +1,486 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_persistent_pipeline_cache"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Persistent pipeline cache layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+// Pipelines created without a pipeline cache use a per device cache instead. It is loaded from a file named after the
+// device's pipeline cache UUID, vendor, device and driver version, and written back on vkDestroyDevice from a
+// background thread through a temporary file that is renamed over the previous one.
+struct device_pipeline_cache
+{
+    VkPipelineCache      cache{ VK_NULL_HANDLE };
+    std::string          path;
+    std::vector<uint8_t> initial_data;
+};
+
+static std::shared_mutex                                     device_lock;
+static std::unordered_map<VkDevice, device_pipeline_cache> device_caches;
+
+// Writes the caches of destroyed devices on a single worker thread, which is started by the first write and exits once
+// no write is queued. vkDestroyInstance waits for it, so that no write is in progress when the layer is unloaded. The
+// writer is never destroyed, as joining a thread from a static destructor can deadlock on Windows, where it runs under
+// the loader lock.
+class cache_writer
+{
+  public:
+    void write(std::string path, std::vector<uint8_t> data)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        jobs_.push_back(write_job{ std::move(path), std::move(data), next_id_++ });
+
+        if (!running_)
+        {
+            // The previous worker has returned, or is about to, once running_ is cleared
+            if (worker_.joinable())
+            {
+                worker_.join();
+            }
+
+            running_ = true;
+            worker_  = std::thread(&cache_writer::Run, this);
+        }
+    }
+
+    // Waits until the queued writes are complete.
+    void finish()
+    {
+        std::thread worker;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            worker = std::move(worker_);
+        }
+
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+  private:
+    struct write_job
+    {
+        std::string          path;
+        std::vector<uint8_t> data;
+        uint32_t             id;
+    };
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        while (!jobs_.empty())
+        {
+            write_job job = std::move(jobs_.front());
+            jobs_.pop_front();
+
+            lock.unlock();
+            WriteFile(job.path, job.data, job.id);
+            lock.lock();
+        }
+
+        running_ = false;
+    }
+
+    static void WriteFile(const std::string& path, const std::vector<uint8_t>& data, uint32_t id)
+    {
+#if defined(_WIN32)
+        const int pid = _getpid();
+#else
+        const int pid = getpid();
+#endif
+        const std::string temporary_path = path + ".tmp." + std::to_string(pid) + "." + std::to_string(id);
+
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file)
+            {
+                base_layer::base_layer_print_error("Failed to write pipeline cache %s\n", temporary_path.c_str());
+                return;
+            }
+        }
+
+        // Readers see either the previous file or the complete new one
+        std::error_code error;
+        std::filesystem::rename(temporary_path, path, error);
+        if (error)
+        {
+            base_layer::base_layer_print_error("Failed to replace pipeline cache %s\n", path.c_str());
+            std::filesystem::remove(temporary_path, error);
+        }
+    }
+
+    std::mutex            lock_;
+    std::deque<write_job> jobs_;
+    std::thread           worker_;
+    bool                  running_{ false };
+    uint32_t              next_id_{ 0 };
+};
+
+static cache_writer& writer = *new cache_writer();
+
+// Pipelines created from pipeline binaries, or that capture data for them, must be created without a pipeline cache.
+// The structure types are spelled out as applications can use newer headers than the layer.
+static constexpr VkStructureType kPipelineBinaryInfoType             = static_cast<VkStructureType>(1000483002);
+static constexpr VkStructureType kPipelineCreateFlags2CreateInfoType = static_cast<VkStructureType>(1000470005);
+static constexpr uint64_t        kPipelineCreate2CaptureDataBit      = 0x80000000ull;
+
+struct pipeline_create_flags2_create_info
+{
+    VkStructureType sType;
+    const void*     pNext;
+    uint64_t        flags;
+};
+
+template <typename CreateInfo>
+static bool CanUseDeviceCache(uint32_t createInfoCount, const CreateInfo* pCreateInfos)
+{
+    for (uint32_t i = 0; i < createInfoCount; ++i)
+    {
+        const VkBaseInStructure* next = reinterpret_cast<const VkBaseInStructure*>(pCreateInfos[i].pNext);
+        for (; next != nullptr; next = next->pNext)
+        {
+            if (next->sType == kPipelineBinaryInfoType)
+            {
+                return false;
+            }
+            else if ((next->sType == kPipelineCreateFlags2CreateInfoType) &&
+                     (reinterpret_cast<const pipeline_create_flags2_create_info*>(next)->flags &
+                      kPipelineCreate2CaptureDataBit))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static std::string GetCacheDirectory()
+{
+    std::string directory = base_layer::get_layer_setting("GFXR_PIPELINE_CACHE_DIR", "debug.gfxr.pipeline_cache_dir");
+
+#if !defined(__ANDROID__)
+    if (directory.empty())
+    {
+        const char* cache_home = std::getenv("XDG_CACHE_HOME");
+        const char* home       = std::getenv("HOME");
+        if ((cache_home != nullptr) && (cache_home[0] != '\0'))
+        {
+            directory = std::string(cache_home) + "/gfxr_pipeline_cache";
+        }
+        else if ((home != nullptr) && (home[0] != '\0'))
+        {
+            directory = std::string(home) + "/.cache/gfxr_pipeline_cache";
+        }
+    }
+#endif
+
+    return directory;
+}
+
+static std::string GetCachePath(const std::string& directory, const VkPhysicalDeviceProperties& properties)
+{
+    char name[128];
+    int  length = snprintf(name,
+                          sizeof(name),
+                          "pipeline_cache_%08x_%08x_%08x_",
+                          properties.vendorID,
+                          properties.deviceID,
+                          properties.driverVersion);
+    for (uint32_t i = 0; i < VK_UUID_SIZE; ++i)
+    {
+        length += snprintf(name + length, sizeof(name) - length, "%02x", properties.pipelineCacheUUID[i]);
+    }
+
+    return directory + "/" + name + ".bin";
+}
+
+// Drivers are expected to reject data created by another device or driver, but not all of them do so gracefully.
+static bool IsCompatibleCacheData(const std::vector<uint8_t>& data, const VkPhysicalDeviceProperties& properties)
+{
+    VkPipelineCacheHeaderVersionOne header;
+    if (data.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    return (header.headerSize >= sizeof(header)) && (header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE) &&
+           (header.vendorID == properties.vendorID) && (header.deviceID == properties.deviceID) &&
+           (std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0);
+}
+
+static std::vector<uint8_t> ReadCacheFile(const std::string& path)
+{
+    std::vector<uint8_t> data;
+    std::ifstream        file(path, std::ios::binary | std::ios::ate);
+    if (file)
+    {
+        data.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+        {
+            data.clear();
+        }
+    }
+
+    return data;
+}
+
+static VkPipelineCache GetDevicePipelineCache(VkDevice device)
+{
+    std::shared_lock<std::shared_mutex> lock(device_lock);
+    auto                                entry = device_caches.find(device);
+    return (entry != device_caches.end()) ? entry->second.cache : VK_NULL_HANDLE;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    const std::string directory = GetCacheDirectory();
+    if (directory.empty())
+    {
+        base_layer::base_layer_print_info("No pipeline cache directory, set GFXR_PIPELINE_CACHE_DIR\n");
+        return VK_SUCCESS;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+
+    VkPhysicalDeviceProperties properties;
+    base_layer::get_physical_device_instance(physicalDevice)
+        ->dispatch_table.GetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    device_pipeline_cache device_cache;
+    device_cache.path         = GetCachePath(directory, properties);
+    device_cache.initial_data = ReadCacheFile(device_cache.path);
+    if (!IsCompatibleCacheData(device_cache.initial_data, properties))
+    {
+        device_cache.initial_data.clear();
+    }
+
+    const DeviceTable&        dispatch_table = base_layer::get_device_handle(*pDevice)->dispatch_table;
+    VkPipelineCacheCreateInfo create_info    = { VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO };
+    create_info.initialDataSize              = device_cache.initial_data.size();
+    create_info.pInitialData                 = device_cache.initial_data.data();
+
+    VkResult result = dispatch_table.CreatePipelineCache(*pDevice, &create_info, nullptr, &device_cache.cache);
+    if ((result != VK_SUCCESS) && !device_cache.initial_data.empty())
+    {
+        base_layer::base_layer_print_error("Pipeline cache %s rejected, starting empty\n", device_cache.path.c_str());
+
+        device_cache.initial_data.clear();
+        create_info.initialDataSize = 0;
+        create_info.pInitialData    = nullptr;
+
+        result = dispatch_table.CreatePipelineCache(*pDevice, &create_info, nullptr, &device_cache.cache);
+    }
+
+    if (result == VK_SUCCESS)
+    {
+        base_layer::base_layer_print_info("Pipeline cache %s loaded, %zu bytes\n",
+                                          device_cache.path.c_str(),
+                                          device_cache.initial_data.size());
+
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        device_caches[*pDevice] = std::move(device_cache);
+    }
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    device_pipeline_cache device_cache;
+    bool                  found = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        auto                                entry = device_caches.find(device);
+        if (entry != device_caches.end())
+        {
+            device_cache = std::move(entry->second);
+            device_caches.erase(entry);
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        const DeviceTable&   dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+        std::vector<uint8_t> data;
+        size_t               size   = 0;
+        VkResult             result = dispatch_table.GetPipelineCacheData(device, device_cache.cache, &size, nullptr);
+        if (result == VK_SUCCESS)
+        {
+            data.resize(size);
+            result = dispatch_table.GetPipelineCacheData(device, device_cache.cache, &size, data.data());
+            data.resize(size);
+        }
+
+        dispatch_table.DestroyPipelineCache(device, device_cache.cache, nullptr);
+
+        // Nothing was added when the driver returns the data it was created with
+        if ((result == VK_SUCCESS) && !data.empty() && (data != device_cache.initial_data))
+        {
+            writer.write(std::move(device_cache.path), std::move(data));
+        }
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+    writer.finish();
+
+    // Forward function to next layer / driver through the base layer, which releases the instance's dispatch table
+    base_layer::base_layer_DestroyInstance(instance, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateGraphicsPipelines(VkDevice                            device,
+                                                             VkPipelineCache                     pipelineCache,
+                                                             uint32_t                            createInfoCount,
+                                                             const VkGraphicsPipelineCreateInfo* pCreateInfos,
+                                                             const VkAllocationCallbacks*        pAllocator,
+                                                             VkPipeline*                         pPipelines)
+{
+    if ((pipelineCache == VK_NULL_HANDLE) && CanUseDeviceCache(createInfoCount, pCreateInfos))
+    {
+        pipelineCache = GetDevicePipelineCache(device);
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.CreateGraphicsPipelines(
+        device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateComputePipelines(VkDevice                           device,
+                                                            VkPipelineCache                    pipelineCache,
+                                                            uint32_t                           createInfoCount,
+                                                            const VkComputePipelineCreateInfo* pCreateInfos,
+                                                            const VkAllocationCallbacks*       pAllocator,
+                                                            VkPipeline*                        pPipelines)
+{
+    if ((pipelineCache == VK_NULL_HANDLE) && CanUseDeviceCache(createInfoCount, pCreateInfos))
+    {
+        pipelineCache = GetDevicePipelineCache(device);
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.CreateComputePipelines(
+        device, pipelineCache, createInfoCount, pCreateInfos, pAllocator, pPipelines);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName)
+    {
+        if (!strcmp(pName, "vkDestroyInstance"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyInstance;
+        }
+        else if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkCreateGraphicsPipelines"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateGraphicsPipelines;
+        }
+        else if (!strcmp(pName, "vkCreateComputePipelines"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateComputePipelines;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
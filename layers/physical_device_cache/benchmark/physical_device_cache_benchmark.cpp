@@ -0,0 +1,198 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the cost per call of repeated physical device queries through the physical device query cache layer and
+// directly against the mock driver, which charges a fixed cost for each query it answers in place of the layers and
+// the driver below. Queries are made from one thread and then from several threads at once, as engines that query
+// formats from worker threads during startup do. Run with the number of calls per thread as the optional first
+// argument, the largest number of threads as the optional second one and the cost per driver query in nanoseconds as
+// the optional third one.
+
+#include "base_layer/test/mock_driver.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Returns the layer's entry point for an instance command, or the mock's when the layer does not hook it.
+#define LAYER_INSTANCE_PROC(context, name) \
+    reinterpret_cast<PFN_##name>(vkGetInstanceProcAddr((context).instance, #name))
+
+static constexpr uint32_t kFormatCount = 64;
+
+static uint64_t query_cost_ns = 1000;
+
+static VKAPI_ATTR void VKAPI_CALL CostlyGetPhysicalDeviceProperties(VkPhysicalDevice            physicalDevice,
+                                                                    VkPhysicalDeviceProperties* pProperties)
+{
+    mock_driver::SpinFor(query_cost_ns);
+    mock_driver::GetPhysicalDeviceProperties(physicalDevice, pProperties);
+}
+
+static VKAPI_ATTR void VKAPI_CALL CostlyGetPhysicalDeviceFormatProperties(VkPhysicalDevice    physicalDevice,
+                                                                          VkFormat            format,
+                                                                          VkFormatProperties* pFormatProperties)
+{
+    (void)physicalDevice;
+    (void)format;
+
+    mock_driver::SpinFor(query_cost_ns);
+    *pFormatProperties                       = {};
+    pFormatProperties->optimalTilingFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+}
+
+// The structures of the chain are left as they are, which is enough for the layer to cache them
+static VKAPI_ATTR void VKAPI_CALL CostlyGetPhysicalDeviceProperties2(VkPhysicalDevice             physicalDevice,
+                                                                     VkPhysicalDeviceProperties2* pProperties)
+{
+    mock_driver::SpinFor(query_cost_ns);
+    mock_driver::GetPhysicalDeviceProperties(physicalDevice, &pProperties->properties);
+}
+
+// Commands of the layer, or of the mock driver when the layer is bypassed
+struct query_commands
+{
+    PFN_vkGetPhysicalDeviceProperties       get_properties{ nullptr };
+    PFN_vkGetPhysicalDeviceFormatProperties get_format_properties{ nullptr };
+    PFN_vkGetPhysicalDeviceProperties2      get_properties2{ nullptr };
+};
+
+// Runs call on thread_count threads at once and reports the time per call seen by each thread, which grows with the
+// thread count when the threads contend on a lock.
+template <typename Call>
+static void Measure(const char* name, uint32_t iterations, uint32_t thread_count, Call call)
+{
+    // Warms up the caches of the layer and of the CPU
+    call(iterations / 16);
+
+    std::vector<std::thread> threads;
+    const auto               begin = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < thread_count; ++i)
+    {
+        threads.emplace_back(call, iterations);
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    printf("%-48s %2u threads %10.1f ns/call\n", name, thread_count, ns / iterations);
+}
+
+static void MeasureCommands(const char*                 mode,
+                            const query_commands&       commands,
+                            const mock_driver::context& context,
+                            uint32_t                    iterations,
+                            uint32_t                    max_threads)
+{
+    char name[64];
+    for (uint32_t thread_count = 1; thread_count <= max_threads; thread_count *= 2)
+    {
+        snprintf(name, sizeof(name), "%s vkGetPhysicalDeviceProperties", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            VkPhysicalDeviceProperties properties;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                commands.get_properties(context.physical_device, &properties);
+            }
+        });
+
+        snprintf(name, sizeof(name), "%s vkGetPhysicalDeviceFormatProperties", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            VkFormatProperties properties;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                const VkFormat format = static_cast<VkFormat>(1 + (i % kFormatCount));
+                commands.get_format_properties(context.physical_device, format, &properties);
+            }
+        });
+
+        snprintf(name, sizeof(name), "%s vkGetPhysicalDeviceProperties2", mode);
+        Measure(name, iterations, thread_count, [&](uint32_t count) {
+            VkPhysicalDeviceVulkan12Properties vulkan12   = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+            VkPhysicalDeviceVulkan11Properties vulkan11   = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES };
+            VkPhysicalDeviceProperties2        properties = { VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2 };
+            vulkan11.pNext                                = &vulkan12;
+            properties.pNext                              = &vulkan11;
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                commands.get_properties2(context.physical_device, &properties);
+            }
+        });
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 100000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    uint32_t max_threads = (argc > 2) ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 8;
+    if (max_threads == 0)
+    {
+        max_threads = 1;
+    }
+
+    if (argc > 3)
+    {
+        query_cost_ns = strtoull(argv[3], nullptr, 10);
+    }
+
+    mock_driver::SetFunction("vkGetPhysicalDeviceProperties", CostlyGetPhysicalDeviceProperties);
+    mock_driver::SetFunction("vkGetPhysicalDeviceFormatProperties", CostlyGetPhysicalDeviceFormatProperties);
+    mock_driver::SetFunction("vkGetPhysicalDeviceProperties2", CostlyGetPhysicalDeviceProperties2);
+
+    mock_driver::context context;
+    if (!mock_driver::CreateContext(&context))
+    {
+        mock_driver::DestroyContext(&context);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u calls per thread, %llu ns per driver query\n",
+           iterations,
+           static_cast<unsigned long long>(query_cost_ns));
+
+    query_commands driver_commands;
+    driver_commands.get_properties        = CostlyGetPhysicalDeviceProperties;
+    driver_commands.get_format_properties = CostlyGetPhysicalDeviceFormatProperties;
+    driver_commands.get_properties2       = CostlyGetPhysicalDeviceProperties2;
+    MeasureCommands("driver", driver_commands, context, iterations, max_threads);
+
+    query_commands layer_commands;
+    layer_commands.get_properties        = LAYER_INSTANCE_PROC(context, vkGetPhysicalDeviceProperties);
+    layer_commands.get_format_properties = LAYER_INSTANCE_PROC(context, vkGetPhysicalDeviceFormatProperties);
+    layer_commands.get_properties2       = LAYER_INSTANCE_PROC(context, vkGetPhysicalDeviceProperties2);
+    MeasureCommands("layer", layer_commands, context, iterations, max_threads);
+
+    mock_driver::DestroyContext(&context);
+    return (mock_driver::GetState().errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
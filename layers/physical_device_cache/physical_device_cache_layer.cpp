@@ -0,0 +1,596 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_physical_device_cache"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Physical device query cache layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// Results of vkGetPhysicalDevice*2 queries are keyed on the structure types in the output chain, preceded by the
+// query parameter (the format for format queries). Only chains made of structures that hold immutable values and no
+// pointers are cached, see GetCacheableStructSize.
+static constexpr uint32_t kMaxChainKeyLength = 16;
+
+struct chain_key
+{
+    uint32_t length{ 0 };
+    uint32_t values[kMaxChainKeyLength];
+
+    bool operator==(const chain_key& other) const
+    {
+        return (length == other.length) && (std::memcmp(values, other.values, length * sizeof(uint32_t)) == 0);
+    }
+};
+
+struct chained_result
+{
+    chain_key            key;
+    std::vector<uint8_t> data; // Contents of the structures in chain order, without their sType and pNext
+};
+
+struct physical_device_cache
+{
+    VkInstance        instance{ VK_NULL_HANDLE };
+    std::shared_mutex lock;
+
+    bool                             properties_cached{ false };
+    VkPhysicalDeviceProperties       properties;
+    bool                             memory_properties_cached{ false };
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    bool                             queue_families_cached{ false };
+    std::vector<VkQueueFamilyProperties>           queue_families;
+    std::unordered_map<VkFormat, VkFormatProperties> formats;
+
+    std::vector<chained_result> properties2;
+    std::vector<chained_result> memory_properties2;
+    std::vector<chained_result> format_properties2;
+};
+
+static std::shared_mutex                                                            cache_lock;
+static std::unordered_map<VkPhysicalDevice, std::unique_ptr<physical_device_cache>> physical_device_caches;
+
+static std::atomic<uint64_t> query_hits{ 0 };
+static std::atomic<uint64_t> query_misses{ 0 };
+static std::atomic<uint64_t> query_uncacheable{ 0 };
+
+static physical_device_cache* GetPhysicalDeviceCache(VkPhysicalDevice physicalDevice)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(cache_lock);
+        auto                                entry = physical_device_caches.find(physicalDevice);
+        if (entry != physical_device_caches.end())
+        {
+            return entry->second.get();
+        }
+    }
+
+    std::unique_ptr<physical_device_cache> cache          = std::make_unique<physical_device_cache>();
+    base_layer::instance_dispatch_table*   instance_table = base_layer::get_physical_device_instance(physicalDevice);
+    cache->instance                                       = (instance_table != nullptr) ? instance_table->instance
+                                                                                        : VK_NULL_HANDLE;
+
+    std::unique_lock<std::shared_mutex> lock(cache_lock);
+    return physical_device_caches.emplace(physicalDevice, std::move(cache)).first->second.get();
+}
+
+static void RemovePhysicalDeviceCaches(VkInstance instance)
+{
+    std::unique_lock<std::shared_mutex> lock(cache_lock);
+    for (auto entry = physical_device_caches.begin(); entry != physical_device_caches.end();)
+    {
+        if (entry->second->instance == instance)
+        {
+            entry = physical_device_caches.erase(entry);
+        }
+        else
+        {
+            ++entry;
+        }
+    }
+}
+
+static const InstanceTable* GetInstanceTable(VkPhysicalDevice physicalDevice)
+{
+    base_layer::instance_dispatch_table* instance_table = base_layer::get_physical_device_instance(physicalDevice);
+    return (instance_table != nullptr) ? &instance_table->dispatch_table : nullptr;
+}
+
+// Size of the output structures that can be cached. Structures reporting values that change over time, such as
+// VkPhysicalDeviceMemoryBudgetPropertiesEXT, or that point to application memory are not listed.
+static size_t GetCacheableStructSize(VkStructureType type)
+{
+    switch (type)
+    {
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2:
+            return sizeof(VkPhysicalDeviceProperties2);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES:
+            return sizeof(VkPhysicalDeviceVulkan11Properties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES:
+            return sizeof(VkPhysicalDeviceVulkan12Properties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES:
+            return sizeof(VkPhysicalDeviceVulkan13Properties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES:
+            return sizeof(VkPhysicalDeviceIDProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRIVER_PROPERTIES:
+            return sizeof(VkPhysicalDeviceDriverProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES:
+            return sizeof(VkPhysicalDeviceSubgroupProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_SIZE_CONTROL_PROPERTIES:
+            return sizeof(VkPhysicalDeviceSubgroupSizeControlProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_3_PROPERTIES:
+            return sizeof(VkPhysicalDeviceMaintenance3Properties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MAINTENANCE_4_PROPERTIES:
+            return sizeof(VkPhysicalDeviceMaintenance4Properties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTIVIEW_PROPERTIES:
+            return sizeof(VkPhysicalDeviceMultiviewProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_POINT_CLIPPING_PROPERTIES:
+            return sizeof(VkPhysicalDevicePointClippingProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROTECTED_MEMORY_PROPERTIES:
+            return sizeof(VkPhysicalDeviceProtectedMemoryProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES:
+            return sizeof(VkPhysicalDeviceDescriptorIndexingProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FLOAT_CONTROLS_PROPERTIES:
+            return sizeof(VkPhysicalDeviceFloatControlsProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DEPTH_STENCIL_RESOLVE_PROPERTIES:
+            return sizeof(VkPhysicalDeviceDepthStencilResolveProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SAMPLER_FILTER_MINMAX_PROPERTIES:
+            return sizeof(VkPhysicalDeviceSamplerFilterMinmaxProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_PROPERTIES:
+            return sizeof(VkPhysicalDeviceTimelineSemaphoreProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_INLINE_UNIFORM_BLOCK_PROPERTIES:
+            return sizeof(VkPhysicalDeviceInlineUniformBlockProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TEXEL_BUFFER_ALIGNMENT_PROPERTIES:
+            return sizeof(VkPhysicalDeviceTexelBufferAlignmentProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_INTEGER_DOT_PRODUCT_PROPERTIES:
+            return sizeof(VkPhysicalDeviceShaderIntegerDotProductProperties);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR:
+            return sizeof(VkPhysicalDevicePushDescriptorPropertiesKHR);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ACCELERATION_STRUCTURE_PROPERTIES_KHR:
+            return sizeof(VkPhysicalDeviceAccelerationStructurePropertiesKHR);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_RAY_TRACING_PIPELINE_PROPERTIES_KHR:
+            return sizeof(VkPhysicalDeviceRayTracingPipelinePropertiesKHR);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_PROPERTIES_EXT:
+            return sizeof(VkPhysicalDeviceMeshShaderPropertiesEXT);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PCI_BUS_INFO_PROPERTIES_EXT:
+            return sizeof(VkPhysicalDevicePCIBusInfoPropertiesEXT);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT:
+            return sizeof(VkPhysicalDeviceExternalMemoryHostPropertiesEXT);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_CONSERVATIVE_RASTERIZATION_PROPERTIES_EXT:
+            return sizeof(VkPhysicalDeviceConservativeRasterizationPropertiesEXT);
+        case VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2:
+            return sizeof(VkPhysicalDeviceMemoryProperties2);
+        case VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2:
+            return sizeof(VkFormatProperties2);
+        case VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3:
+            return sizeof(VkFormatProperties3);
+        default:
+            return 0;
+    }
+}
+
+// Builds the key of a chained query. Returns false if the chain cannot be cached.
+static bool GetChainKey(uint32_t parameter, const void* chain, chain_key* key, size_t* data_size)
+{
+    key->values[0] = parameter;
+    key->length    = 1;
+    *data_size     = 0;
+
+    const VkBaseOutStructure* next = reinterpret_cast<const VkBaseOutStructure*>(chain);
+    for (; next != nullptr; next = next->pNext)
+    {
+        const size_t size = GetCacheableStructSize(next->sType);
+        if ((size == 0) || (key->length == kMaxChainKeyLength))
+        {
+            return false;
+        }
+
+        key->values[key->length++] = static_cast<uint32_t>(next->sType);
+        *data_size += size - sizeof(VkBaseOutStructure);
+    }
+
+    return true;
+}
+
+static void StoreChain(const void* chain, size_t data_size, std::vector<uint8_t>* data)
+{
+    data->resize(data_size);
+    uint8_t*                  destination = data->data();
+    const VkBaseOutStructure* next        = reinterpret_cast<const VkBaseOutStructure*>(chain);
+    for (; next != nullptr; next = next->pNext)
+    {
+        const size_t size = GetCacheableStructSize(next->sType) - sizeof(VkBaseOutStructure);
+        std::memcpy(destination, reinterpret_cast<const uint8_t*>(next) + sizeof(VkBaseOutStructure), size);
+        destination += size;
+    }
+}
+
+static void LoadChain(const std::vector<uint8_t>& data, void* chain)
+{
+    const uint8_t* source = data.data();
+    for (VkBaseOutStructure* next = reinterpret_cast<VkBaseOutStructure*>(chain); next != nullptr; next = next->pNext)
+    {
+        const size_t size = GetCacheableStructSize(next->sType) - sizeof(VkBaseOutStructure);
+        std::memcpy(reinterpret_cast<uint8_t*>(next) + sizeof(VkBaseOutStructure), source, size);
+        source += size;
+    }
+}
+
+// Serves a chained query from results, or calls query and stores its output.
+template <typename Query>
+static void CachedChainedQuery(physical_device_cache*       cache,
+                               std::vector<chained_result>* results,
+                               uint32_t                     parameter,
+                               void*                        chain,
+                               Query                        query)
+{
+    chain_key key;
+    size_t    data_size = 0;
+    if (!GetChainKey(parameter, chain, &key, &data_size))
+    {
+        ++query_uncacheable;
+        query();
+        return;
+    }
+
+    {
+        std::shared_lock<std::shared_mutex> lock(cache->lock);
+        for (const chained_result& result : *results)
+        {
+            if (result.key == key)
+            {
+                ++query_hits;
+                LoadChain(result.data, chain);
+                return;
+            }
+        }
+    }
+
+    ++query_misses;
+    query();
+
+    chained_result result;
+    result.key = key;
+    StoreChain(chain, data_size, &result.data);
+
+    std::unique_lock<std::shared_mutex> lock(cache->lock);
+    results->push_back(std::move(result));
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pDevice;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+    base_layer::base_layer_print_info("Physical device query cache: %llu hits, %llu misses, %llu uncacheable\n",
+                                      static_cast<unsigned long long>(query_hits.load()),
+                                      static_cast<unsigned long long>(query_misses.load()),
+                                      static_cast<unsigned long long>(query_uncacheable.load()));
+
+    RemovePhysicalDeviceCaches(instance);
+
+    // Forward function to next layer / driver through the base layer, which releases the instance's dispatch table
+    base_layer::base_layer_DestroyInstance(instance, pAllocator);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetPhysicalDeviceProperties(VkPhysicalDevice            physicalDevice,
+                                                             VkPhysicalDeviceProperties* pProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+
+    {
+        std::shared_lock<std::shared_mutex> lock(cache->lock);
+        if (cache->properties_cached)
+        {
+            ++query_hits;
+            *pProperties = cache->properties;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    ++query_misses;
+    GetInstanceTable(physicalDevice)->GetPhysicalDeviceProperties(physicalDevice, pProperties);
+
+    std::unique_lock<std::shared_mutex> lock(cache->lock);
+    cache->properties        = *pProperties;
+    cache->properties_cached = true;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetPhysicalDeviceMemoryProperties(VkPhysicalDevice                  physicalDevice,
+                                                                   VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+
+    {
+        std::shared_lock<std::shared_mutex> lock(cache->lock);
+        if (cache->memory_properties_cached)
+        {
+            ++query_hits;
+            *pMemoryProperties = cache->memory_properties;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    ++query_misses;
+    GetInstanceTable(physicalDevice)->GetPhysicalDeviceMemoryProperties(physicalDevice, pMemoryProperties);
+
+    std::unique_lock<std::shared_mutex> lock(cache->lock);
+    cache->memory_properties        = *pMemoryProperties;
+    cache->memory_properties_cached = true;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetPhysicalDeviceFormatProperties(VkPhysicalDevice    physicalDevice,
+                                                                   VkFormat            format,
+                                                                   VkFormatProperties* pFormatProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+
+    {
+        std::shared_lock<std::shared_mutex> lock(cache->lock);
+        auto                                entry = cache->formats.find(format);
+        if (entry != cache->formats.end())
+        {
+            ++query_hits;
+            *pFormatProperties = entry->second;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    ++query_misses;
+    GetInstanceTable(physicalDevice)->GetPhysicalDeviceFormatProperties(physicalDevice, format, pFormatProperties);
+
+    std::unique_lock<std::shared_mutex> lock(cache->lock);
+    cache->formats[format] = *pFormatProperties;
+}
+
+VKAPI_ATTR void VKAPI_CALL
+layer_GetPhysicalDeviceQueueFamilyProperties(VkPhysicalDevice         physicalDevice,
+                                             uint32_t*                pQueueFamilyPropertyCount,
+                                             VkQueueFamilyProperties* pQueueFamilyProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+
+    std::shared_lock<std::shared_mutex> shared_lock(cache->lock);
+    if (!cache->queue_families_cached)
+    {
+        shared_lock.unlock();
+
+        // Forward function to next layer / driver
+        ++query_misses;
+        const InstanceTable*                 instance_table = GetInstanceTable(physicalDevice);
+        uint32_t                             count          = 0;
+        std::vector<VkQueueFamilyProperties> queue_families;
+        instance_table->GetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+        queue_families.resize(count);
+        instance_table->GetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, queue_families.data());
+        queue_families.resize(count);
+
+        {
+            std::unique_lock<std::shared_mutex> lock(cache->lock);
+            if (!cache->queue_families_cached)
+            {
+                cache->queue_families        = std::move(queue_families);
+                cache->queue_families_cached = true;
+            }
+        }
+
+        shared_lock.lock();
+    }
+    else
+    {
+        ++query_hits;
+    }
+
+    const uint32_t count = static_cast<uint32_t>(cache->queue_families.size());
+    if (pQueueFamilyProperties == nullptr)
+    {
+        *pQueueFamilyPropertyCount = count;
+    }
+    else
+    {
+        *pQueueFamilyPropertyCount = std::min(*pQueueFamilyPropertyCount, count);
+        std::copy(cache->queue_families.begin(),
+                  cache->queue_families.begin() + *pQueueFamilyPropertyCount,
+                  pQueueFamilyProperties);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetPhysicalDeviceProperties2(VkPhysicalDevice             physicalDevice,
+                                                              VkPhysicalDeviceProperties2* pProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+    CachedChainedQuery(cache, &cache->properties2, 0, pProperties, [&]() {
+        // Forward function to next layer / driver
+        GetInstanceTable(physicalDevice)->GetPhysicalDeviceProperties2(physicalDevice, pProperties);
+    });
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetPhysicalDeviceProperties2KHR(VkPhysicalDevice             physicalDevice,
+                                                                 VkPhysicalDeviceProperties2* pProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+    CachedChainedQuery(cache, &cache->properties2, 0, pProperties, [&]() {
+        // Forward function to next layer / driver
+        GetInstanceTable(physicalDevice)->GetPhysicalDeviceProperties2KHR(physicalDevice, pProperties);
+    });
+}
+
+VKAPI_ATTR void VKAPI_CALL
+layer_GetPhysicalDeviceMemoryProperties2(VkPhysicalDevice                   physicalDevice,
+                                         VkPhysicalDeviceMemoryProperties2* pMemoryProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+    CachedChainedQuery(cache, &cache->memory_properties2, 0, pMemoryProperties, [&]() {
+        // Forward function to next layer / driver
+        GetInstanceTable(physicalDevice)->GetPhysicalDeviceMemoryProperties2(physicalDevice, pMemoryProperties);
+    });
+}
+
+VKAPI_ATTR void VKAPI_CALL
+layer_GetPhysicalDeviceMemoryProperties2KHR(VkPhysicalDevice                   physicalDevice,
+                                            VkPhysicalDeviceMemoryProperties2* pMemoryProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+    CachedChainedQuery(cache, &cache->memory_properties2, 0, pMemoryProperties, [&]() {
+        // Forward function to next layer / driver
+        GetInstanceTable(physicalDevice)->GetPhysicalDeviceMemoryProperties2KHR(physicalDevice, pMemoryProperties);
+    });
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetPhysicalDeviceFormatProperties2(VkPhysicalDevice     physicalDevice,
+                                                                    VkFormat             format,
+                                                                    VkFormatProperties2* pFormatProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+    CachedChainedQuery(cache, &cache->format_properties2, static_cast<uint32_t>(format), pFormatProperties, [&]() {
+        // Forward function to next layer / driver
+        GetInstanceTable(physicalDevice)->GetPhysicalDeviceFormatProperties2(physicalDevice, format, pFormatProperties);
+    });
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetPhysicalDeviceFormatProperties2KHR(VkPhysicalDevice     physicalDevice,
+                                                                       VkFormat             format,
+                                                                       VkFormatProperties2* pFormatProperties)
+{
+    physical_device_cache* cache = GetPhysicalDeviceCache(physicalDevice);
+    CachedChainedQuery(cache, &cache->format_properties2, static_cast<uint32_t>(format), pFormatProperties, [&]() {
+        // Forward function to next layer / driver
+        GetInstanceTable(physicalDevice)
+            ->GetPhysicalDeviceFormatProperties2KHR(physicalDevice, format, pFormatProperties);
+    });
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName)
+    {
+        if (!strcmp(pName, "vkDestroyInstance"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyInstance;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceProperties"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceProperties;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceMemoryProperties"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceMemoryProperties;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceFormatProperties"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceFormatProperties;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceQueueFamilyProperties"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceQueueFamilyProperties;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceProperties2"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceProperties2;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceProperties2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceProperties2KHR;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceMemoryProperties2"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceMemoryProperties2;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceMemoryProperties2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceMemoryProperties2KHR;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceFormatProperties2"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceFormatProperties2;
+        }
+        else if (!strcmp(pName, "vkGetPhysicalDeviceFormatProperties2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetPhysicalDeviceFormatProperties2KHR;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
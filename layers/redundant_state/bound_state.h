@@ -0,0 +1,345 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef REDUNDANT_STATE_BOUND_STATE_H
+#define REDUNDANT_STATE_BOUND_STATE_H
+
+#include "vulkan/vulkan.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+// The state bound in a command buffer while it is recorded, and the rules of the redundant state layer that decide
+// whether a bind or dynamic state command would set the values already bound. Each Set* function returns true if the
+// command is redundant, and records its values otherwise. Only the first kMaxTrackedSets descriptor sets,
+// kMaxTrackedVertexBuffers vertex bindings and kMaxTrackedViewports viewports and scissors are tracked, commands
+// touching others are never redundant. Not thread safe.
+static constexpr uint32_t kMaxTrackedSets          = 8;
+static constexpr uint32_t kMaxTrackedVertexBuffers = 16;
+static constexpr uint32_t kMaxTrackedViewports     = 16;
+static constexpr uint32_t kBindPointCount          = 3; // Graphics, compute and ray tracing
+static constexpr uint32_t kGraphicsBindPoint       = 0;
+
+// Bits of dynamic_state::valid
+static constexpr uint32_t kLineWidthValid          = 1 << 0;
+static constexpr uint32_t kDepthBiasValid          = 1 << 1;
+static constexpr uint32_t kBlendConstantsValid     = 1 << 2;
+static constexpr uint32_t kDepthBoundsValid        = 1 << 3;
+static constexpr uint32_t kStencilCompareMaskValid = 1 << 4; // Shifted left by one for the back face
+static constexpr uint32_t kStencilWriteMaskValid   = 1 << 6;
+static constexpr uint32_t kStencilReferenceValid   = 1 << 8;
+
+struct bind_point_state
+{
+    VkPipeline       pipeline{ VK_NULL_HANDLE };
+    VkPipelineLayout layout{ VK_NULL_HANDLE };
+    VkDescriptorSet  sets[kMaxTrackedSets]{};
+};
+
+// Binding a graphics pipeline resets the dynamic state, as any state the pipeline does not declare dynamic overwrites
+// the values set in the command buffer.
+struct dynamic_state
+{
+    uint32_t   valid{ 0 };
+    uint32_t   viewport_mask{ 0 };
+    uint32_t   scissor_mask{ 0 };
+    VkViewport viewports[kMaxTrackedViewports];
+    VkRect2D   scissors[kMaxTrackedViewports];
+    float      line_width{ 0.0f };
+    float      depth_bias[3]{}; // Constant factor, clamp and slope factor
+    float      blend_constants[4]{};
+    float      depth_bounds[2]{};
+    uint32_t   stencil_compare_mask[2]{}; // Front and back face
+    uint32_t   stencil_write_mask[2]{};
+    uint32_t   stencil_reference[2]{};
+};
+
+struct command_buffer_state
+{
+    bind_point_state bind_points[kBindPointCount];
+    uint32_t         vertex_buffer_mask{ 0 };
+    VkBuffer         vertex_buffers[kMaxTrackedVertexBuffers];
+    VkDeviceSize     vertex_buffer_offsets[kMaxTrackedVertexBuffers];
+    VkBuffer         index_buffer{ VK_NULL_HANDLE };
+    VkDeviceSize     index_buffer_offset{ 0 };
+    VkIndexType      index_type{ VK_INDEX_TYPE_UINT16 };
+    dynamic_state    dynamic;
+};
+
+// Returns kBindPointCount for the bind points that are not tracked.
+static uint32_t GetBindPointIndex(VkPipelineBindPoint pipelineBindPoint)
+{
+    switch (pipelineBindPoint)
+    {
+        case VK_PIPELINE_BIND_POINT_GRAPHICS:
+            return kGraphicsBindPoint;
+        case VK_PIPELINE_BIND_POINT_COMPUTE:
+            return 1;
+        case VK_PIPELINE_BIND_POINT_RAY_TRACING_KHR:
+            return 2;
+        default:
+            return kBindPointCount;
+    }
+}
+
+// Returns the mask of the tracked entries first to first + count, or 0 if some of them are not tracked.
+static uint32_t GetTrackedMask(uint32_t first, uint32_t count, uint32_t tracked_count)
+{
+    if ((count == 0) || (first >= tracked_count) || (count > tracked_count - first))
+    {
+        return 0;
+    }
+
+    return ((1u << count) - 1) << first;
+}
+
+static bool IsSameViewport(const VkViewport& a, const VkViewport& b)
+{
+    return (a.x == b.x) && (a.y == b.y) && (a.width == b.width) && (a.height == b.height) &&
+           (a.minDepth == b.minDepth) && (a.maxDepth == b.maxDepth);
+}
+
+static bool IsSameScissor(const VkRect2D& a, const VkRect2D& b)
+{
+    return (a.offset.x == b.offset.x) && (a.offset.y == b.offset.y) && (a.extent.width == b.extent.width) &&
+           (a.extent.height == b.extent.height);
+}
+
+// Returns true if values are already set for the entries first to first + count of tracked, and records them
+// otherwise.
+template <typename T, typename Compare>
+static bool
+SetTrackedValues(T* tracked, uint32_t* valid_mask, uint32_t first, uint32_t count, const T* values, Compare compare)
+{
+    const uint32_t mask = GetTrackedMask(first, count, kMaxTrackedViewports);
+    if (mask == 0)
+    {
+        *valid_mask = 0;
+        return false;
+    }
+
+    if (((*valid_mask & mask) == mask) && std::equal(values, values + count, tracked + first, compare))
+    {
+        return true;
+    }
+
+    std::copy(values, values + count, tracked + first);
+    *valid_mask |= mask;
+    return false;
+}
+
+// Returns true if value is already set for every face in faceMask, and records it otherwise.
+static bool SetStencilValue(
+    dynamic_state* dynamic, uint32_t valid_bit, uint32_t* values, VkStencilFaceFlags faceMask, uint32_t value)
+{
+    bool redundant = true;
+    for (uint32_t face = 0; face < 2; ++face)
+    {
+        if ((faceMask & (VK_STENCIL_FACE_FRONT_BIT << face)) != 0)
+        {
+            const uint32_t bit = valid_bit << face;
+            redundant          = redundant && ((dynamic->valid & bit) != 0) && (values[face] == value);
+            values[face]       = value;
+            dynamic->valid |= bit;
+        }
+    }
+
+    return redundant;
+}
+
+// Forgets everything, as when recording begins or after commands that leave the state undefined.
+static void InvalidateState(command_buffer_state* state)
+{
+    *state = {};
+}
+
+static void InvalidateDescriptorSets(bind_point_state* bind_point)
+{
+    bind_point->layout = VK_NULL_HANDLE;
+    std::fill(std::begin(bind_point->sets), std::end(bind_point->sets), VK_NULL_HANDLE);
+}
+
+// Binding shader objects unbinds the pipelines.
+static void UnbindPipelines(command_buffer_state* state)
+{
+    for (bind_point_state& bind_point : state->bind_points)
+    {
+        bind_point.pipeline = VK_NULL_HANDLE;
+    }
+}
+
+static bool SetPipeline(command_buffer_state* state, uint32_t bind_point_index, VkPipeline pipeline)
+{
+    bind_point_state& bind_point = state->bind_points[bind_point_index];
+    if ((pipeline != VK_NULL_HANDLE) && (bind_point.pipeline == pipeline))
+    {
+        return true;
+    }
+
+    bind_point.pipeline = pipeline;
+    if (bind_point_index == kGraphicsBindPoint)
+    {
+        state->dynamic = {};
+    }
+
+    return false;
+}
+
+// Sets bound with a different layout may disturb the other sets, so only the ones bound here remain known. Sets with
+// dynamic offsets are never considered bound, as the offsets are not tracked.
+static bool SetDescriptorSets(bind_point_state*      bind_point,
+                              VkPipelineLayout       layout,
+                              uint32_t               firstSet,
+                              uint32_t               descriptorSetCount,
+                              const VkDescriptorSet* pDescriptorSets,
+                              uint32_t               dynamicOffsetCount)
+{
+    const uint32_t mask = GetTrackedMask(firstSet, descriptorSetCount, kMaxTrackedSets);
+    if (mask == 0)
+    {
+        InvalidateDescriptorSets(bind_point);
+        return false;
+    }
+
+    if (bind_point->layout != layout)
+    {
+        InvalidateDescriptorSets(bind_point);
+        bind_point->layout = layout;
+    }
+    else if ((dynamicOffsetCount == 0) &&
+             std::equal(pDescriptorSets, pDescriptorSets + descriptorSetCount, bind_point->sets + firstSet) &&
+             std::find(pDescriptorSets, pDescriptorSets + descriptorSetCount, VK_NULL_HANDLE) ==
+                 pDescriptorSets + descriptorSetCount)
+    {
+        return true;
+    }
+
+    if (dynamicOffsetCount == 0)
+    {
+        std::copy(pDescriptorSets, pDescriptorSets + descriptorSetCount, bind_point->sets + firstSet);
+    }
+    else
+    {
+        std::fill(bind_point->sets + firstSet, bind_point->sets + firstSet + descriptorSetCount, VK_NULL_HANDLE);
+    }
+
+    return false;
+}
+
+static bool SetVertexBuffers(command_buffer_state* state,
+                             uint32_t              firstBinding,
+                             uint32_t              bindingCount,
+                             const VkBuffer*       pBuffers,
+                             const VkDeviceSize*   pOffsets)
+{
+    const uint32_t mask = GetTrackedMask(firstBinding, bindingCount, kMaxTrackedVertexBuffers);
+    if (mask == 0)
+    {
+        state->vertex_buffer_mask = 0;
+        return false;
+    }
+
+    if (((state->vertex_buffer_mask & mask) == mask) &&
+        std::equal(pBuffers, pBuffers + bindingCount, state->vertex_buffers + firstBinding) &&
+        std::equal(pOffsets, pOffsets + bindingCount, state->vertex_buffer_offsets + firstBinding))
+    {
+        return true;
+    }
+
+    std::copy(pBuffers, pBuffers + bindingCount, state->vertex_buffers + firstBinding);
+    std::copy(pOffsets, pOffsets + bindingCount, state->vertex_buffer_offsets + firstBinding);
+    state->vertex_buffer_mask |= mask;
+    return false;
+}
+
+static bool SetIndexBuffer(command_buffer_state* state, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+    if ((buffer != VK_NULL_HANDLE) && (state->index_buffer == buffer) && (state->index_buffer_offset == offset) &&
+        (state->index_type == indexType))
+    {
+        return true;
+    }
+
+    state->index_buffer        = buffer;
+    state->index_buffer_offset = offset;
+    state->index_type          = indexType;
+    return false;
+}
+
+static bool SetLineWidth(dynamic_state* dynamic, float lineWidth)
+{
+    if (((dynamic->valid & kLineWidthValid) != 0) && (dynamic->line_width == lineWidth))
+    {
+        return true;
+    }
+
+    dynamic->line_width = lineWidth;
+    dynamic->valid |= kLineWidthValid;
+    return false;
+}
+
+static bool
+SetDepthBias(dynamic_state* dynamic, float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor)
+{
+    if (((dynamic->valid & kDepthBiasValid) != 0) && (dynamic->depth_bias[0] == depthBiasConstantFactor) &&
+        (dynamic->depth_bias[1] == depthBiasClamp) && (dynamic->depth_bias[2] == depthBiasSlopeFactor))
+    {
+        return true;
+    }
+
+    dynamic->depth_bias[0] = depthBiasConstantFactor;
+    dynamic->depth_bias[1] = depthBiasClamp;
+    dynamic->depth_bias[2] = depthBiasSlopeFactor;
+    dynamic->valid |= kDepthBiasValid;
+    return false;
+}
+
+static bool SetBlendConstants(dynamic_state* dynamic, const float blendConstants[4])
+{
+    if (((dynamic->valid & kBlendConstantsValid) != 0) &&
+        std::equal(blendConstants, blendConstants + 4, dynamic->blend_constants))
+    {
+        return true;
+    }
+
+    std::copy(blendConstants, blendConstants + 4, dynamic->blend_constants);
+    dynamic->valid |= kBlendConstantsValid;
+    return false;
+}
+
+static bool SetDepthBounds(dynamic_state* dynamic, float minDepthBounds, float maxDepthBounds)
+{
+    if (((dynamic->valid & kDepthBoundsValid) != 0) && (dynamic->depth_bounds[0] == minDepthBounds) &&
+        (dynamic->depth_bounds[1] == maxDepthBounds))
+    {
+        return true;
+    }
+
+    dynamic->depth_bounds[0] = minDepthBounds;
+    dynamic->depth_bounds[1] = maxDepthBounds;
+    dynamic->valid |= kDepthBoundsValid;
+    return false;
+}
+
+#endif // REDUNDANT_STATE_BOUND_STATE_H
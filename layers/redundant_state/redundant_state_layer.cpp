@@ -0,0 +1,1080 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_redundant_state"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Redundant state change elimination layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+#include "base_layer/command_buffer_tracker.inc"
+#include "bound_state.h"
+
+#include <atomic>
+
+// State bound in a command buffer is tracked while it is recorded, and bind and dynamic state commands that would set
+// the values already bound are not forwarded, see bound_state.h. The state of a command buffer is unknown at the start
+// of recording, after vkCmdExecuteCommands and after vkCmdExecuteGeneratedCommandsNV. A device stops being filtered
+// once a vkCmd* command that is not in the dispatch table is handed out for it, as the layer cannot know which state
+// that command changes.
+struct elimination_stats
+{
+    uint32_t calls{ 0 };
+    uint32_t pipelines{ 0 };
+    uint32_t descriptor_sets{ 0 };
+    uint32_t vertex_buffers{ 0 };
+    uint32_t index_buffers{ 0 };
+    uint32_t dynamic_state{ 0 };
+};
+
+// Attached to the dispatch table of each device as its layer data.
+struct device_state
+{
+    std::atomic<bool> unfiltered{ false };
+};
+
+struct command_buffer_record
+{
+    command_buffer_state state;
+    elimination_stats    stats;
+};
+
+static bool IsDeviceFiltered(const base_layer::device_dispatch_table* device_table)
+{
+    const device_state* state = static_cast<const device_state*>(device_table->layer_data);
+    return (state == nullptr) || !state->unfiltered.load(std::memory_order_acquire);
+}
+
+// The record of a command buffer is nullptr in its recording context when the layer did not see it being allocated or
+// its device is unfiltered, and it is then never filtered.
+using recording_context = base_layer::command_buffer_tracker<command_buffer_record>::recording_context;
+
+static base_layer::command_buffer_tracker<command_buffer_record> command_buffers(IsDeviceFiltered);
+
+static std::atomic<uint64_t> total_calls{ 0 };
+static std::atomic<uint64_t> eliminated_pipelines{ 0 };
+static std::atomic<uint64_t> eliminated_descriptor_sets{ 0 };
+static std::atomic<uint64_t> eliminated_vertex_buffers{ 0 };
+static std::atomic<uint64_t> eliminated_index_buffers{ 0 };
+static std::atomic<uint64_t> eliminated_dynamic_state{ 0 };
+
+static void DisableFiltering(VkDevice device, const char* pName)
+{
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table == nullptr)
+    {
+        return;
+    }
+
+    device_state* state = static_cast<device_state*>(device_table->layer_data);
+    if ((state != nullptr) && !state->unfiltered.exchange(true, std::memory_order_acq_rel))
+    {
+        // The flag is seen by the next command recorded by each thread
+        command_buffers.invalidate_recording_contexts();
+
+        base_layer::base_layer_print_info(
+            "Redundant state: %s is not known to the layer, command buffers of device %p are not filtered\n",
+            pName,
+            static_cast<void*>(device));
+    }
+}
+
+static void AccumulateStats(const elimination_stats& stats)
+{
+    total_calls.fetch_add(stats.calls, std::memory_order_relaxed);
+    eliminated_pipelines.fetch_add(stats.pipelines, std::memory_order_relaxed);
+    eliminated_descriptor_sets.fetch_add(stats.descriptor_sets, std::memory_order_relaxed);
+    eliminated_vertex_buffers.fetch_add(stats.vertex_buffers, std::memory_order_relaxed);
+    eliminated_index_buffers.fetch_add(stats.index_buffers, std::memory_order_relaxed);
+    eliminated_dynamic_state.fetch_add(stats.dynamic_state, std::memory_order_relaxed);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    base_layer::get_device_handle(*pDevice)->layer_data = new device_state();
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table != nullptr)
+    {
+        delete static_cast<device_state*>(device_table->layer_data);
+        device_table->layer_data = nullptr;
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyInstance(VkInstance instance, const VkAllocationCallbacks* pAllocator)
+{
+    const uint64_t eliminated = eliminated_pipelines.load() + eliminated_descriptor_sets.load() +
+                                eliminated_vertex_buffers.load() + eliminated_index_buffers.load() +
+                                eliminated_dynamic_state.load();
+    base_layer::base_layer_print_info("Redundant state: %llu of %llu calls eliminated (%llu pipelines, %llu descriptor "
+                                      "sets, %llu vertex buffers, %llu index buffers, %llu dynamic state)\n",
+                                      static_cast<unsigned long long>(eliminated),
+                                      static_cast<unsigned long long>(total_calls.load()),
+                                      static_cast<unsigned long long>(eliminated_pipelines.load()),
+                                      static_cast<unsigned long long>(eliminated_descriptor_sets.load()),
+                                      static_cast<unsigned long long>(eliminated_vertex_buffers.load()),
+                                      static_cast<unsigned long long>(eliminated_index_buffers.load()),
+                                      static_cast<unsigned long long>(eliminated_dynamic_state.load()));
+
+    // Forward function to next layer / driver through the base layer, which releases the instance's dispatch table
+    base_layer::base_layer_DestroyInstance(instance, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_AllocateCommandBuffers(VkDevice                           device,
+                                                            const VkCommandBufferAllocateInfo* pAllocateInfo,
+                                                            VkCommandBuffer*                   pCommandBuffers)
+{
+    // Forward function to next layer / driver through the base layer, which registers the command buffers
+    VkResult result = base_layer::base_layer_AllocateCommandBuffers(device, pAllocateInfo, pCommandBuffers);
+
+    if (result == VK_SUCCESS)
+    {
+        command_buffers.add(device, pAllocateInfo->commandPool, pAllocateInfo->commandBufferCount, pCommandBuffers);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_FreeCommandBuffers(VkDevice               device,
+                                                    VkCommandPool          commandPool,
+                                                    uint32_t               commandBufferCount,
+                                                    const VkCommandBuffer* pCommandBuffers)
+{
+    // Forward function to next layer / driver through the base layer, which unregisters the command buffers
+    base_layer::base_layer_FreeCommandBuffers(device, commandPool, commandBufferCount, pCommandBuffers);
+
+    command_buffers.remove(commandBufferCount, pCommandBuffers);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_ResetCommandPool(VkDevice                device,
+                                                      VkCommandPool           commandPool,
+                                                      VkCommandPoolResetFlags flags)
+{
+    command_buffers.reset_pool(device, commandPool, [](command_buffer_record* record) { *record = {}; });
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.ResetCommandPool(device, commandPool, flags);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyCommandPool(VkDevice                     device,
+                                                    VkCommandPool                commandPool,
+                                                    const VkAllocationCallbacks* pAllocator)
+{
+    // Forward function to next layer / driver through the base layer, which unregisters the pool's command buffers
+    base_layer::base_layer_DestroyCommandPool(device, commandPool, pAllocator);
+
+    command_buffers.destroy_pool(device, commandPool);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BeginCommandBuffer(VkCommandBuffer                 commandBuffer,
+                                                        const VkCommandBufferBeginInfo* pBeginInfo)
+{
+    // Forward function to next layer / driver
+    VkResult           result  = VK_SUCCESS;
+    recording_context* context = command_buffers.get_recording_context_slow(commandBuffer);
+    if (context != nullptr)
+    {
+        if (context->record != nullptr)
+        {
+            InvalidateState(&context->record->state);
+            context->record->stats = {};
+        }
+
+        result = context->dispatch_table->BeginCommandBuffer(commandBuffer, pBeginInfo);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_EndCommandBuffer(VkCommandBuffer commandBuffer)
+{
+    // Forward function to next layer / driver
+    VkResult           result  = VK_SUCCESS;
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        if (context->record != nullptr)
+        {
+            AccumulateStats(context->record->stats);
+            context->record->stats = {};
+        }
+
+        result = context->dispatch_table->EndCommandBuffer(commandBuffer);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_ResetCommandBuffer(VkCommandBuffer commandBuffer, VkCommandBufferResetFlags flags)
+{
+    // Forward function to next layer / driver
+    VkResult           result  = VK_SUCCESS;
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context != nullptr)
+    {
+        if (context->record != nullptr)
+        {
+            InvalidateState(&context->record->state);
+            context->record->stats = {};
+        }
+
+        result = context->dispatch_table->ResetCommandBuffer(commandBuffer, flags);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindPipeline(VkCommandBuffer     commandBuffer,
+                                                 VkPipelineBindPoint pipelineBindPoint,
+                                                 VkPipeline          pipeline)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    const uint32_t         index  = GetBindPointIndex(pipelineBindPoint);
+    if ((record != nullptr) && (index < kBindPointCount))
+    {
+        ++record->stats.calls;
+
+        if (SetPipeline(&record->state, index, pipeline))
+        {
+            ++record->stats.pipelines;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdBindPipeline(commandBuffer, pipelineBindPoint, pipeline);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindPipelineShaderGroupNV(VkCommandBuffer     commandBuffer,
+                                                              VkPipelineBindPoint pipelineBindPoint,
+                                                              VkPipeline          pipeline,
+                                                              uint32_t            groupIndex)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // Binding the pipeline again selects its default shader group, so the next vkCmdBindPipeline is not redundant
+    const uint32_t index = GetBindPointIndex(pipelineBindPoint);
+    if ((context->record != nullptr) && (index < kBindPointCount))
+    {
+        context->record->state.bind_points[index].pipeline = VK_NULL_HANDLE;
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdBindPipelineShaderGroupNV(commandBuffer, pipelineBindPoint, pipeline, groupIndex);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindShadersEXT(VkCommandBuffer              commandBuffer,
+                                                   uint32_t                     stageCount,
+                                                   const VkShaderStageFlagBits* pStages,
+                                                   const VkShaderEXT*           pShaders)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    if (context->record != nullptr)
+    {
+        UnbindPipelines(&context->record->state);
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdBindShadersEXT(commandBuffer, stageCount, pStages, pShaders);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindDescriptorSets(VkCommandBuffer        commandBuffer,
+                                                       VkPipelineBindPoint    pipelineBindPoint,
+                                                       VkPipelineLayout       layout,
+                                                       uint32_t               firstSet,
+                                                       uint32_t               descriptorSetCount,
+                                                       const VkDescriptorSet* pDescriptorSets,
+                                                       uint32_t               dynamicOffsetCount,
+                                                       const uint32_t*        pDynamicOffsets)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    const uint32_t         index  = GetBindPointIndex(pipelineBindPoint);
+    if ((record != nullptr) && (index < kBindPointCount))
+    {
+        ++record->stats.calls;
+
+        if (SetDescriptorSets(&record->state.bind_points[index],
+                              layout,
+                              firstSet,
+                              descriptorSetCount,
+                              pDescriptorSets,
+                              dynamicOffsetCount))
+        {
+            ++record->stats.descriptor_sets;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdBindDescriptorSets(commandBuffer,
+                                                   pipelineBindPoint,
+                                                   layout,
+                                                   firstSet,
+                                                   descriptorSetCount,
+                                                   pDescriptorSets,
+                                                   dynamicOffsetCount,
+                                                   pDynamicOffsets);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdPushDescriptorSetKHR(VkCommandBuffer             commandBuffer,
+                                                         VkPipelineBindPoint         pipelineBindPoint,
+                                                         VkPipelineLayout            layout,
+                                                         uint32_t                    set,
+                                                         uint32_t                    descriptorWriteCount,
+                                                         const VkWriteDescriptorSet* pDescriptorWrites)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    const uint32_t index = GetBindPointIndex(pipelineBindPoint);
+    if ((context->record != nullptr) && (index < kBindPointCount))
+    {
+        InvalidateDescriptorSets(&context->record->state.bind_points[index]);
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdPushDescriptorSetKHR(
+        commandBuffer, pipelineBindPoint, layout, set, descriptorWriteCount, pDescriptorWrites);
+}
+
+VKAPI_ATTR void VKAPI_CALL
+layer_CmdPushDescriptorSetWithTemplateKHR(VkCommandBuffer            commandBuffer,
+                                          VkDescriptorUpdateTemplate descriptorUpdateTemplate,
+                                          VkPipelineLayout           layout,
+                                          uint32_t                   set,
+                                          const void*                pData)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // The bind point is part of the template
+    if (context->record != nullptr)
+    {
+        for (bind_point_state& bind_point : context->record->state.bind_points)
+        {
+            InvalidateDescriptorSets(&bind_point);
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdPushDescriptorSetWithTemplateKHR(
+        commandBuffer, descriptorUpdateTemplate, layout, set, pData);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindVertexBuffers(VkCommandBuffer     commandBuffer,
+                                                      uint32_t            firstBinding,
+                                                      uint32_t            bindingCount,
+                                                      const VkBuffer*     pBuffers,
+                                                      const VkDeviceSize* pOffsets)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        if (SetVertexBuffers(&record->state, firstBinding, bindingCount, pBuffers, pOffsets))
+        {
+            ++record->stats.vertex_buffers;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdBindVertexBuffers(commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindVertexBuffers2(VkCommandBuffer     commandBuffer,
+                                                       uint32_t            firstBinding,
+                                                       uint32_t            bindingCount,
+                                                       const VkBuffer*     pBuffers,
+                                                       const VkDeviceSize* pOffsets,
+                                                       const VkDeviceSize* pSizes,
+                                                       const VkDeviceSize* pStrides)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // Sizes and strides are not tracked
+    if (context->record != nullptr)
+    {
+        context->record->state.vertex_buffer_mask = 0;
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdBindVertexBuffers2(
+        commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets, pSizes, pStrides);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindVertexBuffers2EXT(VkCommandBuffer     commandBuffer,
+                                                          uint32_t            firstBinding,
+                                                          uint32_t            bindingCount,
+                                                          const VkBuffer*     pBuffers,
+                                                          const VkDeviceSize* pOffsets,
+                                                          const VkDeviceSize* pSizes,
+                                                          const VkDeviceSize* pStrides)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // Sizes and strides are not tracked
+    if (context->record != nullptr)
+    {
+        context->record->state.vertex_buffer_mask = 0;
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdBindVertexBuffers2EXT(
+        commandBuffer, firstBinding, bindingCount, pBuffers, pOffsets, pSizes, pStrides);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdBindIndexBuffer(VkCommandBuffer commandBuffer,
+                                                    VkBuffer        buffer,
+                                                    VkDeviceSize    offset,
+                                                    VkIndexType     indexType)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        if (SetIndexBuffer(&record->state, buffer, offset, indexType))
+        {
+            ++record->stats.index_buffers;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdBindIndexBuffer(commandBuffer, buffer, offset, indexType);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetViewport(VkCommandBuffer   commandBuffer,
+                                                uint32_t          firstViewport,
+                                                uint32_t          viewportCount,
+                                                const VkViewport* pViewports)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        dynamic_state& dynamic = record->state.dynamic;
+        if (SetTrackedValues(
+                dynamic.viewports, &dynamic.viewport_mask, firstViewport, viewportCount, pViewports, IsSameViewport))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetViewport(commandBuffer, firstViewport, viewportCount, pViewports);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetScissor(VkCommandBuffer commandBuffer,
+                                               uint32_t        firstScissor,
+                                               uint32_t        scissorCount,
+                                               const VkRect2D* pScissors)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        dynamic_state& dynamic = record->state.dynamic;
+        if (SetTrackedValues(
+                dynamic.scissors, &dynamic.scissor_mask, firstScissor, scissorCount, pScissors, IsSameScissor))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetScissor(commandBuffer, firstScissor, scissorCount, pScissors);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetViewportWithCount(VkCommandBuffer   commandBuffer,
+                                                         uint32_t          viewportCount,
+                                                         const VkViewport* pViewports)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // The viewport count is not tracked
+    if (context->record != nullptr)
+    {
+        context->record->state.dynamic.viewport_mask = 0;
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetViewportWithCount(commandBuffer, viewportCount, pViewports);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetViewportWithCountEXT(VkCommandBuffer   commandBuffer,
+                                                            uint32_t          viewportCount,
+                                                            const VkViewport* pViewports)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // The viewport count is not tracked
+    if (context->record != nullptr)
+    {
+        context->record->state.dynamic.viewport_mask = 0;
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetViewportWithCountEXT(commandBuffer, viewportCount, pViewports);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetScissorWithCount(VkCommandBuffer commandBuffer,
+                                                        uint32_t        scissorCount,
+                                                        const VkRect2D* pScissors)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // The scissor count is not tracked
+    if (context->record != nullptr)
+    {
+        context->record->state.dynamic.scissor_mask = 0;
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetScissorWithCount(commandBuffer, scissorCount, pScissors);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetScissorWithCountEXT(VkCommandBuffer commandBuffer,
+                                                           uint32_t        scissorCount,
+                                                           const VkRect2D* pScissors)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // The scissor count is not tracked
+    if (context->record != nullptr)
+    {
+        context->record->state.dynamic.scissor_mask = 0;
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetScissorWithCountEXT(commandBuffer, scissorCount, pScissors);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetLineWidth(VkCommandBuffer commandBuffer, float lineWidth)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        if (SetLineWidth(&record->state.dynamic, lineWidth))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetLineWidth(commandBuffer, lineWidth);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetDepthBias(VkCommandBuffer commandBuffer,
+                                                 float           depthBiasConstantFactor,
+                                                 float           depthBiasClamp,
+                                                 float           depthBiasSlopeFactor)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        if (SetDepthBias(&record->state.dynamic, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetDepthBias(
+        commandBuffer, depthBiasConstantFactor, depthBiasClamp, depthBiasSlopeFactor);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetBlendConstants(VkCommandBuffer commandBuffer, const float blendConstants[4])
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        if (SetBlendConstants(&record->state.dynamic, blendConstants))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetBlendConstants(commandBuffer, blendConstants);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetDepthBounds(VkCommandBuffer commandBuffer,
+                                                   float           minDepthBounds,
+                                                   float           maxDepthBounds)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        if (SetDepthBounds(&record->state.dynamic, minDepthBounds, maxDepthBounds))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetDepthBounds(commandBuffer, minDepthBounds, maxDepthBounds);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetStencilCompareMask(VkCommandBuffer    commandBuffer,
+                                                          VkStencilFaceFlags faceMask,
+                                                          uint32_t           compareMask)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        dynamic_state& dynamic = record->state.dynamic;
+        if (SetStencilValue(&dynamic, kStencilCompareMaskValid, dynamic.stencil_compare_mask, faceMask, compareMask))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetStencilCompareMask(commandBuffer, faceMask, compareMask);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetStencilWriteMask(VkCommandBuffer    commandBuffer,
+                                                        VkStencilFaceFlags faceMask,
+                                                        uint32_t           writeMask)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        dynamic_state& dynamic = record->state.dynamic;
+        if (SetStencilValue(&dynamic, kStencilWriteMaskValid, dynamic.stencil_write_mask, faceMask, writeMask))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetStencilWriteMask(commandBuffer, faceMask, writeMask);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdSetStencilReference(VkCommandBuffer    commandBuffer,
+                                                        VkStencilFaceFlags faceMask,
+                                                        uint32_t           reference)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    command_buffer_record* record = context->record;
+    if (record != nullptr)
+    {
+        ++record->stats.calls;
+
+        dynamic_state& dynamic = record->state.dynamic;
+        if (SetStencilValue(&dynamic, kStencilReferenceValid, dynamic.stencil_reference, faceMask, reference))
+        {
+            ++record->stats.dynamic_state;
+            return;
+        }
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdSetStencilReference(commandBuffer, faceMask, reference);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdExecuteCommands(VkCommandBuffer        commandBuffer,
+                                                    uint32_t               commandBufferCount,
+                                                    const VkCommandBuffer* pCommandBuffers)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // The state of the command buffer is undefined after secondary command buffers are executed
+    if (context->record != nullptr)
+    {
+        InvalidateState(&context->record->state);
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdExecuteCommands(commandBuffer, commandBufferCount, pCommandBuffers);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_CmdExecuteGeneratedCommandsNV(VkCommandBuffer                  commandBuffer,
+                                                               VkBool32                         isPreprocessed,
+                                                               const VkGeneratedCommandsInfoNV* pGeneratedCommandsInfo)
+{
+    recording_context* context = command_buffers.get_recording_context(commandBuffer);
+    if (context == nullptr)
+    {
+        return;
+    }
+
+    // The generated commands can bind shaders, vertex and index buffers and set state, which is undefined afterwards
+    if (context->record != nullptr)
+    {
+        InvalidateState(&context->record->state);
+    }
+
+    // Forward function to next layer / driver
+    context->dispatch_table->CmdExecuteGeneratedCommandsNV(commandBuffer, isPreprocessed, pGeneratedCommandsInfo);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName)
+    {
+        if (!strcmp(pName, "vkDestroyInstance"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyInstance;
+        }
+        else if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkAllocateCommandBuffers"))
+        {
+            result = (PFN_vkVoidFunction)layer_AllocateCommandBuffers;
+        }
+        else if (!strcmp(pName, "vkFreeCommandBuffers"))
+        {
+            result = (PFN_vkVoidFunction)layer_FreeCommandBuffers;
+        }
+        else if (!strcmp(pName, "vkResetCommandPool"))
+        {
+            result = (PFN_vkVoidFunction)layer_ResetCommandPool;
+        }
+        else if (!strcmp(pName, "vkDestroyCommandPool"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyCommandPool;
+        }
+        else if (!strcmp(pName, "vkBeginCommandBuffer"))
+        {
+            result = (PFN_vkVoidFunction)layer_BeginCommandBuffer;
+        }
+        else if (!strcmp(pName, "vkEndCommandBuffer"))
+        {
+            result = (PFN_vkVoidFunction)layer_EndCommandBuffer;
+        }
+        else if (!strcmp(pName, "vkResetCommandBuffer"))
+        {
+            result = (PFN_vkVoidFunction)layer_ResetCommandBuffer;
+        }
+        else if (!strcmp(pName, "vkCmdBindPipeline"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdBindPipeline;
+        }
+        else if (!strcmp(pName, "vkCmdBindPipelineShaderGroupNV"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdBindPipelineShaderGroupNV;
+        }
+        else if (!strcmp(pName, "vkCmdBindShadersEXT"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdBindShadersEXT;
+        }
+        else if (!strcmp(pName, "vkCmdBindDescriptorSets"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdBindDescriptorSets;
+        }
+        else if (!strcmp(pName, "vkCmdPushDescriptorSetKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdPushDescriptorSetKHR;
+        }
+        else if (!strcmp(pName, "vkCmdPushDescriptorSetWithTemplateKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdPushDescriptorSetWithTemplateKHR;
+        }
+        else if (!strcmp(pName, "vkCmdBindVertexBuffers"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdBindVertexBuffers;
+        }
+        else if (!strcmp(pName, "vkCmdBindVertexBuffers2"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdBindVertexBuffers2;
+        }
+        else if (!strcmp(pName, "vkCmdBindVertexBuffers2EXT"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdBindVertexBuffers2EXT;
+        }
+        else if (!strcmp(pName, "vkCmdBindIndexBuffer"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdBindIndexBuffer;
+        }
+        else if (!strcmp(pName, "vkCmdSetViewport"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetViewport;
+        }
+        else if (!strcmp(pName, "vkCmdSetScissor"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetScissor;
+        }
+        else if (!strcmp(pName, "vkCmdSetViewportWithCount"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetViewportWithCount;
+        }
+        else if (!strcmp(pName, "vkCmdSetViewportWithCountEXT"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetViewportWithCountEXT;
+        }
+        else if (!strcmp(pName, "vkCmdSetScissorWithCount"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetScissorWithCount;
+        }
+        else if (!strcmp(pName, "vkCmdSetScissorWithCountEXT"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetScissorWithCountEXT;
+        }
+        else if (!strcmp(pName, "vkCmdSetLineWidth"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetLineWidth;
+        }
+        else if (!strcmp(pName, "vkCmdSetDepthBias"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetDepthBias;
+        }
+        else if (!strcmp(pName, "vkCmdSetBlendConstants"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetBlendConstants;
+        }
+        else if (!strcmp(pName, "vkCmdSetDepthBounds"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetDepthBounds;
+        }
+        else if (!strcmp(pName, "vkCmdSetStencilCompareMask"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetStencilCompareMask;
+        }
+        else if (!strcmp(pName, "vkCmdSetStencilWriteMask"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetStencilWriteMask;
+        }
+        else if (!strcmp(pName, "vkCmdSetStencilReference"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdSetStencilReference;
+        }
+        else if (!strcmp(pName, "vkCmdExecuteCommands"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdExecuteCommands;
+        }
+        else if (!strcmp(pName, "vkCmdExecuteGeneratedCommandsNV"))
+        {
+            result = (PFN_vkVoidFunction)layer_CmdExecuteGeneratedCommandsNV;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+
+        // The application can record a command the layer does not see and that may change the tracked state
+        if ((result != nullptr) && (device != VK_NULL_HANDLE) && base_layer::is_unknown_command_buffer_command(pName))
+        {
+            DisableFiltering(device, pName);
+        }
+    }
+
+    return result;
+}
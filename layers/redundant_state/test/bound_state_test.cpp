@@ -0,0 +1,252 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the rules of the redundant state layer that decide whether a bind or dynamic state command is redundant, with
+// integers standing in for the Vulkan handles.
+
+#include "../bound_state.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (false)
+
+template <typename Handle>
+static Handle MakeHandle(uintptr_t value)
+{
+    return reinterpret_cast<Handle>(value);
+}
+
+static const VkPipeline       kPipelineA = MakeHandle<VkPipeline>(1);
+static const VkPipeline       kPipelineB = MakeHandle<VkPipeline>(2);
+static const VkPipelineLayout kLayoutA   = MakeHandle<VkPipelineLayout>(3);
+static const VkPipelineLayout kLayoutB   = MakeHandle<VkPipelineLayout>(4);
+static const VkDescriptorSet  kSetA      = MakeHandle<VkDescriptorSet>(5);
+static const VkDescriptorSet  kSetB      = MakeHandle<VkDescriptorSet>(6);
+static const VkBuffer         kBufferA   = MakeHandle<VkBuffer>(7);
+static const VkBuffer         kBufferB   = MakeHandle<VkBuffer>(8);
+
+static void TestPipelines()
+{
+    command_buffer_state state;
+    const uint32_t       graphics = GetBindPointIndex(VK_PIPELINE_BIND_POINT_GRAPHICS);
+    const uint32_t       compute  = GetBindPointIndex(VK_PIPELINE_BIND_POINT_COMPUTE);
+
+    CHECK(!SetPipeline(&state, graphics, kPipelineA));
+    CHECK(SetPipeline(&state, graphics, kPipelineA));
+    CHECK(!SetPipeline(&state, graphics, kPipelineB));
+
+    // Each bind point has its own pipeline
+    CHECK(!SetPipeline(&state, compute, kPipelineB));
+    CHECK(SetPipeline(&state, graphics, kPipelineB));
+
+    // Binding a null pipeline is never redundant
+    CHECK(!SetPipeline(&state, graphics, VK_NULL_HANDLE));
+    CHECK(!SetPipeline(&state, graphics, VK_NULL_HANDLE));
+
+    CHECK(GetBindPointIndex(VK_PIPELINE_BIND_POINT_MAX_ENUM) == kBindPointCount);
+}
+
+static void TestPipelineBindResetsDynamicState()
+{
+    command_buffer_state state;
+    const uint32_t       graphics = GetBindPointIndex(VK_PIPELINE_BIND_POINT_GRAPHICS);
+    const uint32_t       compute  = GetBindPointIndex(VK_PIPELINE_BIND_POINT_COMPUTE);
+
+    CHECK(!SetPipeline(&state, graphics, kPipelineA));
+    CHECK(!SetLineWidth(&state.dynamic, 2.0f));
+    CHECK(SetLineWidth(&state.dynamic, 2.0f));
+
+    // Binding the pipeline already bound or a compute pipeline keeps the dynamic state
+    CHECK(SetPipeline(&state, graphics, kPipelineA));
+    CHECK(!SetPipeline(&state, compute, kPipelineB));
+    CHECK(SetLineWidth(&state.dynamic, 2.0f));
+
+    // State that a new graphics pipeline does not declare dynamic replaces the values set before
+    CHECK(!SetPipeline(&state, graphics, kPipelineB));
+    CHECK(!SetLineWidth(&state.dynamic, 2.0f));
+}
+
+static void TestDescriptorSets()
+{
+    bind_point_state bind_point;
+
+    const VkDescriptorSet sets[] = { kSetA, kSetB };
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutA, 0, 2, sets, 0));
+    CHECK(SetDescriptorSets(&bind_point, kLayoutA, 0, 2, sets, 0));
+    CHECK(SetDescriptorSets(&bind_point, kLayoutA, 1, 1, &kSetB, 0));
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutA, 1, 1, &kSetA, 0));
+
+    // Sets bound with a different layout forget the other sets
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutB, 0, 1, &kSetA, 0));
+    CHECK(SetDescriptorSets(&bind_point, kLayoutB, 0, 1, &kSetA, 0));
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutB, 1, 1, &kSetA, 0));
+
+    // Null sets are never considered bound
+    const VkDescriptorSet null_set = VK_NULL_HANDLE;
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutB, 2, 1, &null_set, 0));
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutB, 2, 1, &null_set, 0));
+
+    // Sets beyond the tracked ones are never redundant, and forget the tracked ones
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutB, kMaxTrackedSets, 1, &kSetB, 0));
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutB, kMaxTrackedSets, 1, &kSetB, 0));
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutB, 0, 1, &kSetA, 0));
+}
+
+static void TestDescriptorSetsWithDynamicOffsets()
+{
+    bind_point_state bind_point;
+
+    // The offsets are not tracked, so sets bound with dynamic offsets are never redundant
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutA, 0, 1, &kSetA, 1));
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutA, 0, 1, &kSetA, 1));
+
+    // Nor are they known to be bound once they are bound again without offsets
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutA, 0, 1, &kSetA, 0));
+    CHECK(SetDescriptorSets(&bind_point, kLayoutA, 0, 1, &kSetA, 0));
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutA, 0, 1, &kSetA, 1));
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutA, 0, 1, &kSetA, 0));
+
+    // Push descriptors forget the sets of the bind point
+    InvalidateDescriptorSets(&bind_point);
+    CHECK(!SetDescriptorSets(&bind_point, kLayoutA, 0, 1, &kSetA, 0));
+}
+
+static void TestVertexAndIndexBuffers()
+{
+    command_buffer_state state;
+
+    const VkBuffer     buffers[] = { kBufferA, kBufferB };
+    const VkDeviceSize offsets[] = { 0, 64 };
+    CHECK(!SetVertexBuffers(&state, 0, 2, buffers, offsets));
+    CHECK(SetVertexBuffers(&state, 0, 2, buffers, offsets));
+    CHECK(SetVertexBuffers(&state, 1, 1, &buffers[1], &offsets[1]));
+    CHECK(!SetVertexBuffers(&state, 1, 1, &buffers[1], &offsets[0]));
+    CHECK(!SetVertexBuffers(&state, 2, 1, &buffers[1], &offsets[1]));
+
+    // Bindings beyond the tracked ones forget the tracked ones
+    CHECK(!SetVertexBuffers(&state, kMaxTrackedVertexBuffers, 1, buffers, offsets));
+    CHECK(!SetVertexBuffers(&state, 0, 1, buffers, offsets));
+
+    CHECK(!SetIndexBuffer(&state, kBufferA, 0, VK_INDEX_TYPE_UINT16));
+    CHECK(SetIndexBuffer(&state, kBufferA, 0, VK_INDEX_TYPE_UINT16));
+    CHECK(!SetIndexBuffer(&state, kBufferA, 0, VK_INDEX_TYPE_UINT32));
+    CHECK(!SetIndexBuffer(&state, kBufferA, 128, VK_INDEX_TYPE_UINT32));
+    CHECK(!SetIndexBuffer(&state, VK_NULL_HANDLE, 0, VK_INDEX_TYPE_UINT32));
+    CHECK(!SetIndexBuffer(&state, VK_NULL_HANDLE, 0, VK_INDEX_TYPE_UINT32));
+}
+
+static void TestDynamicState()
+{
+    dynamic_state dynamic;
+
+    const VkViewport viewports[] = { { 0.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f },
+                                     { 64.0f, 0.0f, 64.0f, 64.0f, 0.0f, 1.0f } };
+    CHECK(!SetTrackedValues(dynamic.viewports, &dynamic.viewport_mask, 0, 2, viewports, IsSameViewport));
+    CHECK(SetTrackedValues(dynamic.viewports, &dynamic.viewport_mask, 1, 1, &viewports[1], IsSameViewport));
+    CHECK(!SetTrackedValues(dynamic.viewports, &dynamic.viewport_mask, 1, 1, &viewports[0], IsSameViewport));
+    CHECK(!SetTrackedValues(dynamic.viewports, &dynamic.viewport_mask, 2, 1, &viewports[0], IsSameViewport));
+
+    const VkRect2D scissor = { { 0, 0 }, { 64, 64 } };
+    CHECK(!SetTrackedValues(dynamic.scissors, &dynamic.scissor_mask, 0, 1, &scissor, IsSameScissor));
+    CHECK(SetTrackedValues(dynamic.scissors, &dynamic.scissor_mask, 0, 1, &scissor, IsSameScissor));
+
+    CHECK(!SetDepthBias(&dynamic, 1.0f, 0.0f, 2.0f));
+    CHECK(SetDepthBias(&dynamic, 1.0f, 0.0f, 2.0f));
+    CHECK(!SetDepthBias(&dynamic, 1.0f, 0.5f, 2.0f));
+
+    const float blend_constants[]       = { 0.0f, 0.25f, 0.5f, 1.0f };
+    const float other_blend_constants[] = { 0.0f, 0.25f, 0.5f, 0.75f };
+    CHECK(!SetBlendConstants(&dynamic, blend_constants));
+    CHECK(SetBlendConstants(&dynamic, blend_constants));
+    CHECK(!SetBlendConstants(&dynamic, other_blend_constants));
+
+    CHECK(!SetDepthBounds(&dynamic, 0.0f, 1.0f));
+    CHECK(SetDepthBounds(&dynamic, 0.0f, 1.0f));
+    CHECK(!SetDepthBounds(&dynamic, 0.0f, 0.5f));
+
+    // Stencil values are tracked per face
+    CHECK(!SetStencilValue(
+        &dynamic, kStencilReferenceValid, dynamic.stencil_reference, VK_STENCIL_FACE_FRONT_BIT, 1));
+    CHECK(SetStencilValue(&dynamic, kStencilReferenceValid, dynamic.stencil_reference, VK_STENCIL_FACE_FRONT_BIT, 1));
+    CHECK(!SetStencilValue(
+        &dynamic, kStencilReferenceValid, dynamic.stencil_reference, VK_STENCIL_FACE_FRONT_AND_BACK, 1));
+    CHECK(SetStencilValue(&dynamic, kStencilReferenceValid, dynamic.stencil_reference, VK_STENCIL_FACE_BACK_BIT, 1));
+    CHECK(!SetStencilValue(
+        &dynamic, kStencilCompareMaskValid, dynamic.stencil_compare_mask, VK_STENCIL_FACE_BACK_BIT, 1));
+}
+
+static void TestInvalidation()
+{
+    command_buffer_state state;
+    const uint32_t       graphics = GetBindPointIndex(VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+    // Binding shader objects with vkCmdBindShadersEXT unbinds the pipelines
+    CHECK(!SetPipeline(&state, graphics, kPipelineA));
+    UnbindPipelines(&state);
+    CHECK(!SetPipeline(&state, graphics, kPipelineA));
+
+    // Everything is unknown after vkCmdExecuteCommands
+    const VkDeviceSize offset = 0;
+    CHECK(!SetDescriptorSets(&state.bind_points[graphics], kLayoutA, 0, 1, &kSetA, 0));
+    CHECK(!SetVertexBuffers(&state, 0, 1, &kBufferA, &offset));
+    CHECK(!SetIndexBuffer(&state, kBufferB, 0, VK_INDEX_TYPE_UINT16));
+    CHECK(!SetLineWidth(&state.dynamic, 1.0f));
+    InvalidateState(&state);
+    CHECK(!SetPipeline(&state, graphics, kPipelineA));
+    CHECK(!SetDescriptorSets(&state.bind_points[graphics], kLayoutA, 0, 1, &kSetA, 0));
+    CHECK(!SetVertexBuffers(&state, 0, 1, &kBufferA, &offset));
+    CHECK(!SetIndexBuffer(&state, kBufferB, 0, VK_INDEX_TYPE_UINT16));
+    CHECK(!SetLineWidth(&state.dynamic, 1.0f));
+}
+
+int main()
+{
+    TestPipelines();
+    TestPipelineBindResetsDynamicState();
+    TestDescriptorSets();
+    TestDescriptorSetsWithDynamicOffsets();
+    TestVertexAndIndexBuffers();
+    TestDynamicState();
+    TestInvalidation();
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
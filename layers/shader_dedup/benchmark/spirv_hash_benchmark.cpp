@@ -0,0 +1,128 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the throughput of the shader dedup layer's SPIR-V hash over modules of several sizes, with the SIMD and the
+// portable implementations. For reference, it also measures a word-wise FNV-1a hash and memcmp. memcmp stands for the
+// comparison that confirms a hash match. Run with the number of MiB hashed per measurement as the optional first
+// argument.
+
+#include "../spirv_hash.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Keeps the results alive so that the hashes are not optimized away
+static volatile uint64_t sink = 0;
+
+static std::vector<uint32_t> MakeCode(size_t word_count, uint32_t seed)
+{
+    std::vector<uint32_t> code(word_count);
+    uint32_t              state = seed;
+    for (uint32_t& word : code)
+    {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        word = state;
+    }
+
+    return code;
+}
+
+static uint64_t HashFnv1a(const uint32_t* code, size_t code_size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < code_size / sizeof(uint32_t); ++i)
+    {
+        hash = (hash ^ code[i]) * 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+template <typename Call>
+static void Measure(const char* name, size_t code_size, size_t total_size, Call call)
+{
+    const size_t iterations = std::max(total_size / code_size, size_t(1));
+
+    // Warms up the caches of the CPU
+    for (size_t i = 0; i < (iterations / 16); ++i)
+    {
+        sink = sink + call();
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        sink = sink + call();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    printf("%-8s %8zu bytes %10.2f GB/s %12.1f ns/module\n",
+           name,
+           code_size,
+           static_cast<double>(iterations * code_size) / ns,
+           ns / iterations);
+}
+
+int main(int argc, char** argv)
+{
+    size_t total_mib = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 1024;
+    if (total_mib == 0)
+    {
+        total_mib = 1;
+    }
+
+    // Sizes of small to large SPIR-V modules, with a tail that is not a whole number of stripes
+    const size_t kCodeSizes[] = { 260, 4 * 1024 + 4, 64 * 1024 + 12, 1024 * 1024 + 20 };
+
+#if defined(SPIRV_HASH_SSE2)
+    printf("%zu MiB per measurement, SSE2\n", total_mib);
+#elif defined(SPIRV_HASH_NEON)
+    printf("%zu MiB per measurement, NEON\n", total_mib);
+#else
+    printf("%zu MiB per measurement, no SIMD implementation\n", total_mib);
+#endif
+
+    for (size_t code_size : kCodeSizes)
+    {
+        const std::vector<uint32_t> code  = MakeCode(code_size / sizeof(uint32_t), 7);
+        const std::vector<uint32_t> copy  = code;
+        const size_t                total = total_mib * 1024 * 1024;
+
+        Measure("simd", code_size, total, [&]() { return spirv_hash::HashCode(code.data(), code_size); });
+        Measure("scalar", code_size, total, [&]() { return spirv_hash::HashCodeScalar(code.data(), code_size); });
+        Measure("fnv1a", code_size, total, [&]() { return HashFnv1a(code.data(), code_size); });
+        Measure("memcmp", code_size, total, [&]() {
+            return static_cast<uint64_t>(std::memcmp(code.data(), copy.data(), code_size));
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
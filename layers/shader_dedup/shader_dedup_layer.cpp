@@ -0,0 +1,302 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_shader_dedup"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Shader module deduplication layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+
+#include "spirv_hash.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// Shader modules created from identical SPIR-V share one module, which is destroyed with its last reference. Only
+// modules created without a pNext chain, flags or allocation callbacks are shared, and devices that enable the
+// privateData feature are left alone as it requires handles to be unique.
+struct shared_module
+{
+    VkShaderModule        module{ VK_NULL_HANDLE };
+    std::vector<uint32_t> code;
+    uint64_t              hash{ 0 };
+    uint32_t              references{ 0 };
+};
+
+struct device_modules
+{
+    std::mutex                                                                lock;
+    std::unordered_map<uint64_t, std::vector<std::unique_ptr<shared_module>>> modules_by_hash;
+    std::unordered_map<VkShaderModule, shared_module*>                        modules_by_handle;
+
+    uint64_t created_count{ 0 };
+    uint64_t shared_count{ 0 };
+    uint64_t hashed_bytes{ 0 };
+    uint64_t hash_ns{ 0 };
+};
+
+static std::shared_mutex                                              device_lock;
+static std::unordered_map<VkDevice, std::unique_ptr<device_modules>> devices;
+
+static device_modules* GetDeviceModules(VkDevice device)
+{
+    std::shared_lock<std::shared_mutex> lock(device_lock);
+    auto                                entry = devices.find(device);
+    return (entry != devices.end()) ? entry->second.get() : nullptr;
+}
+
+// Must be called with modules->lock held.
+static shared_module* FindModule(device_modules* modules, uint64_t hash, const VkShaderModuleCreateInfo* pCreateInfo)
+{
+    auto entry = modules->modules_by_hash.find(hash);
+    if (entry == modules->modules_by_hash.end())
+    {
+        return nullptr;
+    }
+
+    const size_t word_count = pCreateInfo->codeSize / sizeof(uint32_t);
+    for (const std::unique_ptr<shared_module>& module : entry->second)
+    {
+        if ((module->code.size() == word_count) &&
+            (std::memcmp(module->code.data(), pCreateInfo->pCode, pCreateInfo->codeSize) == 0))
+        {
+            return module.get();
+        }
+    }
+
+    return nullptr;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pAllocator;
+
+    if (!base_layer::is_private_data_enabled(pCreateInfo))
+    {
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        devices[*pDevice] = std::make_unique<device_modules>();
+    }
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    std::unique_ptr<device_modules> modules;
+    {
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        auto                                entry = devices.find(device);
+        if (entry != devices.end())
+        {
+            modules = std::move(entry->second);
+            devices.erase(entry);
+        }
+    }
+
+    if (modules != nullptr)
+    {
+        const double seconds = static_cast<double>(modules->hash_ns) / 1e9;
+        base_layer::base_layer_print_info("Shader module deduplication: %llu of %llu modules shared, %llu bytes hashed "
+                                          "at %.2f GB/s\n",
+                                          static_cast<unsigned long long>(modules->shared_count),
+                                          static_cast<unsigned long long>(modules->created_count),
+                                          static_cast<unsigned long long>(modules->hashed_bytes),
+                                          (seconds > 0.0) ? static_cast<double>(modules->hashed_bytes) / 1e9 / seconds
+                                                          : 0.0);
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateShaderModule(VkDevice                        device,
+                                                        const VkShaderModuleCreateInfo* pCreateInfo,
+                                                        const VkAllocationCallbacks*    pAllocator,
+                                                        VkShaderModule*                 pShaderModule)
+{
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+    device_modules*    modules        = GetDeviceModules(device);
+    if ((modules == nullptr) || (pCreateInfo->pNext != nullptr) || (pCreateInfo->flags != 0) ||
+        (pAllocator != nullptr))
+    {
+        // Forward function to next layer / driver
+        return dispatch_table.CreateShaderModule(device, pCreateInfo, pAllocator, pShaderModule);
+    }
+
+    const uint64_t start_ns = base_layer::get_timestamp_ns();
+    const uint64_t hash     = spirv_hash::HashCode(pCreateInfo->pCode, pCreateInfo->codeSize);
+    const uint64_t hash_ns  = base_layer::get_timestamp_ns() - start_ns;
+
+    {
+        std::lock_guard<std::mutex> lock(modules->lock);
+        ++modules->created_count;
+        modules->hashed_bytes += pCreateInfo->codeSize;
+        modules->hash_ns += hash_ns;
+
+        shared_module* module = FindModule(modules, hash, pCreateInfo);
+        if (module != nullptr)
+        {
+            ++module->references;
+            ++modules->shared_count;
+            *pShaderModule = module->module;
+            return VK_SUCCESS;
+        }
+    }
+
+    // Forward function to next layer / driver. The module is created without holding the lock, so another thread may
+    // have added the same code in the meantime.
+    VkShaderModule new_module = VK_NULL_HANDLE;
+    VkResult       result     = dispatch_table.CreateShaderModule(device, pCreateInfo, pAllocator, &new_module);
+    if (result != VK_SUCCESS)
+    {
+        return result;
+    }
+
+    std::lock_guard<std::mutex> lock(modules->lock);
+    shared_module*              module = FindModule(modules, hash, pCreateInfo);
+    if (module != nullptr)
+    {
+        dispatch_table.DestroyShaderModule(device, new_module, pAllocator);
+        ++module->references;
+        ++modules->shared_count;
+        *pShaderModule = module->module;
+        return VK_SUCCESS;
+    }
+
+    std::unique_ptr<shared_module> added = std::make_unique<shared_module>();
+    added->module                        = new_module;
+    added->code.assign(pCreateInfo->pCode, pCreateInfo->pCode + pCreateInfo->codeSize / sizeof(uint32_t));
+    added->hash       = hash;
+    added->references = 1;
+
+    modules->modules_by_handle[new_module] = added.get();
+    modules->modules_by_hash[hash].push_back(std::move(added));
+
+    *pShaderModule = new_module;
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyShaderModule(VkDevice                     device,
+                                                     VkShaderModule               shaderModule,
+                                                     const VkAllocationCallbacks* pAllocator)
+{
+    device_modules* modules = GetDeviceModules(device);
+    if ((modules != nullptr) && (shaderModule != VK_NULL_HANDLE))
+    {
+        std::lock_guard<std::mutex> lock(modules->lock);
+        auto                        entry = modules->modules_by_handle.find(shaderModule);
+        if (entry != modules->modules_by_handle.end())
+        {
+            shared_module* module = entry->second;
+            if (--module->references > 0)
+            {
+                return;
+            }
+
+            std::vector<std::unique_ptr<shared_module>>& bucket = modules->modules_by_hash[module->hash];
+            bucket.erase(std::find_if(
+                bucket.begin(), bucket.end(), [module](const std::unique_ptr<shared_module>& candidate) {
+                    return candidate.get() == module;
+                }));
+            if (bucket.empty())
+            {
+                modules->modules_by_hash.erase(module->hash);
+            }
+
+            modules->modules_by_handle.erase(entry);
+        }
+    }
+
+    // Forward function to next layer / driver
+    base_layer::get_device_handle(device)->dispatch_table.DestroyShaderModule(device, shaderModule, pAllocator);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName)
+    {
+        if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkCreateShaderModule"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateShaderModule;
+        }
+        else if (!strcmp(pName, "vkDestroyShaderModule"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyShaderModule;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
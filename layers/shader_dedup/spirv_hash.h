@@ -0,0 +1,294 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SHADER_DEDUP_SPIRV_HASH_H
+#define SHADER_DEDUP_SPIRV_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define SPIRV_HASH_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define SPIRV_HASH_NEON
+#endif
+
+// Hashes SPIR-V code in the style of XXH3. The code is consumed in stripes of 32 bytes by four 64-bit lanes, each of
+// which adds the product of the low and high halves of its input word mixed with a key, and the input word of its
+// neighbour. The keys advance by one word per stripe, and the lanes are scrambled after each block of stripes so that
+// the order of the stripes matters. The stripes are accumulated with SSE2 or NEON where available, two lanes per
+// register using their 32x32->64 bit multiplies, and with portable code otherwise. Both give the same hash.
+namespace spirv_hash
+{
+
+static constexpr size_t   kLaneCount       = 4;
+static constexpr size_t   kStripeSize      = kLaneCount * sizeof(uint64_t);
+static constexpr size_t   kStripesPerBlock = 16;
+static constexpr size_t   kBlockSize       = kStripeSize * kStripesPerBlock;
+static constexpr size_t   kSecretWords     = kStripesPerBlock + 2 * kLaneCount; // Stripe keys, then scramble keys
+static constexpr uint64_t kPrime1          = 0x9e3779b185ebca87ull;
+static constexpr uint64_t kPrime2          = 0xc2b2ae3d27d4eb4full;
+static constexpr uint64_t kPrime3          = 0x165667b19e3779f9ull;
+static constexpr uint64_t kPrime4          = 0x85ebca77c2b2ae63ull;
+static constexpr uint32_t kScramblePrime   = 0x9e3779b1u;
+
+struct secret
+{
+    uint64_t words[kSecretWords];
+};
+
+// Fills the keys with splitmix64 output
+static constexpr secret MakeSecret()
+{
+    secret   result{};
+    uint64_t state = kPrime1;
+    for (size_t i = 0; i < kSecretWords; ++i)
+    {
+        state += 0x9e3779b97f4a7c15ull;
+        uint64_t value  = state;
+        value           = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value           = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        result.words[i] = value ^ (value >> 31);
+    }
+
+    return result;
+}
+
+static constexpr secret kSecret = MakeSecret();
+
+static inline uint64_t RotateLeft(uint64_t value, uint32_t bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t HashRound(uint64_t accumulator, uint64_t input)
+{
+    return RotateLeft(accumulator + input * kPrime2, 31) * kPrime1;
+}
+
+static inline void AccumulateStripesScalar(uint64_t* lanes, const uint8_t* input, size_t stripe_count)
+{
+    for (size_t stripe = 0; stripe < stripe_count; ++stripe)
+    {
+        uint64_t words[kLaneCount];
+        std::memcpy(words, input + stripe * kStripeSize, sizeof(words));
+
+        const uint64_t* keys = kSecret.words + stripe;
+        for (size_t i = 0; i < kLaneCount; ++i)
+        {
+            const uint64_t word_key = words[i] ^ keys[i];
+            lanes[i ^ 1] += words[i];
+            lanes[i] += (word_key & 0xffffffffull) * (word_key >> 32);
+        }
+    }
+}
+
+static inline void ScrambleLanesScalar(uint64_t* lanes)
+{
+    const uint64_t* keys = kSecret.words + kStripesPerBlock + kLaneCount;
+    for (size_t i = 0; i < kLaneCount; ++i)
+    {
+        lanes[i] = (lanes[i] ^ (lanes[i] >> 47) ^ keys[i]) * kScramblePrime;
+    }
+}
+
+#if defined(SPIRV_HASH_SSE2)
+
+static inline void AccumulateStripesSimd(uint64_t* lanes, const uint8_t* input, size_t stripe_count)
+{
+    __m128i accumulators[2] = { _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes)),
+                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 2)) };
+
+    for (size_t stripe = 0; stripe < stripe_count; ++stripe)
+    {
+        const __m128i*  words = reinterpret_cast<const __m128i*>(input + stripe * kStripeSize);
+        const uint64_t* keys  = kSecret.words + stripe;
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const __m128i word     = _mm_loadu_si128(words + i);
+            const __m128i key      = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 2 * i));
+            const __m128i word_key = _mm_xor_si128(word, key);
+
+            // Multiplies the low half of each lane with its high half, which the shuffle moves to the low half
+            const __m128i product = _mm_mul_epu32(word_key, _mm_shuffle_epi32(word_key, _MM_SHUFFLE(0, 3, 0, 1)));
+            const __m128i swapped = _mm_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2));
+            accumulators[i]       = _mm_add_epi64(accumulators[i], _mm_add_epi64(product, swapped));
+        }
+    }
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), accumulators[0]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 2), accumulators[1]);
+}
+
+static inline void ScrambleLanesSimd(uint64_t* lanes)
+{
+    const uint64_t* keys  = kSecret.words + kStripesPerBlock + kLaneCount;
+    const __m128i   prime = _mm_set1_epi32(static_cast<int>(kScramblePrime));
+    for (size_t i = 0; i < 2; ++i)
+    {
+        __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 2 * i));
+        lane         = _mm_xor_si128(lane, _mm_srli_epi64(lane, 47));
+        lane         = _mm_xor_si128(lane, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + 2 * i)));
+
+        // 64x32 bit multiply from the products of both halves
+        const __m128i product_low  = _mm_mul_epu32(lane, prime);
+        const __m128i product_high = _mm_mul_epu32(_mm_shuffle_epi32(lane, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+        lane                       = _mm_add_epi64(product_low, _mm_slli_epi64(product_high, 32));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 2 * i), lane);
+    }
+}
+
+#elif defined(SPIRV_HASH_NEON)
+
+static inline void AccumulateStripesSimd(uint64_t* lanes, const uint8_t* input, size_t stripe_count)
+{
+    uint64x2_t accumulators[2] = { vld1q_u64(lanes), vld1q_u64(lanes + 2) };
+
+    for (size_t stripe = 0; stripe < stripe_count; ++stripe)
+    {
+        const uint8_t*  words = input + stripe * kStripeSize;
+        const uint64_t* keys  = kSecret.words + stripe;
+        for (size_t i = 0; i < 2; ++i)
+        {
+            const uint64x2_t word     = vreinterpretq_u64_u8(vld1q_u8(words + 16 * i));
+            const uint64x2_t word_key = veorq_u64(word, vld1q_u64(keys + 2 * i));
+
+            // Multiplies the low half of each lane with its high half
+            accumulators[i] = vaddq_u64(accumulators[i], vextq_u64(word, word, 1));
+            accumulators[i] = vmlal_u32(accumulators[i], vmovn_u64(word_key), vshrn_n_u64(word_key, 32));
+        }
+    }
+
+    vst1q_u64(lanes, accumulators[0]);
+    vst1q_u64(lanes + 2, accumulators[1]);
+}
+
+static inline void ScrambleLanesSimd(uint64_t* lanes)
+{
+    const uint64_t*  keys  = kSecret.words + kStripesPerBlock + kLaneCount;
+    const uint32x2_t prime = vdup_n_u32(kScramblePrime);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        uint64x2_t lane = vld1q_u64(lanes + 2 * i);
+        lane            = veorq_u64(lane, vshrq_n_u64(lane, 47));
+        lane            = veorq_u64(lane, vld1q_u64(keys + 2 * i));
+
+        // 64x32 bit multiply from the products of both halves
+        const uint64x2_t product_high = vshlq_n_u64(vmull_u32(vshrn_n_u64(lane, 32), prime), 32);
+        vst1q_u64(lanes + 2 * i, vmlal_u32(product_high, vmovn_u64(lane), prime));
+    }
+}
+
+#else
+
+// No SIMD implementation for the target
+static inline void AccumulateStripesSimd(uint64_t* lanes, const uint8_t* input, size_t stripe_count)
+{
+    AccumulateStripesScalar(lanes, input, stripe_count);
+}
+
+static inline void ScrambleLanesSimd(uint64_t* lanes)
+{
+    ScrambleLanesScalar(lanes);
+}
+
+#endif
+
+template <bool Simd>
+static uint64_t HashCodeWith(const uint32_t* code, size_t code_size)
+{
+    const uint8_t* bytes             = reinterpret_cast<const uint8_t*>(code);
+    uint64_t       lanes[kLaneCount] = { kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1 };
+    size_t         offset            = 0;
+
+    for (; offset + kBlockSize <= code_size; offset += kBlockSize)
+    {
+        if (Simd)
+        {
+            AccumulateStripesSimd(lanes, bytes + offset, kStripesPerBlock);
+            ScrambleLanesSimd(lanes);
+        }
+        else
+        {
+            AccumulateStripesScalar(lanes, bytes + offset, kStripesPerBlock);
+            ScrambleLanesScalar(lanes);
+        }
+    }
+
+    const size_t stripe_count = (code_size - offset) / kStripeSize;
+    if (Simd)
+    {
+        AccumulateStripesSimd(lanes, bytes + offset, stripe_count);
+    }
+    else
+    {
+        AccumulateStripesScalar(lanes, bytes + offset, stripe_count);
+    }
+    offset += stripe_count * kStripeSize;
+
+    uint64_t hash = code_size * kPrime1;
+    for (uint64_t lane : lanes)
+    {
+        hash = RotateLeft(hash ^ HashRound(0, lane), 27) * kPrime1 + kPrime4;
+    }
+
+    for (; offset + sizeof(uint64_t) <= code_size; offset += sizeof(uint64_t))
+    {
+        uint64_t input;
+        std::memcpy(&input, bytes + offset, sizeof(input));
+        hash = RotateLeft(hash ^ HashRound(0, input), 27) * kPrime1 + kPrime4;
+    }
+
+    for (; offset + sizeof(uint32_t) <= code_size; offset += sizeof(uint32_t))
+    {
+        uint32_t input;
+        std::memcpy(&input, bytes + offset, sizeof(input));
+        hash = RotateLeft(hash ^ (input * kPrime1), 23) * kPrime2 + kPrime3;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// code_size is in bytes and a multiple of 4, as required for SPIR-V.
+static inline uint64_t HashCode(const uint32_t* code, size_t code_size)
+{
+    return HashCodeWith<true>(code, code_size);
+}
+
+// The portable implementation, which HashCode must match.
+static inline uint64_t HashCodeScalar(const uint32_t* code, size_t code_size)
+{
+    return HashCodeWith<false>(code, code_size);
+}
+
+} // namespace spirv_hash
+
+#endif // SHADER_DEDUP_SPIRV_HASH_H
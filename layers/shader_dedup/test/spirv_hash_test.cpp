@@ -0,0 +1,122 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests that the SIMD and portable implementations of the shader dedup layer's SPIR-V hash agree.
+
+#include "../spirv_hash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (false)
+
+static std::vector<uint32_t> MakeCode(size_t word_count, uint32_t seed)
+{
+    std::vector<uint32_t> code(word_count);
+    uint32_t              state = seed;
+    for (uint32_t& word : code)
+    {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        word = state;
+    }
+
+    return code;
+}
+
+static uint64_t Hash(const std::vector<uint32_t>& code)
+{
+    return spirv_hash::HashCode(code.data(), code.size() * sizeof(uint32_t));
+}
+
+static void TestSimdMatchesScalar()
+{
+    // Covers empty code, partial stripes, partial blocks and several blocks, with unaligned code
+    for (size_t word_count = 0; word_count < 3 * spirv_hash::kBlockSize / sizeof(uint32_t) + 9; ++word_count)
+    {
+        std::vector<uint32_t> code = MakeCode(word_count + 1, static_cast<uint32_t>(word_count) + 1);
+        for (size_t first = 0; first < 2; ++first)
+        {
+            const size_t code_size = word_count * sizeof(uint32_t);
+            CHECK(spirv_hash::HashCode(code.data() + first, code_size) ==
+                  spirv_hash::HashCodeScalar(code.data() + first, code_size));
+        }
+    }
+}
+
+static void TestSingleWordChangesHash()
+{
+    const std::vector<uint32_t> code = MakeCode(3 * spirv_hash::kBlockSize / sizeof(uint32_t) + 3, 7);
+    const uint64_t              hash = Hash(code);
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+        std::vector<uint32_t> changed = code;
+        changed[i] ^= 1u << (i % 32);
+        CHECK(Hash(changed) != hash);
+    }
+
+    // Appending a zero word changes the size
+    std::vector<uint32_t> longer = code;
+    longer.push_back(0);
+    CHECK(Hash(longer) != hash);
+}
+
+static void TestStripeOrderChangesHash()
+{
+    // Swapping two stripes of a block keeps the sum of their words
+    const size_t          stripe_words = spirv_hash::kStripeSize / sizeof(uint32_t);
+    std::vector<uint32_t> code         = MakeCode(spirv_hash::kBlockSize / sizeof(uint32_t), 11);
+    std::vector<uint32_t> swapped      = code;
+    std::swap_ranges(swapped.begin(), swapped.begin() + stripe_words, swapped.begin() + stripe_words);
+    CHECK(Hash(swapped) != Hash(code));
+}
+
+int main()
+{
+    TestSimdMatchesScalar();
+    TestSingleWordChangesHash();
+    TestStripeOrderChangesHash();
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,249 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the distribution of the wake-up latency of vkWaitForFences, the time from the signal of the fence to the
+// return of the wait, through the spin wait layer and directly against the mock driver. The mock completes each
+// submission from another thread after a fixed delay, and blocks waiting threads on a condition variable the way a
+// driver blocks them in the kernel. Run with the number of waits as the optional first argument and the time the
+// mock takes to complete a submission in nanoseconds as the optional second one.
+
+#include "base_layer/test/mock_driver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+static uint64_t completion_delay_ns = 20000;
+
+static int64_t GetTimestampNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Completes the submissions of the mock on its own thread, standing in for the GPU.
+struct completion_thread
+{
+    std::mutex              lock;
+    std::condition_variable submitted;
+    std::condition_variable signaled;
+    std::vector<VkFence>    pending;
+    bool                    stop{ false };
+    std::atomic<int64_t>    signal_ns{ 0 }; // Time the last fence was signaled
+    std::thread             thread;
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        for (;;)
+        {
+            submitted.wait(guard, [this]() { return stop || !pending.empty(); });
+            if (pending.empty())
+            {
+                return;
+            }
+
+            const VkFence fence = pending.front();
+            pending.erase(pending.begin());
+
+            guard.unlock();
+            mock_driver::SpinFor(completion_delay_ns);
+            mock_driver::fence_object* object = mock_driver::GetFence(fence);
+            guard.lock();
+
+            // The time is stored first, as a spinning wait can return as soon as the fence is signaled
+            signal_ns.store(GetTimestampNs(), std::memory_order_release);
+            if (object != nullptr)
+            {
+                object->signaled.store(true, std::memory_order_release);
+            }
+
+            signaled.notify_all();
+        }
+    }
+};
+
+static completion_thread completions;
+
+static VKAPI_ATTR VkResult VKAPI_CALL DelayedQueueSubmit(VkQueue             queue,
+                                                         uint32_t            submitCount,
+                                                         const VkSubmitInfo* pSubmits,
+                                                         VkFence             fence)
+{
+    (void)queue;
+    (void)submitCount;
+    (void)pSubmits;
+
+    if (fence != VK_NULL_HANDLE)
+    {
+        std::lock_guard<std::mutex> guard(completions.lock);
+        completions.pending.push_back(fence);
+        completions.submitted.notify_one();
+    }
+
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL
+BlockingWaitForFences(VkDevice device, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout)
+{
+    (void)device;
+
+    std::vector<mock_driver::fence_object*> fences(fenceCount);
+    for (uint32_t i = 0; i < fenceCount; ++i)
+    {
+        fences[i] = mock_driver::GetFence(pFences[i]);
+        if (fences[i] == nullptr)
+        {
+            return VK_ERROR_DEVICE_LOST;
+        }
+    }
+
+    const auto is_signaled = [](const mock_driver::fence_object* fence) {
+        return fence->signaled.load(std::memory_order_acquire);
+    };
+    const auto is_complete = [&]() {
+        return waitAll ? std::all_of(fences.begin(), fences.end(), is_signaled)
+                       : std::any_of(fences.begin(), fences.end(), is_signaled);
+    };
+
+    std::unique_lock<std::mutex> guard(completions.lock);
+    if (timeout == UINT64_MAX)
+    {
+        completions.signaled.wait(guard, is_complete);
+        return VK_SUCCESS;
+    }
+
+    return completions.signaled.wait_for(guard, std::chrono::nanoseconds(timeout), is_complete) ? VK_SUCCESS
+                                                                                                 : VK_TIMEOUT;
+}
+
+// Commands of the layer, or of the mock driver when the layer is bypassed
+struct fence_commands
+{
+    PFN_vkResetFences   reset_fences{ nullptr };
+    PFN_vkQueueSubmit   queue_submit{ nullptr };
+    PFN_vkWaitForFences wait_for_fences{ nullptr };
+};
+
+static void MeasureWaits(const char*                 mode,
+                         const fence_commands&       commands,
+                         const mock_driver::context& context,
+                         VkFence                     fence,
+                         uint32_t                    iterations)
+{
+    std::vector<int64_t> latencies;
+    latencies.reserve(iterations);
+
+    // The first waits warm up the caches and let the layer learn the completion time of the device
+    const uint32_t warm_up = std::max(iterations / 16, 1u);
+    for (uint32_t i = 0; i < warm_up + iterations; ++i)
+    {
+        commands.reset_fences(context.device, 1, &fence);
+        commands.queue_submit(context.queue, 0, nullptr, fence);
+        commands.wait_for_fences(context.device, 1, &fence, VK_TRUE, UINT64_MAX);
+
+        const int64_t end_ns = GetTimestampNs();
+        if (i >= warm_up)
+        {
+            latencies.push_back(end_ns - completions.signal_ns.load(std::memory_order_acquire));
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&](uint32_t percent) {
+        return static_cast<double>(latencies[(latencies.size() - 1) * percent / 100]) / 1000.0;
+    };
+
+    printf("%-8s wake-up latency: p50 %8.2f us, p90 %8.2f us, p99 %8.2f us, max %8.2f us\n",
+           mode,
+           percentile(50),
+           percentile(90),
+           percentile(99),
+           static_cast<double>(latencies.back()) / 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 2000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    if (argc > 2)
+    {
+        completion_delay_ns = strtoull(argv[2], nullptr, 10);
+    }
+
+    mock_driver::SetLayerSetting("GFXR_SPIN_WAIT", "1");
+    mock_driver::SetFunction("vkQueueSubmit", DelayedQueueSubmit);
+    mock_driver::SetFunction("vkWaitForFences", BlockingWaitForFences);
+
+    mock_driver::context context;
+    if (!mock_driver::CreateContext(&context))
+    {
+        mock_driver::DestroyContext(&context);
+        return EXIT_FAILURE;
+    }
+
+    completions.thread = std::thread(&completion_thread::Run, &completions);
+
+    VkFence           fence      = VK_NULL_HANDLE;
+    VkFenceCreateInfo fence_info = { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+    MOCK_DEVICE_PROC(context, vkCreateFence)(context.device, &fence_info, nullptr, &fence);
+
+    printf("%u waits, %llu ns per submission, %u hardware threads\n",
+           iterations,
+           static_cast<unsigned long long>(completion_delay_ns),
+           std::thread::hardware_concurrency());
+
+    fence_commands driver_commands;
+    driver_commands.reset_fences    = mock_driver::ResetFences;
+    driver_commands.queue_submit    = DelayedQueueSubmit;
+    driver_commands.wait_for_fences = BlockingWaitForFences;
+    MeasureWaits("driver", driver_commands, context, fence, iterations);
+
+    fence_commands layer_commands;
+    layer_commands.reset_fences    = MOCK_DEVICE_PROC(context, vkResetFences);
+    layer_commands.queue_submit    = MOCK_DEVICE_PROC(context, vkQueueSubmit);
+    layer_commands.wait_for_fences = MOCK_DEVICE_PROC(context, vkWaitForFences);
+    MeasureWaits("layer", layer_commands, context, fence, iterations);
+
+    {
+        std::lock_guard<std::mutex> guard(completions.lock);
+        completions.stop = true;
+        completions.submitted.notify_one();
+    }
+    completions.thread.join();
+
+    MOCK_DEVICE_PROC(context, vkDestroyFence)(context.device, fence, nullptr);
+    mock_driver::DestroyContext(&context);
+    return (mock_driver::GetState().errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
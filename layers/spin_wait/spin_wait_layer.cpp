@@ -0,0 +1,463 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_spin_wait"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Spin then block fence and semaphore wait layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// vkWaitForFences and vkWaitSemaphores first poll vkGetFenceStatus or vkGetSemaphoreCounterValue for a spin budget,
+// and only fall back to the blocking wait of the driver if the wait did not complete within it, which avoids the
+// wake-up latency of a blocked thread for short waits. The budget is twice the recent completion time of waits on the
+// device, kept as a moving average separately for fences and semaphores. Devices whose waits take longer than
+// kMaxSpinNs on average block right away, so long waits do not burn CPU time.
+static constexpr uint64_t kMinSpinNs          = 5000;
+static constexpr uint64_t kMaxSpinNs          = 200000;
+static constexpr uint32_t kAverageWeight      = 8; // A new completion time moves the average by 1/kAverageWeight
+static constexpr uint32_t kLatencyBucketCount = 16;
+
+// Completion times in buckets of powers of two microseconds, the last bucket holds everything above
+struct latency_histogram
+{
+    std::atomic<uint64_t> buckets[kLatencyBucketCount] = {};
+
+    void Add(uint64_t latency_ns)
+    {
+        uint32_t bucket = 0;
+        for (uint64_t bound = 1000; (latency_ns >= bound) && (bucket < kLatencyBucketCount - 1); bound <<= 1)
+        {
+            ++bucket;
+        }
+
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+struct wait_policy
+{
+    std::atomic<uint64_t> average_ns{ 0 };
+
+    std::atomic<uint64_t> waits{ 0 };
+    std::atomic<uint64_t> spin_completions{ 0 };
+    std::atomic<uint64_t> blocked_waits{ 0 };
+    std::atomic<uint64_t> blocked_spin_ns{ 0 }; // Time spent spinning before blocking
+    latency_histogram     spin_latency;
+    latency_histogram     blocked_latency;
+
+    uint64_t GetSpinBudget() const
+    {
+        const uint64_t average = average_ns.load(std::memory_order_relaxed);
+        return (average <= kMaxSpinNs) ? std::min(std::max(2 * average, kMinSpinNs), kMaxSpinNs) : 0;
+    }
+
+    // Concurrent waits may lose each other's update, which only delays the average
+    void AddCompletion(uint64_t wait_ns)
+    {
+        const uint64_t average = average_ns.load(std::memory_order_relaxed);
+        average_ns.store(average - (average / kAverageWeight) + (wait_ns / kAverageWeight), std::memory_order_relaxed);
+    }
+};
+
+struct device_waits
+{
+    wait_policy fences;
+    wait_policy semaphores;
+};
+
+static std::shared_mutex                                           device_lock;
+static std::unordered_map<VkDevice, std::unique_ptr<device_waits>> devices;
+
+static bool IsSpinWaitEnabled()
+{
+    static const bool enabled = base_layer::is_layer_setting_enabled("GFXR_SPIN_WAIT", "debug.gfxr.spin_wait");
+    return enabled;
+}
+
+// Lets the other hardware thread of the core run between polls
+static void CpuRelax()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static device_waits* GetDeviceWaits(VkDevice device)
+{
+    std::shared_lock<std::shared_mutex> lock(device_lock);
+    auto                                entry = devices.find(device);
+    return (entry != devices.end()) ? entry->second.get() : nullptr;
+}
+
+// Polls the wait condition until it holds, the spin budget or the timeout expire, or polling fails, and otherwise
+// blocks for the rest of the timeout. Poll returns VK_SUCCESS once the condition holds and VK_NOT_READY before.
+template <typename Poll, typename Block>
+static VkResult SpinThenBlock(wait_policy* policy, uint64_t timeout, Poll poll, Block block)
+{
+    const uint64_t start_ns  = base_layer::get_timestamp_ns();
+    const uint64_t budget_ns = std::min(policy->GetSpinBudget(), timeout);
+
+    VkResult result  = VK_NOT_READY;
+    uint64_t spin_ns = 0;
+    while (spin_ns < budget_ns)
+    {
+        result = poll();
+        if (result != VK_NOT_READY)
+        {
+            break;
+        }
+
+        CpuRelax();
+        spin_ns = base_layer::get_timestamp_ns() - start_ns;
+    }
+
+    const bool blocked = (result == VK_NOT_READY);
+    if (blocked)
+    {
+        spin_ns = base_layer::get_timestamp_ns() - start_ns;
+        if (spin_ns >= timeout)
+        {
+            result = VK_TIMEOUT;
+        }
+        else
+        {
+            result = block((timeout == UINT64_MAX) ? UINT64_MAX : (timeout - spin_ns));
+        }
+    }
+
+    const uint64_t wait_ns = base_layer::get_timestamp_ns() - start_ns;
+
+    policy->waits.fetch_add(1, std::memory_order_relaxed);
+    if (blocked)
+    {
+        policy->blocked_waits.fetch_add(1, std::memory_order_relaxed);
+        policy->blocked_spin_ns.fetch_add(spin_ns, std::memory_order_relaxed);
+    }
+    else if (result == VK_SUCCESS)
+    {
+        policy->spin_completions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (result == VK_SUCCESS)
+    {
+        policy->AddCompletion(wait_ns);
+        (blocked ? policy->blocked_latency : policy->spin_latency).Add(wait_ns);
+    }
+
+    return result;
+}
+
+static std::string FormatHistogram(const latency_histogram& histogram)
+{
+    std::string result;
+    for (uint32_t bucket = 0; bucket < kLatencyBucketCount; ++bucket)
+    {
+        const uint64_t count = histogram.buckets[bucket].load();
+        if (count != 0)
+        {
+            char entry[64];
+            if (bucket < kLatencyBucketCount - 1)
+            {
+                snprintf(entry, sizeof(entry), " <%lluus:%llu", 1ull << bucket, static_cast<unsigned long long>(count));
+            }
+            else
+            {
+                snprintf(entry,
+                         sizeof(entry),
+                         " >=%lluus:%llu",
+                         1ull << (bucket - 1),
+                         static_cast<unsigned long long>(count));
+            }
+            result += entry;
+        }
+    }
+
+    return result.empty() ? std::string(" none") : result;
+}
+
+static void PrintWaitStats(const char* name, const wait_policy& policy)
+{
+    const uint64_t waits   = policy.waits.load();
+    const uint64_t blocked = policy.blocked_waits.load();
+    if (waits == 0)
+    {
+        return;
+    }
+
+    base_layer::base_layer_print_info("Spin wait: %s: %llu waits, %llu completed while spinning, %llu blocked after "
+                                      "spinning %.1f us on average, spin budget %.1f us\n",
+                                      name,
+                                      static_cast<unsigned long long>(waits),
+                                      static_cast<unsigned long long>(policy.spin_completions.load()),
+                                      static_cast<unsigned long long>(blocked),
+                                      (blocked != 0) ? static_cast<double>(policy.blocked_spin_ns.load()) /
+                                                           static_cast<double>(blocked) / 1000.0
+                                                     : 0.0,
+                                      static_cast<double>(policy.GetSpinBudget()) / 1000.0);
+    base_layer::base_layer_print_info("Spin wait: %s completed while spinning:%s\n",
+                                      name,
+                                      FormatHistogram(policy.spin_latency).c_str());
+    base_layer::base_layer_print_info("Spin wait: %s completed after blocking:%s\n",
+                                      name,
+                                      FormatHistogram(policy.blocked_latency).c_str());
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    // With a single hardware thread, spinning only delays the thread that would complete the wait
+    if (IsSpinWaitEnabled() && (std::thread::hardware_concurrency() == 1))
+    {
+        base_layer::base_layer_print_info("Spin wait: single hardware thread, waits are not changed\n");
+    }
+    else if (IsSpinWaitEnabled())
+    {
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        devices[*pDevice] = std::make_unique<device_waits>();
+    }
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    std::unique_ptr<device_waits> waits;
+    {
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        auto                                entry = devices.find(device);
+        if (entry != devices.end())
+        {
+            waits = std::move(entry->second);
+            devices.erase(entry);
+        }
+    }
+
+    if (waits != nullptr)
+    {
+        PrintWaitStats("fences", waits->fences);
+        PrintWaitStats("semaphores", waits->semaphores);
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitForFences(
+    VkDevice device, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout)
+{
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+    device_waits*      waits          = GetDeviceWaits(device);
+    if ((waits == nullptr) || (timeout == 0) || (fenceCount == 0))
+    {
+        // Forward function to next layer / driver
+        return dispatch_table.WaitForFences(device, fenceCount, pFences, waitAll, timeout);
+    }
+
+    // Signaled fences stay signaled during the wait, so polling resumes from the first fence that was not
+    uint32_t first_unsignaled = 0;
+    auto     poll             = [&]() -> VkResult {
+        for (uint32_t i = first_unsignaled; i < fenceCount; ++i)
+        {
+            const VkResult status = dispatch_table.GetFenceStatus(device, pFences[i]);
+            if (status == VK_SUCCESS)
+            {
+                if (!waitAll)
+                {
+                    return VK_SUCCESS;
+                }
+                else if (i == first_unsignaled)
+                {
+                    ++first_unsignaled;
+                }
+            }
+            else if ((status != VK_NOT_READY) || waitAll)
+            {
+                return status;
+            }
+        }
+
+        return (first_unsignaled == fenceCount) ? VK_SUCCESS : VK_NOT_READY;
+    };
+
+    return SpinThenBlock(&waits->fences, timeout, poll, [&](uint64_t remaining) -> VkResult {
+        // Forward function to next layer / driver
+        return dispatch_table.WaitForFences(device, fenceCount, pFences, waitAll, remaining);
+    });
+}
+
+static VkResult WaitSemaphores(VkDevice                       device,
+                               const VkSemaphoreWaitInfo*     pWaitInfo,
+                               uint64_t                       timeout,
+                               PFN_vkWaitSemaphores           wait_semaphores,
+                               PFN_vkGetSemaphoreCounterValue get_counter_value)
+{
+    device_waits* waits = GetDeviceWaits(device);
+    if ((waits == nullptr) || (timeout == 0) || (pWaitInfo->semaphoreCount == 0) || (get_counter_value == nullptr))
+    {
+        // Forward function to next layer / driver
+        return wait_semaphores(device, pWaitInfo, timeout);
+    }
+
+    const bool wait_any    = (pWaitInfo->flags & VK_SEMAPHORE_WAIT_ANY_BIT) != 0;
+    uint32_t   first_unmet = 0;
+    auto       poll        = [&]() -> VkResult {
+        for (uint32_t i = first_unmet; i < pWaitInfo->semaphoreCount; ++i)
+        {
+            uint64_t       value  = 0;
+            const VkResult status = get_counter_value(device, pWaitInfo->pSemaphores[i], &value);
+            if (status != VK_SUCCESS)
+            {
+                return status;
+            }
+            else if (value >= pWaitInfo->pValues[i])
+            {
+                if (wait_any)
+                {
+                    return VK_SUCCESS;
+                }
+                else if (i == first_unmet)
+                {
+                    ++first_unmet;
+                }
+            }
+            else if (!wait_any)
+            {
+                return VK_NOT_READY;
+            }
+        }
+
+        return (first_unmet == pWaitInfo->semaphoreCount) ? VK_SUCCESS : VK_NOT_READY;
+    };
+
+    return SpinThenBlock(&waits->semaphores, timeout, poll, [&](uint64_t remaining) -> VkResult {
+        // Forward function to next layer / driver
+        return wait_semaphores(device, pWaitInfo, remaining);
+    });
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitSemaphores(VkDevice                   device,
+                                                    const VkSemaphoreWaitInfo* pWaitInfo,
+                                                    uint64_t                   timeout)
+{
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+    return WaitSemaphores(
+        device, pWaitInfo, timeout, dispatch_table.WaitSemaphores, dispatch_table.GetSemaphoreCounterValue);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitSemaphoresKHR(VkDevice                   device,
+                                                       const VkSemaphoreWaitInfo* pWaitInfo,
+                                                       uint64_t                   timeout)
+{
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+    return WaitSemaphores(
+        device, pWaitInfo, timeout, dispatch_table.WaitSemaphoresKHR, dispatch_table.GetSemaphoreCounterValueKHR);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName && IsSpinWaitEnabled())
+    {
+        if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkWaitForFences"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitForFences;
+        }
+        else if (!strcmp(pName, "vkWaitSemaphores"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitSemaphores;
+        }
+        else if (!strcmp(pName, "vkWaitSemaphoresKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitSemaphoresKHR;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
@@ -0,0 +1,185 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Measures the cost per call of small allocations, binds and maps through the suballocation layer and directly
+// against the mock driver, which charges a fixed cost for each vkAllocateMemory and vkFreeMemory it receives. Run with
+// the number of calls per command as the optional first argument and the driver's cost per allocation in nanoseconds
+// as the optional second one.
+
+#include "base_layer/test/mock_driver.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static constexpr VkDeviceSize kAllocationSize  = 64 * 1024;
+static constexpr uint32_t     kLiveAllocations = 256;
+
+static uint64_t allocation_cost_ns = 20000;
+
+static VKAPI_ATTR VkResult VKAPI_CALL CostlyAllocateMemory(VkDevice                     device,
+                                                           const VkMemoryAllocateInfo*  pAllocateInfo,
+                                                           const VkAllocationCallbacks* pAllocator,
+                                                           VkDeviceMemory*              pMemory)
+{
+    mock_driver::SpinFor(allocation_cost_ns);
+    return mock_driver::AllocateMemory(device, pAllocateInfo, pAllocator, pMemory);
+}
+
+static VKAPI_ATTR void VKAPI_CALL CostlyFreeMemory(VkDevice                     device,
+                                                   VkDeviceMemory               memory,
+                                                   const VkAllocationCallbacks* pAllocator)
+{
+    mock_driver::SpinFor(allocation_cost_ns);
+    mock_driver::FreeMemory(device, memory, pAllocator);
+}
+
+// Commands of the layer, or of the mock driver when the layer is bypassed
+struct memory_commands
+{
+    PFN_vkAllocateMemory   allocate_memory{ nullptr };
+    PFN_vkFreeMemory       free_memory{ nullptr };
+    PFN_vkBindBufferMemory bind_buffer_memory{ nullptr };
+    PFN_vkMapMemory        map_memory{ nullptr };
+    PFN_vkUnmapMemory      unmap_memory{ nullptr };
+};
+
+template <typename Call>
+static void Measure(const char* name, uint32_t iterations, Call call)
+{
+    // Warms up the caches of the layer and of the CPU
+    call(iterations / 16);
+
+    const auto begin = std::chrono::steady_clock::now();
+    call(iterations);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    printf("%-40s %10.1f ns/call\n", name, ns / iterations);
+}
+
+static void MeasureCommands(const char*                 mode,
+                            const memory_commands&      commands,
+                            const mock_driver::context& context,
+                            uint32_t                    iterations)
+{
+    VkMemoryAllocateInfo allocate_info = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocate_info.allocationSize       = kAllocationSize;
+    allocate_info.memoryTypeIndex      = 1;
+
+    // Allocations made and freed in a loop, with other allocations live so that the blocks are partly used
+    std::vector<VkDeviceMemory> live(kLiveAllocations, VK_NULL_HANDLE);
+    for (VkDeviceMemory& memory : live)
+    {
+        commands.allocate_memory(context.device, &allocate_info, nullptr, &memory);
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s vkAllocateMemory+vkFreeMemory", mode);
+    Measure(name, iterations, [&](uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            VkDeviceMemory& memory = live[i % kLiveAllocations];
+            commands.free_memory(context.device, memory, nullptr);
+            commands.allocate_memory(context.device, &allocate_info, nullptr, &memory);
+        }
+    });
+
+    snprintf(name, sizeof(name), "%s vkBindBufferMemory", mode);
+    Measure(name, iterations, [&](uint32_t count) {
+        const VkBuffer buffer = mock_driver::NewHandle<VkBuffer>();
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            commands.bind_buffer_memory(context.device, buffer, live[i % kLiveAllocations], 0);
+        }
+
+        // The mock records every bind, which is not part of the measured cost of the next command
+        mock_driver::GetState().binds.clear();
+    });
+
+    snprintf(name, sizeof(name), "%s vkMapMemory+vkUnmapMemory", mode);
+    Measure(name, iterations, [&](uint32_t count) {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            void*          data   = nullptr;
+            VkDeviceMemory memory = live[i % kLiveAllocations];
+            commands.map_memory(context.device, memory, 0, VK_WHOLE_SIZE, 0, &data);
+            commands.unmap_memory(context.device, memory);
+        }
+    });
+
+    for (VkDeviceMemory memory : live)
+    {
+        commands.free_memory(context.device, memory, nullptr);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t iterations = (argc > 1) ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 100000;
+    if (iterations == 0)
+    {
+        iterations = 1;
+    }
+
+    if (argc > 2)
+    {
+        allocation_cost_ns = strtoull(argv[2], nullptr, 10);
+    }
+
+    mock_driver::SetLayerSetting("GFXR_SUBALLOCATION", "1");
+    mock_driver::SetFunction("vkAllocateMemory", CostlyAllocateMemory);
+    mock_driver::SetFunction("vkFreeMemory", CostlyFreeMemory);
+
+    mock_driver::context context;
+    if (!mock_driver::CreateContext(&context))
+    {
+        mock_driver::DestroyContext(&context);
+        return EXIT_FAILURE;
+    }
+
+    printf("%u calls per command, %llu ns per driver allocation\n",
+           iterations,
+           static_cast<unsigned long long>(allocation_cost_ns));
+
+    memory_commands driver_commands;
+    driver_commands.allocate_memory    = CostlyAllocateMemory;
+    driver_commands.free_memory        = CostlyFreeMemory;
+    driver_commands.bind_buffer_memory = mock_driver::BindBufferMemory;
+    driver_commands.map_memory         = mock_driver::MapMemory;
+    driver_commands.unmap_memory       = mock_driver::UnmapMemory;
+    MeasureCommands("driver", driver_commands, context, iterations);
+
+    memory_commands layer_commands;
+    layer_commands.allocate_memory    = MOCK_DEVICE_PROC(context, vkAllocateMemory);
+    layer_commands.free_memory        = MOCK_DEVICE_PROC(context, vkFreeMemory);
+    layer_commands.bind_buffer_memory = MOCK_DEVICE_PROC(context, vkBindBufferMemory);
+    layer_commands.map_memory         = MOCK_DEVICE_PROC(context, vkMapMemory);
+    layer_commands.unmap_memory       = MOCK_DEVICE_PROC(context, vkUnmapMemory);
+    MeasureCommands("layer", layer_commands, context, iterations);
+
+    mock_driver::DestroyContext(&context);
+    return (mock_driver::GetState().errors == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SUBALLOCATION_BUDDY_ALLOCATOR_H
+#define SUBALLOCATION_BUDDY_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+// Splits a range of granularity << max_order bytes into ranges of granularity << order bytes, each aligned to its own
+// size. Not thread safe.
+class buddy_allocator
+{
+  public:
+    // Returns the order of the smallest range that holds size bytes.
+    static uint32_t get_order(uint64_t size, uint64_t granularity)
+    {
+        uint32_t order = 0;
+        while ((granularity << order) < size)
+        {
+            ++order;
+        }
+
+        return order;
+    }
+
+    void reset(uint64_t granularity, uint32_t max_order)
+    {
+        granularity_      = granularity;
+        allocation_count_ = 0;
+        free_ranges_.assign(max_order + 1, std::set<uint64_t>());
+        free_ranges_[max_order].insert(0);
+    }
+
+    size_t allocation_count() const { return allocation_count_; }
+
+    bool allocate(uint32_t order, uint64_t* offset)
+    {
+        const uint32_t max_order = static_cast<uint32_t>(free_ranges_.size()) - 1;
+
+        uint32_t available = order;
+        while ((available <= max_order) && free_ranges_[available].empty())
+        {
+            ++available;
+        }
+
+        if (available > max_order)
+        {
+            return false;
+        }
+
+        *offset = *free_ranges_[available].begin();
+        free_ranges_[available].erase(free_ranges_[available].begin());
+
+        // Keep the lower half of the range and free the upper one until it has the requested size
+        while (available > order)
+        {
+            --available;
+            free_ranges_[available].insert(*offset + (granularity_ << available));
+        }
+
+        ++allocation_count_;
+        return true;
+    }
+
+    void free(uint32_t order, uint64_t offset)
+    {
+        const uint32_t max_order = static_cast<uint32_t>(free_ranges_.size()) - 1;
+
+        // Merge the range with its buddy for as long as the buddy is free
+        for (; order < max_order; ++order)
+        {
+            auto buddy = free_ranges_[order].find(offset ^ (granularity_ << order));
+            if (buddy == free_ranges_[order].end())
+            {
+                break;
+            }
+
+            offset = std::min(offset, *buddy);
+            free_ranges_[order].erase(buddy);
+        }
+
+        free_ranges_[order].insert(offset);
+        --allocation_count_;
+    }
+
+  private:
+    uint64_t granularity_{ 0 };
+    size_t   allocation_count_{ 0 };
+
+    // Offsets of the free ranges of size granularity_ << order, indexed by order
+    std::vector<std::set<uint64_t>> free_ranges_;
+};
+
+#endif // SUBALLOCATION_BUDDY_ALLOCATOR_H
@@ -0,0 +1,1026 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_suballocation"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Device memory suballocation layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+
+#include "buddy_allocator.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// Small vkAllocateMemory requests without a pNext chain are served from large blocks allocated per memory type. The
+// application receives a handle owned by the layer, which is translated to the block and an offset in every command
+// that takes device memory. The commitment and priority of a suballocation are handled by the layer, as they apply to
+// a whole memory object. Requests with a pNext chain (dedicated, exported, device address or priority allocations)
+// and lazily allocated memory types are always forwarded.
+//
+// Blocks are split with a buddy allocator. A suballocation is aligned to its size rounded up to a power of two, which
+// is at least the alignment of any resource that fits in it when resource sizes are multiples of their alignment. As
+// that is not guaranteed, binds check the alignment the resource requires, and a suballocation that does not meet it
+// is moved to a dedicated allocation if it was neither bound nor mapped before. The smallest suballocation is large
+// enough that host accessed ranges and linear and optimal resources never share a nonCoherentAtomSize or
+// bufferImageGranularity page.
+static constexpr VkDeviceSize kMaxSuballocationSize = 1024 * 1024;
+static constexpr VkDeviceSize kMaxBlockSize         = 32 * 1024 * 1024;
+static constexpr VkDeviceSize kMinGranularity       = 256;
+
+struct device_allocator;
+
+struct memory_block
+{
+    VkDeviceMemory  memory{ VK_NULL_HANDLE };
+    uint8_t*        mapped{ nullptr };
+    buddy_allocator ranges;
+};
+
+// Guarded by the allocator's lock until the suballocation is used, after which block and offset no longer change.
+struct suballocation
+{
+    device_allocator* allocator{ nullptr };
+    uint32_t          memory_type{ 0 };
+    memory_block*     block{ nullptr };
+    VkDeviceSize      offset{ 0 };
+    VkDeviceSize      size{ 0 };
+    uint32_t          order{ 0 };
+    bool              used{ false }; // Bound or mapped
+
+    // Block of the dedicated allocation the suballocation was moved to, if any
+    std::unique_ptr<memory_block> dedicated_block;
+};
+
+struct memory_type_blocks
+{
+    uint32_t                                   max_order{ 0 }; // Order of a whole block, 0 if not suballocated
+    std::vector<std::unique_ptr<memory_block>> blocks;
+};
+
+struct device_allocator
+{
+    VkDevice                        device{ VK_NULL_HANDLE };
+    VkDeviceSize                    granularity{ kMinGranularity };
+    std::vector<memory_type_blocks> memory_types;
+
+    std::mutex lock;
+    uint64_t   suballocation_count{ 0 };
+    uint64_t   block_count{ 0 };
+    uint64_t   dedicated_count{ 0 };
+};
+
+static std::shared_mutex                                                  allocator_lock;
+static std::unordered_map<VkDevice, std::unique_ptr<device_allocator>>     device_allocators;
+static std::unordered_map<VkDeviceMemory, std::unique_ptr<suballocation>> suballocations;
+
+static bool IsSuballocationEnabled()
+{
+    static const bool enabled = base_layer::is_layer_setting_enabled("GFXR_SUBALLOCATION", "debug.gfxr.suballocation");
+    return enabled;
+}
+
+static VkDeviceSize RoundUpToPowerOfTwo(VkDeviceSize value)
+{
+    VkDeviceSize result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+
+    return result;
+}
+
+static device_allocator* GetDeviceAllocator(VkDevice device)
+{
+    std::shared_lock<std::shared_mutex> lock(allocator_lock);
+    auto                                entry = device_allocators.find(device);
+    return (entry != device_allocators.end()) ? entry->second.get() : nullptr;
+}
+
+// Returns the suballocation memory refers to, or nullptr if memory was allocated by the next layer.
+static suballocation* GetSuballocation(VkDeviceMemory memory)
+{
+    if (memory == VK_NULL_HANDLE)
+    {
+        return nullptr;
+    }
+
+    std::shared_lock<std::shared_mutex> lock(allocator_lock);
+    auto                                entry = suballocations.find(memory);
+    return (entry != suballocations.end()) ? entry->second.get() : nullptr;
+}
+
+// Must be called with allocator->lock held.
+static suballocation* Suballocate(device_allocator* allocator, uint32_t memory_type, VkDeviceSize size)
+{
+    memory_type_blocks& type_blocks = allocator->memory_types[memory_type];
+    const uint32_t      order       = buddy_allocator::get_order(size, allocator->granularity);
+    VkDeviceSize        offset      = 0;
+
+    memory_block* block = nullptr;
+    for (const std::unique_ptr<memory_block>& candidate : type_blocks.blocks)
+    {
+        if (candidate->ranges.allocate(order, &offset))
+        {
+            block = candidate.get();
+            break;
+        }
+    }
+
+    if (block == nullptr)
+    {
+        std::unique_ptr<memory_block> new_block     = std::make_unique<memory_block>();
+        VkMemoryAllocateInfo          allocate_info = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+        allocate_info.allocationSize                = allocator->granularity << type_blocks.max_order;
+        allocate_info.memoryTypeIndex               = memory_type;
+
+        // Forward function to next layer / driver
+        const DeviceTable& dispatch_table = base_layer::get_device_handle(allocator->device)->dispatch_table;
+        if (dispatch_table.AllocateMemory(allocator->device, &allocate_info, nullptr, &new_block->memory) !=
+            VK_SUCCESS)
+        {
+            return nullptr;
+        }
+
+        new_block->ranges.reset(allocator->granularity, type_blocks.max_order);
+        new_block->ranges.allocate(order, &offset);
+
+        block = new_block.get();
+        type_blocks.blocks.push_back(std::move(new_block));
+        ++allocator->block_count;
+    }
+
+    std::unique_ptr<suballocation> result = std::make_unique<suballocation>();
+    result->allocator                     = allocator;
+    result->memory_type                   = memory_type;
+    result->block                         = block;
+    result->offset                        = offset;
+    result->size                          = allocator->granularity << order;
+    result->order                         = order;
+    ++allocator->suballocation_count;
+
+    suballocation* handle = result.get();
+
+    std::unique_lock<std::shared_mutex> lock(allocator_lock);
+    suballocations[reinterpret_cast<VkDeviceMemory>(handle)] = std::move(result);
+    return handle;
+}
+
+// Must be called with allocator->lock held.
+static void FreeBlockMemory(device_allocator* allocator, memory_block* block)
+{
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(allocator->device)->dispatch_table;
+    if (block->mapped != nullptr)
+    {
+        dispatch_table.UnmapMemory(allocator->device, block->memory);
+    }
+
+    // Forward function to next layer / driver
+    dispatch_table.FreeMemory(allocator->device, block->memory, nullptr);
+}
+
+// Must be called with allocator->lock held.
+static void ReleaseBlock(device_allocator* allocator, memory_type_blocks* type_blocks, memory_block* block)
+{
+    FreeBlockMemory(allocator, block);
+
+    auto entry = std::find_if(type_blocks->blocks.begin(),
+                              type_blocks->blocks.end(),
+                              [block](const std::unique_ptr<memory_block>& candidate) {
+                                  return candidate.get() == block;
+                              });
+    type_blocks->blocks.erase(entry);
+}
+
+// Returns the range of a suballocation to its block. Must be called with allocator->lock held.
+static void ReleaseRange(device_allocator* allocator, suballocation* memory)
+{
+    memory_type_blocks& type_blocks = allocator->memory_types[memory->memory_type];
+    memory_block*       block       = memory->block;
+    block->ranges.free(memory->order, memory->offset);
+
+    // One empty block is kept per memory type so that allocating and freeing in a loop does not reach the driver
+    if ((block->ranges.allocation_count() == 0) && (type_blocks.blocks.size() > 1))
+    {
+        ReleaseBlock(allocator, &type_blocks, block);
+    }
+}
+
+static void FreeSuballocation(suballocation* memory)
+{
+    device_allocator*           allocator = memory->allocator;
+    std::lock_guard<std::mutex> lock(allocator->lock);
+
+    if (memory->dedicated_block != nullptr)
+    {
+        FreeBlockMemory(allocator, memory->dedicated_block.get());
+    }
+    else
+    {
+        ReleaseRange(allocator, memory);
+    }
+
+    std::unique_lock<std::shared_mutex> handle_lock(allocator_lock);
+    suballocations.erase(reinterpret_cast<VkDeviceMemory>(memory));
+}
+
+// Moves a suballocation that was neither bound nor mapped to a dedicated allocation of its own, at offset 0. Must be
+// called with allocator->lock held.
+static bool MoveToDedicatedAllocation(suballocation* memory)
+{
+    device_allocator*             allocator     = memory->allocator;
+    std::unique_ptr<memory_block> block         = std::make_unique<memory_block>();
+    VkMemoryAllocateInfo          allocate_info = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocate_info.allocationSize                = memory->size;
+    allocate_info.memoryTypeIndex               = memory->memory_type;
+
+    // Forward function to next layer / driver
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(allocator->device)->dispatch_table;
+    if (dispatch_table.AllocateMemory(allocator->device, &allocate_info, nullptr, &block->memory) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    ReleaseRange(allocator, memory);
+    memory->block           = block.get();
+    memory->offset          = 0;
+    memory->dedicated_block = std::move(block);
+    ++allocator->dedicated_count;
+    return true;
+}
+
+static VkResult MapSuballocation(suballocation* memory, VkDeviceSize offset, void** ppData)
+{
+    device_allocator*           allocator = memory->allocator;
+    std::lock_guard<std::mutex> lock(allocator->lock);
+
+    // Blocks are mapped once and stay mapped until they are freed, as a memory object can only be mapped once
+    memory->used        = true;
+    memory_block* block = memory->block;
+    if (block->mapped == nullptr)
+    {
+        // Forward function to next layer / driver
+        void*    data   = nullptr;
+        VkResult result = base_layer::get_device_handle(allocator->device)
+                              ->dispatch_table.MapMemory(allocator->device, block->memory, 0, VK_WHOLE_SIZE, 0, &data);
+        if (result != VK_SUCCESS)
+        {
+            return result;
+        }
+
+        block->mapped = static_cast<uint8_t*>(data);
+    }
+
+    *ppData = block->mapped + memory->offset + offset;
+    return VK_SUCCESS;
+}
+
+// Returns ranges translated to the blocks of suballocated memory.
+static std::vector<VkMappedMemoryRange> TranslateMemoryRanges(uint32_t memoryRangeCount,
+                                                              const VkMappedMemoryRange* pMemoryRanges)
+{
+    std::vector<VkMappedMemoryRange> ranges(pMemoryRanges, pMemoryRanges + memoryRangeCount);
+    for (VkMappedMemoryRange& range : ranges)
+    {
+        suballocation* memory = GetSuballocation(range.memory);
+        if (memory != nullptr)
+        {
+            if (range.size == VK_WHOLE_SIZE)
+            {
+                range.size = memory->size - range.offset;
+            }
+
+            range.memory = memory->block->memory;
+            range.offset += memory->offset;
+        }
+    }
+
+    return ranges;
+}
+
+// Translates the memory and offset of a bind. get_alignment returns the alignment the bound resource requires, and is
+// only called for suballocated memory.
+template <typename GetAlignment>
+static void TranslateMemory(VkDeviceMemory* memory, VkDeviceSize* offset, GetAlignment get_alignment)
+{
+    suballocation* allocation = GetSuballocation(*memory);
+    if (allocation == nullptr)
+    {
+        return;
+    }
+
+    device_allocator*           allocator = allocation->allocator;
+    std::lock_guard<std::mutex> lock(allocator->lock);
+
+    const VkDeviceSize alignment = get_alignment();
+    if ((alignment != 0) && ((allocation->offset % alignment) != 0))
+    {
+        if (allocation->used || !MoveToDedicatedAllocation(allocation))
+        {
+            base_layer::base_layer_print_error(
+                "Suballocation: memory at offset %llu cannot be bound to a resource aligned to %llu bytes\n",
+                static_cast<unsigned long long>(allocation->offset),
+                static_cast<unsigned long long>(alignment));
+        }
+    }
+
+    allocation->used = true;
+    *memory          = allocation->block->memory;
+    *offset += allocation->offset;
+}
+
+static void TranslateMemory(VkDeviceMemory* memory, VkDeviceSize* offset)
+{
+    TranslateMemory(memory, offset, []() -> VkDeviceSize { return 0; });
+}
+
+static VkDeviceSize GetBufferAlignment(VkDevice device, VkBuffer buffer)
+{
+    VkMemoryRequirements requirements;
+    base_layer::get_device_handle(device)->dispatch_table.GetBufferMemoryRequirements(device, buffer, &requirements);
+    return requirements.alignment;
+}
+
+static VkDeviceSize GetImageAlignment(VkDevice device, VkImage image)
+{
+    VkMemoryRequirements requirements;
+    base_layer::get_device_handle(device)->dispatch_table.GetImageMemoryRequirements(device, image, &requirements);
+    return requirements.alignment;
+}
+
+// The planes of disjoint images have their own requirements, which are only reported by vkGetImageMemoryRequirements2.
+static VkDeviceSize GetImageAlignment(VkDevice device, const VkBindImageMemoryInfo& bind_info)
+{
+    const VkBaseInStructure* next = reinterpret_cast<const VkBaseInStructure*>(bind_info.pNext);
+    while ((next != nullptr) && (next->sType != VK_STRUCTURE_TYPE_BIND_IMAGE_PLANE_MEMORY_INFO))
+    {
+        next = next->pNext;
+    }
+
+    if (next == nullptr)
+    {
+        return GetImageAlignment(device, bind_info.image);
+    }
+
+    const VkBindImagePlaneMemoryInfo*  plane_bind = reinterpret_cast<const VkBindImagePlaneMemoryInfo*>(next);
+    VkImagePlaneMemoryRequirementsInfo plane_info = { VK_STRUCTURE_TYPE_IMAGE_PLANE_MEMORY_REQUIREMENTS_INFO };
+    plane_info.planeAspect                        = plane_bind->planeAspect;
+
+    VkImageMemoryRequirementsInfo2 requirements_info = { VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2 };
+    requirements_info.pNext                          = &plane_info;
+    requirements_info.image                          = bind_info.image;
+
+    VkMemoryRequirements2 requirements   = { VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+    const DeviceTable&    dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+    if (dispatch_table.GetImageMemoryRequirements2 != nullptr)
+    {
+        dispatch_table.GetImageMemoryRequirements2(device, &requirements_info, &requirements);
+    }
+    else
+    {
+        dispatch_table.GetImageMemoryRequirements2KHR(device, &requirements_info, &requirements);
+    }
+
+    return requirements.memoryRequirements.alignment;
+}
+
+static VkDeviceSize GetVideoSessionAlignment(VkDevice device, VkVideoSessionKHR session, uint32_t bind_index)
+{
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(device)->dispatch_table;
+    uint32_t           count          = 0;
+    dispatch_table.GetVideoSessionMemoryRequirementsKHR(device, session, &count, nullptr);
+
+    std::vector<VkVideoSessionMemoryRequirementsKHR> requirements(
+        count, { VK_STRUCTURE_TYPE_VIDEO_SESSION_MEMORY_REQUIREMENTS_KHR });
+    dispatch_table.GetVideoSessionMemoryRequirementsKHR(device, session, &count, requirements.data());
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (requirements[i].memoryBindIndex == bind_index)
+        {
+            return requirements[i].memoryRequirements.alignment;
+        }
+    }
+
+    return 0;
+}
+
+static VkDeviceSize GetAccelerationStructureAlignment(VkDevice device, VkAccelerationStructureNV acceleration_structure)
+{
+    VkAccelerationStructureMemoryRequirementsInfoNV requirements_info = {
+        VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_MEMORY_REQUIREMENTS_INFO_NV
+    };
+    requirements_info.type                  = VK_ACCELERATION_STRUCTURE_MEMORY_REQUIREMENTS_TYPE_OBJECT_NV;
+    requirements_info.accelerationStructure = acceleration_structure;
+
+    VkMemoryRequirements2KHR requirements = { VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR };
+    base_layer::get_device_handle(device)->dispatch_table.GetAccelerationStructureMemoryRequirementsNV(
+        device, &requirements_info, &requirements);
+    return requirements.memoryRequirements.alignment;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    if (!IsSuballocationEnabled())
+    {
+        return VK_SUCCESS;
+    }
+
+    const InstanceTable& instance_table = base_layer::get_physical_device_instance(physicalDevice)->dispatch_table;
+
+    VkPhysicalDeviceProperties       properties;
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    instance_table.GetPhysicalDeviceProperties(physicalDevice, &properties);
+    instance_table.GetPhysicalDeviceMemoryProperties(physicalDevice, &memory_properties);
+
+    std::unique_ptr<device_allocator> allocator = std::make_unique<device_allocator>();
+    allocator->device                           = *pDevice;
+    allocator->granularity = RoundUpToPowerOfTwo(std::max({ kMinGranularity,
+                                                            properties.limits.nonCoherentAtomSize,
+                                                            properties.limits.bufferImageGranularity }));
+    allocator->memory_types.resize(memory_properties.memoryTypeCount);
+
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i)
+    {
+        const VkMemoryType& memory_type = memory_properties.memoryTypes[i];
+        if ((memory_type.propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) != 0)
+        {
+            continue;
+        }
+
+        // Blocks take at most an eighth of their heap and hold at least two of the largest suballocations
+        VkDeviceSize block_size = kMaxBlockSize;
+        while ((block_size > memory_properties.memoryHeaps[memory_type.heapIndex].size / 8) &&
+               (block_size > allocator->granularity))
+        {
+            block_size >>= 1;
+        }
+
+        if (block_size >= 2 * std::max(kMaxSuballocationSize, allocator->granularity))
+        {
+            allocator->memory_types[i].max_order = buddy_allocator::get_order(block_size, allocator->granularity);
+        }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(allocator_lock);
+    device_allocators[*pDevice] = std::move(allocator);
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    std::unique_ptr<device_allocator>          allocator;
+    std::vector<std::unique_ptr<memory_block>> dedicated_blocks;
+    {
+        std::unique_lock<std::shared_mutex> lock(allocator_lock);
+        auto                                entry = device_allocators.find(device);
+        if (entry != device_allocators.end())
+        {
+            allocator = std::move(entry->second);
+            device_allocators.erase(entry);
+
+            // Memory the application did not free is released with its blocks
+            for (auto suballocation = suballocations.begin(); suballocation != suballocations.end();)
+            {
+                if (suballocation->second->allocator == allocator.get())
+                {
+                    if (suballocation->second->dedicated_block != nullptr)
+                    {
+                        dedicated_blocks.push_back(std::move(suballocation->second->dedicated_block));
+                    }
+
+                    suballocation = suballocations.erase(suballocation);
+                }
+                else
+                {
+                    ++suballocation;
+                }
+            }
+        }
+    }
+
+    if (allocator != nullptr)
+    {
+        base_layer::base_layer_print_info(
+            "Suballocation: %llu allocations served from %llu blocks, %llu moved to a dedicated allocation\n",
+            static_cast<unsigned long long>(allocator->suballocation_count),
+            static_cast<unsigned long long>(allocator->block_count),
+            static_cast<unsigned long long>(allocator->dedicated_count));
+
+        std::lock_guard<std::mutex> lock(allocator->lock);
+        for (const std::unique_ptr<memory_block>& block : dedicated_blocks)
+        {
+            FreeBlockMemory(allocator.get(), block.get());
+        }
+
+        for (memory_type_blocks& type_blocks : allocator->memory_types)
+        {
+            while (!type_blocks.blocks.empty())
+            {
+                ReleaseBlock(allocator.get(), &type_blocks, type_blocks.blocks.back().get());
+            }
+        }
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_AllocateMemory(VkDevice                     device,
+                                                    const VkMemoryAllocateInfo*  pAllocateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkDeviceMemory*              pMemory)
+{
+    device_allocator* allocator = GetDeviceAllocator(device);
+    if ((allocator != nullptr) && (pAllocateInfo->pNext == nullptr) &&
+        (pAllocateInfo->allocationSize <= kMaxSuballocationSize) &&
+        (pAllocateInfo->memoryTypeIndex < allocator->memory_types.size()) &&
+        (allocator->memory_types[pAllocateInfo->memoryTypeIndex].max_order != 0))
+    {
+        std::lock_guard<std::mutex> lock(allocator->lock);
+        suballocation* memory = Suballocate(allocator, pAllocateInfo->memoryTypeIndex, pAllocateInfo->allocationSize);
+        if (memory != nullptr)
+        {
+            *pMemory = reinterpret_cast<VkDeviceMemory>(memory);
+            return VK_SUCCESS;
+        }
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.AllocateMemory(
+        device, pAllocateInfo, pAllocator, pMemory);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_FreeMemory(VkDevice                     device,
+                                            VkDeviceMemory               memory,
+                                            const VkAllocationCallbacks* pAllocator)
+{
+    suballocation* allocation = GetSuballocation(memory);
+    if (allocation != nullptr)
+    {
+        FreeSuballocation(allocation);
+        return;
+    }
+
+    // Forward function to next layer / driver
+    base_layer::get_device_handle(device)->dispatch_table.FreeMemory(device, memory, pAllocator);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_MapMemory(VkDevice         device,
+                                               VkDeviceMemory   memory,
+                                               VkDeviceSize     offset,
+                                               VkDeviceSize     size,
+                                               VkMemoryMapFlags flags,
+                                               void**           ppData)
+{
+    suballocation* allocation = GetSuballocation(memory);
+    if (allocation != nullptr)
+    {
+        return MapSuballocation(allocation, offset, ppData);
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.MapMemory(device, memory, offset, size, flags, ppData);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_MapMemory2KHR(VkDevice                  device,
+                                                   const VkMemoryMapInfoKHR* pMemoryMapInfo,
+                                                   void**                    ppData)
+{
+    suballocation* allocation = GetSuballocation(pMemoryMapInfo->memory);
+    if (allocation != nullptr)
+    {
+        return MapSuballocation(allocation, pMemoryMapInfo->offset, ppData);
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.MapMemory2KHR(device, pMemoryMapInfo, ppData);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_UnmapMemory(VkDevice device, VkDeviceMemory memory)
+{
+    // Suballocated memory stays mapped with its block
+    if (GetSuballocation(memory) == nullptr)
+    {
+        // Forward function to next layer / driver
+        base_layer::get_device_handle(device)->dispatch_table.UnmapMemory(device, memory);
+    }
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_UnmapMemory2KHR(VkDevice device, const VkMemoryUnmapInfoKHR* pMemoryUnmapInfo)
+{
+    // Suballocated memory stays mapped with its block
+    if (GetSuballocation(pMemoryUnmapInfo->memory) != nullptr)
+    {
+        return VK_SUCCESS;
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.UnmapMemory2KHR(device, pMemoryUnmapInfo);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_FlushMappedMemoryRanges(VkDevice                   device,
+                                                             uint32_t                   memoryRangeCount,
+                                                             const VkMappedMemoryRange* pMemoryRanges)
+{
+    std::vector<VkMappedMemoryRange> ranges = TranslateMemoryRanges(memoryRangeCount, pMemoryRanges);
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.FlushMappedMemoryRanges(
+        device, memoryRangeCount, ranges.data());
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_InvalidateMappedMemoryRanges(VkDevice                   device,
+                                                                  uint32_t                   memoryRangeCount,
+                                                                  const VkMappedMemoryRange* pMemoryRanges)
+{
+    std::vector<VkMappedMemoryRange> ranges = TranslateMemoryRanges(memoryRangeCount, pMemoryRanges);
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.InvalidateMappedMemoryRanges(
+        device, memoryRangeCount, ranges.data());
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindBufferMemory(VkDevice       device,
+                                                      VkBuffer       buffer,
+                                                      VkDeviceMemory memory,
+                                                      VkDeviceSize   memoryOffset)
+{
+    TranslateMemory(&memory, &memoryOffset, [device, buffer]() { return GetBufferAlignment(device, buffer); });
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.BindBufferMemory(device, buffer, memory, memoryOffset);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindImageMemory(VkDevice       device,
+                                                     VkImage        image,
+                                                     VkDeviceMemory memory,
+                                                     VkDeviceSize   memoryOffset)
+{
+    TranslateMemory(&memory, &memoryOffset, [device, image]() { return GetImageAlignment(device, image); });
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.BindImageMemory(device, image, memory, memoryOffset);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindBufferMemory2(VkDevice                      device,
+                                                       uint32_t                      bindInfoCount,
+                                                       const VkBindBufferMemoryInfo* pBindInfos)
+{
+    std::vector<VkBindBufferMemoryInfo> bind_infos(pBindInfos, pBindInfos + bindInfoCount);
+    for (VkBindBufferMemoryInfo& bind_info : bind_infos)
+    {
+        TranslateMemory(&bind_info.memory, &bind_info.memoryOffset, [device, &bind_info]() {
+            return GetBufferAlignment(device, bind_info.buffer);
+        });
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.BindBufferMemory2(
+        device, bindInfoCount, bind_infos.data());
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindBufferMemory2KHR(VkDevice                      device,
+                                                          uint32_t                      bindInfoCount,
+                                                          const VkBindBufferMemoryInfo* pBindInfos)
+{
+    std::vector<VkBindBufferMemoryInfo> bind_infos(pBindInfos, pBindInfos + bindInfoCount);
+    for (VkBindBufferMemoryInfo& bind_info : bind_infos)
+    {
+        TranslateMemory(&bind_info.memory, &bind_info.memoryOffset, [device, &bind_info]() {
+            return GetBufferAlignment(device, bind_info.buffer);
+        });
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.BindBufferMemory2KHR(
+        device, bindInfoCount, bind_infos.data());
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindImageMemory2(VkDevice                     device,
+                                                      uint32_t                     bindInfoCount,
+                                                      const VkBindImageMemoryInfo* pBindInfos)
+{
+    std::vector<VkBindImageMemoryInfo> bind_infos(pBindInfos, pBindInfos + bindInfoCount);
+    for (VkBindImageMemoryInfo& bind_info : bind_infos)
+    {
+        TranslateMemory(&bind_info.memory, &bind_info.memoryOffset, [device, &bind_info]() {
+            return GetImageAlignment(device, bind_info);
+        });
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.BindImageMemory2(
+        device, bindInfoCount, bind_infos.data());
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindImageMemory2KHR(VkDevice                     device,
+                                                         uint32_t                     bindInfoCount,
+                                                         const VkBindImageMemoryInfo* pBindInfos)
+{
+    std::vector<VkBindImageMemoryInfo> bind_infos(pBindInfos, pBindInfos + bindInfoCount);
+    for (VkBindImageMemoryInfo& bind_info : bind_infos)
+    {
+        TranslateMemory(&bind_info.memory, &bind_info.memoryOffset, [device, &bind_info]() {
+            return GetImageAlignment(device, bind_info);
+        });
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.BindImageMemory2KHR(
+        device, bindInfoCount, bind_infos.data());
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_BindVideoSessionMemoryKHR(VkDevice                               device,
+                                                               VkVideoSessionKHR                      videoSession,
+                                                               uint32_t                               bindInfoCount,
+                                                               const VkBindVideoSessionMemoryInfoKHR* pBindInfos)
+{
+    std::vector<VkBindVideoSessionMemoryInfoKHR> bind_infos(pBindInfos, pBindInfos + bindInfoCount);
+    for (VkBindVideoSessionMemoryInfoKHR& bind_info : bind_infos)
+    {
+        TranslateMemory(&bind_info.memory, &bind_info.memoryOffset, [device, videoSession, &bind_info]() {
+            return GetVideoSessionAlignment(device, videoSession, bind_info.memoryBindIndex);
+        });
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.BindVideoSessionMemoryKHR(
+        device, videoSession, bindInfoCount, bind_infos.data());
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+layer_BindAccelerationStructureMemoryNV(VkDevice                                       device,
+                                        uint32_t                                       bindInfoCount,
+                                        const VkBindAccelerationStructureMemoryInfoNV* pBindInfos)
+{
+    std::vector<VkBindAccelerationStructureMemoryInfoNV> bind_infos(pBindInfos, pBindInfos + bindInfoCount);
+    for (VkBindAccelerationStructureMemoryInfoNV& bind_info : bind_infos)
+    {
+        TranslateMemory(&bind_info.memory, &bind_info.memoryOffset, [device, &bind_info]() {
+            return GetAccelerationStructureAlignment(device, bind_info.accelerationStructure);
+        });
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(device)->dispatch_table.BindAccelerationStructureMemoryNV(
+        device, bindInfoCount, bind_infos.data());
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetDeviceMemoryCommitment(VkDevice       device,
+                                                           VkDeviceMemory memory,
+                                                           VkDeviceSize*  pCommittedMemoryInBytes)
+{
+    // Lazily allocated memory, the only memory whose commitment can change, is never suballocated
+    suballocation* allocation = GetSuballocation(memory);
+    if (allocation != nullptr)
+    {
+        *pCommittedMemoryInBytes = allocation->size;
+        return;
+    }
+
+    // Forward function to next layer / driver
+    base_layer::get_device_handle(device)->dispatch_table.GetDeviceMemoryCommitment(
+        device, memory, pCommittedMemoryInBytes);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_SetDeviceMemoryPriorityEXT(VkDevice device, VkDeviceMemory memory, float priority)
+{
+    suballocation* allocation = GetSuballocation(memory);
+    if (allocation != nullptr)
+    {
+        // A block is shared by other suballocations, whose priority it must keep, so only the priority of a
+        // suballocation moved to a dedicated allocation is changed
+        std::lock_guard<std::mutex> lock(allocation->allocator->lock);
+        if (allocation->dedicated_block == nullptr)
+        {
+            return;
+        }
+
+        memory = allocation->dedicated_block->memory;
+    }
+
+    // Forward function to next layer / driver
+    base_layer::get_device_handle(device)->dispatch_table.SetDeviceMemoryPriorityEXT(device, memory, priority);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueueBindSparse(VkQueue                 queue,
+                                                     uint32_t                bindInfoCount,
+                                                     const VkBindSparseInfo* pBindInfo,
+                                                     VkFence                 fence)
+{
+    // The bind arrays are copied so that the memory of each bind can be translated
+    std::vector<VkBindSparseInfo>                                      bind_infos(pBindInfo, pBindInfo + bindInfoCount);
+    std::vector<std::vector<VkSparseBufferMemoryBindInfo>>             buffer_binds(bindInfoCount);
+    std::vector<std::vector<VkSparseImageOpaqueMemoryBindInfo>>        image_opaque_binds(bindInfoCount);
+    std::vector<std::vector<VkSparseImageMemoryBindInfo>>              image_binds(bindInfoCount);
+    std::vector<std::unique_ptr<std::vector<VkSparseMemoryBind>>>      memory_binds;
+    std::vector<std::unique_ptr<std::vector<VkSparseImageMemoryBind>>> image_memory_binds;
+
+    auto translate_binds = [&memory_binds](uint32_t count, const VkSparseMemoryBind* pBinds) {
+        memory_binds.push_back(std::make_unique<std::vector<VkSparseMemoryBind>>(pBinds, pBinds + count));
+        for (VkSparseMemoryBind& bind : *memory_binds.back())
+        {
+            TranslateMemory(&bind.memory, &bind.memoryOffset);
+        }
+        return memory_binds.back()->data();
+    };
+
+    for (uint32_t i = 0; i < bindInfoCount; ++i)
+    {
+        VkBindSparseInfo& bind_info = bind_infos[i];
+
+        buffer_binds[i].assign(bind_info.pBufferBinds, bind_info.pBufferBinds + bind_info.bufferBindCount);
+        for (VkSparseBufferMemoryBindInfo& buffer_bind : buffer_binds[i])
+        {
+            buffer_bind.pBinds = translate_binds(buffer_bind.bindCount, buffer_bind.pBinds);
+        }
+        bind_info.pBufferBinds = buffer_binds[i].data();
+
+        image_opaque_binds[i].assign(bind_info.pImageOpaqueBinds,
+                                     bind_info.pImageOpaqueBinds + bind_info.imageOpaqueBindCount);
+        for (VkSparseImageOpaqueMemoryBindInfo& image_opaque_bind : image_opaque_binds[i])
+        {
+            image_opaque_bind.pBinds = translate_binds(image_opaque_bind.bindCount, image_opaque_bind.pBinds);
+        }
+        bind_info.pImageOpaqueBinds = image_opaque_binds[i].data();
+
+        image_binds[i].assign(bind_info.pImageBinds, bind_info.pImageBinds + bind_info.imageBindCount);
+        for (VkSparseImageMemoryBindInfo& image_bind : image_binds[i])
+        {
+            image_memory_binds.push_back(std::make_unique<std::vector<VkSparseImageMemoryBind>>(
+                image_bind.pBinds, image_bind.pBinds + image_bind.bindCount));
+            for (VkSparseImageMemoryBind& bind : *image_memory_binds.back())
+            {
+                TranslateMemory(&bind.memory, &bind.memoryOffset);
+            }
+            image_bind.pBinds = image_memory_binds.back()->data();
+        }
+        bind_info.pImageBinds = image_binds[i].data();
+    }
+
+    // Forward function to next layer / driver
+    return base_layer::get_device_handle(queue)->dispatch_table.QueueBindSparse(
+        queue, bindInfoCount, bind_infos.data(), fence);
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    if (pName)
+    {
+        if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkAllocateMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_AllocateMemory;
+        }
+        else if (!strcmp(pName, "vkFreeMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_FreeMemory;
+        }
+        else if (!strcmp(pName, "vkMapMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_MapMemory;
+        }
+        else if (!strcmp(pName, "vkMapMemory2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_MapMemory2KHR;
+        }
+        else if (!strcmp(pName, "vkUnmapMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_UnmapMemory;
+        }
+        else if (!strcmp(pName, "vkUnmapMemory2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_UnmapMemory2KHR;
+        }
+        else if (!strcmp(pName, "vkFlushMappedMemoryRanges"))
+        {
+            result = (PFN_vkVoidFunction)layer_FlushMappedMemoryRanges;
+        }
+        else if (!strcmp(pName, "vkInvalidateMappedMemoryRanges"))
+        {
+            result = (PFN_vkVoidFunction)layer_InvalidateMappedMemoryRanges;
+        }
+        else if (!strcmp(pName, "vkBindBufferMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindBufferMemory;
+        }
+        else if (!strcmp(pName, "vkBindImageMemory"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindImageMemory;
+        }
+        else if (!strcmp(pName, "vkBindBufferMemory2"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindBufferMemory2;
+        }
+        else if (!strcmp(pName, "vkBindBufferMemory2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindBufferMemory2KHR;
+        }
+        else if (!strcmp(pName, "vkBindImageMemory2"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindImageMemory2;
+        }
+        else if (!strcmp(pName, "vkBindImageMemory2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindImageMemory2KHR;
+        }
+        else if (!strcmp(pName, "vkQueueBindSparse"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueueBindSparse;
+        }
+        else if (!strcmp(pName, "vkBindVideoSessionMemoryKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindVideoSessionMemoryKHR;
+        }
+        else if (!strcmp(pName, "vkBindAccelerationStructureMemoryNV"))
+        {
+            result = (PFN_vkVoidFunction)layer_BindAccelerationStructureMemoryNV;
+        }
+        else if (!strcmp(pName, "vkGetDeviceMemoryCommitment"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetDeviceMemoryCommitment;
+        }
+        else if (!strcmp(pName, "vkSetDeviceMemoryPriorityEXT"))
+        {
+            result = (PFN_vkVoidFunction)layer_SetDeviceMemoryPriorityEXT;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
@@ -0,0 +1,189 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the buddy allocator that splits the blocks of the suballocation layer.
+
+#include "../buddy_allocator.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+static constexpr uint64_t kGranularity = 256;
+static constexpr uint32_t kMaxOrder    = 10;
+static constexpr uint64_t kBlockSize   = kGranularity << kMaxOrder;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (false)
+
+struct range
+{
+    uint64_t offset;
+    uint32_t order;
+};
+
+static uint64_t GetSize(const range& allocated)
+{
+    return kGranularity << allocated.order;
+}
+
+// Checks that the allocated ranges are aligned to their size, lie in the block and do not overlap.
+static void CheckRanges(const std::vector<range>& ranges)
+{
+    std::vector<bool> used(kBlockSize / kGranularity, false);
+    for (const range& allocated : ranges)
+    {
+        CHECK((allocated.offset % GetSize(allocated)) == 0);
+        CHECK((allocated.offset + GetSize(allocated)) <= kBlockSize);
+        const uint64_t first = allocated.offset / kGranularity;
+        const uint64_t end   = (allocated.offset + GetSize(allocated)) / kGranularity;
+        for (uint64_t unit = first; unit < std::min(end, static_cast<uint64_t>(used.size())); ++unit)
+        {
+            CHECK(!used[unit]);
+            used[unit] = true;
+        }
+    }
+}
+
+static void TestGetOrder()
+{
+    CHECK(buddy_allocator::get_order(1, kGranularity) == 0);
+    CHECK(buddy_allocator::get_order(kGranularity, kGranularity) == 0);
+    CHECK(buddy_allocator::get_order(kGranularity + 1, kGranularity) == 1);
+    CHECK(buddy_allocator::get_order(kBlockSize, kGranularity) == kMaxOrder);
+}
+
+static void TestWholeBlock()
+{
+    buddy_allocator allocator;
+    allocator.reset(kGranularity, kMaxOrder);
+
+    uint64_t offset = 1;
+    CHECK(allocator.allocate(kMaxOrder, &offset));
+    CHECK(offset == 0);
+    CHECK(!allocator.allocate(0, &offset));
+
+    allocator.free(kMaxOrder, 0);
+    CHECK(allocator.allocation_count() == 0);
+    CHECK(allocator.allocate(kMaxOrder, &offset));
+}
+
+static void TestFillWithSmallestRanges()
+{
+    buddy_allocator allocator;
+    allocator.reset(kGranularity, kMaxOrder);
+
+    std::vector<range> ranges;
+    uint64_t           offset = 0;
+    while (allocator.allocate(0, &offset))
+    {
+        ranges.push_back(range{ offset, 0 });
+    }
+
+    CHECK(ranges.size() == (kBlockSize / kGranularity));
+    CheckRanges(ranges);
+
+    // Freeing every range merges the block back into one range
+    for (const range& allocated : ranges)
+    {
+        allocator.free(allocated.order, allocated.offset);
+    }
+
+    CHECK(allocator.allocation_count() == 0);
+    CHECK(allocator.allocate(kMaxOrder, &offset) && (offset == 0));
+}
+
+static void TestRandomAllocations()
+{
+    buddy_allocator allocator;
+    allocator.reset(kGranularity, kMaxOrder);
+
+    std::mt19937       random(1234);
+    std::vector<range> ranges;
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        if (!ranges.empty() && ((random() % 3) == 0))
+        {
+            const size_t index = random() % ranges.size();
+            allocator.free(ranges[index].order, ranges[index].offset);
+            std::swap(ranges[index], ranges.back());
+            ranges.pop_back();
+        }
+        else
+        {
+            const uint32_t order  = random() % (kMaxOrder + 1);
+            uint64_t       offset = 0;
+            if (allocator.allocate(order, &offset))
+            {
+                ranges.push_back(range{ offset, order });
+            }
+        }
+
+        CHECK(allocator.allocation_count() == ranges.size());
+        if ((i % 500) == 0)
+        {
+            CheckRanges(ranges);
+        }
+    }
+
+    CheckRanges(ranges);
+
+    std::shuffle(ranges.begin(), ranges.end(), random);
+    for (const range& allocated : ranges)
+    {
+        allocator.free(allocated.order, allocated.offset);
+    }
+
+    uint64_t offset = 1;
+    CHECK(allocator.allocation_count() == 0);
+    CHECK(allocator.allocate(kMaxOrder, &offset) && (offset == 0));
+}
+
+int main()
+{
+    TestGetOrder();
+    TestWholeBlock();
+    TestFillWithSmallestRanges();
+    TestRandomAllocations();
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
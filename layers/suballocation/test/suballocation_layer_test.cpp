@@ -0,0 +1,398 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the suballocation layer against the mock driver, which fails a test when a handle owned by the layer reaches
+// it in place of the memory it allocated.
+
+#include "base_layer/test/mock_driver.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static constexpr uint32_t     kDeviceLocalType  = 0;
+static constexpr uint32_t     kHostVisibleType  = 1;
+static constexpr VkDeviceSize kSuballocatedSize = 64 * 1024;
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (false)
+
+// Number of calls that reached the commands installed in the mock by the test
+static uint32_t commitment_calls = 0;
+static uint32_t priority_calls   = 0;
+
+static VKAPI_ATTR void VKAPI_CALL MockGetDeviceMemoryCommitment(VkDevice       device,
+                                                                VkDeviceMemory memory,
+                                                                VkDeviceSize*  pCommittedMemoryInBytes)
+{
+    (void)device;
+
+    ++commitment_calls;
+    mock_driver::memory_object* allocation = mock_driver::GetMemory(memory);
+    *pCommittedMemoryInBytes               = (allocation != nullptr) ? allocation->size : 0;
+}
+
+static VKAPI_ATTR void VKAPI_CALL MockSetDeviceMemoryPriorityEXT(VkDevice device, VkDeviceMemory memory, float priority)
+{
+    (void)device;
+    (void)priority;
+
+    ++priority_calls;
+    mock_driver::GetMemory(memory);
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL
+MockGetVideoSessionMemoryRequirementsKHR(VkDevice                             device,
+                                         VkVideoSessionKHR                    videoSession,
+                                         uint32_t*                            pMemoryRequirementsCount,
+                                         VkVideoSessionMemoryRequirementsKHR* pMemoryRequirements)
+{
+    (void)device;
+    (void)videoSession;
+
+    if ((pMemoryRequirements != nullptr) && (*pMemoryRequirementsCount > 0))
+    {
+        pMemoryRequirements[0].memoryBindIndex    = 0;
+        pMemoryRequirements[0].memoryRequirements = mock_driver::GetState().resource_requirements;
+    }
+
+    *pMemoryRequirementsCount = 1;
+    return VK_SUCCESS;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL
+MockBindVideoSessionMemoryKHR(VkDevice                               device,
+                              VkVideoSessionKHR                      videoSession,
+                              uint32_t                               bindInfoCount,
+                              const VkBindVideoSessionMemoryInfoKHR* pBindInfos)
+{
+    (void)device;
+    (void)videoSession;
+
+    VkResult result = VK_SUCCESS;
+    for (uint32_t i = 0; (i < bindInfoCount) && (result == VK_SUCCESS); ++i)
+    {
+        result = mock_driver::CheckBind(pBindInfos[i].memory, pBindInfos[i].memoryOffset);
+    }
+
+    return result;
+}
+
+static VKAPI_ATTR void VKAPI_CALL
+MockGetAccelerationStructureMemoryRequirementsNV(VkDevice                                               device,
+                                                 const VkAccelerationStructureMemoryRequirementsInfoNV* pInfo,
+                                                 VkMemoryRequirements2KHR* pMemoryRequirements)
+{
+    (void)device;
+    (void)pInfo;
+    pMemoryRequirements->memoryRequirements = mock_driver::GetState().resource_requirements;
+}
+
+static VKAPI_ATTR VkResult VKAPI_CALL
+MockBindAccelerationStructureMemoryNV(VkDevice                                       device,
+                                      uint32_t                                       bindInfoCount,
+                                      const VkBindAccelerationStructureMemoryInfoNV* pBindInfos)
+{
+    (void)device;
+
+    VkResult result = VK_SUCCESS;
+    for (uint32_t i = 0; (i < bindInfoCount) && (result == VK_SUCCESS); ++i)
+    {
+        result = mock_driver::CheckBind(pBindInfos[i].memory, pBindInfos[i].memoryOffset);
+    }
+
+    return result;
+}
+
+static VkDeviceMemory Allocate(const mock_driver::context& context,
+                               VkDeviceSize                size,
+                               uint32_t                    memory_type,
+                               const void*                 next = nullptr)
+{
+    VkMemoryAllocateInfo allocate_info = { VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO };
+    allocate_info.pNext                = next;
+    allocate_info.allocationSize       = size;
+    allocate_info.memoryTypeIndex      = memory_type;
+
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    CHECK(MOCK_DEVICE_PROC(context, vkAllocateMemory)(context.device, &allocate_info, nullptr, &memory) == VK_SUCCESS);
+    return memory;
+}
+
+static void Free(const mock_driver::context& context, VkDeviceMemory memory)
+{
+    MOCK_DEVICE_PROC(context, vkFreeMemory)(context.device, memory, nullptr);
+}
+
+// Binds a buffer to memory and returns the driver's memory and offset it was bound to.
+static mock_driver::memory_bind Bind(const mock_driver::context& context, VkDeviceMemory memory)
+{
+    const size_t bind_count = mock_driver::GetState().binds.size();
+    CHECK(MOCK_DEVICE_PROC(context, vkBindBufferMemory)(
+              context.device, mock_driver::NewHandle<VkBuffer>(), memory, 0) == VK_SUCCESS);
+
+    const std::vector<mock_driver::memory_bind>& binds = mock_driver::GetState().binds;
+    CHECK(binds.size() == (bind_count + 1));
+    return binds.empty() ? mock_driver::memory_bind{} : binds.back();
+}
+
+static void TestSmallAllocationsShareBlocks()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    const uint64_t              driver_allocations = mock_driver::GetState().memory_allocation_count;
+    std::vector<VkDeviceMemory> allocations;
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        allocations.push_back(Allocate(context, kSuballocatedSize, kDeviceLocalType));
+    }
+
+    // All of them fit in the first block
+    CHECK(mock_driver::GetState().memory_allocation_count == (driver_allocations + 1));
+
+    std::vector<mock_driver::memory_bind> binds;
+    for (VkDeviceMemory memory : allocations)
+    {
+        binds.push_back(Bind(context, memory));
+    }
+
+    for (size_t i = 0; i < binds.size(); ++i)
+    {
+        CHECK(binds[i].memory == binds[0].memory);
+        CHECK((binds[i].offset % kSuballocatedSize) == 0);
+        for (size_t j = 0; j < i; ++j)
+        {
+            CHECK(binds[i].offset != binds[j].offset);
+        }
+    }
+
+    for (VkDeviceMemory memory : allocations)
+    {
+        Free(context, memory);
+    }
+
+    mock_driver::DestroyContext(&context);
+}
+
+static void TestMappedRangesDoNotOverlap()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    VkDeviceMemory first  = Allocate(context, kSuballocatedSize, kHostVisibleType);
+    VkDeviceMemory second = Allocate(context, kSuballocatedSize, kHostVisibleType);
+
+    uint8_t* first_data  = nullptr;
+    uint8_t* second_data = nullptr;
+    CHECK(MOCK_DEVICE_PROC(context, vkMapMemory)(context.device,
+                                                 first,
+                                                 0,
+                                                 VK_WHOLE_SIZE,
+                                                 0,
+                                                 reinterpret_cast<void**>(&first_data)) == VK_SUCCESS);
+    CHECK(MOCK_DEVICE_PROC(context, vkMapMemory)(context.device,
+                                                 second,
+                                                 0,
+                                                 VK_WHOLE_SIZE,
+                                                 0,
+                                                 reinterpret_cast<void**>(&second_data)) == VK_SUCCESS);
+
+    if ((first_data != nullptr) && (second_data != nullptr))
+    {
+        memset(first_data, 0x11, static_cast<size_t>(kSuballocatedSize));
+        memset(second_data, 0x22, static_cast<size_t>(kSuballocatedSize));
+        CHECK((first_data[0] == 0x11) && (first_data[kSuballocatedSize - 1] == 0x11));
+        CHECK((second_data[0] == 0x22) && (second_data[kSuballocatedSize - 1] == 0x22));
+    }
+
+    VkMappedMemoryRange range = { VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE };
+    range.memory              = second;
+    range.size                = VK_WHOLE_SIZE;
+    CHECK(MOCK_DEVICE_PROC(context, vkFlushMappedMemoryRanges)(context.device, 1, &range) == VK_SUCCESS);
+
+    MOCK_DEVICE_PROC(context, vkUnmapMemory)(context.device, first);
+    MOCK_DEVICE_PROC(context, vkUnmapMemory)(context.device, second);
+    Free(context, first);
+    Free(context, second);
+
+    mock_driver::DestroyContext(&context);
+}
+
+static void TestForwardedAllocations()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    // Allocations with a pNext chain and large allocations reach the driver
+    VkMemoryPriorityAllocateInfoEXT priority_info = { VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT };
+    priority_info.priority                        = 1.0f;
+
+    const uint64_t driver_allocations = mock_driver::GetState().memory_allocation_count;
+    VkDeviceMemory chained            = Allocate(context, kSuballocatedSize, kDeviceLocalType, &priority_info);
+    VkDeviceMemory large              = Allocate(context, 16 * 1024 * 1024, kDeviceLocalType);
+    CHECK(mock_driver::GetState().memory_allocation_count == (driver_allocations + 2));
+
+    const size_t errors = mock_driver::GetState().errors;
+    CHECK(Bind(context, chained).memory == chained);
+    CHECK(Bind(context, large).memory == large);
+    CHECK(mock_driver::GetState().errors == errors);
+
+    Free(context, chained);
+    Free(context, large);
+
+    mock_driver::DestroyContext(&context);
+}
+
+static void TestMisalignedBindMovesToDedicatedAllocation()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    VkDeviceMemory first  = Allocate(context, kSuballocatedSize, kDeviceLocalType);
+    VkDeviceMemory second = Allocate(context, kSuballocatedSize, kDeviceLocalType);
+
+    // One of the two is at an odd multiple of its size, which does not meet twice its alignment
+    const mock_driver::memory_bind first_bind         = Bind(context, first);
+    const uint64_t                 driver_allocations = mock_driver::GetState().memory_allocation_count;
+
+    mock_driver::GetState().resource_requirements.alignment = 2 * kSuballocatedSize;
+    const mock_driver::memory_bind second_bind              = Bind(context, second);
+    mock_driver::GetState().resource_requirements.alignment = 256;
+
+    CHECK((second_bind.offset % (2 * kSuballocatedSize)) == 0);
+    if (first_bind.offset == 0)
+    {
+        CHECK(mock_driver::GetState().memory_allocation_count == (driver_allocations + 1));
+        CHECK(second_bind.memory != first_bind.memory);
+    }
+
+    Free(context, first);
+    Free(context, second);
+
+    mock_driver::DestroyContext(&context);
+}
+
+static void TestExtensionCommandsReceiveDriverMemory()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    VkDeviceMemory memory = Allocate(context, kSuballocatedSize, kDeviceLocalType);
+
+    // The commitment and priority of a shared block are not queried or changed for one suballocation
+    VkDeviceSize committed = 0;
+    MOCK_DEVICE_PROC(context, vkGetDeviceMemoryCommitment)(context.device, memory, &committed);
+    MOCK_DEVICE_PROC(context, vkSetDeviceMemoryPriorityEXT)(context.device, memory, 0.5f);
+    CHECK(committed == kSuballocatedSize);
+    CHECK((commitment_calls == 0) && (priority_calls == 0));
+
+    VkBindVideoSessionMemoryInfoKHR video_bind = { VK_STRUCTURE_TYPE_BIND_VIDEO_SESSION_MEMORY_INFO_KHR };
+    video_bind.memoryBindIndex                 = 0;
+    video_bind.memory                          = memory;
+    video_bind.memoryOffset                    = 0;
+    video_bind.memorySize                      = kSuballocatedSize;
+    CHECK(MOCK_DEVICE_PROC(context, vkBindVideoSessionMemoryKHR)(
+              context.device, mock_driver::NewHandle<VkVideoSessionKHR>(), 1, &video_bind) == VK_SUCCESS);
+
+    VkDeviceMemory acceleration_structure_memory = Allocate(context, kSuballocatedSize, kDeviceLocalType);
+
+    VkBindAccelerationStructureMemoryInfoNV acceleration_structure_bind = {
+        VK_STRUCTURE_TYPE_BIND_ACCELERATION_STRUCTURE_MEMORY_INFO_NV
+    };
+    acceleration_structure_bind.accelerationStructure = mock_driver::NewHandle<VkAccelerationStructureNV>();
+    acceleration_structure_bind.memory                = acceleration_structure_memory;
+    CHECK(MOCK_DEVICE_PROC(context, vkBindAccelerationStructureMemoryNV)(
+              context.device, 1, &acceleration_structure_bind) == VK_SUCCESS);
+
+    // Forwarded memory reaches the driver unchanged
+    VkMemoryPriorityAllocateInfoEXT priority_info = { VK_STRUCTURE_TYPE_MEMORY_PRIORITY_ALLOCATE_INFO_EXT };
+
+    VkDeviceMemory forwarded = Allocate(context, kSuballocatedSize, kDeviceLocalType, &priority_info);
+    MOCK_DEVICE_PROC(context, vkGetDeviceMemoryCommitment)(context.device, forwarded, &committed);
+    MOCK_DEVICE_PROC(context, vkSetDeviceMemoryPriorityEXT)(context.device, forwarded, 0.5f);
+    CHECK((commitment_calls == 1) && (priority_calls == 1));
+
+    Free(context, memory);
+    Free(context, acceleration_structure_memory);
+    Free(context, forwarded);
+
+    mock_driver::DestroyContext(&context);
+}
+
+static void TestDestroyDeviceReleasesBlocks()
+{
+    mock_driver::context context;
+    CHECK(mock_driver::CreateContext(&context));
+
+    // Memory the application does not free is released with the device, along with the empty blocks kept per type
+    Allocate(context, kSuballocatedSize, kDeviceLocalType);
+    Allocate(context, kSuballocatedSize, kHostVisibleType);
+
+    VkDeviceMemory freed = Allocate(context, kSuballocatedSize, kHostVisibleType);
+    Free(context, freed);
+
+    mock_driver::DestroyContext(&context);
+    CHECK(mock_driver::GetLiveMemoryCount() == 0);
+}
+
+int main()
+{
+    mock_driver::SetLayerSetting("GFXR_SUBALLOCATION", "1");
+
+    mock_driver::SetFunction("vkGetDeviceMemoryCommitment", MockGetDeviceMemoryCommitment);
+    mock_driver::SetFunction("vkSetDeviceMemoryPriorityEXT", MockSetDeviceMemoryPriorityEXT);
+    mock_driver::SetFunction("vkGetVideoSessionMemoryRequirementsKHR", MockGetVideoSessionMemoryRequirementsKHR);
+    mock_driver::SetFunction("vkBindVideoSessionMemoryKHR", MockBindVideoSessionMemoryKHR);
+    mock_driver::SetFunction("vkGetAccelerationStructureMemoryRequirementsNV",
+                             MockGetAccelerationStructureMemoryRequirementsNV);
+    mock_driver::SetFunction("vkBindAccelerationStructureMemoryNV", MockBindAccelerationStructureMemoryNV);
+
+    TestSmallAllocationsShareBlocks();
+    TestMappedRangesDoNotOverlap();
+    TestForwardedAllocations();
+    TestMisalignedBindMovesToDedicatedAllocation();
+    TestExtensionCommandsReceiveDriverMemory();
+    TestDestroyDeviceReleasesBlocks();
+
+    // Every handle the driver received was one it allocated
+    CHECK(mock_driver::GetState().errors == 0);
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SUBMIT_COALESCING_PENDING_SUBMITS_H
+#define SUBMIT_COALESCING_PENDING_SUBMITS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+// The batches held back by the submit coalescing layer for one device, in submission order, and the semaphores of the
+// device whose payload can leave it. The handle types are template parameters so that the batching can be tested
+// without a Vulkan device. Not thread safe.
+template <typename Queue, typename Semaphore, typename StageFlags, typename CommandBuffer>
+class pending_submits
+{
+  public:
+    struct batch
+    {
+        Queue                      queue{};
+        std::vector<Semaphore>     wait_semaphores;
+        std::vector<StageFlags>    wait_stages;
+        std::vector<CommandBuffer> command_buffers;
+        std::vector<Semaphore>     signal_semaphores;
+    };
+
+    size_t size() const { return count_; }
+
+    // Semaphores that can be exported may be waited on by another device, API or process, which cannot see the
+    // batches held back here.
+    void add_exportable_semaphore(Semaphore semaphore) { exportable_semaphores_.insert(semaphore); }
+
+    void remove_semaphore(Semaphore semaphore) { exportable_semaphores_.erase(semaphore); }
+
+    // Batches that signal an exportable semaphore must be submitted right away.
+    bool can_hold_back(uint32_t signal_semaphore_count, const Semaphore* signal_semaphores) const
+    {
+        if (!exportable_semaphores_.empty())
+        {
+            for (uint32_t i = 0; i < signal_semaphore_count; ++i)
+            {
+                if (exportable_semaphores_.count(signal_semaphores[i]) != 0)
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void add(Queue                queue,
+             uint32_t             wait_semaphore_count,
+             const Semaphore*     wait_semaphores,
+             const StageFlags*    wait_stages,
+             uint32_t             command_buffer_count,
+             const CommandBuffer* command_buffers,
+             uint32_t             signal_semaphore_count,
+             const Semaphore*     signal_semaphores)
+    {
+        // Batches are reused to keep their allocations, only the first count_ are pending
+        if (count_ == batches_.size())
+        {
+            batches_.emplace_back();
+        }
+
+        batch& pending = batches_[count_++];
+        pending.queue  = queue;
+        pending.wait_semaphores.assign(wait_semaphores, wait_semaphores + wait_semaphore_count);
+        pending.wait_stages.assign(wait_stages, wait_stages + wait_semaphore_count);
+        pending.command_buffers.assign(command_buffers, command_buffers + command_buffer_count);
+        pending.signal_semaphores.assign(signal_semaphores, signal_semaphores + signal_semaphore_count);
+    }
+
+    // Calls submit(batches, count, last) for each run of consecutive pending batches on the same queue, in submission
+    // order, with last set for the final run, and then empties the list.
+    template <typename Submit>
+    void flush(Submit submit)
+    {
+        size_t first = 0;
+        while (first < count_)
+        {
+            size_t end = first + 1;
+            while ((end < count_) && (batches_[end].queue == batches_[first].queue))
+            {
+                ++end;
+            }
+
+            submit(&batches_[first], end - first, end == count_);
+            first = end;
+        }
+
+        count_ = 0;
+    }
+
+  private:
+    std::vector<batch>            batches_;
+    size_t                        count_{ 0 };
+    std::unordered_set<Semaphore> exportable_semaphores_;
+};
+
+#endif // SUBMIT_COALESCING_PENDING_SUBMITS_H
@@ -0,0 +1,834 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+#define LAYER_NAME "VK_LAYER_LUNARG_submit_coalescing"
+#define LAYER_VERSION_MAJOR 0
+#define LAYER_VERSION_MINOR 1
+#define LAYER_VERSION_PATCH 0
+#define LAYER_DESCRIPTION "Submit coalescing layer"
+#define LAYER_VERSION_DESIGNATION "-dev"
+
+#include "base_layer/base_layer.inc"
+
+#include "pending_submits.h"
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+// Fence-less vkQueueSubmit batches without pNext chains are held back and forwarded together, one vkQueueSubmit per
+// run of consecutive batches on the same queue. Pending batches are kept in a single list per device in submission
+// order, so that semaphores signaled by a batch are always submitted before the batches that wait on them, even
+// across queues. They are forwarded at the next submit that cannot be held back, and before any command through
+// which the application can observe or wait for queue progress. Batches that signal a semaphore shared outside the
+// device are never held back, as its waiters cannot be seen here.
+static constexpr size_t kMaxPendingBatches = 256;
+
+using submit_batches = pending_submits<VkQueue, VkSemaphore, VkPipelineStageFlags, VkCommandBuffer>;
+
+struct device_state
+{
+    VkDevice   device{ VK_NULL_HANDLE };
+    std::mutex lock;
+
+    submit_batches            pending;
+    std::vector<VkSubmitInfo> submit_infos;
+
+    uint64_t application_submits{ 0 };
+    uint64_t forwarded_submits{ 0 };
+};
+
+static std::shared_mutex                                            device_lock;
+static std::unordered_map<VkDevice, std::unique_ptr<device_state>> device_states;
+
+static bool IsSubmitCoalescingEnabled()
+{
+    static const bool enabled =
+        base_layer::is_layer_setting_enabled("GFXR_SUBMIT_COALESCING", "debug.gfxr.submit_coalescing");
+    return enabled;
+}
+
+static device_state* GetDeviceState(VkDevice device)
+{
+    std::shared_lock<std::shared_mutex> lock(device_lock);
+    auto                                entry = device_states.find(device);
+    return (entry != device_states.end()) ? entry->second.get() : nullptr;
+}
+
+static device_state* GetQueueState(VkQueue queue)
+{
+    base_layer::child_handle_info info;
+    return base_layer::get_child_handle(queue, &info) ? static_cast<device_state*>(info.layer_data) : nullptr;
+}
+
+static void AddExportableSemaphore(VkDevice device, VkSemaphore semaphore)
+{
+    device_state* state = GetDeviceState(device);
+    if (state != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(state->lock);
+        state->pending.add_exportable_semaphore(semaphore);
+    }
+}
+
+// Must be called with state->lock held.
+static bool CanHoldBack(const device_state* state, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+    if ((fence != VK_NULL_HANDLE) || (submitCount == 0))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < submitCount; ++i)
+    {
+        // Chained structures, such as timeline semaphore values, are not copied
+        if ((pSubmits[i].pNext != nullptr) ||
+            !state->pending.can_hold_back(pSubmits[i].signalSemaphoreCount, pSubmits[i].pSignalSemaphores))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static VkSubmitInfo GetSubmitInfo(const submit_batches::batch& batch)
+{
+    VkSubmitInfo submit         = { VK_STRUCTURE_TYPE_SUBMIT_INFO };
+    submit.waitSemaphoreCount   = static_cast<uint32_t>(batch.wait_semaphores.size());
+    submit.pWaitSemaphores      = batch.wait_semaphores.data();
+    submit.pWaitDstStageMask    = batch.wait_stages.data();
+    submit.commandBufferCount   = static_cast<uint32_t>(batch.command_buffers.size());
+    submit.pCommandBuffers      = batch.command_buffers.data();
+    submit.signalSemaphoreCount = static_cast<uint32_t>(batch.signal_semaphores.size());
+    submit.pSignalSemaphores    = batch.signal_semaphores.data();
+    return submit;
+}
+
+// Forwards the pending batches, followed by the submits passed in for queue if it is not VK_NULL_HANDLE. They share
+// the last vkQueueSubmit call when it is for the same queue. Must be called with state->lock held. Returns the first
+// error reported by the next layer.
+static VkResult SubmitPending(
+    device_state* state, VkQueue queue, uint32_t submitCount, const VkSubmitInfo* pSubmits, VkFence fence)
+{
+    VkResult           result         = VK_SUCCESS;
+    bool               submitted      = (queue == VK_NULL_HANDLE);
+    const DeviceTable& dispatch_table = base_layer::get_device_handle(state->device)->dispatch_table;
+
+    state->pending.flush([&](const submit_batches::batch* batches, size_t count, bool last) {
+        const VkQueue run_queue = batches[0].queue;
+
+        state->submit_infos.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            state->submit_infos.push_back(GetSubmitInfo(batches[i]));
+        }
+
+        VkFence run_fence = VK_NULL_HANDLE;
+        if (last && (run_queue == queue))
+        {
+            state->submit_infos.insert(state->submit_infos.end(), pSubmits, pSubmits + submitCount);
+            run_fence = fence;
+            submitted = true;
+        }
+
+        // Forward function to next layer / driver
+        ++state->forwarded_submits;
+        VkResult run_result = dispatch_table.QueueSubmit(
+            run_queue, static_cast<uint32_t>(state->submit_infos.size()), state->submit_infos.data(), run_fence);
+        if (result == VK_SUCCESS)
+        {
+            result = run_result;
+        }
+    });
+
+    if (!submitted)
+    {
+        // Forward function to next layer / driver
+        ++state->forwarded_submits;
+        VkResult submit_result = dispatch_table.QueueSubmit(queue, submitCount, pSubmits, fence);
+        if (result == VK_SUCCESS)
+        {
+            result = submit_result;
+        }
+    }
+
+    return result;
+}
+
+static VkResult FlushDevice(VkDevice device)
+{
+    device_state* state = GetDeviceState(device);
+    if (state == nullptr)
+    {
+        return VK_SUCCESS;
+    }
+
+    std::lock_guard<std::mutex> lock(state->lock);
+    return SubmitPending(state, VK_NULL_HANDLE, 0, nullptr, VK_NULL_HANDLE);
+}
+
+static VkResult FlushQueue(VkQueue queue)
+{
+    device_state* state = GetQueueState(queue);
+    if (state == nullptr)
+    {
+        return VK_SUCCESS;
+    }
+
+    std::lock_guard<std::mutex> lock(state->lock);
+    return SubmitPending(state, VK_NULL_HANDLE, 0, nullptr, VK_NULL_HANDLE);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateInstance(const VkInstanceCreateInfo*  pCreateInfo,
+                                                    const VkAllocationCallbacks* pAllocator,
+                                                    VkInstance*                  pInstance)
+{
+    (void)pCreateInfo;
+    (void)pAllocator;
+    (void)pInstance;
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateDevice(VkPhysicalDevice             physicalDevice,
+                                                  const VkDeviceCreateInfo*    pCreateInfo,
+                                                  const VkAllocationCallbacks* pAllocator,
+                                                  VkDevice*                    pDevice)
+{
+    (void)physicalDevice;
+    (void)pCreateInfo;
+    (void)pAllocator;
+
+    if (IsSubmitCoalescingEnabled())
+    {
+        std::unique_ptr<device_state> state = std::make_unique<device_state>();
+        state->device                       = *pDevice;
+
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        device_states[*pDevice] = std::move(state);
+    }
+
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroyDevice(VkDevice device, const VkAllocationCallbacks* pAllocator)
+{
+    device_state* state = GetDeviceState(device);
+    if (state != nullptr)
+    {
+        {
+            std::lock_guard<std::mutex> lock(state->lock);
+            SubmitPending(state, VK_NULL_HANDLE, 0, nullptr, VK_NULL_HANDLE);
+
+            base_layer::base_layer_print_info("Submit coalescing: %llu vkQueueSubmit calls forwarded as %llu\n",
+                                              static_cast<unsigned long long>(state->application_submits),
+                                              static_cast<unsigned long long>(state->forwarded_submits));
+        }
+
+        std::unique_lock<std::shared_mutex> lock(device_lock);
+        device_states.erase(device);
+    }
+
+    // Forward function to next layer / driver through the base layer, which releases the device's dispatch table
+    base_layer::base_layer_DestroyDevice(device, pAllocator);
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetDeviceQueue(VkDevice device,
+                                                uint32_t queueFamilyIndex,
+                                                uint32_t queueIndex,
+                                                VkQueue* pQueue)
+{
+    // Forward function to next layer / driver through the base layer, which registers the queue
+    base_layer::base_layer_GetDeviceQueue(device, queueFamilyIndex, queueIndex, pQueue);
+
+    device_state* state = GetDeviceState(device);
+    if ((state != nullptr) && (*pQueue != VK_NULL_HANDLE))
+    {
+        base_layer::set_child_handle_data(*pQueue, state);
+    }
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_GetDeviceQueue2(VkDevice                  device,
+                                                 const VkDeviceQueueInfo2* pQueueInfo,
+                                                 VkQueue*                  pQueue)
+{
+    // Forward function to next layer / driver through the base layer, which registers the queue
+    base_layer::base_layer_GetDeviceQueue2(device, pQueueInfo, pQueue);
+
+    device_state* state = GetDeviceState(device);
+    if ((state != nullptr) && (*pQueue != VK_NULL_HANDLE))
+    {
+        base_layer::set_child_handle_data(*pQueue, state);
+    }
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueueSubmit(VkQueue             queue,
+                                                 uint32_t            submitCount,
+                                                 const VkSubmitInfo* pSubmits,
+                                                 VkFence             fence)
+{
+    device_state* state = GetQueueState(queue);
+    if (state == nullptr)
+    {
+        // Forward function to next layer / driver
+        base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(queue);
+        return (device_table != nullptr)
+                   ? device_table->dispatch_table.QueueSubmit(queue, submitCount, pSubmits, fence)
+                   : VK_SUCCESS;
+    }
+
+    std::lock_guard<std::mutex> lock(state->lock);
+    ++state->application_submits;
+
+    if (!CanHoldBack(state, submitCount, pSubmits, fence))
+    {
+        return SubmitPending(state, queue, submitCount, pSubmits, fence);
+    }
+
+    for (uint32_t i = 0; i < submitCount; ++i)
+    {
+        const VkSubmitInfo& submit = pSubmits[i];
+        state->pending.add(queue,
+                           submit.waitSemaphoreCount,
+                           submit.pWaitSemaphores,
+                           submit.pWaitDstStageMask,
+                           submit.commandBufferCount,
+                           submit.pCommandBuffers,
+                           submit.signalSemaphoreCount,
+                           submit.pSignalSemaphores);
+    }
+
+    VkResult result = VK_SUCCESS;
+    if (state->pending.size() >= kMaxPendingBatches)
+    {
+        result = SubmitPending(state, VK_NULL_HANDLE, 0, nullptr, VK_NULL_HANDLE);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueueSubmit2(VkQueue              queue,
+                                                  uint32_t             submitCount,
+                                                  const VkSubmitInfo2* pSubmits,
+                                                  VkFence              fence)
+{
+    VkResult                           result       = FlushQueue(queue);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(queue);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.QueueSubmit2(queue, submitCount, pSubmits, fence);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueueSubmit2KHR(VkQueue              queue,
+                                                     uint32_t             submitCount,
+                                                     const VkSubmitInfo2* pSubmits,
+                                                     VkFence              fence)
+{
+    VkResult                           result       = FlushQueue(queue);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(queue);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.QueueSubmit2KHR(queue, submitCount, pSubmits, fence);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueueBindSparse(VkQueue                 queue,
+                                                     uint32_t                bindInfoCount,
+                                                     const VkBindSparseInfo* pBindInfo,
+                                                     VkFence                 fence)
+{
+    VkResult                           result       = FlushQueue(queue);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(queue);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.QueueBindSparse(queue, bindInfoCount, pBindInfo, fence);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueuePresentKHR(VkQueue queue, const VkPresentInfoKHR* pPresentInfo)
+{
+    VkResult                           result       = FlushQueue(queue);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(queue);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.QueuePresentKHR(queue, pPresentInfo);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_QueueWaitIdle(VkQueue queue)
+{
+    VkResult                           result       = FlushQueue(queue);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(queue);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.QueueWaitIdle(queue);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_DeviceWaitIdle(VkDevice device)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.DeviceWaitIdle(device);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitForFences(
+    VkDevice device, uint32_t fenceCount, const VkFence* pFences, VkBool32 waitAll, uint64_t timeout)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.WaitForFences(device, fenceCount, pFences, waitAll, timeout);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetFenceStatus(VkDevice device, VkFence fence)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetFenceStatus(device, fence);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetEventStatus(VkDevice device, VkEvent event)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetEventStatus(device, event);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetQueryPoolResults(VkDevice           device,
+                                                         VkQueryPool        queryPool,
+                                                         uint32_t           firstQuery,
+                                                         uint32_t           queryCount,
+                                                         size_t             dataSize,
+                                                         void*              pData,
+                                                         VkDeviceSize       stride,
+                                                         VkQueryResultFlags flags)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetQueryPoolResults(
+            device, queryPool, firstQuery, queryCount, dataSize, pData, stride, flags);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitSemaphores(VkDevice                   device,
+                                                    const VkSemaphoreWaitInfo* pWaitInfo,
+                                                    uint64_t                   timeout)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.WaitSemaphores(device, pWaitInfo, timeout);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_WaitSemaphoresKHR(VkDevice                   device,
+                                                       const VkSemaphoreWaitInfo* pWaitInfo,
+                                                       uint64_t                   timeout)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.WaitSemaphoresKHR(device, pWaitInfo, timeout);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetSemaphoreCounterValue(VkDevice device, VkSemaphore semaphore, uint64_t* pValue)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetSemaphoreCounterValue(device, semaphore, pValue);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetSemaphoreCounterValueKHR(VkDevice    device,
+                                                                 VkSemaphore semaphore,
+                                                                 uint64_t*   pValue)
+{
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetSemaphoreCounterValueKHR(device, semaphore, pValue);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetSemaphoreFdKHR(VkDevice                       device,
+                                                       const VkSemaphoreGetFdInfoKHR* pGetFdInfo,
+                                                       int*                           pFd)
+{
+    // Exporting a semaphore's payload requires its signal operation to be submitted
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetSemaphoreFdKHR(device, pGetFdInfo, pFd);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+layer_GetSemaphoreWin32HandleKHR(VkDevice                                device,
+                                 const VkSemaphoreGetWin32HandleInfoKHR* pGetWin32HandleInfo,
+                                 HANDLE*                                 pHandle)
+{
+    // Exporting a semaphore's payload requires its signal operation to be submitted
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetSemaphoreWin32HandleKHR(device, pGetWin32HandleInfo, pHandle);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetFenceFdKHR(VkDevice device, const VkFenceGetFdInfoKHR* pGetFdInfo, int* pFd)
+{
+    // Exporting a fence's payload requires its signal operation to be submitted, after the batches held back before it
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetFenceFdKHR(device, pGetFdInfo, pFd);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_GetFenceWin32HandleKHR(VkDevice                            device,
+                                                            const VkFenceGetWin32HandleInfoKHR* pGetWin32HandleInfo,
+                                                            HANDLE*                             pHandle)
+{
+    // Exporting a fence's payload requires its signal operation to be submitted, after the batches held back before it
+    VkResult                           result       = FlushDevice(device);
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if ((result == VK_SUCCESS) && (device_table != nullptr))
+    {
+        // Forward function to next layer / driver
+        result = device_table->dispatch_table.GetFenceWin32HandleKHR(device, pGetWin32HandleInfo, pHandle);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_CreateSemaphore(VkDevice                     device,
+                                                     const VkSemaphoreCreateInfo* pCreateInfo,
+                                                     const VkAllocationCallbacks* pAllocator,
+                                                     VkSemaphore*                 pSemaphore)
+{
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table == nullptr)
+    {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Forward function to next layer / driver
+    VkResult result = device_table->dispatch_table.CreateSemaphore(device, pCreateInfo, pAllocator, pSemaphore);
+
+    if (result == VK_SUCCESS)
+    {
+        const VkBaseInStructure* next = reinterpret_cast<const VkBaseInStructure*>(pCreateInfo->pNext);
+        while ((next != nullptr) && (next->sType != VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO))
+        {
+            next = next->pNext;
+        }
+
+        if ((next != nullptr) && (reinterpret_cast<const VkExportSemaphoreCreateInfo*>(next)->handleTypes != 0))
+        {
+            AddExportableSemaphore(device, *pSemaphore);
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR void VKAPI_CALL layer_DestroySemaphore(VkDevice                     device,
+                                                  VkSemaphore                  semaphore,
+                                                  const VkAllocationCallbacks* pAllocator)
+{
+    device_state* state = GetDeviceState(device);
+    if ((state != nullptr) && (semaphore != VK_NULL_HANDLE))
+    {
+        std::lock_guard<std::mutex> lock(state->lock);
+        state->pending.remove_semaphore(semaphore);
+    }
+
+    // Forward function to next layer / driver
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table != nullptr)
+    {
+        device_table->dispatch_table.DestroySemaphore(device, semaphore, pAllocator);
+    }
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL layer_ImportSemaphoreFdKHR(VkDevice                          device,
+                                                          const VkImportSemaphoreFdInfoKHR* pImportSemaphoreFdInfo)
+{
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table == nullptr)
+    {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Forward function to next layer / driver
+    VkResult result = device_table->dispatch_table.ImportSemaphoreFdKHR(device, pImportSemaphoreFdInfo);
+
+    // The imported payload may be shared with its exporter
+    if (result == VK_SUCCESS)
+    {
+        AddExportableSemaphore(device, pImportSemaphoreFdInfo->semaphore);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL
+layer_ImportSemaphoreWin32HandleKHR(VkDevice                                   device,
+                                    const VkImportSemaphoreWin32HandleInfoKHR* pImportSemaphoreWin32HandleInfo)
+{
+    base_layer::device_dispatch_table* device_table = base_layer::get_device_handle(device);
+    if (device_table == nullptr)
+    {
+        return VK_ERROR_INITIALIZATION_FAILED;
+    }
+
+    // Forward function to next layer / driver
+    VkResult result =
+        device_table->dispatch_table.ImportSemaphoreWin32HandleKHR(device, pImportSemaphoreWin32HandleInfo);
+
+    // The imported payload may be shared with its exporter
+    if (result == VK_SUCCESS)
+    {
+        AddExportableSemaphore(device, pImportSemaphoreWin32HandleInfo->semaphore);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetProcAddr(const char* pName)
+{
+    PFN_vkVoidFunction result = nullptr;
+
+    // The hooks only flush the batches held back, so they are not installed unless the layer is enabled
+    if (pName && IsSubmitCoalescingEnabled())
+    {
+        if (!strcmp(pName, "vkDestroyDevice"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroyDevice;
+        }
+        else if (!strcmp(pName, "vkGetDeviceQueue"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetDeviceQueue;
+        }
+        else if (!strcmp(pName, "vkGetDeviceQueue2"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetDeviceQueue2;
+        }
+        else if (!strcmp(pName, "vkQueueSubmit"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueueSubmit;
+        }
+        else if (!strcmp(pName, "vkQueueSubmit2"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueueSubmit2;
+        }
+        else if (!strcmp(pName, "vkQueueSubmit2KHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueueSubmit2KHR;
+        }
+        else if (!strcmp(pName, "vkQueueBindSparse"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueueBindSparse;
+        }
+        else if (!strcmp(pName, "vkQueuePresentKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueuePresentKHR;
+        }
+        else if (!strcmp(pName, "vkQueueWaitIdle"))
+        {
+            result = (PFN_vkVoidFunction)layer_QueueWaitIdle;
+        }
+        else if (!strcmp(pName, "vkDeviceWaitIdle"))
+        {
+            result = (PFN_vkVoidFunction)layer_DeviceWaitIdle;
+        }
+        else if (!strcmp(pName, "vkWaitForFences"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitForFences;
+        }
+        else if (!strcmp(pName, "vkGetFenceStatus"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetFenceStatus;
+        }
+        else if (!strcmp(pName, "vkGetEventStatus"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetEventStatus;
+        }
+        else if (!strcmp(pName, "vkGetQueryPoolResults"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetQueryPoolResults;
+        }
+        else if (!strcmp(pName, "vkWaitSemaphores"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitSemaphores;
+        }
+        else if (!strcmp(pName, "vkWaitSemaphoresKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_WaitSemaphoresKHR;
+        }
+        else if (!strcmp(pName, "vkGetSemaphoreCounterValue"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetSemaphoreCounterValue;
+        }
+        else if (!strcmp(pName, "vkGetSemaphoreCounterValueKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetSemaphoreCounterValueKHR;
+        }
+        else if (!strcmp(pName, "vkGetSemaphoreFdKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetSemaphoreFdKHR;
+        }
+        else if (!strcmp(pName, "vkGetSemaphoreWin32HandleKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetSemaphoreWin32HandleKHR;
+        }
+        else if (!strcmp(pName, "vkGetFenceFdKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetFenceFdKHR;
+        }
+        else if (!strcmp(pName, "vkGetFenceWin32HandleKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_GetFenceWin32HandleKHR;
+        }
+        else if (!strcmp(pName, "vkCreateSemaphore"))
+        {
+            result = (PFN_vkVoidFunction)layer_CreateSemaphore;
+        }
+        else if (!strcmp(pName, "vkDestroySemaphore"))
+        {
+            result = (PFN_vkVoidFunction)layer_DestroySemaphore;
+        }
+        else if (!strcmp(pName, "vkImportSemaphoreFdKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_ImportSemaphoreFdKHR;
+        }
+        else if (!strcmp(pName, "vkImportSemaphoreWin32HandleKHR"))
+        {
+            result = (PFN_vkVoidFunction)layer_ImportSemaphoreWin32HandleKHR;
+        }
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetInstanceProcAddr(VkInstance instance, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetInstanceProcAddr(instance, pName);
+    }
+
+    return result;
+}
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL layer_GetDeviceProcAddr(VkDevice device, const char* pName)
+{
+    PFN_vkVoidFunction result = layer_GetProcAddr(pName);
+
+    if (!result)
+    {
+        result = base_layer::base_layer_GetDeviceProcAddr(device, pName);
+    }
+
+    return result;
+}
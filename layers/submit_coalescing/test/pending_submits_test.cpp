@@ -0,0 +1,166 @@
+/*
+** Copyright (c) 2023 Valve Corporation
+** Copyright (c) 2023 LunarG, Inc.
+**
+** Permission is hereby granted, free of charge, to any person obtaining a
+** copy of this software and associated documentation files (the "Software"),
+** to deal in the Software without restriction, including without limitation
+** the rights to use, copy, modify, merge, publish, distribute, sublicense,
+** and/or sell copies of the Software, and to permit persons to whom the
+** Software is furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+** FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+** DEALINGS IN THE SOFTWARE.
+*/
+
+// Tests the batching of the submit coalescing layer with integers standing in for the Vulkan handles.
+
+#include "../pending_submits.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using test_submits = pending_submits<int, int, unsigned, int>;
+
+struct submitted_run
+{
+    int              queue;
+    std::vector<int> command_buffers;
+    bool             last;
+};
+
+static int failures = 0;
+
+#define CHECK(condition)                                                                  \
+    do                                                                                    \
+    {                                                                                     \
+        if (!(condition))                                                                 \
+        {                                                                                 \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            ++failures;                                                                   \
+        }                                                                                 \
+    } while (false)
+
+static void AddBatch(test_submits* submits, int queue, int command_buffer, int signal_semaphore = 0)
+{
+    const int      wait_semaphore = 100 + command_buffer;
+    const unsigned wait_stage     = 1;
+    submits->add(queue,
+                 1,
+                 &wait_semaphore,
+                 &wait_stage,
+                 1,
+                 &command_buffer,
+                 (signal_semaphore != 0) ? 1 : 0,
+                 &signal_semaphore);
+}
+
+static std::vector<submitted_run> Flush(test_submits* submits)
+{
+    std::vector<submitted_run> runs;
+    submits->flush([&runs](const test_submits::batch* batches, size_t count, bool last) {
+        submitted_run run{ batches[0].queue, {}, last };
+        for (size_t i = 0; i < count; ++i)
+        {
+            // A run only holds batches of its queue
+            CHECK(batches[i].queue == run.queue);
+            CHECK(batches[i].wait_semaphores.size() == 1);
+            CHECK(batches[i].wait_semaphores[0] == 100 + batches[i].command_buffers[0]);
+            run.command_buffers.insert(
+                run.command_buffers.end(), batches[i].command_buffers.begin(), batches[i].command_buffers.end());
+        }
+        runs.push_back(run);
+    });
+    return runs;
+}
+
+static void TestConsecutiveBatchesShareARun()
+{
+    test_submits submits;
+    AddBatch(&submits, 1, 10);
+    AddBatch(&submits, 1, 11);
+    AddBatch(&submits, 1, 12);
+    CHECK(submits.size() == 3);
+
+    std::vector<submitted_run> runs = Flush(&submits);
+    CHECK(runs.size() == 1);
+    CHECK(runs[0].queue == 1);
+    CHECK((runs[0].command_buffers == std::vector<int>{ 10, 11, 12 }));
+    CHECK(runs[0].last);
+    CHECK(submits.size() == 0);
+}
+
+static void TestRunsKeepSubmissionOrderAcrossQueues()
+{
+    test_submits submits;
+    AddBatch(&submits, 1, 10);
+    AddBatch(&submits, 2, 20);
+    AddBatch(&submits, 2, 21);
+    AddBatch(&submits, 1, 11);
+
+    std::vector<submitted_run> runs = Flush(&submits);
+    CHECK(runs.size() == 3);
+    CHECK((runs[0].queue == 1) && (runs[0].command_buffers == std::vector<int>{ 10 }) && !runs[0].last);
+    CHECK((runs[1].queue == 2) && (runs[1].command_buffers == std::vector<int>{ 20, 21 }) && !runs[1].last);
+    CHECK((runs[2].queue == 1) && (runs[2].command_buffers == std::vector<int>{ 11 }) && runs[2].last);
+}
+
+static void TestFlushEmptiesAndBatchesAreReused()
+{
+    test_submits submits;
+    CHECK(Flush(&submits).empty());
+
+    AddBatch(&submits, 1, 10);
+    AddBatch(&submits, 1, 11);
+    Flush(&submits);
+    CHECK(submits.size() == 0);
+    CHECK(Flush(&submits).empty());
+
+    // The reused batches must not keep the contents of the previous ones
+    AddBatch(&submits, 3, 30);
+    std::vector<submitted_run> runs = Flush(&submits);
+    CHECK(runs.size() == 1);
+    CHECK((runs[0].queue == 3) && (runs[0].command_buffers == std::vector<int>{ 30 }));
+}
+
+static void TestExportableSemaphoresAreNotHeldBack()
+{
+    test_submits submits;
+    const int    signals[] = { 5, 6 };
+    CHECK(submits.can_hold_back(2, signals));
+    CHECK(submits.can_hold_back(0, nullptr));
+
+    submits.add_exportable_semaphore(6);
+    CHECK(!submits.can_hold_back(2, signals));
+    CHECK(submits.can_hold_back(1, signals));
+
+    // A destroyed semaphore handle can be reused for a semaphore that is not exportable
+    submits.remove_semaphore(6);
+    CHECK(submits.can_hold_back(2, signals));
+}
+
+int main()
+{
+    TestConsecutiveBatchesShareARun();
+    TestRunsKeepSubmissionOrderAcrossQueues();
+    TestFlushEmptiesAndBatchesAreReused();
+    TestExportableSemaphoresAreNotHeldBack();
+
+    if (failures != 0)
+    {
+        fprintf(stderr, "%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}